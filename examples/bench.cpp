@@ -1,7 +1,18 @@
 #include <neo/unicode.hpp>
 
 #define NONIUS_RUNNER
+// nonius uses `concept` as an identifier, which is a keyword when neo::unicode
+// is built with -fconcepts.
+#define concept nonius_concept
 #include <nonius.h++>
+#undef concept
+
+#include <utf8rewind.h>
+
+#include <cstring>
+#include <numeric>
+#include <regex>
+#include <vector>
 
 /**
  * Explicitly instantiate std::string so that we are sure to get the same
@@ -103,4 +114,478 @@ NONIUS_BENCHMARK("Copy large neo::unicode", [](chronometer meter) {
     neo::unicode str = charptr;
     vector<storage_for<neo::unicode>> storage(meter.runs());
     meter.measure([&](int i) { storage[i].construct(str); });
-});
\ No newline at end of file
+});
+
+namespace {
+
+const char* const plagueis
+    = "Did you ever hear the tragedy of Darth Plagueis The Wise? I thought not. It’s not a "
+      "story the Jedi would tell you. It’s a Sith legend. Darth Plagueis was a Dark Lord of "
+      "the Sith, so powerful and so wise he could use the Force to influence the midichlorians "
+      "to create life… He had such a knowledge of the dark side that he could even keep the "
+      "ones he cared about from dying. The dark side of the Force is a pathway to many "
+      "abilities some consider to be unnatural. He became so powerful… the only thing he was "
+      "afraid of was losing his power, which eventually, of course, he did. Unfortunately, he "
+      "taught his apprentice everything he knew, then his apprentice killed him in his sleep. "
+      "Ironic. He could save others from death, but not himself.";
+
+}  // namespace
+
+NONIUS_BENCHMARK("Iterate code points with utf8toutf32", [](chronometer meter) {
+    neo::unicode str = plagueis;
+    meter.measure([&] {
+        std::int32_t errors = 0;
+        const auto size = ::utf8toutf32(str.data(), str.byte_size(), nullptr, 0, &errors);
+        vector<unicode_t> code_points(size / sizeof(unicode_t));
+        ::utf8toutf32(str.data(), str.byte_size(), code_points.data(), size, &errors);
+        char32_t sum = 0;
+        for (auto cp : code_points) {
+            sum += cp;
+        }
+        return sum;
+    });
+});
+
+NONIUS_BENCHMARK("Iterate code points of neo::unicode", [](chronometer meter) {
+    neo::unicode str = plagueis;
+    meter.measure([&] { return std::accumulate(str.begin(), str.end(), char32_t(0)); });
+});
+
+NONIUS_BENCHMARK("Iterate code points of neo::unicode in reverse", [](chronometer meter) {
+    neo::unicode str = plagueis;
+    meter.measure([&] { return std::accumulate(str.rbegin(), str.rend(), char32_t(0)); });
+});
+
+NONIUS_BENCHMARK("Count code points with utf8len", [](chronometer meter) {
+    string str;
+    while (str.size() < 1 << 20) {
+        str += plagueis;
+    }
+    meter.measure([&] { return ::utf8len(str.c_str()); });
+});
+
+NONIUS_BENCHMARK("Count code points with neo::count_code_points", [](chronometer meter) {
+    string str;
+    while (str.size() < 1 << 20) {
+        str += plagueis;
+    }
+    // Vary the size and keep the result, so that the count is neither
+    // hoisted out of the loop nor thrown away
+    volatile std::size_t count = 0;
+    meter.measure([&](int i) { count = neo::count_code_points(str.data(), str.size() - (i & 1)); });
+});
+
+namespace {
+
+const char short_needle[] = "Darth Sidious";
+const char long_needle[] = "Darth Sidious, Dark Lord of the Sith, who killed his master in his sleep";
+
+string search_haystack(const char* needle) {
+    string str;
+    while (str.size() < 1 << 20) {
+        str += plagueis;
+    }
+    return str + needle;
+}
+
+/**
+ * Searches are pure, so the haystack is read through a volatile pointer and
+ * the result is written to a volatile, to keep them from being hoisted out of
+ * the measurement loop or thrown away
+ */
+template <typename T> const T& opaque(const T& v) {
+    const T* volatile p = &v;
+    return *p;
+}
+
+template <typename T> void keep(T v) {
+    volatile T sink = v;
+    (void)sink;
+}
+
+}  // namespace
+
+NONIUS_BENCHMARK("Find a short needle with std::string::find", [](chronometer meter) {
+    const auto str = search_haystack(short_needle);
+    meter.measure([&] { keep(opaque(str).find(short_needle)); });
+});
+
+NONIUS_BENCHMARK("Find a short needle with neo::unicode::find", [](chronometer meter) {
+    const neo::unicode u = search_haystack(short_needle).c_str();
+    meter.measure([&] { keep(opaque(u).find(short_needle).position()); });
+});
+
+NONIUS_BENCHMARK("Find a long needle with std::string::find", [](chronometer meter) {
+    const auto str = search_haystack(long_needle);
+    meter.measure([&] { keep(opaque(str).find(long_needle)); });
+});
+
+NONIUS_BENCHMARK("Find a long needle with neo::unicode::find", [](chronometer meter) {
+    const neo::unicode u = search_haystack(long_needle).c_str();
+    meter.measure([&] { keep(opaque(u).find(long_needle).position()); });
+});
+
+NONIUS_BENCHMARK("Find a byte with memchr", [](chronometer meter) {
+    const auto str = search_haystack("#");
+    meter.measure([&] {
+        const auto& s = opaque(str);
+        keep(std::memchr(s.data(), '#', s.size()));
+    });
+});
+
+NONIUS_BENCHMARK("Find a byte with neo::unicode::find", [](chronometer meter) {
+    const neo::unicode u = search_haystack("#").c_str();
+    meter.measure([&] { keep(opaque(u).find("#").position()); });
+});
+
+NONIUS_BENCHMARK("Find ignoring case with utf8casefold", [](chronometer meter) {
+    const auto str = search_haystack(short_needle);
+    const string needle = "DARTH SIDIOUS";
+    meter.measure([&] {
+        const auto& hay = opaque(str);
+        std::int32_t errors = 0;
+        string folded_hay(::utf8casefold(hay.data(), hay.size(), nullptr, 0, 0, &errors), '\0');
+        ::utf8casefold(hay.data(), hay.size(), &folded_hay[0], folded_hay.size(), 0, &errors);
+        string folded_needle(::utf8casefold(needle.data(), needle.size(), nullptr, 0, 0, &errors),
+                             '\0');
+        ::utf8casefold(needle.data(), needle.size(), &folded_needle[0], folded_needle.size(), 0, &errors);
+        keep(folded_hay.find(folded_needle));
+    });
+});
+
+NONIUS_BENCHMARK("Find ignoring case with neo::unicode::find", [](chronometer meter) {
+    const neo::unicode u = search_haystack(short_needle).c_str();
+    meter.measure([&] { keep(opaque(u).find("DARTH SIDIOUS", neo::match::case_insensitive).position()); });
+});
+
+NONIUS_BENCHMARK("Find canonically equivalent with utf8normalize", [](chronometer meter) {
+    const auto str = search_haystack(short_needle);
+    meter.measure([&] {
+        const auto& hay = opaque(str);
+        std::int32_t errors = 0;
+        const auto flags = UTF8_NORMALIZE_DECOMPOSE;
+        string nfd_hay(::utf8normalize(hay.data(), hay.size(), nullptr, 0, flags, &errors), '\0');
+        ::utf8normalize(hay.data(), hay.size(), &nfd_hay[0], nfd_hay.size(), flags, &errors);
+        keep(nfd_hay.find(short_needle));
+    });
+});
+
+NONIUS_BENCHMARK("Find canonically equivalent with neo::unicode::find", [](chronometer meter) {
+    const neo::unicode u = search_haystack(short_needle).c_str();
+    meter.measure([&] { keep(opaque(u).find(short_needle, neo::match::canonical).position()); });
+});
+
+namespace {
+
+/**
+ * Made-up names, and one at the very end of the haystack
+ */
+std::vector<neo::unicode> keywords(std::size_t n) {
+    std::vector<neo::unicode> ret;
+    std::uint32_t seed = 1;
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+        string word;
+        for (int j = 0; j < 7; ++j) {
+            seed = seed * 1103515245 + 12345;
+            word.push_back(static_cast<char>((j ? 'a' : 'A') + (seed >> 16) % 26));
+        }
+        ret.emplace_back(word.c_str());
+    }
+    ret.emplace_back(short_needle);
+    return ret;
+}
+
+}  // namespace
+
+NONIUS_BENCHMARK("Find 16 keywords with neo::unicode::find", [](chronometer meter) {
+    const neo::unicode u = search_haystack(short_needle).c_str();
+    const auto words = keywords(16);
+    meter.measure([&] {
+        std::size_t n = 0;
+        for (const auto& word : words) {
+            n += opaque(u).contains(word);
+        }
+        keep(n);
+    });
+});
+
+NONIUS_BENCHMARK("Find 16 keywords with neo::pattern_set", [](chronometer meter) {
+    const neo::unicode u = search_haystack(short_needle).c_str();
+    const neo::pattern_set set(keywords(16));
+    meter.measure([&] { keep(set.found_in(opaque(u))); });
+});
+
+NONIUS_BENCHMARK("Find 2000 keywords with neo::pattern_set", [](chronometer meter) {
+    const neo::unicode u = search_haystack(short_needle).c_str();
+    const neo::pattern_set set(keywords(2000));
+    meter.measure([&] { keep(set.found_in(opaque(u))); });
+});
+
+NONIUS_BENCHMARK("Find 2000 keywords ignoring case with neo::pattern_set", [](chronometer meter) {
+    const neo::unicode u = search_haystack(short_needle).c_str();
+    const neo::pattern_set set(keywords(2000), neo::match::case_insensitive);
+    meter.measure([&] { keep(set.found_in(opaque(u))); });
+});
+
+NONIUS_BENCHMARK("Find a regex with std::regex", [](chronometer meter) {
+    const auto str = search_haystack(short_needle);
+    const std::regex re("[A-Z]\\w+ S\\w+s");
+    meter.measure([&] {
+        std::smatch m;
+        keep(std::regex_search(opaque(str), m, re));
+    });
+});
+
+NONIUS_BENCHMARK("Find a regex with neo::regex", [](chronometer meter) {
+    const neo::unicode u = search_haystack(short_needle).c_str();
+    const neo::regex re("[A-Z]\\w+ S\\w+s");
+    meter.measure([&] { keep(re.search(opaque(u)).first.position()); });
+});
+
+NONIUS_BENCHMARK("Find a regex with a literal prefix with neo::regex", [](chronometer meter) {
+    const neo::unicode u = search_haystack(short_needle).c_str();
+    const neo::regex re("Darth S\\w+");
+    meter.measure([&] { keep(re.search(opaque(u)).first.position()); });
+});
+
+NONIUS_BENCHMARK("Find a regex ignoring case with neo::regex", [](chronometer meter) {
+    const neo::unicode u = search_haystack(short_needle).c_str();
+    const neo::regex re("\\p{Lu}\\p{Ll}+ sidious", neo::match::case_insensitive);
+    meter.measure([&] { keep(re.search(opaque(u)).first.position()); });
+});
+
+namespace {
+
+string large_text() {
+    string str;
+    while (str.size() < 1 << 20) {
+        str += plagueis;
+    }
+    return str;
+}
+
+}  // namespace
+
+NONIUS_BENCHMARK("Hash a large std::string with std::hash", [](chronometer meter) {
+    const auto str = large_text();
+    meter.measure([&] { keep(std::hash<string>{}(opaque(str))); });
+});
+
+NONIUS_BENCHMARK("Hash a large std::string with neo::text_hash", [](chronometer meter) {
+    const auto str = large_text();
+    meter.measure([&] { keep(neo::text_hash{}(opaque(str))); });
+});
+
+NONIUS_BENCHMARK("Hash a large neo::unicode again", [](chronometer meter) {
+    const neo::unicode u = large_text().c_str();
+    u.hash();
+    meter.measure([&] { keep(std::hash<neo::unicode>{}(opaque(u))); });
+});
+
+NONIUS_BENCHMARK("Compare UTF-8 with UTF-16 by transcoding", [](chronometer meter) {
+    const neo::unicode u = large_text().c_str();
+    const auto u16 = u.encode<neo::utf16>();
+    const neo::basic_text<neo::utf16> t16 = u16.data();
+    meter.measure([&] {
+        const auto other = opaque(u).encode<neo::utf16>();
+        keep(std::char_traits<char16_t>::compare(other.data(), t16.data(), t16.code_unit_size()));
+    });
+});
+
+NONIUS_BENCHMARK("Compare UTF-8 with UTF-16 with neo::unicode::compare", [](chronometer meter) {
+    const neo::unicode u = large_text().c_str();
+    const auto u16 = u.encode<neo::utf16>();
+    const neo::basic_text<neo::utf16> t16 = u16.data();
+    meter.measure([&] { keep(opaque(u).compare(t16)); });
+});
+
+NONIUS_BENCHMARK("Compare equal large neo::unicode", [](chronometer meter) {
+    const neo::unicode a = large_text().c_str();
+    const neo::unicode b = large_text().c_str();
+    meter.measure([&] { keep(opaque(a).compare(b)); });
+});
+
+NONIUS_BENCHMARK("Count grapheme clusters of neo::unicode", [](chronometer meter) {
+    const neo::unicode u = large_text().c_str();
+    meter.measure([&] {
+        const auto range = neo::graphemes(opaque(u));
+        keep(std::distance(range.begin(), range.end()));
+    });
+});
+
+NONIUS_BENCHMARK("Count grapheme clusters of non-ASCII neo::unicode", [](chronometer meter) {
+    string str;
+    while (str.size() < 1 << 20) {
+        str += "Ελληνικά, русский, हिन्दी, 한국어, 👨‍👩‍👧 🇫🇷. ";
+    }
+    const neo::unicode u = str.c_str();
+    meter.measure([&] {
+        const auto range = neo::graphemes(opaque(u));
+        keep(std::distance(range.begin(), range.end()));
+    });
+});
+
+NONIUS_BENCHMARK("Count words of neo::unicode", [](chronometer meter) {
+    const neo::unicode u = large_text().c_str();
+    meter.measure([&] {
+        const auto range = neo::words(opaque(u));
+        keep(std::distance(range.begin(), range.end()));
+    });
+});
+
+NONIUS_BENCHMARK("Count words of neo::unicode, skipping space and punctuation", [](chronometer meter) {
+    const neo::unicode u = large_text().c_str();
+    meter.measure([&] {
+        const auto range = neo::words(opaque(u), neo::word_segments::skip_space_and_punctuation);
+        keep(std::distance(range.begin(), range.end()));
+    });
+});
+
+NONIUS_BENCHMARK("Count sentences of neo::unicode", [](chronometer meter) {
+    const neo::unicode u = large_text().c_str();
+    meter.measure([&] {
+        const auto range = neo::sentences(opaque(u));
+        keep(std::distance(range.begin(), range.end()));
+    });
+});
+
+NONIUS_BENCHMARK("Count sentences of a stream in 4 KiB pieces", [](chronometer meter) {
+    const auto str = large_text();
+    meter.measure([&] {
+        neo::sentence_stream<neo::utf8> stream;
+        std::size_t n = 0;
+        const auto count = [&](std::size_t) { ++n; };
+        const auto& s = opaque(str);
+        for (std::size_t i = 0; i < s.size(); i += 4096) {
+            stream.feed(s.data() + i, std::min<std::size_t>(4096, s.size() - i), count);
+        }
+        stream.finish(count);
+        keep(n);
+    });
+});
+
+NONIUS_BENCHMARK("Count line break opportunities of neo::unicode", [](chronometer meter) {
+    const neo::unicode u = large_text().c_str();
+    meter.measure([&] {
+        const auto range = neo::line_breaks(opaque(u));
+        keep(std::distance(range.begin(), range.end()));
+    });
+});
+
+NONIUS_BENCHMARK("Resolve bidi levels of left-to-right non-ASCII neo::unicode", [](chronometer meter) {
+    string str;
+    while (str.size() < 1 << 20) {
+        str += "Ελληνικά, русский, हिन्दी, 한국어, “quoted” 123. ";
+    }
+    const neo::unicode u = str.c_str();
+    meter.measure([&] { keep(neo::resolve_bidi(opaque(u)).is_left_to_right()); });
+});
+
+NONIUS_BENCHMARK("Resolve bidi levels of mixed-direction neo::unicode", [](chronometer meter) {
+    string str;
+    while (str.size() < 1 << 20) {
+        str += "English (עברית 123) and العربية ١٢٣, then back. ";
+    }
+    const neo::unicode u = str.c_str();
+    meter.measure([&] { keep(neo::resolve_bidi(opaque(u)).level(opaque(str.size() / 2))); });
+});
+
+NONIUS_BENCHMARK("Measure the display width of neo::unicode", [](chronometer meter) {
+    const neo::unicode u = large_text().c_str();
+    meter.measure([&] { keep(neo::display_width(opaque(u))); });
+});
+
+NONIUS_BENCHMARK("Measure the display width of non-ASCII neo::unicode", [](chronometer meter) {
+    string str;
+    while (str.size() < 1 << 20) {
+        str += "Ελληνικά, русский, हिन्दी, 한국어, 漢字, 👨‍👩‍👧 🇫🇷. ";
+    }
+    const neo::unicode u = str.c_str();
+    meter.measure([&] { keep(neo::display_width(opaque(u))); });
+});
+
+NONIUS_BENCHMARK("Truncate non-ASCII neo::unicode between grapheme clusters", [](chronometer meter) {
+    string str;
+    while (str.size() < 1 << 20) {
+        str += "Ελληνικά, русский, हिन्दी, 한국어, 漢字, 👨‍👩‍👧 🇫🇷. ";
+    }
+    const neo::unicode u = str.c_str();
+    meter.measure([&] { keep(neo::truncate_to(opaque(u), 1000000).code_unit_size()); });
+});
+
+NONIUS_BENCHMARK("Split neo::unicode at spaces", [](chronometer meter) {
+    const neo::unicode u = large_text().c_str();
+    meter.measure([&] {
+        const auto range = neo::split(opaque(u), " ");
+        keep(std::distance(range.begin(), range.end()));
+    });
+});
+
+NONIUS_BENCHMARK("Split neo::unicode at any of space, comma and period", [](chronometer meter) {
+    const neo::unicode u = large_text().c_str();
+    meter.measure([&] {
+        const auto range = neo::split_any(opaque(u), " ,.");
+        keep(std::distance(range.begin(), range.end()));
+    });
+});
+
+namespace {
+
+string log_text() {
+    string str;
+    for (int i = 0; str.size() < 1 << 20; ++i) {
+        str += "2016-08-01 12:00:" + std::to_string(i % 60) + " INFO Request handled in " + std::to_string(i) + " ms\n";
+    }
+    return str;
+}
+
+}  // namespace
+
+NONIUS_BENCHMARK("Count lines of a log in neo::unicode", [](chronometer meter) {
+    const neo::unicode u = log_text().c_str();
+    meter.measure([&] {
+        const auto range = neo::lines(opaque(u));
+        keep(std::distance(range.begin(), range.end()));
+    });
+});
+
+NONIUS_BENCHMARK("Scan the lines of a log with neo::for_each_line", [](chronometer meter) {
+    const auto str = log_text();
+    meter.measure([&] {
+        std::size_t count = 0;
+        neo::for_each_line(opaque(str).data(), str.size(), [&](const neo::scanned_line&) { ++count; });
+        keep(count);
+    });
+});
+
+NONIUS_BENCHMARK("Scan the lines of a log with neo::for_each_line, checking UTF-8", [](chronometer meter) {
+    auto str = log_text();
+    // A few lines with non-ASCII and malformed bytes
+    for (std::size_t i = 1000; i < str.size(); i += 100000) {
+        str.replace(i, 4, "\xc3\xa9\xff ");
+    }
+    meter.measure([&] {
+        std::size_t invalid = 0;
+        neo::for_each_line(opaque(str).data(),
+                           str.size(),
+                           [&](const neo::scanned_line& line) { invalid += !line.valid; },
+                           neo::line_check::utf8);
+        keep(invalid);
+    });
+});
+
+NONIUS_BENCHMARK("Trim a field of neo::unicode", [](chronometer meter) {
+    const neo::unicode u = "  some field value\t";
+    meter.measure([&] { keep(neo::trim(opaque(u)).code_unit_size()); });
+});
+
+NONIUS_BENCHMARK("Trim the fields of a large neo::unicode", [](chronometer meter) {
+    const neo::unicode u = large_text().c_str();
+    meter.measure([&] {
+        std::size_t size = 0;
+        for (const auto field : neo::split(opaque(u), ",")) {
+            size += neo::trim(field).code_unit_size();
+        }
+        keep(size);
+    });
+});
@@ -0,0 +1,89 @@
+#include "any_text.hpp"
+
+using namespace neo;
+
+void any_text::_destroy() noexcept {
+    visit_encoding(_encoding, [this](auto enc) {
+        using buffer = buffer_type_t<decltype(enc)>;
+        const_cast<buffer&>(this->_source_as<decltype(enc)>()).~buffer();
+    });
+    for (std::size_t i = 0; i < n_encodings; ++i) {
+        const auto cached = _cache[i].exchange(nullptr, std::memory_order_acq_rel);
+        if (cached) {
+            visit_encoding(static_cast<encoding_id>(i + 1), [cached](auto enc) {
+                delete static_cast<buffer_type_t<decltype(enc)>*>(cached);
+            });
+        }
+    }
+}
+
+void any_text::_copy_from(const any_text& other) {
+    _encoding = other._encoding;
+    visit_encoding(_encoding, [&](auto enc) {
+        using buffer = buffer_type_t<decltype(enc)>;
+        new (const_cast<buffer*>(&this->_source_as<decltype(enc)>()))
+            buffer(other._source_as<decltype(enc)>());
+    });
+    // The cached buffers are shared, so copying them is cheap
+    for (std::size_t i = 0; i < n_encodings; ++i) {
+        const auto cached = other._cache[i].load(std::memory_order_acquire);
+        if (cached) {
+            visit_encoding(static_cast<encoding_id>(i + 1), [&](auto enc) {
+                using buffer = buffer_type_t<decltype(enc)>;
+                _cache[i].store(new buffer(*static_cast<const buffer*>(cached)),
+                                std::memory_order_release);
+            });
+        }
+    }
+}
+
+any_text::any_text(const any_text& other) {
+    _destroy();
+    try {
+        _copy_from(other);
+    } catch (...) {
+        // The destructor won't run, so drop the cache entries copied so far
+        _destroy();
+        throw;
+    }
+}
+
+any_text::any_text(any_text&& other) noexcept {
+    *this = std::move(other);
+}
+
+any_text& any_text::operator=(const any_text& other) {
+    if (&other != this) {
+        _destroy();
+        _copy_from(other);
+    }
+    return *this;
+}
+
+any_text& any_text::operator=(any_text&& other) noexcept {
+    if (&other == this) {
+        return *this;
+    }
+    _destroy();
+    _encoding = other._encoding;
+    visit_encoding(_encoding, [&](auto enc) {
+        using buffer = buffer_type_t<decltype(enc)>;
+        new (const_cast<buffer*>(&this->_source_as<decltype(enc)>()))
+            buffer(std::move(const_cast<buffer&>(other._source_as<decltype(enc)>())));
+    });
+    for (std::size_t i = 0; i < n_encodings; ++i) {
+        _cache[i].store(other._cache[i].exchange(nullptr, std::memory_order_acq_rel),
+                        std::memory_order_release);
+    }
+    return *this;
+}
+
+any_text::~any_text() {
+    _destroy();
+}
+
+std::size_t any_text::byte_size() const noexcept {
+    return visit_encoding(_encoding, [this](auto enc) -> std::size_t {
+        return this->_source_as<decltype(enc)>().byte_size();
+    });
+}
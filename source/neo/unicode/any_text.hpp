@@ -0,0 +1,217 @@
+#ifndef NEO_UNICODE_ANY_TEXT_HPP_INCLUDED
+#define NEO_UNICODE_ANY_TEXT_HPP_INCLUDED
+
+#include "detect.hpp"
+#include "encoding_id.hpp"
+#include "text.hpp"
+
+#include <atomic>
+#include <ostream>
+#include <type_traits>
+
+namespace neo {
+
+/**
+ * Text whose encoding is chosen at runtime. The code units are kept in the
+ * encoding they arrived in, and are only transcoded when they are asked for
+ * in another encoding. Each transcoding is done once and cached, so repeated
+ * requests share the same buffer.
+ *
+ * The encodings are those named by `encoding_id`. Concurrent use of a const
+ * `any_text` is safe: the cache is filled with a compare-and-swap, and a
+ * thread that loses the race discards its own result.
+ */
+class any_text {
+    static constexpr std::size_t n_encodings = 6;
+
+    union source_buffer {
+        utf8::buffer_type u8;
+        utf16::buffer_type u16;
+        utf32::buffer_type u32;
+
+        source_buffer() noexcept
+            : u8() {
+        }
+        ~source_buffer() {
+        }
+    };
+
+    encoding_id _encoding = encoding_id::utf8;
+    source_buffer _source;
+    /**
+     * One slot per `encoding_id` other than `unknown`, holding a heap-allocated
+     * buffer of that encoding once it has been requested.
+     */
+    mutable std::atomic<void*> _cache[n_encodings] = {};
+
+    static std::size_t _slot(encoding_id id) noexcept {
+        return static_cast<std::size_t>(id) - 1;
+    }
+
+    const utf8::buffer_type& _get(const char*) const noexcept {
+        return _source.u8;
+    }
+    const utf16::buffer_type& _get(const char16_t*) const noexcept {
+        return _source.u16;
+    }
+    const utf32::buffer_type& _get(const char32_t*) const noexcept {
+        return _source.u32;
+    }
+
+    /**
+     * Whether the code units of `Encoding` are of a type that can be held
+     */
+    template <typename Encoding, typename Unit = typename Encoding::code_unit_type>
+    using holds_units = std::integral_constant<bool,
+                                               std::is_same<Unit, char>::value || std::is_same<Unit, char16_t>::value
+                                                   || std::is_same<Unit, char32_t>::value>;
+
+    template <typename Encoding> const buffer_type_t<Encoding>& _source_as() const noexcept {
+        return _get(static_cast<const typename Encoding::code_unit_type*>(nullptr));
+    }
+
+    void _copy_from(const any_text& other);
+    void _destroy() noexcept;
+
+    template <typename Encoding> void _set_source(buffer_type_t<Encoding> buf) noexcept {
+        _destroy();
+        _encoding = encoding_id_of<Encoding>::value;
+        new (const_cast<buffer_type_t<Encoding>*>(&_source_as<Encoding>()))
+            buffer_type_t<Encoding>(std::move(buf));
+    }
+
+public:
+    /**
+     * Construct an empty UTF-8 text
+     */
+    any_text() = default;
+
+    /**
+     * Construct from a buffer of code units of `Encoding`. The buffer is
+     * shared, not copied.
+     */
+    template <typename Encoding>
+    any_text(Encoding, buffer_type_t<Encoding> buf) noexcept {
+        static_assert(holds_units<Encoding>::value, "any_text only holds char, char16_t and char32_t code units");
+        _set_source<Encoding>(std::move(buf));
+    }
+
+    /**
+     * Construct from a text, keeping its encoding. The buffer is shared, not
+     * copied.
+     */
+    template <typename Encoding>
+    any_text(const basic_text<Encoding>& text) noexcept
+        : any_text(Encoding{}, text.template encode<Encoding>()) {
+        static_assert(holds_units<Encoding>::value, "any_text only holds char, char16_t and char32_t code units");
+    }
+
+    /**
+     * Construct from raw bytes in the encoding named by `id`. The bytes are
+     * copied as they are, without validation. Throws `std::invalid_argument`
+     * for `encoding_id::unknown`, or if `size` is not a whole number of code
+     * units.
+     */
+    any_text(encoding_id id, const void* data, std::size_t size) {
+        visit_encoding(id, [&](auto enc) {
+            using encoding = decltype(enc);
+            this->_set_source<encoding>(unicode_detail::buffer_from_bytes<encoding>(data, size));
+        });
+    }
+
+    /**
+     * Construct from raw bytes in whichever encoding `detect_encoding` picks.
+     * A byte order mark is dropped.
+     */
+    static any_text from_bytes(const void* data, std::size_t size) {
+        const auto detected = detect_encoding(data, size);
+        return any_text(detected.encoding(),
+                        static_cast<const char*>(data) + detected.bom_size,
+                        size - detected.bom_size);
+    }
+
+    /**
+     * Copy the text and the encodings cached so far. The source buffer is
+     * shared, but each cached buffer is allocated again, so this may throw.
+     */
+    any_text(const any_text& other);
+    any_text(any_text&& other) noexcept;
+    any_text& operator=(const any_text& other);
+    any_text& operator=(any_text&& other) noexcept;
+    ~any_text();
+
+    /**
+     * The encoding that the text is stored in
+     */
+    encoding_id encoding() const noexcept {
+        return _encoding;
+    }
+
+    /**
+     * The size of the text in bytes, in the encoding it is stored in
+     */
+    std::size_t byte_size() const noexcept;
+
+    /**
+     * Check whether the text is available in the encoding named by `id`
+     * without transcoding.
+     */
+    bool has_encoding(encoding_id id) const noexcept {
+        return id == _encoding || (id != encoding_id::unknown
+                                   && _cache[_slot(id)].load(std::memory_order_acquire));
+    }
+
+    /**
+     * Get the code units of the text in `Encoding`. If the text is stored in
+     * another encoding, it is transcoded on the first request and the result
+     * is cached.
+     */
+    template <typename Encoding> buffer_type_t<Encoding> encode() const {
+        constexpr auto id = encoding_id_of<Encoding>::value;
+        using buffer = buffer_type_t<Encoding>;
+        static_assert(holds_units<Encoding>::value, "any_text only holds char, char16_t and char32_t code units");
+        if (id == _encoding) {
+            return _source_as<Encoding>();
+        }
+        auto& slot = _cache[_slot(id)];
+        void* cached = slot.load(std::memory_order_acquire);
+        if (!cached) {
+            auto fresh = new buffer(visit_encoding(_encoding, [this](auto enc) {
+                using from_encoding = decltype(enc);
+                return convert_encoding<from_encoding, Encoding>(
+                    this->_source_as<from_encoding>());
+            }));
+            if (slot.compare_exchange_strong(cached,
+                                             fresh,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+                cached = fresh;
+            } else {
+                delete fresh;
+            }
+        }
+        return *static_cast<const buffer*>(cached);
+    }
+
+    /**
+     * Get the text as a `basic_text` of `Encoding`. See `encode()`.
+     */
+    template <typename Encoding> basic_text<Encoding> as() const {
+        return basic_text<Encoding>(encode<Encoding>());
+    }
+};
+
+/**
+ * Stream output for `any_text`. Writes from the encoding the text is stored
+ * in, so this never fills the cache.
+ */
+template <typename CharT, typename Traits>
+std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& o,
+                                              const any_text& t) {
+    visit_encoding(t.encoding(), [&](auto enc) { o << t.as<decltype(enc)>(); });
+    return o;
+}
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_ANY_TEXT_HPP_INCLUDED
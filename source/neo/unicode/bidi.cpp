@@ -0,0 +1,590 @@
+#include "bidi.hpp"
+
+#include <algorithm>
+
+namespace neo {
+
+namespace unicode_detail {
+
+namespace {
+
+using bc = bidi_class;
+
+/**
+ * The deepest embedding level of BD2
+ */
+constexpr unsigned max_depth = 125;
+
+/**
+ * The size of the bracket stack of BD16
+ */
+constexpr std::size_t max_bracket_openers = 63;
+
+constexpr std::size_t no_index = std::size_t(-1);
+
+bool is_isolate_initiator(bc t) noexcept {
+    return t == bc::lri || t == bc::rli || t == bc::fsi;
+}
+
+bool is_isolate_control(bc t) noexcept {
+    return is_isolate_initiator(t) || t == bc::pdi;
+}
+
+/**
+ * The neutral and isolate formatting characters of N1, NI for short
+ */
+bool is_neutral_or_isolate(bc t) noexcept {
+    return t == bc::b || t == bc::s || t == bc::ws || t == bc::on || is_isolate_control(t);
+}
+
+/**
+ * The direction that N0 and N1 see in a resolved type: EN and AN are R, and
+ * everything that isn't strong is ON
+ */
+bc strong_direction(bc t) noexcept {
+    if (t == bc::l) {
+        return bc::l;
+    }
+    if (t == bc::r || t == bc::al || t == bc::en || t == bc::an) {
+        return bc::r;
+    }
+    return bc::on;
+}
+
+bc direction_of_level(unsigned level) noexcept {
+    return (level & 1) ? bc::r : bc::l;
+}
+
+/**
+ * BD16 pairs U+2329 and U+232A with their canonical equivalents U+3008 and
+ * U+3009
+ */
+char32_t canonical_bracket(char32_t cp) noexcept {
+    return cp == 0x2329 ? 0x3008 : cp == 0x232A ? 0x3009 : cp;
+}
+
+const bidi_bracket& find_bracket(char32_t cp) noexcept {
+    return *std::lower_bound(bidi_brackets,
+                             bidi_brackets + bidi_bracket_count,
+                             cp,
+                             [](const bidi_bracket& b, char32_t c) { return b.code_point < c; });
+}
+
+/**
+ * Rules P2 to I2 over the paragraphs of a text. The arrays are kept across
+ * paragraphs and isolating run sequences so that they are only allocated
+ * once.
+ */
+class bidi_resolver {
+    struct stack_entry {
+        unsigned level;
+        bc override_status;
+        bool isolate;
+    };
+
+    struct opener {
+        char32_t closing;
+        std::size_t position;
+    };
+
+    const char32_t* _cps;
+    std::uint8_t* _levels;
+    std::vector<std::uint8_t> _props;
+    // The embedding levels of X1 to X8, before the types are resolved
+    std::vector<std::uint8_t> _embedding;
+    // The types as the rules change them
+    std::vector<bc> _types;
+    // The matching PDI of each isolate initiator, by BD9. Only allocated
+    // once there is an isolate initiator.
+    std::vector<std::size_t> _matching_pdi;
+    // Where the level runs of BD7 start, then the end of the paragraph, and
+    // whether each run continues an isolating run sequence
+    std::vector<std::size_t> _run_starts;
+    std::vector<bool> _chained;
+    std::vector<stack_entry> _stack;
+    std::vector<std::size_t> _sequence;
+    std::vector<bc> _sequence_types;
+    std::vector<opener> _openers;
+    std::vector<std::pair<std::size_t, std::size_t>> _bracket_pairs;
+
+    bc original(std::size_t i) const noexcept {
+        return static_cast<bc>(_props[i] & 0x1F);
+    }
+
+    bool removed(std::size_t i) const noexcept {
+        return is_removed_by_x9(original(i));
+    }
+
+    /**
+     * P2 and P3 over [i, last): 0 or 1 for the first L, or R or AL, outside
+     * of isolates, or -1 if there is none
+     */
+    int first_strong_level(std::size_t i, std::size_t last) const noexcept {
+        for (; i < last; ++i) {
+            const auto t = original(i);
+            if (t == bc::l) {
+                return 0;
+            }
+            if (t == bc::r || t == bc::al) {
+                return 1;
+            }
+            if (is_isolate_initiator(t)) {
+                if (_matching_pdi[i] == no_index) {
+                    break;
+                }
+                i = _matching_pdi[i];
+            }
+        }
+        return -1;
+    }
+
+    void match_isolates(std::size_t first, std::size_t last) {
+        auto& open = _sequence;
+        open.clear();
+        for (auto i = first; i != last; ++i) {
+            const auto t = original(i);
+            if (is_isolate_initiator(t)) {
+                _matching_pdi.resize(_props.size());
+                _matching_pdi[i] = no_index;
+                open.push_back(i);
+            } else if (t == bc::pdi && !open.empty()) {
+                _matching_pdi[open.back()] = i;
+                open.pop_back();
+            }
+        }
+    }
+
+    /**
+     * X1 to X8
+     */
+    void explicit_levels(std::size_t first, std::size_t last, unsigned paragraph_level) {
+        _stack.clear();
+        _stack.push_back({paragraph_level, bc::on, false});
+        unsigned overflow_isolates = 0;
+        unsigned overflow_embeddings = 0;
+        unsigned valid_isolates = 0;
+        for (auto i = first; i != last; ++i) {
+            const auto t = original(i);
+            _types[i] = t;
+            const auto top = _stack.back();
+            _embedding[i] = static_cast<std::uint8_t>(top.level);
+            switch (t) {
+            case bc::rle:
+            case bc::lre:
+            case bc::rlo:
+            case bc::lro: {
+                const bool rtl = t == bc::rle || t == bc::rlo;
+                const unsigned level = rtl ? (top.level + 1) | 1 : (top.level + 2) & ~1u;
+                if (level <= max_depth && overflow_isolates == 0 && overflow_embeddings == 0) {
+                    const auto override_status = t == bc::rlo ? bc::r : t == bc::lro ? bc::l : bc::on;
+                    _stack.push_back({level, override_status, false});
+                } else if (overflow_isolates == 0) {
+                    ++overflow_embeddings;
+                }
+                break;
+            }
+            case bc::rli:
+            case bc::lri:
+            case bc::fsi: {
+                if (top.override_status != bc::on) {
+                    _types[i] = top.override_status;
+                }
+                bool rtl = t == bc::rli;
+                if (t == bc::fsi) {
+                    const auto end = _matching_pdi[i] == no_index ? last : _matching_pdi[i];
+                    rtl = first_strong_level(i + 1, end) == 1;
+                }
+                const unsigned level = rtl ? (top.level + 1) | 1 : (top.level + 2) & ~1u;
+                if (level <= max_depth && overflow_isolates == 0 && overflow_embeddings == 0) {
+                    ++valid_isolates;
+                    _stack.push_back({level, bc::on, true});
+                } else {
+                    ++overflow_isolates;
+                }
+                break;
+            }
+            case bc::pdi:
+                if (overflow_isolates > 0) {
+                    --overflow_isolates;
+                } else if (valid_isolates > 0) {
+                    overflow_embeddings = 0;
+                    while (!_stack.back().isolate) {
+                        _stack.pop_back();
+                    }
+                    _stack.pop_back();
+                    --valid_isolates;
+                }
+                _embedding[i] = static_cast<std::uint8_t>(_stack.back().level);
+                if (_stack.back().override_status != bc::on) {
+                    _types[i] = _stack.back().override_status;
+                }
+                break;
+            case bc::pdf:
+                if (overflow_isolates > 0) {
+                } else if (overflow_embeddings > 0) {
+                    --overflow_embeddings;
+                } else if (!top.isolate && _stack.size() >= 2) {
+                    _stack.pop_back();
+                }
+                break;
+            case bc::b:
+                _embedding[i] = static_cast<std::uint8_t>(paragraph_level);
+                break;
+            case bc::bn:
+                break;
+            default:
+                if (top.override_status != bc::on) {
+                    _types[i] = top.override_status;
+                }
+                break;
+            }
+        }
+    }
+
+    /**
+     * W1 to W7 over the types of an isolating run sequence
+     */
+    static void resolve_weak_types(std::vector<bc>& t, bc sos, bc eos) noexcept {
+        const auto m = t.size();
+        for (std::size_t k = 0; k < m; ++k) {
+            if (t[k] == bc::nsm) {
+                t[k] = k == 0 ? sos : is_isolate_control(t[k - 1]) ? bc::on : t[k - 1];
+            }
+        }
+        auto last_strong = sos;
+        for (auto& type : t) {
+            if (type == bc::l || type == bc::r || type == bc::al) {
+                last_strong = type;
+            } else if (type == bc::en && last_strong == bc::al) {
+                type = bc::an;
+            }
+        }
+        for (auto& type : t) {
+            if (type == bc::al) {
+                type = bc::r;
+            }
+        }
+        for (std::size_t k = 1; k + 1 < m; ++k) {
+            const auto before = t[k - 1];
+            if ((t[k] == bc::es || t[k] == bc::cs) && before == bc::en && t[k + 1] == bc::en) {
+                t[k] = bc::en;
+            } else if (t[k] == bc::cs && before == bc::an && t[k + 1] == bc::an) {
+                t[k] = bc::an;
+            }
+        }
+        for (std::size_t k = 0; k < m;) {
+            if (t[k] != bc::et) {
+                ++k;
+                continue;
+            }
+            const auto start = k;
+            while (k < m && t[k] == bc::et) {
+                ++k;
+            }
+            const auto before = start == 0 ? sos : t[start - 1];
+            const auto after = k == m ? eos : t[k];
+            if (before == bc::en || after == bc::en) {
+                for (auto j = start; j != k; ++j) {
+                    t[j] = bc::en;
+                }
+            }
+        }
+        for (auto& type : t) {
+            if (type == bc::es || type == bc::et || type == bc::cs) {
+                type = bc::on;
+            }
+        }
+        last_strong = sos;
+        for (auto& type : t) {
+            if (type == bc::l || type == bc::r) {
+                last_strong = type;
+            } else if (type == bc::en && last_strong == bc::l) {
+                type = bc::l;
+            }
+        }
+    }
+
+    /**
+     * BD16 and N0: brackets take the direction of what they enclose, or of
+     * what comes before them
+     */
+    void resolve_brackets(bc sos, unsigned level) {
+        auto& t = _sequence_types;
+        const auto m = t.size();
+        _openers.clear();
+        _bracket_pairs.clear();
+        for (std::size_t k = 0; k < m; ++k) {
+            const auto i = _sequence[k];
+            if (t[k] != bc::on || !(_props[i] & bidi_bracket_bit)) {
+                continue;
+            }
+            const auto cp = canonical_bracket(_cps[i]);
+            const auto& bracket = find_bracket(cp);
+            if (bracket.opening) {
+                if (_openers.size() == max_bracket_openers) {
+                    break;
+                }
+                _openers.push_back({canonical_bracket(bracket.pair), k});
+                continue;
+            }
+            for (auto j = _openers.size(); j-- > 0;) {
+                if (_openers[j].closing == cp) {
+                    _bracket_pairs.emplace_back(_openers[j].position, k);
+                    _openers.resize(j);
+                    break;
+                }
+            }
+        }
+        std::sort(_bracket_pairs.begin(), _bracket_pairs.end());
+
+        const auto embedding = direction_of_level(level);
+        const auto set_bracket = [&](std::size_t k, bc dir) {
+            t[k] = dir;
+            for (++k; k < m && original(_sequence[k]) == bc::nsm; ++k) {
+                t[k] = dir;
+            }
+        };
+        for (const auto& pair : _bracket_pairs) {
+            auto found = bc::on;
+            for (auto k = pair.first + 1; k < pair.second; ++k) {
+                const auto d = strong_direction(t[k]);
+                if (d == embedding) {
+                    found = d;
+                    break;
+                }
+                if (d != bc::on) {
+                    found = d;
+                }
+            }
+            if (found == bc::on) {
+                continue;
+            }
+            auto dir = embedding;
+            if (found != embedding) {
+                auto context = sos;
+                for (auto k = pair.first; k-- > 0;) {
+                    const auto d = strong_direction(t[k]);
+                    if (d != bc::on) {
+                        context = d;
+                        break;
+                    }
+                }
+                dir = context == found ? found : embedding;
+            }
+            set_bracket(pair.first, dir);
+            set_bracket(pair.second, dir);
+        }
+    }
+
+    /**
+     * W1 to I2 for the isolating run sequence in `_sequence`
+     */
+    void resolve_sequence(std::size_t first, std::size_t last, unsigned paragraph_level) {
+        const auto start = _sequence.front();
+        const auto end = _sequence.back();
+        const unsigned level = _embedding[start];
+        auto before = start;
+        while (before != first && removed(before - 1)) {
+            --before;
+        }
+        const unsigned level_before = before == first ? paragraph_level : _embedding[before - 1];
+        auto after = end + 1;
+        while (after != last && removed(after)) {
+            ++after;
+        }
+        const unsigned level_after
+            = is_isolate_initiator(original(end)) || after == last ? paragraph_level : _embedding[after];
+        const auto sos = direction_of_level(std::max(level, level_before));
+        const auto eos = direction_of_level(std::max(level, level_after));
+
+        auto& t = _sequence_types;
+        t.clear();
+        for (const auto i : _sequence) {
+            t.push_back(_types[i]);
+        }
+        resolve_weak_types(t, sos, eos);
+        resolve_brackets(sos, level);
+
+        // N1 and N2
+        const auto m = t.size();
+        for (std::size_t k = 0; k < m;) {
+            if (!is_neutral_or_isolate(t[k])) {
+                ++k;
+                continue;
+            }
+            const auto start = k;
+            while (k < m && is_neutral_or_isolate(t[k])) {
+                ++k;
+            }
+            const auto lead = start == 0 ? sos : strong_direction(t[start - 1]);
+            const auto trail = k == m ? eos : strong_direction(t[k]);
+            const auto dir = lead == trail ? lead : direction_of_level(level);
+            for (auto j = start; j != k; ++j) {
+                t[j] = dir;
+            }
+        }
+
+        // I1 and I2
+        for (std::size_t k = 0; k < m; ++k) {
+            const auto i = _sequence[k];
+            auto& lv = _levels[i];
+            lv = _embedding[i];
+            if (lv & 1) {
+                lv = static_cast<std::uint8_t>(lv + (t[k] == bc::l || t[k] == bc::en || t[k] == bc::an));
+            } else if (t[k] == bc::r) {
+                lv = static_cast<std::uint8_t>(lv + 1);
+            } else if (t[k] == bc::en || t[k] == bc::an) {
+                lv = static_cast<std::uint8_t>(lv + 2);
+            }
+        }
+    }
+
+    /**
+     * X9 and X10: resolve each isolating run sequence of [first, last)
+     */
+    void resolve_sequences(std::size_t first, std::size_t last, unsigned paragraph_level) {
+        _run_starts.clear();
+        auto previous = no_index;
+        for (auto i = first; i != last; ++i) {
+            if (removed(i)) {
+                continue;
+            }
+            if (previous == no_index || _embedding[i] != _embedding[previous]) {
+                _run_starts.push_back(i);
+            }
+            previous = i;
+        }
+        const auto runs = _run_starts.size();
+        _run_starts.push_back(last);
+        _chained.assign(runs, false);
+        for (std::size_t run = 0; run < runs; ++run) {
+            if (_chained[run]) {
+                continue;
+            }
+            _sequence.clear();
+            auto current = run;
+            while (true) {
+                for (auto i = _run_starts[current]; i != _run_starts[current + 1]; ++i) {
+                    if (!removed(i)) {
+                        _sequence.push_back(i);
+                    }
+                }
+                const auto tail = _sequence.back();
+                if (!is_isolate_initiator(original(tail)) || _matching_pdi[tail] == no_index) {
+                    break;
+                }
+                const auto pdi = _matching_pdi[tail];
+                const auto next = std::lower_bound(_run_starts.begin(), _run_starts.end(), pdi);
+                if (*next != pdi) {
+                    break;
+                }
+                current = static_cast<std::size_t>(next - _run_starts.begin());
+                _chained[current] = true;
+            }
+            resolve_sequence(first, last, paragraph_level);
+        }
+    }
+
+    /**
+     * Give the characters that X9 removes the level of the character before
+     * them, and apply the parts of L1 that don't depend on where lines break
+     */
+    void finish_levels(std::size_t first, std::size_t last, unsigned paragraph_level) noexcept {
+        for (auto i = first; i != last; ++i) {
+            if (is_removed_by_x9(original(i))) {
+                _levels[i] = static_cast<std::uint8_t>(i == first ? paragraph_level : _levels[i - 1]);
+            }
+        }
+        bool trailing = true;
+        for (auto i = last; i-- > first;) {
+            const auto t = original(i);
+            if (t == bc::b || t == bc::s) {
+                _levels[i] = static_cast<std::uint8_t>(paragraph_level);
+                trailing = true;
+            } else if (trailing && is_whitespace_for_l1(t)) {
+                _levels[i] = static_cast<std::uint8_t>(paragraph_level);
+            } else {
+                trailing = false;
+            }
+        }
+    }
+
+public:
+    bidi_resolver(const char32_t* cps, std::size_t size, std::uint8_t* levels)
+        : _cps(cps)
+        , _levels(levels)
+        , _props(size)
+        , _embedding(size)
+        , _types(size) {
+        for (std::size_t i = 0; i < size; ++i) {
+            _props[i] = bidi_properties(cps[i]);
+        }
+    }
+
+    void resolve(text_direction direction, std::vector<bidi_paragraph>& paragraphs) {
+        const auto size = _props.size();
+        std::size_t first = 0;
+        while (first != size) {
+            // P1, keeping CR LF together
+            auto last = first;
+            while (last != size && original(last) != bc::b) {
+                ++last;
+            }
+            if (last != size) {
+                ++last;
+                if (_cps[last - 1] == '\r' && last != size && _cps[last] == '\n') {
+                    ++last;
+                }
+            }
+            match_isolates(first, last);
+            unsigned level = direction == text_direction::right_to_left ? 1 : 0;
+            if (direction == text_direction::automatic) {
+                level = first_strong_level(first, last) == 1 ? 1 : 0;
+            }
+            explicit_levels(first, last, level);
+            resolve_sequences(first, last, level);
+            finish_levels(first, last, level);
+            paragraphs.push_back({last, static_cast<std::uint8_t>(level)});
+            first = last;
+        }
+    }
+};
+
+}  // namespace
+
+void resolve_bidi_levels(const char32_t* code_points,
+                         std::size_t size,
+                         text_direction direction,
+                         std::uint8_t* levels,
+                         std::vector<bidi_paragraph>& paragraphs) {
+    bidi_resolver(code_points, size, levels).resolve(direction, paragraphs);
+}
+
+void reorder_by_levels(std::size_t* order, std::uint8_t* levels, std::size_t size) noexcept {
+    unsigned highest = 0;
+    unsigned lowest_odd = 0xFF;
+    for (std::size_t k = 0; k < size; ++k) {
+        highest = std::max<unsigned>(highest, levels[k]);
+        if (levels[k] & 1) {
+            lowest_odd = std::min<unsigned>(lowest_odd, levels[k]);
+        }
+    }
+    for (auto level = highest; level >= lowest_odd; --level) {
+        for (std::size_t k = 0; k < size;) {
+            if (levels[k] < level) {
+                ++k;
+                continue;
+            }
+            const auto start = k;
+            while (k < size && levels[k] >= level) {
+                ++k;
+            }
+            std::reverse(order + start, order + k);
+            std::reverse(levels + start, levels + k);
+        }
+    }
+}
+
+}  // namespace unicode_detail
+
+}  // namespace neo
@@ -0,0 +1,367 @@
+#ifndef NEO_UNICODE_BIDI_HPP_INCLUDED
+#define NEO_UNICODE_BIDI_HPP_INCLUDED
+
+#include "repertoire.hpp"
+#include "search.hpp"
+#include "simd.hpp"
+#include "text.hpp"
+#include "text_view.hpp"
+#include "ucd_tables.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace neo {
+
+/**
+ * The base direction of the paragraphs of a text
+ */
+enum class text_direction : unsigned char {
+    /// From the first strong character of each paragraph, by rules P2 and P3
+    /// of UAX #9, or left-to-right if there is none
+    automatic,
+    left_to_right,
+    right_to_left,
+};
+
+namespace unicode_detail {
+
+constexpr bidi_class bidi_class_of(std::uint8_t props) noexcept {
+    return static_cast<bidi_class>(props & 0x1F);
+}
+
+/**
+ * The characters that rule X9 removes: embeddings, overrides and BN
+ */
+constexpr bool is_removed_by_x9(bidi_class c) noexcept {
+    return c == bidi_class::lre || c == bidi_class::lro || c == bidi_class::rle || c == bidi_class::rlo
+        || c == bidi_class::pdf || c == bidi_class::bn;
+}
+
+/**
+ * The characters that rule L1 resets to the paragraph level before a
+ * separator or the end of a line
+ */
+constexpr bool is_whitespace_for_l1(bidi_class c) noexcept {
+    return c == bidi_class::ws || c == bidi_class::lri || c == bidi_class::rli || c == bidi_class::fsi
+        || c == bidi_class::pdi || is_removed_by_x9(c);
+}
+
+/**
+ * The classes without which every level of a paragraph that isn't
+ * right-to-left is zero: strong right-to-left, Arabic digits, and explicit
+ * formatting
+ */
+constexpr bool is_right_to_left_or_explicit(bidi_class c) noexcept {
+    return c == bidi_class::r || c == bidi_class::al || c == bidi_class::an
+        || (c >= bidi_class::lre && c <= bidi_class::pdi);
+}
+
+/**
+ * Whether a right-to-left or explicit formatting code point could start at a
+ * code unit of value `u` in UTF-8, UTF-16 or UTF-32. The generator checks
+ * that in UTF-8 they only start with these lead bytes, which cover U+0580 to
+ * U+0FFF, U+2000 to U+2FFF, and U+F000 to U+3FFFF.
+ */
+inline bool may_start_right_to_left(std::uint8_t u) noexcept {
+    return (u >= 0xD6 && u <= 0xE0) || u == 0xE2 || u == 0xEF || u == 0xF0;
+}
+
+inline bool may_start_right_to_left(std::uint16_t u) noexcept {
+    return (u >= 0x0580 && u <= 0x0FFF) || (u >= 0x2000 && u <= 0x2FFF) || u >= 0xF000
+        || (u >= 0xD800 && u <= 0xD8BF);
+}
+
+inline bool may_start_right_to_left(std::uint32_t u) noexcept {
+    return (u >= 0x0580 && u <= 0x0FFF) || (u >= 0x2000 && u <= 0x2FFF) || (u >= 0xF000 && u <= 0x3FFFF);
+}
+
+#if NEO_UNICODE_HAVE_SSE2
+template <std::size_t Size> __m128i lanes_in_range(__m128i v, std::int32_t lo, std::int32_t hi) noexcept {
+    using lanes = unit_lanes<Size>;
+    return _mm_and_si128(lanes::gt(v, lanes::splat(static_cast<std::uint32_t>(lo - 1))),
+                         lanes::gt(lanes::splat(static_cast<std::uint32_t>(hi + 1)), v));
+}
+
+/**
+ * `may_start_right_to_left()` for each lane, with the ranges as the signed
+ * numbers that the comparisons see
+ */
+template <std::size_t Size> struct right_to_left_lanes;
+
+template <> struct right_to_left_lanes<1> {
+    static __m128i candidates(__m128i v) noexcept {
+        // 0xD6 to 0xE0, 0xE2, and 0xEF to 0xF0
+        const auto e2 = lanes_in_range<1>(v, -30, -30);
+        return _mm_or_si128(_mm_or_si128(lanes_in_range<1>(v, -42, -32), e2), lanes_in_range<1>(v, -17, -16));
+    }
+};
+
+template <> struct right_to_left_lanes<2> {
+    static __m128i candidates(__m128i v) noexcept {
+        // 0xF000 to 0xFFFF, and the high surrogates of U+10000 to U+3FFFF
+        const auto low = _mm_or_si128(lanes_in_range<2>(v, 0x0580, 0x0FFF), lanes_in_range<2>(v, 0x2000, 0x2FFF));
+        const auto high = _mm_or_si128(lanes_in_range<2>(v, -0x1000, -1), lanes_in_range<2>(v, -0x2800, -0x2741));
+        return _mm_or_si128(low, high);
+    }
+};
+
+template <> struct right_to_left_lanes<4> {
+    static __m128i candidates(__m128i v) noexcept {
+        const auto low = _mm_or_si128(lanes_in_range<4>(v, 0x0580, 0x0FFF), lanes_in_range<4>(v, 0x2000, 0x2FFF));
+        return _mm_or_si128(low, lanes_in_range<4>(v, 0xF000, 0x3FFFF));
+    }
+};
+#endif
+
+/**
+ * Skip the code units from `p` at which no right-to-left or explicit
+ * formatting character can start, a block at a time
+ */
+template <typename Unit> const Unit* skip_left_to_right(const Unit* p, const Unit* last) noexcept {
+    using unit = std::conditional_t<sizeof(Unit) == 1,
+                                    std::uint8_t,
+                                    std::conditional_t<sizeof(Unit) == 2, std::uint16_t, std::uint32_t>>;
+#if NEO_UNICODE_HAVE_SSE2
+    constexpr std::size_t width = 16 / sizeof(Unit);
+    while (last - p >= static_cast<std::ptrdiff_t>(width)) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const auto candidates = right_to_left_lanes<sizeof(Unit)>::candidates(v);
+        const auto found
+            = static_cast<std::uint32_t>(_mm_movemask_epi8(candidates)) & unit_lanes<sizeof(Unit)>::lane_bits;
+        if (found) {
+            return p + count_trailing_zeros(found) / sizeof(Unit);
+        }
+        p += width;
+    }
+#endif
+    while (p != last && !may_start_right_to_left(static_cast<unit>(*p))) {
+        ++p;
+    }
+    return p;
+}
+
+/**
+ * Whether any code point in [p, last) is right-to-left or explicit
+ * formatting. Only the code points at the units that `skip_left_to_right()`
+ * stops at are decoded.
+ */
+template <typename Encoding, typename Unit> bool has_right_to_left(const Unit* p, const Unit* last) noexcept {
+    while (p != last) {
+        if (ascii_code_units<Encoding>::value) {
+            p = skip_left_to_right(p, last);
+            if (p == last) {
+                break;
+            }
+        }
+        const auto cp = decoder<Encoding>::next(p, last);
+        if (is_right_to_left_or_explicit(bidi_class_of(bidi_properties(cp)))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+struct bidi_paragraph {
+    // The index of the code point after the paragraph, or its code unit
+    // offset in `bidi_levels`
+    std::size_t end;
+    std::uint8_t level;
+};
+
+/**
+ * Resolve the embedding levels of `size` code points by rules P1 to I2 of
+ * UAX #9, and the parts of L1 that don't depend on where lines break. Sets a
+ * level for each code point, and appends the end and level of every
+ * paragraph to `paragraphs`.
+ */
+void resolve_bidi_levels(const char32_t* code_points,
+                         std::size_t size,
+                         text_direction direction,
+                         std::uint8_t* levels,
+                         std::vector<bidi_paragraph>& paragraphs);
+
+/**
+ * Rule L2: reverse every run of `order` at each level from the highest to
+ * the lowest odd one. `levels` is reordered along with it.
+ */
+void reorder_by_levels(std::size_t* order, std::uint8_t* levels, std::size_t size) noexcept;
+
+}  // namespace unicode_detail
+
+/**
+ * The embedding levels of a text by the Unicode Bidirectional Algorithm
+ * (UAX #9), as returned by `resolve_bidi()`. Odd levels are right-to-left.
+ * Levels are kept by code unit offset, the same for every unit of a code
+ * point, and text without right-to-left or explicit formatting characters
+ * has no levels to keep. It refers to the text, which must outlive it.
+ */
+template <typename Encoding> class bidi_levels {
+public:
+    using code_unit_type = typename Encoding::code_unit_type;
+
+private:
+    const code_unit_type* _first;
+    const code_unit_type* _last;
+    // The level of every code unit, or empty if they are all zero
+    std::vector<std::uint8_t> _levels;
+    // The end of every paragraph, as a code unit offset, and its level
+    std::vector<unicode_detail::bidi_paragraph> _paragraphs;
+
+    void _resolve(text_direction direction) {
+        const auto size = static_cast<std::size_t>(_last - _first);
+        std::vector<char32_t> cps;
+        cps.reserve(size);
+        for (auto p = _first; p != _last;) {
+            cps.push_back(decoder<Encoding>::next(p, _last));
+        }
+        std::vector<std::uint8_t> levels(cps.size());
+        unicode_detail::resolve_bidi_levels(cps.data(), cps.size(), direction, levels.data(), _paragraphs);
+        if (std::all_of(levels.begin(), levels.end(), [](std::uint8_t l) { return l == 0; })) {
+            _paragraphs.clear();
+            return;
+        }
+        // Decode again to spread the levels and paragraph ends over code
+        // units, rather than keep the offset of every code point
+        _levels.resize(size);
+        auto para = _paragraphs.begin();
+        std::size_t k = 0;
+        for (auto p = _first; p != _last; ++k) {
+            const auto offset = static_cast<std::size_t>(p - _first);
+            if (para->end == k) {
+                para->end = offset;
+                ++para;
+            }
+            decoder<Encoding>::next(p, _last);
+            std::fill(_levels.data() + offset, _levels.data() + (p - _first), levels[k]);
+        }
+        para->end = size;
+    }
+
+public:
+    /**
+     * Resolve the levels of [first, last) with paragraphs in `direction`.
+     * Nothing is decoded unless the text might have right-to-left or
+     * explicit formatting characters, or `direction` is right-to-left. A
+     * `known` repertoire of ASCII or Latin-1 has none.
+     */
+    bidi_levels(const code_unit_type* first,
+                const code_unit_type* last,
+                text_direction direction,
+                repertoire known = repertoire::any)
+        : _first(first)
+        , _last(last) {
+        if (direction == text_direction::right_to_left
+            || (known > repertoire::latin1 && unicode_detail::has_right_to_left<Encoding>(first, last))) {
+            _resolve(direction);
+        }
+    }
+
+    /**
+     * Whether every level is zero, so that the text is displayed in logical
+     * order
+     */
+    bool is_left_to_right() const noexcept {
+        return _levels.empty();
+    }
+
+    /**
+     * The level of the code point that has the code unit at `offset`
+     */
+    std::uint8_t level(std::size_t offset) const noexcept {
+        return _levels.empty() ? 0 : _levels[offset];
+    }
+
+    /**
+     * The level of the paragraph that has the code unit at `offset`
+     */
+    std::uint8_t paragraph_level(std::size_t offset) const noexcept {
+        const auto para = std::upper_bound(_paragraphs.begin(),
+                                           _paragraphs.end(),
+                                           offset,
+                                           [](std::size_t o, const unicode_detail::bidi_paragraph& p) {
+                                               return o < p.end;
+                                           });
+        return para == _paragraphs.end() ? 0 : para->level;
+    }
+
+    /**
+     * The reordering map of the line [first, last), which must not cross
+     * paragraphs: the code unit offset of each of its code points in the
+     * order they are displayed, by rules L1 and L2
+     */
+    std::vector<std::size_t> visual_order(std::size_t first, std::size_t last) const {
+        std::vector<std::size_t> order;
+        auto p = _first + first;
+        const auto end = _first + last;
+        if (_levels.empty()) {
+            while (p != end) {
+                order.push_back(static_cast<std::size_t>(p - _first));
+                decoder<Encoding>::next(p, end);
+            }
+            return order;
+        }
+        std::vector<std::uint8_t> levels;
+        while (p != end) {
+            const auto offset = static_cast<std::size_t>(p - _first);
+            order.push_back(offset);
+            levels.push_back(_levels[offset]);
+            decoder<Encoding>::next(p, end);
+        }
+        // L1 for the whitespace at the end of the line
+        for (auto k = order.size(); k-- > 0;) {
+            auto q = _first + order[k];
+            const auto props = unicode_detail::bidi_properties(decoder<Encoding>::next(q, end));
+            if (!unicode_detail::is_whitespace_for_l1(unicode_detail::bidi_class_of(props))) {
+                break;
+            }
+            levels[k] = paragraph_level(first);
+        }
+        unicode_detail::reorder_by_levels(order.data(), levels.data(), order.size());
+        return order;
+    }
+
+    /**
+     * The reordering map of the whole text, with each paragraph as one line
+     */
+    std::vector<std::size_t> visual_order() const {
+        if (_paragraphs.empty()) {
+            return visual_order(0, static_cast<std::size_t>(_last - _first));
+        }
+        std::vector<std::size_t> order;
+        std::size_t first = 0;
+        for (const auto& para : _paragraphs) {
+            const auto line = visual_order(first, para.end);
+            order.insert(order.end(), line.begin(), line.end());
+            first = para.end;
+        }
+        return order;
+    }
+};
+
+/**
+ * Resolve the embedding levels of `text` by the Unicode Bidirectional
+ * Algorithm. Text that is all left-to-right, as most is, costs one scan and
+ * no allocation.
+ */
+template <typename Encoding, typename Buffer>
+bidi_levels<Encoding> resolve_bidi(const basic_text<Encoding, Buffer>& text,
+                                   text_direction direction = text_direction::automatic) {
+    return bidi_levels<Encoding>(text.data(), text.data() + text.code_unit_size(), direction, text.repertoire());
+}
+
+template <typename Encoding, typename Buffer>
+void resolve_bidi(const basic_text<Encoding, Buffer>&&, text_direction = text_direction::automatic) = delete;
+
+template <typename Encoding>
+bidi_levels<Encoding> resolve_bidi(basic_text_view<Encoding> view,
+                                   text_direction direction = text_direction::automatic) {
+    return bidi_levels<Encoding>(view.data(), view.data() + view.code_unit_size(), direction);
+}
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_BIDI_HPP_INCLUDED
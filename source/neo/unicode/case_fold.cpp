@@ -0,0 +1,39 @@
+#include "case_fold.hpp"
+
+#include "encodings/all.hpp"
+
+#include <cstdint>
+
+extern "C" {
+#include <internal/database.h>
+}
+
+namespace neo {
+
+namespace unicode_detail {
+
+std::size_t fold_case_from_table(char32_t cp, char32_t* out) noexcept {
+    if (cp < 0x110000 && (PROPERTY_GET_CM(cp) & QuickCheckCaseMapped_Casefolded)) {
+        std::uint8_t length = 0;
+        auto folded = database_querydecomposition(static_cast<unicode_t>(cp),
+                                                  CaseFoldingIndex1Ptr,
+                                                  CaseFoldingIndex2Ptr,
+                                                  CaseFoldingDataPtr,
+                                                  &length);
+        if (folded) {
+            // The folding is stored as UTF-8
+            const auto end = folded + length;
+            std::size_t n = 0;
+            while (folded != end && n < max_case_fold_size) {
+                out[n++] = decoder<utf8>::next(folded, end);
+            }
+            return n;
+        }
+    }
+    out[0] = cp;
+    return 1;
+}
+
+}  // namespace unicode_detail
+
+}  // namespace neo
@@ -0,0 +1,38 @@
+#ifndef NEO_UNICODE_CASE_FOLD_HPP_INCLUDED
+#define NEO_UNICODE_CASE_FOLD_HPP_INCLUDED
+
+#include <cstddef>
+
+namespace neo {
+
+namespace unicode_detail {
+
+/**
+ * The most code points that one code point folds to
+ */
+constexpr std::size_t max_case_fold_size = 3;
+
+/**
+ * Look up the full case folding of `cp` in the Unicode database, and write
+ * it to `out`. Returns the number of code points written.
+ */
+std::size_t fold_case_from_table(char32_t cp, char32_t* out) noexcept;
+
+/**
+ * Write the full case folding of `cp` to `out`, which has room for
+ * `max_case_fold_size` code points, and return how many were written. ASCII
+ * is folded inline.
+ */
+inline std::size_t fold_case(char32_t cp, char32_t* out) noexcept {
+    if (cp < 0x80) {
+        out[0] = (cp - U'A' < 26) ? cp + 0x20 : cp;
+        return 1;
+    }
+    return fold_case_from_table(cp, out);
+}
+
+}  // namespace unicode_detail
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_CASE_FOLD_HPP_INCLUDED
@@ -0,0 +1,109 @@
+#ifndef NEO_UNICODE_CODE_POINT_INDEX_HPP_INCLUDED
+#define NEO_UNICODE_CODE_POINT_INDEX_HPP_INCLUDED
+
+#include "code_unit_buffer.hpp"
+#include "counting.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace neo {
+
+namespace unicode_detail {
+
+/**
+ * Code unit offsets of every `stride`th code point of a text. Seeking to a
+ * code point starts from the nearest checkpoint before it, so it takes time
+ * proportional to `stride` instead of to the length of the text.
+ */
+struct code_point_index : buffer_attachment {
+    std::size_t stride;
+    // offsets[i] is the offset of code point `i * stride`
+    std::vector<std::size_t> offsets;
+
+    /**
+     * Build the index for the code units [first, last) of `Encoding`. This is
+     * one pass of `code_point_counter<Encoding>::advance()`. A `stride` of
+     * zero is taken as one.
+     */
+    template <typename Encoding, typename Unit>
+    static std::unique_ptr<code_point_index>
+    build(const Unit* first, const Unit* last, std::size_t stride) {
+        if (stride == 0) {
+            stride = 1;
+        }
+        auto index = std::make_unique<code_point_index>();
+        index->stride = stride;
+        index->offsets.reserve(static_cast<std::size_t>(last - first) / stride + 1);
+        for (auto p = first; p != last;) {
+            index->offsets.push_back(static_cast<std::size_t>(p - first));
+            auto n = stride;
+            p = code_point_counter<Encoding>::advance(p, last, n);
+        }
+        return index;
+    }
+
+    /**
+     * Get the offset of the checkpoint nearest before code point `n`, and
+     * subtract the index of that checkpoint from `n`.
+     */
+    std::size_t checkpoint(std::size_t& n) const noexcept {
+        if (offsets.empty()) {
+            return 0;
+        }
+        auto i = n / stride;
+        if (i >= offsets.size()) {
+            i = offsets.size() - 1;
+        }
+        n -= i * stride;
+        return offsets[i];
+    }
+};
+
+template <typename T>
+using attachment_t = decltype(std::declval<const T&>().attachment());
+
+/**
+ * Get the code point index attached to a buffer, or null if it has none or
+ * the buffer type doesn't support attachments.
+ */
+template <typename Buffer, typename = std::enable_if_t<is_detected_v<attachment_t, Buffer>>>
+const code_point_index* code_point_index_of(const Buffer& buf) noexcept {
+    return dynamic_cast<const code_point_index*>(buf.attachment());
+}
+
+template <typename Buffer,
+          typename = std::enable_if_t<!is_detected_v<attachment_t, Buffer>>,
+          typename = void>
+const code_point_index* code_point_index_of(const Buffer&) noexcept {
+    return nullptr;
+}
+
+/**
+ * Build a code point index and attach it to a buffer, if it can hold one.
+ */
+template <typename Encoding,
+          typename Buffer,
+          typename = std::enable_if_t<is_detected_v<attachment_t, Buffer>>>
+void attach_code_point_index(const Buffer& buf, std::size_t stride) {
+    if (!buf.can_attach() || buf.attachment()) {
+        return;
+    }
+    buf.attach(code_point_index::build<Encoding>(buf.data(),
+                                                 buf.data() + buf.code_unit_size(),
+                                                 stride));
+}
+
+template <typename Encoding,
+          typename Buffer,
+          typename = std::enable_if_t<!is_detected_v<attachment_t, Buffer>>,
+          typename = void>
+void attach_code_point_index(const Buffer&, std::size_t) {
+}
+
+}  // namespace unicode_detail
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_CODE_POINT_INDEX_HPP_INCLUDED
@@ -0,0 +1,109 @@
+#ifndef NEO_UNICODE_CODE_POINT_ITERATOR_HPP_INCLUDED
+#define NEO_UNICODE_CODE_POINT_ITERATOR_HPP_INCLUDED
+
+#include "encodings/encodings.hpp"
+
+#include <cstddef>
+#include <iterator>
+
+namespace neo {
+
+/**
+ * A bidirectional iterator over the code points of a code unit sequence in
+ * `Encoding`. Dereferencing yields the `char32_t` code point. Malformed
+ * sequences yield U+FFFD, and they are stepped over the same way in both
+ * directions.
+ *
+ * The iterator decodes each code point once, when it arrives at it, and
+ * keeps the result. It knows the bounds of the whole sequence, so it can be
+ * moved in either direction from any position.
+ */
+template <typename Encoding> class code_point_iterator {
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = char32_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = char32_t;
+    using code_unit_type = typename Encoding::code_unit_type;
+
+private:
+    using decoder_type = decoder<Encoding>;
+
+    const code_unit_type* _begin = nullptr;
+    const code_unit_type* _pos = nullptr;
+    // The end of the code point at `_pos`
+    const code_unit_type* _next = nullptr;
+    const code_unit_type* _end = nullptr;
+    char32_t _cp = 0;
+
+    void _decode() noexcept {
+        _next = _pos;
+        if (_pos != _end) {
+            _cp = decoder_type::next(_next, _end);
+        }
+    }
+
+public:
+    code_point_iterator() = default;
+
+    /**
+     * Construct an iterator at `pos`, which must be the start of a code point
+     * in [begin, end].
+     */
+    code_point_iterator(const code_unit_type* begin,
+                        const code_unit_type* pos,
+                        const code_unit_type* end) noexcept
+        : _begin(begin)
+        , _pos(pos)
+        , _end(end) {
+        _decode();
+    }
+
+    /**
+     * Get a pointer to the first code unit of the current code point
+     */
+    const code_unit_type* position() const noexcept {
+        return _pos;
+    }
+
+    char32_t operator*() const noexcept {
+        return _cp;
+    }
+
+    code_point_iterator& operator++() noexcept {
+        _pos = _next;
+        _decode();
+        return *this;
+    }
+
+    code_point_iterator operator++(int) noexcept {
+        auto copy = *this;
+        ++*this;
+        return copy;
+    }
+
+    code_point_iterator& operator--() noexcept {
+        _next = _pos;
+        _cp = decoder_type::prev(_pos, _begin);
+        return *this;
+    }
+
+    code_point_iterator operator--(int) noexcept {
+        auto copy = *this;
+        --*this;
+        return copy;
+    }
+
+    friend bool operator==(const code_point_iterator& a, const code_point_iterator& b) noexcept {
+        return a._pos == b._pos;
+    }
+
+    friend bool operator!=(const code_point_iterator& a, const code_point_iterator& b) noexcept {
+        return !(a == b);
+    }
+};
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_CODE_POINT_ITERATOR_HPP_INCLUDED
@@ -8,6 +8,7 @@
 #include <memory>
 
 #include "concepts.hpp"
+#include "repertoire.hpp"
 
 namespace neo {
 
@@ -17,6 +18,18 @@ namespace neo {
  */
 static constexpr std::size_t small_size = 32;
 
+namespace unicode_detail {
+
+/**
+ * Base class for data that is computed from the code units of a buffer and
+ * cached alongside them. See `code_unit_buffer::attach()`.
+ */
+struct buffer_attachment {
+    virtual ~buffer_attachment() = default;
+};
+
+}  // namespace unicode_detail
+
 /**
  * `neo::code_unit_buffer` is a class template for working with sequences of
  * code units. It manages allocation and the like.
@@ -36,6 +49,12 @@ static constexpr std::size_t small_size = 32;
  *      `code_unit_buffer` will not copy the bytes, just increase a refcount to
  *      the allocated buffer. This makes copying `unicode` objects extremely
  *      cheap, even for many large strings.
+ *
+ * Because the contents never change, the buffer also records the smallest
+ * `neo::repertoire` that covers them. It is computed when the code units are
+ * copied in, or on first request for string literals. Dynamically allocated
+ * buffers can also carry an attachment, such as an index into the code
+ * units, which is shared by all copies of the buffer.
  */
 template <neo_concept_param(CodeUnit) T, typename Allocator = std::allocator<char>>
 class code_unit_buffer {
@@ -118,6 +137,12 @@ private:
         std::atomic<std::size_t> refs;
         // Size is the length of the string
         size_type size;
+        // The number of code points, or `uncounted`
+        std::atomic<size_type> code_points;
+        // The hash of the code units, or `unhashed`
+        std::atomic<std::size_t> hash;
+        // Cached data derived from the string, or null
+        std::atomic<const unicode_detail::buffer_attachment*> attachment;
         double _align;
         // The buffer lies here
         value_type arr[1];
@@ -150,11 +175,30 @@ private:
      */
     mode _mode = small;
 
+    /**
+     * Sentinel for `_repertoire` meaning that we haven't classified the
+     * contents yet
+     */
+    static constexpr unsigned char unclassified = 0xFF;
+
+    /**
+     * The `neo::repertoire` of the contents, or `unclassified`. Literals are
+     * classified lazily, so this may be written from a const member.
+     */
+    mutable std::atomic<unsigned char> _repertoire{
+        static_cast<unsigned char>(neo::repertoire::ascii)};
+
     /**
      * The allocator. TODO: Use EBO on this
      */
     allocator_type _alloc;
 
+    void _classify() noexcept {
+        _repertoire.store(static_cast<unsigned char>(
+                              unicode_detail::classify(data(), code_unit_size())),
+                          std::memory_order_relaxed);
+    }
+
     char* _dynamic_as_char_ptr() {
         return reinterpret_cast<char*>(_content.dynamic);
     }
@@ -168,10 +212,11 @@ private:
         auto old_refs = _content.dynamic->refs.fetch_sub(1, std::memory_order_relaxed);
         if (old_refs == 1) {
             // No more references to our dynamic data. Free the data
+            delete _content.dynamic->attachment.load(std::memory_order_acquire);
             Alloc::deallocate(_alloc,
                               _dynamic_as_char_ptr(),
-                              // The size hint. Add the size of the string.
-                              (_content.dynamic->size + sizeof(value_type)) + sizeof(dynamic_data));
+                              // The size hint. The same size as in `_init_dynamic`
+                              sizeof(dynamic_data) + (_content.dynamic->size * sizeof(value_type)));
             // Reset the dynamic data, we aren't using it anymore
             _content.dynamic = nullptr;
         }
@@ -195,6 +240,7 @@ private:
         _mode = literal;
         _content.literal.pointer = ptr;
         _content.literal.size = len;
+        _repertoire.store(unclassified, std::memory_order_relaxed);
     }
 
     dynamic_data* _steal_dynamic() && {
@@ -204,6 +250,8 @@ private:
         _mode = small;
         _content.small.size = 0;
         _content.small.arr[0] = value_type(0);
+        _repertoire.store(static_cast<unsigned char>(neo::repertoire::ascii),
+                          std::memory_order_relaxed);
         return ptr;
     }
 
@@ -220,6 +268,9 @@ private:
         // Initialize the dynamic data
         _content.dynamic->refs.store(1, std::memory_order_relaxed);  // One reference
         _content.dynamic->size = size;                               // Size of string
+        _content.dynamic->code_points.store(uncounted, std::memory_order_relaxed);
+        _content.dynamic->hash.store(unhashed, std::memory_order_relaxed);
+        _content.dynamic->attachment.store(nullptr, std::memory_order_relaxed);
         _content.dynamic->arr[size] = value_type(0);                 // Add null terminator
     }
 
@@ -287,6 +338,7 @@ public:
         const auto size = std::distance(first, last);
         auto wr_ptr = _prepare_storage(size);
         std::char_traits<T>::copy(wr_ptr, first, size);
+        _classify();
     }
 
     template <typename CharPointer,
@@ -310,6 +362,8 @@ public:
     code_unit_buffer(code_unit_buffer&& other) noexcept {
         if (other._mode == dynamic) {
             // Steal their dynamic pointer. No need to do any reference counting
+            _repertoire.store(other._repertoire.load(std::memory_order_relaxed),
+                              std::memory_order_relaxed);
             _content.dynamic = std::move(other)._steal_dynamic();
             _mode = dynamic;
         } else {
@@ -341,6 +395,8 @@ public:
         }
         // Take their mode
         _mode = other._mode;
+        _repertoire.store(other._repertoire.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
         return *this;
     }
 
@@ -354,6 +410,8 @@ public:
         }
         _alloc = Alloc::select_on_container_copy_construction(other._alloc);
         if (other._mode == dynamic) {
+            _repertoire.store(other._repertoire.load(std::memory_order_relaxed),
+                              std::memory_order_relaxed);
             _content.dynamic = std::move(other)._steal_dynamic();
             _mode = dynamic;
         } else {
@@ -399,6 +457,111 @@ public:
         std::terminate();
     }
 
+    /**
+     * Get the smallest repertoire that covers the code units in the buffer.
+     */
+    neo::repertoire repertoire() const noexcept {
+        auto r = _repertoire.load(std::memory_order_relaxed);
+        if (r == unclassified) {
+            // Racing threads will all compute the same value. That's fine.
+            r = static_cast<unsigned char>(unicode_detail::classify(data(), code_unit_size()));
+            _repertoire.store(r, std::memory_order_relaxed);
+        }
+        return static_cast<neo::repertoire>(r);
+    }
+
+    /**
+     * Returned by `cached_code_point_count()` if there is no count
+     */
+    static constexpr size_type uncounted = static_cast<size_type>(-1);
+
+    /**
+     * Get the number of code points stored by `cache_code_point_count()`, or
+     * `uncounted`. Only dynamically allocated buffers store a count, and it is
+     * shared by all copies of the buffer.
+     */
+    size_type cached_code_point_count() const noexcept {
+        if (_mode != dynamic) {
+            return uncounted;
+        }
+        return _content.dynamic->code_points.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Store the number of code points in the buffer, if it can hold it.
+     * Threads that race to store it will store the same number.
+     */
+    void cache_code_point_count(size_type n) const noexcept {
+        if (_mode == dynamic) {
+            _content.dynamic->code_points.store(n, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Returned by `cached_hash()` if there is no hash
+     */
+    static constexpr std::size_t unhashed = 0;
+
+    /**
+     * Get the hash stored by `cache_hash()`, or `unhashed`. Only dynamically
+     * allocated buffers store a hash, and it is shared by all copies of the
+     * buffer.
+     */
+    std::size_t cached_hash() const noexcept {
+        if (_mode != dynamic) {
+            return unhashed;
+        }
+        return _content.dynamic->hash.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Store the hash of the code units, if the buffer can hold it. Threads
+     * that race to store it will store the same hash.
+     */
+    void cache_hash(std::size_t h) const noexcept {
+        if (_mode == dynamic) {
+            _content.dynamic->hash.store(h, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Get the attachment of the buffer, or null if it has none.
+     */
+    const unicode_detail::buffer_attachment* attachment() const noexcept {
+        if (_mode != dynamic) {
+            return nullptr;
+        }
+        return _content.dynamic->attachment.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Check whether the buffer can hold an attachment. Only dynamically
+     * allocated buffers can.
+     */
+    bool can_attach() const noexcept {
+        return _mode == dynamic;
+    }
+
+    /**
+     * Attach `att` to the buffer, unless it already has an attachment. Only
+     * dynamically allocated buffers can hold one. Returns the attachment that
+     * the buffer ends up with, which is null if it can't hold one.
+     */
+    const unicode_detail::buffer_attachment*
+    attach(std::unique_ptr<const unicode_detail::buffer_attachment> att) const noexcept {
+        if (_mode != dynamic) {
+            return nullptr;
+        }
+        const unicode_detail::buffer_attachment* expected = nullptr;
+        if (_content.dynamic->attachment.compare_exchange_strong(expected,
+                                                                 att.get(),
+                                                                 std::memory_order_acq_rel,
+                                                                 std::memory_order_acquire)) {
+            return att.release();
+        }
+        return expected;
+    }
+
     /**
      * Construct from a string literal. Uses the named-constructor idiom to make
      * this explicit. `neo::basic_text` will also do the implicit conversion.
@@ -411,6 +574,7 @@ public:
         code_unit_buffer ret;
         auto wr_ptr = ret._prepare_storage(len);
         fn(wr_ptr);
+        ret._classify();
         return ret;
     }
 };
@@ -0,0 +1,249 @@
+#ifndef NEO_UNICODE_COMPARE_HPP_INCLUDED
+#define NEO_UNICODE_COMPARE_HPP_INCLUDED
+
+#include "encodings/all.hpp"
+#include "hash.hpp"
+#include "simd.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace neo {
+
+namespace unicode_detail {
+
+/**
+ * The form of the code units of an encoding, as far as ordering goes. Code
+ * units of UTF-8, UTF-32 and Latin-1 compare in code point order as unsigned
+ * numbers. UTF-16 does too, except that surrogates must sort after
+ * U+E000..U+FFFF. Byte-swapped code units say nothing about the order.
+ */
+enum class unit_form { other, utf8, utf16, utf32, latin1 };
+
+template <typename Encoding> struct unit_form_of : std::integral_constant<unit_form, unit_form::other> {};
+template <> struct unit_form_of<utf8> : std::integral_constant<unit_form, unit_form::utf8> {};
+template <> struct unit_form_of<utf16> : std::integral_constant<unit_form, unit_form::utf16> {};
+template <> struct unit_form_of<utf32> : std::integral_constant<unit_form, unit_form::utf32> {};
+template <> struct unit_form_of<latin1> : std::integral_constant<unit_form, unit_form::latin1> {};
+template <> struct unit_form_of<wide> : unit_form_of<wide::underlying> {};
+template <byte_order Order>
+struct unit_form_of<utf16_ordered<Order>>
+    : std::integral_constant<unit_form, Order == byte_order::native ? unit_form::utf16 : unit_form::other> {};
+template <byte_order Order>
+struct unit_form_of<utf32_ordered<Order>>
+    : std::integral_constant<unit_form, Order == byte_order::native ? unit_form::utf32 : unit_form::other> {};
+
+/**
+ * Whether two encodings can be compared by their code units alone
+ */
+template <typename Left, typename Right>
+struct same_unit_form : std::integral_constant<bool,
+                                               unit_form_of<Left>::value == unit_form_of<Right>::value
+                                                   && unit_form_of<Left>::value != unit_form::other> {};
+
+/**
+ * The number of leading bytes that are the same in `a` and `b`, of `n`
+ */
+inline std::size_t mismatch_bytes(const unsigned char* a, const unsigned char* b, std::size_t n) noexcept {
+    std::size_t i = 0;
+#if NEO_UNICODE_HAVE_SSE2
+    for (; i + 16 <= n; i += 16) {
+        const auto eq = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        const auto differ = static_cast<std::uint32_t>(_mm_movemask_epi8(eq)) ^ 0xFFFFu;
+        if (differ != 0) {
+            return i + count_trailing_zeros(differ);
+        }
+    }
+#else
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t x;
+        std::uint64_t y;
+        std::memcpy(&x, a + i, 8);
+        std::memcpy(&y, b + i, 8);
+        if (x != y) {
+            break;
+        }
+    }
+#endif
+    while (i != n && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+/**
+ * The number of leading code units that are the same ASCII code point in
+ * UTF-8 `a` and UTF-16 `b`, of `n`
+ */
+template <typename Unit16>
+std::size_t equal_ascii_prefix(const char* a, const Unit16* b, std::size_t n) noexcept {
+    static_assert(sizeof(Unit16) == 2, "UTF-16 code units are two bytes");
+    std::size_t i = 0;
+#if NEO_UNICODE_HAVE_SSE2
+    const auto zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        if (_mm_movemask_epi8(bytes) != 0) {
+            break;
+        }
+        const auto lo = _mm_cmpeq_epi16(_mm_unpacklo_epi8(bytes, zero),
+                                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        const auto hi = _mm_cmpeq_epi16(_mm_unpackhi_epi8(bytes, zero),
+                                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 8)));
+        if (_mm_movemask_epi8(_mm_and_si128(lo, hi)) != 0xFFFF) {
+            break;
+        }
+    }
+#endif
+    while (i != n && static_cast<unsigned char>(a[i]) < 0x80
+           && static_cast<unsigned char>(a[i]) == static_cast<std::uint16_t>(b[i])) {
+        ++i;
+    }
+    return i;
+}
+
+/**
+ * A UTF-16 code unit as a number that sorts in code point order: surrogates
+ * move above U+E000..U+FFFF
+ */
+inline std::uint32_t utf16_sort_key(std::uint32_t u) noexcept {
+    if (u >= 0xE000) {
+        return u - 0x800;
+    }
+    if (u >= 0xD800) {
+        return u + 0x2000;
+    }
+    return u;
+}
+
+template <typename Size> int compare_sizes(Size a, Size b) noexcept {
+    return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+/**
+ * Compare by code units: skip the equal prefix, then compare the first code
+ * units that differ.
+ */
+template <typename Left, typename Right, typename LUnit, typename RUnit>
+int compare_code_points(const LUnit* l, std::size_t l_size, const RUnit* r, std::size_t r_size, std::true_type) noexcept {
+    static_assert(sizeof(LUnit) == sizeof(RUnit), "the same form has the same code units");
+    const auto n = l_size < r_size ? l_size : r_size;
+    const auto i = mismatch_bytes(reinterpret_cast<const unsigned char*>(l),
+                                  reinterpret_cast<const unsigned char*>(r),
+                                  n * sizeof(LUnit))
+        / sizeof(LUnit);
+    if (i == n) {
+        return compare_sizes(l_size, r_size);
+    }
+    std::uint32_t a = static_cast<std::make_unsigned_t<LUnit>>(l[i]);
+    std::uint32_t b = static_cast<std::make_unsigned_t<RUnit>>(r[i]);
+    if (unit_form_of<Left>::value == unit_form::utf16) {
+        a = utf16_sort_key(a);
+        b = utf16_sort_key(b);
+    }
+    return a < b ? -1 : 1;
+}
+
+/**
+ * The number of leading code units that are the same ASCII code points in
+ * `l` and `r`, if that can be found quickly. Only used for UTF-8 with UTF-16.
+ */
+template <typename LUnit, typename RUnit>
+std::size_t equal_prefix(const LUnit*, std::size_t, const RUnit*, std::size_t) noexcept {
+    return 0;
+}
+
+template <typename Unit16, typename = std::enable_if_t<sizeof(Unit16) == 2>>
+std::size_t equal_prefix(const char* l, std::size_t l_size, const Unit16* r, std::size_t r_size) noexcept {
+    return equal_ascii_prefix(l, r, l_size < r_size ? l_size : r_size);
+}
+
+/**
+ * Compare by decoding both sides. Between code points that have to be
+ * decoded, runs of equal ASCII are skipped where the encodings make that
+ * cheap.
+ */
+template <typename Left, typename Right, typename LUnit, typename RUnit>
+int compare_code_points(const LUnit* l, std::size_t l_size, const RUnit* r, std::size_t r_size, std::false_type) noexcept {
+    constexpr bool skip_left = unit_form_of<Left>::value == unit_form::utf8
+        && unit_form_of<Right>::value == unit_form::utf16;
+    constexpr bool skip_right = unit_form_of<Left>::value == unit_form::utf16
+        && unit_form_of<Right>::value == unit_form::utf8;
+    auto lp = l;
+    auto rp = r;
+    const auto l_end = l + l_size;
+    const auto r_end = r + r_size;
+    while (true) {
+        std::size_t skip = 0;
+        if (skip_left) {
+            skip = equal_prefix(lp, l_end - lp, rp, r_end - rp);
+        } else if (skip_right) {
+            skip = equal_prefix(rp, r_end - rp, lp, l_end - lp);
+        }
+        lp += skip;
+        rp += skip;
+        if (lp == l_end || rp == r_end) {
+            break;
+        }
+        const auto a = decoder<Left>::next(lp, l_end);
+        const auto b = decoder<Right>::next(rp, r_end);
+        if (a != b) {
+            return a < b ? -1 : 1;
+        }
+    }
+    return compare_sizes(lp != l_end, rp != r_end);
+}
+
+/**
+ * Compare [l, l + l_size) of `Left` with [r, r + r_size) of `Right` in code
+ * point order. Returns a negative number, zero, or a positive number.
+ */
+template <typename Left, typename Right, typename LUnit, typename RUnit>
+int compare_code_points(const LUnit* l, std::size_t l_size, const RUnit* r, std::size_t r_size) noexcept {
+    return compare_code_points<Left, Right>(l, l_size, r, r_size, same_unit_form<Left, Right>{});
+}
+
+/**
+ * Check [l, l + l_size) of `Left` and [r, r + r_size) of `Right` for the
+ * same code points. The same form of code units needs the same size.
+ */
+template <typename Left, typename Right, typename LUnit, typename RUnit>
+bool equal_code_points(const LUnit* l, std::size_t l_size, const RUnit* r, std::size_t r_size) noexcept {
+    if (same_unit_form<Left, Right>::value && l_size != r_size) {
+        return false;
+    }
+    return compare_code_points<Left, Right>(l, l_size, r, r_size) == 0;
+}
+
+/**
+ * Hash a buffer of `Encoding` so that the texts that `equal_code_points()`
+ * finds equal hash alike. Code units that compare as they are hash as they
+ * are, with the buffer's cache. Others are decoded, and their code points
+ * hashed a chunk at a time.
+ */
+template <typename Encoding, typename Buffer> std::size_t hash_code_points(const Buffer& buf) noexcept {
+    if (same_unit_form<Encoding, Encoding>::value) {
+        return hash_of(buf);
+    }
+    constexpr std::size_t chunk_size = 256;
+    char32_t chunk[chunk_size];
+    auto p = buf.data();
+    const auto last = p + buf.code_unit_size();
+    std::size_t h = 0;
+    do {
+        std::size_t n = 0;
+        while (n != chunk_size && p != last) {
+            chunk[n++] = decoder<Encoding>::next(p, last);
+        }
+        h = h * static_cast<std::size_t>(0x9E3779B97F4A7C15ull) + hash_code_units(chunk, n);
+    } while (p != last);
+    return h;
+}
+
+}  // namespace unicode_detail
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_COMPARE_HPP_INCLUDED
@@ -0,0 +1,398 @@
+#ifndef NEO_UNICODE_COUNTING_HPP_INCLUDED
+#define NEO_UNICODE_COUNTING_HPP_INCLUDED
+
+#include "encodings/all.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+namespace neo {
+
+namespace unicode_detail {
+
+/**
+ * Counts and skips code points without decoding them, as the decoders step
+ * through them. A UTF-8 continuation byte or a UTF-16 low surrogate only
+ * starts a code point if it is stray, which is told by the code units before
+ * it, so that malformed text counts as many U+FFFD as iteration finds.
+ *
+ * `starts_code_point(first, p)` tells whether a code point starts at `p`, in
+ * code units that start at `first`. Encodings without a counter of their own
+ * are assumed to start one at every code unit.
+ *
+ * `count(p, end)` returns the number of code points in [p, end).
+ *
+ * `advance(p, end, n)` returns a pointer to the start of the `n`th code point
+ * at or after `p`, and sets `n` to zero. If there are fewer than `n` code
+ * points, it returns `end` and leaves in `n` the number that were missing.
+ * `p` must be the start of a code point.
+ */
+template <typename Encoding> struct code_point_counter {
+    using unit = typename Encoding::code_unit_type;
+
+    static bool starts_code_point(const unit*, const unit*) noexcept {
+        return true;
+    }
+
+    static std::size_t count(const unit* p, const unit* end) noexcept {
+        std::size_t n = 0;
+        for (; p != end; ++n) {
+            decoder<Encoding>::next(p, end);
+        }
+        return n;
+    }
+
+    static const unit* advance(const unit* p, const unit* end, std::size_t& n) noexcept {
+        for (; n && p != end; --n) {
+            decoder<Encoding>::next(p, end);
+        }
+        return p;
+    }
+};
+
+template <typename Unit> struct fixed_width_counter {
+    static bool starts_code_point(const Unit*, const Unit*) noexcept {
+        return true;
+    }
+
+    static std::size_t count(const Unit* p, const Unit* end) noexcept {
+        return static_cast<std::size_t>(end - p);
+    }
+
+    static const Unit* advance(const Unit* p, const Unit* end, std::size_t& n) noexcept {
+        const auto avail = static_cast<std::size_t>(end - p);
+        if (n <= avail) {
+            p += n;
+            n = 0;
+            return p;
+        }
+        n -= avail;
+        return end;
+    }
+};
+
+struct utf8_counter {
+    static bool is_continuation(unsigned b) noexcept {
+        return (b & 0xC0) == 0x80;
+    }
+
+    /**
+     * Whether `b` is a lead byte that `decode_utf8()` takes continuation bytes
+     * after, at least `min` being one of 0xC0, 0xE0 and 0xF0
+     */
+    static bool is_lead(unsigned b, unsigned min) noexcept {
+        return b >= min && b < 0xF8;
+    }
+
+    static bool starts_code_point(const char* first, const char* p) noexcept {
+        if (!is_continuation(static_cast<unsigned char>(*p))) {
+            return true;
+        }
+        // Bytes before `first` are as good as ASCII
+        const auto before = [&](std::ptrdiff_t i) -> unsigned {
+            return p - first >= i ? static_cast<unsigned char>(p[-i]) : 0;
+        };
+        // The lead byte that takes this one can be up to three bytes back,
+        // with continuation bytes between
+        const auto b1 = before(1);
+        const auto b2 = before(2);
+        return !(is_lead(b1, 0xC0)
+                 || (is_continuation(b1)
+                     && (is_lead(b2, 0xE0) || (is_continuation(b2) && is_lead(before(3), 0xF0)))));
+    }
+
+#if NEO_UNICODE_HAVE_SSE2
+    /**
+     * The lanes of the 16 bytes at `p` that start a code point, if those bytes
+     * and the three before them are well-formed. Otherwise some lane of `bad`
+     * is set. The three bytes before must have passed too, or a lead byte
+     * among them may be cut short before `p`.
+     */
+    static __m128i starting_lanes(const char* p, __m128i& bad) noexcept {
+        const auto load = [&](int i) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p - i)); };
+        const auto v = load(0);
+        const auto b3 = load(3);
+        // The lanes that a lead byte up to three bytes back needs to be
+        // continuation bytes
+        const auto needed = _mm_or_si128(_mm_or_si128(_mm_subs_epu8(load(1), _mm_set1_epi8(-65)),
+                                                      _mm_subs_epu8(load(2), _mm_set1_epi8(-33))),
+                                         _mm_subs_epu8(b3, _mm_set1_epi8(-17)));
+        // Continuation bytes are the ones below -64 as signed bytes
+        const auto starts = _mm_cmpgt_epi8(v, _mm_set1_epi8(-65));
+        bad = _mm_or_si128(bad, _mm_xor_si128(_mm_cmpeq_epi8(needed, _mm_setzero_si128()), starts));
+        // No byte takes continuation bytes after 0xF8 and up
+        bad = _mm_or_si128(bad, _mm_subs_epu8(_mm_max_epu8(v, b3), _mm_set1_epi8(-9)));
+        return starts;
+    }
+
+    static std::size_t count_slowly(const char* first, const char* p, const char* end) noexcept {
+        std::size_t n = 0;
+        for (; p != end; ++p) {
+            n += starts_code_point(first, p);
+        }
+        return n;
+    }
+#endif
+
+    /**
+     * Well-formed text is counted with a vector per 16 bytes, and anything
+     * else one byte at a time, along with the 64 bytes after it
+     */
+    static std::size_t count(const char* p, const char* end) noexcept {
+        const auto first = p;
+        std::size_t n = 0;
+#if NEO_UNICODE_HAVE_SSE2
+        const auto zero = _mm_setzero_si128();
+        // The vectors look three bytes back
+        for (; p != end && p - first < 3; ++p) {
+            n += starts_code_point(first, p);
+        }
+        bool passed_before = false;
+        while (end - p >= 64) {
+            // Each byte lane counts the code points that start in it, four
+            // per 64 bytes. It can take 63 of those before it overflows, and
+            // then the lanes are summed.
+            auto acc = zero;
+            auto n_chunks = std::min<std::size_t>(static_cast<std::size_t>(end - p) / 64, 63);
+            for (; n_chunks; --n_chunks, p += 64) {
+                auto bad = zero;
+                auto starts = starting_lanes(p, bad);
+                starts = _mm_add_epi8(starts, starting_lanes(p + 16, bad));
+                starts = _mm_add_epi8(starts, starting_lanes(p + 32, bad));
+                starts = _mm_add_epi8(starts, starting_lanes(p + 48, bad));
+                const auto passed = _mm_movemask_epi8(_mm_cmpeq_epi8(bad, zero)) == 0xFFFF;
+                if (passed && passed_before) {
+                    acc = _mm_sub_epi8(acc, starts);
+                } else {
+                    n += count_slowly(first, p, p + 64);
+                }
+                passed_before = passed;
+            }
+            const auto sums = _mm_sad_epu8(acc, zero);
+            n += static_cast<std::size_t>(_mm_cvtsi128_si32(sums))
+                + static_cast<std::size_t>(_mm_extract_epi16(sums, 4));
+        }
+#endif
+        for (; p != end; ++p) {
+            n += starts_code_point(first, p);
+        }
+        return n;
+    }
+
+    static const char* advance(const char* p, const char* end, std::size_t& n) noexcept {
+        const auto first = p;
+#if NEO_UNICODE_HAVE_SSE2
+        const auto zero = _mm_setzero_si128();
+        // The vectors look three bytes back
+        for (; p != end && p - first < 3; ++p) {
+            if (starts_code_point(first, p)) {
+                if (n == 0) {
+                    return p;
+                }
+                --n;
+            }
+        }
+        bool passed_before = false;
+        while (end - p >= 16) {
+            auto bad = zero;
+            const auto starts = static_cast<std::uint32_t>(_mm_movemask_epi8(starting_lanes(p, bad)));
+            const auto passed = _mm_movemask_epi8(_mm_cmpeq_epi8(bad, zero)) == 0xFFFF;
+            const auto count = passed && passed_before ? population_count(starts) : count_slowly(first, p, p + 16);
+            if (count > n) {
+                break;
+            }
+            n -= count;
+            p += 16;
+            passed_before = passed;
+        }
+#endif
+        for (; p != end; ++p) {
+            if (starts_code_point(first, p)) {
+                if (n == 0) {
+                    return p;
+                }
+                --n;
+            }
+        }
+        return end;
+    }
+};
+
+template <bool Swap, typename Unit> struct utf16_counter {
+    static bool is_high(Unit u) noexcept {
+        return (load_utf16<Swap>(&u) & 0xFC00) == 0xD800;
+    }
+
+    static bool is_low(Unit u) noexcept {
+        return (load_utf16<Swap>(&u) & 0xFC00) == 0xDC00;
+    }
+
+    /**
+     * Every code unit starts a code point but a low surrogate after a high one
+     */
+    static bool starts_code_point(const Unit* first, const Unit* p) noexcept {
+        return !(is_low(*p) && p != first && is_high(p[-1]));
+    }
+
+#if NEO_UNICODE_HAVE_SSE2
+    /**
+     * The lanes of the 8 code units at `p` that don't start a code point. It
+     * looks at the code unit before `p`.
+     */
+    static __m128i continuing_lanes(const Unit* p) noexcept {
+        const auto load = [&](int i) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p - i)); };
+        const auto mask = _mm_set1_epi16(static_cast<short>(Swap ? 0x00FC : 0xFC00));
+        const auto high = _mm_set1_epi16(static_cast<short>(Swap ? 0x00D8 : 0xD800));
+        const auto low = _mm_set1_epi16(static_cast<short>(Swap ? 0x00DC : 0xDC00));
+        return _mm_and_si128(_mm_cmpeq_epi16(_mm_and_si128(load(0), mask), low),
+                             _mm_cmpeq_epi16(_mm_and_si128(load(1), mask), high));
+    }
+#endif
+
+    static std::size_t count(const Unit* p, const Unit* end) noexcept {
+        if (p == end) {
+            return 0;
+        }
+        const auto size = static_cast<std::size_t>(end - p);
+        const auto first = p;
+        // The first code unit always starts one
+        ++p;
+        std::size_t n_continuing = 0;
+#if NEO_UNICODE_HAVE_SSE2
+        const auto ones = _mm_set1_epi16(1);
+        while (end - p >= 8) {
+            // Count in 16-bit lanes, then sum them in pairs to 32 bits
+            auto acc = _mm_setzero_si128();
+            auto n_blocks = std::min<std::size_t>(static_cast<std::size_t>(end - p) / 8, 0x7FFF);
+            for (; n_blocks; --n_blocks, p += 8) {
+                acc = _mm_sub_epi16(acc, continuing_lanes(p));
+            }
+            alignas(16) std::uint32_t lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_madd_epi16(acc, ones));
+            n_continuing += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        }
+#endif
+        for (; p != end; ++p) {
+            n_continuing += !starts_code_point(first, p);
+        }
+        return size - n_continuing;
+    }
+
+    static const Unit* advance(const Unit* p, const Unit* end, std::size_t& n) noexcept {
+        if (p == end) {
+            return end;
+        }
+        if (n == 0) {
+            return p;
+        }
+        const auto first = p;
+        // The first code unit always starts one
+        ++p;
+        --n;
+#if NEO_UNICODE_HAVE_SSE2
+        while (end - p >= 8) {
+            // Two mask bits per code unit
+            const auto count = 8 - population_count(_mm_movemask_epi8(continuing_lanes(p))) / 2;
+            if (count > n) {
+                break;
+            }
+            n -= count;
+            p += 8;
+        }
+#endif
+        for (; p != end; ++p) {
+            if (starts_code_point(first, p)) {
+                if (n == 0) {
+                    return p;
+                }
+                --n;
+            }
+        }
+        return end;
+    }
+};
+
+template <> struct code_point_counter<utf8> : utf8_counter {};
+template <> struct code_point_counter<latin1> : fixed_width_counter<char> {};
+template <> struct code_point_counter<utf16> : utf16_counter<false, char16_t> {};
+template <> struct code_point_counter<utf32> : fixed_width_counter<char32_t> {};
+
+template <byte_order Order>
+struct code_point_counter<utf16_ordered<Order>>
+    : utf16_counter<Order != byte_order::native, char16_t> {};
+
+template <byte_order Order>
+struct code_point_counter<utf32_ordered<Order>> : fixed_width_counter<char32_t> {};
+
+template <>
+struct code_point_counter<wide>
+    : std::conditional_t<sizeof(wchar_t) == 2,
+                         utf16_counter<false, wchar_t>,
+                         fixed_width_counter<wchar_t>> {};
+
+template <typename T>
+using cached_code_point_count_t = decltype(std::declval<const T&>().cached_code_point_count());
+
+/**
+ * Count the code points in a buffer of `Encoding`, using and filling the
+ * buffer's cache if it has one.
+ */
+template <typename Encoding,
+          typename Buffer,
+          typename = std::enable_if_t<is_detected_v<cached_code_point_count_t, Buffer>>>
+std::size_t code_point_count_of(const Buffer& buf) noexcept {
+    auto n = buf.cached_code_point_count();
+    if (n == Buffer::uncounted) {
+        n = code_point_counter<Encoding>::count(buf.data(), buf.data() + buf.code_unit_size());
+        buf.cache_code_point_count(n);
+    }
+    return n;
+}
+
+template <typename Encoding,
+          typename Buffer,
+          typename = std::enable_if_t<!is_detected_v<cached_code_point_count_t, Buffer>>,
+          typename = void>
+std::size_t code_point_count_of(const Buffer& buf) noexcept {
+    return code_point_counter<Encoding>::count(buf.data(), buf.data() + buf.code_unit_size());
+}
+
+}  // namespace unicode_detail
+
+/**
+ * Count the code points in a UTF-8 sequence of `size` bytes. Embedded nulls
+ * are counted like any other code point. Malformed sequences count as the
+ * U+FFFD that iterating them gives, including one for each stray
+ * continuation byte.
+ */
+inline std::size_t count_code_points(const char* ptr, std::size_t size) noexcept {
+    return unicode_detail::code_point_counter<utf8>::count(ptr, ptr + size);
+}
+
+/**
+ * Count the code points in a UTF-16 sequence of `size` code units. Unpaired
+ * surrogates count as one code point each.
+ */
+inline std::size_t count_code_points(const char16_t* ptr, std::size_t size) noexcept {
+    return unicode_detail::code_point_counter<utf16>::count(ptr, ptr + size);
+}
+
+/**
+ * Count the code points in a UTF-32 sequence, which is `size`.
+ */
+inline std::size_t count_code_points(const char32_t*, std::size_t size) noexcept {
+    return size;
+}
+
+/**
+ * Count the code points in a wide string of `size` code units.
+ */
+inline std::size_t count_code_points(const wchar_t* ptr, std::size_t size) noexcept {
+    return unicode_detail::code_point_counter<wide>::count(ptr, ptr + size);
+}
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_COUNTING_HPP_INCLUDED
@@ -0,0 +1,194 @@
+#include "detect.hpp"
+
+#include <neo/unicode/simd.hpp>
+
+#include <algorithm>
+#include <initializer_list>
+
+using namespace neo;
+using namespace neo::unicode_detail;
+
+namespace {
+
+struct byte_statistics {
+    // Zero bytes, by offset modulo four
+    std::size_t zeros[4] = {};
+    // Bytes above 0x7F
+    std::size_t high = 0;
+    bool valid_utf8 = true;
+};
+
+/**
+ * Check the UTF-8 sequences that start before `limit`, advancing `p` past
+ * them. The last one may end beyond `limit`, but not beyond `end`.
+ */
+bool validate_utf8(const unsigned char*& p,
+                   const unsigned char* limit,
+                   const unsigned char* end) noexcept {
+    while (p < limit) {
+        if (*p < 0x80) {
+            ++p;
+        } else if (decode_utf8(p, end) == invalid_code_point) {
+            return false;
+        }
+    }
+    return true;
+}
+
+byte_statistics gather_statistics(const unsigned char* first, const unsigned char* last) noexcept {
+    byte_statistics stats;
+    auto p = first;
+    // The UTF-8 validation trails `p`, and only looks at blocks with non-ASCII
+    // bytes in them
+    auto checked = first;
+#if NEO_UNICODE_HAVE_SSE2
+    const auto zero = _mm_setzero_si128();
+    // Blocks start at multiples of sixteen, so lane `i` is at offset `i`
+    // modulo four
+    for (; last - p >= 16; p += 16) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const auto zero_mask
+            = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)));
+        const auto high_mask = static_cast<std::uint32_t>(_mm_movemask_epi8(v));
+        if (zero_mask) {
+            stats.zeros[0] += population_count(zero_mask & 0x1111);
+            stats.zeros[1] += population_count(zero_mask & 0x2222);
+            stats.zeros[2] += population_count(zero_mask & 0x4444);
+            stats.zeros[3] += population_count(zero_mask & 0x8888);
+        }
+        if (!stats.valid_utf8) {
+            stats.high += population_count(high_mask);
+        } else if (high_mask) {
+            stats.high += population_count(high_mask);
+            stats.valid_utf8 = validate_utf8(checked, p + 16, last);
+        } else {
+            checked = std::max(checked, p + 16);
+        }
+    }
+#endif
+    for (auto tail = p; tail != last; ++tail) {
+        stats.zeros[(tail - first) & 3] += *tail == 0;
+        stats.high += *tail >> 7;
+    }
+    if (stats.valid_utf8) {
+        stats.valid_utf8 = validate_utf8(checked, last, last);
+    }
+    return stats;
+}
+
+/**
+ * Match the byte order marks. UTF-32LE is checked before UTF-16LE because
+ * its mark starts with the UTF-16LE one.
+ */
+encoding_id match_bom(const unsigned char* p, std::size_t size, std::size_t& bom_size) noexcept {
+    const auto starts_with = [&](std::initializer_list<unsigned char> bom) {
+        return size >= bom.size() && std::equal(bom.begin(), bom.end(), p);
+    };
+    if (starts_with({0xEF, 0xBB, 0xBF})) {
+        bom_size = 3;
+        return encoding_id::utf8;
+    } else if (size % 4 == 0 && starts_with({0xFF, 0xFE, 0x00, 0x00})) {
+        bom_size = 4;
+        return encoding_id::utf32le;
+    } else if (size % 4 == 0 && starts_with({0x00, 0x00, 0xFE, 0xFF})) {
+        bom_size = 4;
+        return encoding_id::utf32be;
+    } else if (size % 2 == 0 && starts_with({0xFF, 0xFE})) {
+        bom_size = 2;
+        return encoding_id::utf16le;
+    } else if (size % 2 == 0 && starts_with({0xFE, 0xFF})) {
+        bom_size = 2;
+        return encoding_id::utf16be;
+    }
+    return encoding_id::unknown;
+}
+
+struct candidate_list {
+    detected_encoding& result;
+    std::size_t count = 0;
+
+    void add(encoding_id id, detection_confidence conf) noexcept {
+        if (count < std::extent<decltype(result.candidates)>::value) {
+            result.candidates[count++] = {id, conf};
+        }
+    }
+};
+
+/**
+ * Look for the zero bytes of mostly-Latin text in UTF-16 or UTF-32, where
+ * every code unit has zero high-order bytes. `lo` and `hi` are the
+ * zero counts for the low and high halves of each code unit.
+ */
+detection_confidence wide_confidence(std::size_t n_units, std::size_t lo, std::size_t hi) noexcept {
+    if (hi == 0 || lo * 4 >= hi) {
+        return detection_confidence::none;
+    }
+    return hi * 2 >= n_units ? detection_confidence::high : detection_confidence::medium;
+}
+
+}  // namespace
+
+detected_encoding neo::detect_encoding(const void* data, std::size_t size) noexcept {
+    detected_encoding result;
+    candidate_list candidates{result};
+    const auto first = static_cast<const unsigned char*>(data);
+
+    const auto bom = match_bom(first, size, result.bom_size);
+    if (bom != encoding_id::unknown) {
+        candidates.add(bom, detection_confidence::certain);
+        if (bom == encoding_id::utf32le) {
+            // Could also be UTF-16LE text that starts with a null
+            candidates.add(encoding_id::utf16le, detection_confidence::low);
+        }
+        return result;
+    }
+
+    const auto stats = gather_statistics(first, first + size);
+    const auto n_zeros = stats.zeros[0] + stats.zeros[1] + stats.zeros[2] + stats.zeros[3];
+
+    if (n_zeros == 0) {
+        // Neither UTF-16 nor UTF-32 text gets far without a zero byte unless
+        // it is all CJK, which would almost never be valid UTF-8.
+        if (stats.valid_utf8) {
+            candidates.add(encoding_id::utf8, detection_confidence::high);
+            // Pure ASCII is ISO-8859-1 just as well
+            candidates.add(encoding_id::latin1,
+                           stats.high ? detection_confidence::low : detection_confidence::medium);
+        } else {
+            candidates.add(encoding_id::latin1, detection_confidence::medium);
+        }
+        return result;
+    }
+
+    if (size % 4 == 0) {
+        // One of the high two bytes is always zero, the other one almost
+        // always is
+        const auto n_units = size / 4;
+        if (stats.zeros[3] == n_units && stats.zeros[2] * 4 >= n_units * 3
+            && stats.zeros[0] < n_units) {
+            candidates.add(encoding_id::utf32le, detection_confidence::high);
+        } else if (stats.zeros[0] == n_units && stats.zeros[1] * 4 >= n_units * 3
+                   && stats.zeros[3] < n_units) {
+            candidates.add(encoding_id::utf32be, detection_confidence::high);
+        }
+    }
+    if (size % 2 == 0) {
+        const auto n_units = size / 2;
+        const auto even = stats.zeros[0] + stats.zeros[2];
+        const auto odd = stats.zeros[1] + stats.zeros[3];
+        const auto le = wide_confidence(n_units, even, odd);
+        const auto be = wide_confidence(n_units, odd, even);
+        if (le != detection_confidence::none) {
+            candidates.add(encoding_id::utf16le, le);
+        } else if (be != detection_confidence::none) {
+            candidates.add(encoding_id::utf16be, be);
+        }
+    }
+    // Zero bytes are valid UTF-8 and ISO-8859-1, just unusual in text
+    if (stats.valid_utf8) {
+        candidates.add(encoding_id::utf8, detection_confidence::low);
+    } else {
+        candidates.add(encoding_id::latin1, detection_confidence::low);
+    }
+    return result;
+}
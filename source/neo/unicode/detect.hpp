@@ -0,0 +1,99 @@
+#ifndef NEO_UNICODE_DETECT_HPP_INCLUDED
+#define NEO_UNICODE_DETECT_HPP_INCLUDED
+
+#include "encoding_id.hpp"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace neo {
+
+/**
+ * How sure `detect_encoding` is of a guess. The enumerators are ordered from
+ * least to most confident.
+ */
+enum class detection_confidence : unsigned char {
+    none,
+    /// Possible, but nothing in the data points to it
+    low,
+    /// Consistent with the data, but other encodings are too
+    medium,
+    /// The data strongly suggests this encoding
+    high,
+    /// The data starts with the byte order mark of this encoding
+    certain,
+};
+
+struct encoding_candidate {
+    encoding_id encoding = encoding_id::unknown;
+    detection_confidence confidence = detection_confidence::none;
+};
+
+/**
+ * The result of `detect_encoding`.
+ */
+struct detected_encoding {
+    /**
+     * The plausible encodings, most likely first. Unused entries have an
+     * encoding of `encoding_id::unknown`.
+     */
+    encoding_candidate candidates[3];
+    /**
+     * The number of bytes taken by a byte order mark at the start of the
+     * data. The byte order mark is not part of the text.
+     */
+    std::size_t bom_size = 0;
+
+    encoding_id encoding() const noexcept {
+        return candidates[0].encoding;
+    }
+
+    detection_confidence confidence() const noexcept {
+        return candidates[0].confidence;
+    }
+};
+
+/**
+ * Guess the encoding of a sequence of bytes. Recognizes byte order marks,
+ * and otherwise decides between UTF-8, UTF-16, UTF-32 and ISO-8859-1 from
+ * UTF-8 validity and the positions of zero bytes, gathered in a single pass
+ * over the data.
+ */
+detected_encoding detect_encoding(const void* data, std::size_t size) noexcept;
+
+namespace unicode_detail {
+
+template <typename T> using byte_data_t = decltype(std::declval<const T&>().data());
+template <typename T> using byte_size_t = decltype(std::declval<const T&>().size());
+
+}  // namespace unicode_detail
+
+/**
+ * Guess the encoding of a contiguous container of bytes, such as a
+ * `std::string` or `std::vector<char>`.
+ */
+template <typename Bytes,
+          typename = unicode_detail::byte_data_t<Bytes>,
+          typename = unicode_detail::byte_size_t<Bytes>>
+detected_encoding detect_encoding(const Bytes& bytes) noexcept {
+    return detect_encoding(bytes.data(), bytes.size() * sizeof(*bytes.data()));
+}
+
+/**
+ * Transcode bytes of unknown encoding to `ToEncoding`, using the encoding
+ * picked by `detect_encoding`. A byte order mark is dropped. Throws
+ * `std::runtime_error` if the data turns out not to be valid in the detected
+ * encoding.
+ */
+template <typename ToEncoding>
+buffer_type_t<ToEncoding> decode_bytes(const void* data, std::size_t size) {
+    const auto detected = detect_encoding(data, size);
+    return transcode_bytes<ToEncoding>(detected.encoding(),
+                                       static_cast<const char*>(data) + detected.bom_size,
+                                       size - detected.bom_size);
+}
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_DETECT_HPP_INCLUDED
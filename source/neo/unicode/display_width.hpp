@@ -0,0 +1,182 @@
+#ifndef NEO_UNICODE_DISPLAY_WIDTH_HPP_INCLUDED
+#define NEO_UNICODE_DISPLAY_WIDTH_HPP_INCLUDED
+
+#include "grapheme.hpp"
+#include "search.hpp"
+#include "simd.hpp"
+#include "text.hpp"
+#include "text_view.hpp"
+#include "ucd_tables.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace neo {
+
+namespace unicode_detail {
+
+constexpr unsigned display_width_of(std::uint8_t props) noexcept {
+    return props & 0x03;
+}
+
+constexpr unsigned ascii_display_width(unsigned u) noexcept {
+    return u >= 0x20 && u != 0x7F ? 1 : 0;
+}
+
+/**
+ * Skip the ASCII from `p` while `width` plus its width fits in `budget`,
+ * adding its width to `width`
+ */
+template <typename Unit>
+const Unit* skip_ascii_width(const Unit* p, const Unit* last, std::size_t budget, std::size_t& width) noexcept {
+#if NEO_UNICODE_HAVE_SSE2
+    using lanes = unit_lanes<sizeof(Unit)>;
+    constexpr std::size_t lane_count = 16 / sizeof(Unit);
+    const auto below_space = lanes::splat(0x1F);
+    const auto del = lanes::splat(0x7F);
+    while (last - p >= static_cast<std::ptrdiff_t>(lane_count) && budget - width >= lane_count) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const auto ascii = static_cast<std::uint32_t>(_mm_movemask_epi8(lanes::ascii(v))) & lanes::lane_bits;
+        if (ascii != lanes::lane_bits) {
+            break;
+        }
+        // Signed comparison is fine, since every lane is ASCII
+        const auto shown = _mm_andnot_si128(lanes::eq(v, del), lanes::gt(v, below_space));
+        width += population_count(static_cast<std::uint32_t>(_mm_movemask_epi8(shown)) & lanes::lane_bits);
+        p += lane_count;
+    }
+#endif
+    for (; p != last; ++p) {
+        const auto u = static_cast<std::make_unsigned_t<Unit>>(*p);
+        if (u >= 0x80 || width + ascii_display_width(u) > budget) {
+            break;
+        }
+        width += ascii_display_width(u);
+    }
+    return p;
+}
+
+/**
+ * The width of the grapheme cluster [p, last): the widest of its code
+ * points, or two for an emoji variation selector after a code point that
+ * can be emoji
+ */
+template <typename Encoding, typename Unit> unsigned cluster_display_width(const Unit* p, const Unit* last) noexcept {
+    const auto first = width_properties(decoder<Encoding>::next(p, last));
+    auto width = display_width_of(first);
+    while (p != last && width < 2) {
+        const auto cp = decoder<Encoding>::next(p, last);
+        if (cp == 0xFE0F && (first & width_emoji_bit)) {
+            return 2;
+        }
+        const auto w = display_width_of(width_properties(cp));
+        width = w > width ? w : width;
+    }
+    return width;
+}
+
+/**
+ * Add the width of the grapheme clusters from `p` to `width` while it stays
+ * within `budget`, and return where the first cluster that doesn't fit
+ * starts, or `last`
+ */
+template <typename Encoding, typename Unit>
+const Unit* fit_display_width(const Unit* p, const Unit* last, std::size_t budget, std::size_t& width) noexcept {
+    using unit = std::make_unsigned_t<Unit>;
+    while (p != last) {
+        if (ascii_code_units<Encoding>::value && unit(*p) < 0x80) {
+            const auto q = skip_ascii_width(p, last, budget, width);
+            if (q == last || unit(*q) < 0x80) {
+                return q;
+            }
+            // What follows may extend the cluster of the last ASCII code
+            // point, as a combining mark or an emoji keycap does
+            p = q - 1;
+            width -= ascii_display_width(unit(*p));
+        }
+        const auto next = next_grapheme_break<Encoding>(p, last);
+        const auto w = cluster_display_width<Encoding>(p, next);
+        if (budget - width < w) {
+            return p;
+        }
+        width += w;
+        p = next;
+    }
+    return p;
+}
+
+}  // namespace unicode_detail
+
+/**
+ * The columns that `text` takes in a terminal or other monospace display.
+ * Each grapheme cluster is as wide as its widest code point: two for East
+ * Asian wide and fullwidth characters and emoji, none for marks, formatting
+ * and control characters, and one for the rest. A variation selector that
+ * asks for emoji makes it two. East Asian ambiguous characters are one, as
+ * outside of East Asian contexts. Runs of ASCII are measured without
+ * looking up any properties.
+ */
+template <typename Encoding, typename Buffer>
+std::size_t display_width(const basic_text<Encoding, Buffer>& text) noexcept {
+    std::size_t width = 0;
+    unicode_detail::fit_display_width<Encoding>(text.data(),
+                                                text.data() + text.code_unit_size(),
+                                                std::numeric_limits<std::size_t>::max(),
+                                                width);
+    return width;
+}
+
+template <typename Encoding> std::size_t display_width(basic_text_view<Encoding> view) noexcept {
+    std::size_t width = 0;
+    unicode_detail::fit_display_width<Encoding>(view.data(),
+                                                view.data() + view.code_unit_size(),
+                                                std::numeric_limits<std::size_t>::max(),
+                                                width);
+    return width;
+}
+
+/**
+ * How much of a text fits in a number of columns, as returned by
+ * `fit_display_width()`
+ */
+struct display_width_fit {
+    /**
+     * The code unit offset of the first grapheme cluster that doesn't fit,
+     * or the size of the text if all of it does
+     */
+    std::size_t offset;
+    /**
+     * The display width of the text before `offset`
+     */
+    std::size_t width;
+};
+
+/**
+ * Measure the grapheme clusters of `text` that fit in `max_width` columns,
+ * as `display_width()` does, stopping at the first one that doesn't
+ */
+template <typename Encoding, typename Buffer>
+display_width_fit fit_display_width(const basic_text<Encoding, Buffer>& text, std::size_t max_width) noexcept {
+    std::size_t width = 0;
+    const auto stop = unicode_detail::fit_display_width<Encoding>(text.data(),
+                                                                  text.data() + text.code_unit_size(),
+                                                                  max_width,
+                                                                  width);
+    return {static_cast<std::size_t>(stop - text.data()), width};
+}
+
+template <typename Encoding>
+display_width_fit fit_display_width(basic_text_view<Encoding> view, std::size_t max_width) noexcept {
+    std::size_t width = 0;
+    const auto stop = unicode_detail::fit_display_width<Encoding>(view.data(),
+                                                                  view.data() + view.code_unit_size(),
+                                                                  max_width,
+                                                                  width);
+    return {static_cast<std::size_t>(stop - view.data()), width};
+}
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_DISPLAY_WIDTH_HPP_INCLUDED
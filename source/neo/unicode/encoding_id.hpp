@@ -0,0 +1,131 @@
+#ifndef NEO_UNICODE_ENCODING_ID_HPP_INCLUDED
+#define NEO_UNICODE_ENCODING_ID_HPP_INCLUDED
+
+#include "encodings/all.hpp"
+#include "encodings/convert.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace neo {
+
+/**
+ * Names an encoding at runtime, for data whose encoding is only known once
+ * it has been read. Use `visit_encoding` to get back to the encoding type.
+ */
+enum class encoding_id : unsigned char {
+    unknown,
+    utf8,
+    utf16le,
+    utf16be,
+    utf32le,
+    utf32be,
+    latin1,
+};
+
+/**
+ * Get the `encoding_id` of an encoding type, as `encoding_id_of<E>::value`.
+ */
+template <typename Encoding> struct encoding_id_of;
+
+template <encoding_id Id>
+using encoding_id_constant = std::integral_constant<encoding_id, Id>;
+
+template <> struct encoding_id_of<utf8> : encoding_id_constant<encoding_id::utf8> {};
+template <> struct encoding_id_of<latin1> : encoding_id_constant<encoding_id::latin1> {};
+
+template <byte_order Order>
+struct encoding_id_of<utf16_ordered<Order>>
+    : encoding_id_constant<Order == byte_order::little ? encoding_id::utf16le
+                                                       : encoding_id::utf16be> {};
+
+template <byte_order Order>
+struct encoding_id_of<utf32_ordered<Order>>
+    : encoding_id_constant<Order == byte_order::little ? encoding_id::utf32le
+                                                       : encoding_id::utf32be> {};
+
+template <> struct encoding_id_of<utf16> : encoding_id_of<utf16_ordered<byte_order::native>> {};
+template <> struct encoding_id_of<utf32> : encoding_id_of<utf32_ordered<byte_order::native>> {};
+template <> struct encoding_id_of<wide> : encoding_id_of<wide::underlying> {};
+
+/**
+ * Get the name of an encoding, as given by its `get_name()`.
+ */
+inline const char* encoding_name(encoding_id id) noexcept {
+    switch (id) {
+    case encoding_id::utf8:
+        return utf8::get_name();
+    case encoding_id::utf16le:
+        return utf16le::get_name();
+    case encoding_id::utf16be:
+        return utf16be::get_name();
+    case encoding_id::utf32le:
+        return utf32le::get_name();
+    case encoding_id::utf32be:
+        return utf32be::get_name();
+    case encoding_id::latin1:
+        return latin1::get_name();
+    case encoding_id::unknown:
+        break;
+    }
+    return "unknown";
+}
+
+/**
+ * Call `fn` with a default-constructed object of the encoding type named by
+ * `id`. Throws `std::invalid_argument` for `encoding_id::unknown`.
+ */
+template <typename Func> decltype(auto) visit_encoding(encoding_id id, Func&& fn) {
+    switch (id) {
+    case encoding_id::utf8:
+        return fn(utf8{});
+    case encoding_id::utf16le:
+        return fn(utf16le{});
+    case encoding_id::utf16be:
+        return fn(utf16be{});
+    case encoding_id::utf32le:
+        return fn(utf32le{});
+    case encoding_id::utf32be:
+        return fn(utf32be{});
+    case encoding_id::latin1:
+        return fn(latin1{});
+    case encoding_id::unknown:
+        break;
+    }
+    throw std::invalid_argument("Unknown encoding");
+}
+
+namespace unicode_detail {
+
+/**
+ * Copy raw bytes into a buffer of the code units of `Encoding`. The bytes
+ * need not be aligned for the code unit type.
+ */
+template <typename Encoding>
+buffer_type_t<Encoding> buffer_from_bytes(const void* data, std::size_t size) {
+    using unit = typename Encoding::code_unit_type;
+    if (size % sizeof(unit) != 0) {
+        throw std::invalid_argument("Input is not a whole number of code units");
+    }
+    return buffer_type_t<Encoding>::fill(size / sizeof(unit), [&](unit* out) {
+        std::memcpy(out, data, size);
+    });
+}
+
+}  // namespace unicode_detail
+
+/**
+ * Transcode raw bytes in the encoding named by `from` to `ToEncoding`.
+ */
+template <typename ToEncoding>
+buffer_type_t<ToEncoding> transcode_bytes(encoding_id from, const void* data, std::size_t size) {
+    return visit_encoding(from, [&](auto enc) {
+        using from_encoding = decltype(enc);
+        return convert_encoding<from_encoding, ToEncoding>(
+            unicode_detail::buffer_from_bytes<from_encoding>(data, size));
+    });
+}
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_ENCODING_ID_HPP_INCLUDED
@@ -6,6 +6,8 @@
 #include "utf16.hpp"
 #include "utf32.hpp"
 #include "wide.hpp"
+#include "endian.hpp"
+#include "latin1.hpp"
 
 #include "native.hpp"
 
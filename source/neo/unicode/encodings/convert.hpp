@@ -0,0 +1,60 @@
+#ifndef NEO_UNICODE_ENCODINGS_CONVERT_HPP_INCLUDED
+#define NEO_UNICODE_ENCODINGS_CONVERT_HPP_INCLUDED
+
+#include <neo/unicode/concepts.hpp>
+
+#include "encodings.hpp"
+#include "utf8.hpp"
+
+#include <type_traits>
+#include <utility>
+
+namespace neo {
+
+namespace unicode_detail {
+
+template <typename From, typename To>
+using direct_encode_t
+    = decltype(encoder<From, To>::encode(std::declval<const buffer_type_t<From>&>()));
+
+template <typename T> struct convert_tag {};
+
+template <typename Encoding>
+buffer_type_t<Encoding> convert(const buffer_type_t<Encoding>& buf,
+                                convert_tag<Encoding>,
+                                convert_tag<Encoding>) {
+    return buf;
+}
+
+template <typename From,
+          typename To,
+          typename = std::enable_if_t<is_detected_v<direct_encode_t, From, To>>>
+buffer_type_t<To> convert(const buffer_type_t<From>& buf, convert_tag<From>, convert_tag<To>) {
+    return encoder<From, To>::encode(buf);
+}
+
+template <typename From,
+          typename To,
+          typename = std::enable_if_t<!is_detected_v<direct_encode_t, From, To>>,
+          typename = void>
+buffer_type_t<To> convert(const buffer_type_t<From>& buf, convert_tag<From>, convert_tag<To>) {
+    return encoder<utf8, To>::encode(encoder<From, utf8>::encode(buf));
+}
+
+}  // namespace unicode_detail
+
+/**
+ * Convert a buffer of code units from one encoding to another. Uses the
+ * `encoder` between the two if there is one, and goes through UTF-8 otherwise.
+ * Converting to the same encoding shares the buffer.
+ */
+template <typename FromEncoding, typename ToEncoding>
+buffer_type_t<ToEncoding> convert_encoding(const buffer_type_t<FromEncoding>& buf) {
+    return unicode_detail::convert(buf,
+                                   unicode_detail::convert_tag<FromEncoding>{},
+                                   unicode_detail::convert_tag<ToEncoding>{});
+}
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_ENCODINGS_CONVERT_HPP_INCLUDED
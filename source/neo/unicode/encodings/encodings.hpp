@@ -13,6 +13,21 @@ using encoding_for_char_type_t = typename encoding_for_char_type<Char>::type;
 
 template <typename FromEncoding, typename ToEncoding> struct encoder;
 
+/**
+ * Decodes code points from code units of `Encoding`. Specializations provide:
+ *
+ * - `static char32_t next(const code_unit_type*& p, const code_unit_type* end)`
+ *      decodes the code point starting at `p` and advances `p` past it.
+ *      Malformed sequences decode as U+FFFD.
+ * - `static char32_t prev(const code_unit_type*& p, const code_unit_type* begin)`
+ *      decodes the code point that ends at `p` and moves `p` back to its
+ *      start. Stops at the same boundaries as `next()`, including in
+ *      malformed input.
+ * - `static constexpr bool is_fixed_width(neo::repertoire)` tells whether
+ *      text of the given repertoire has exactly one code unit per code point.
+ */
+template <typename Encoding> struct decoder;
+
 } // namespace encodings
 
 } // namespace neo
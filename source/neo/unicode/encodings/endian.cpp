@@ -0,0 +1,268 @@
+#include "endian.hpp"
+
+#include <neo/unicode/simd.hpp>
+
+using namespace neo::unicode_detail;
+
+namespace {
+
+/**
+ * Decode like `decode_utf8()`, but with U+FFFD for malformed input, as the
+ * encoders for the native byte order give
+ */
+char32_t decode_utf8_or_replace(const unsigned char*& p, const unsigned char* end) noexcept {
+    const auto cp = decode_utf8(p, end);
+    return cp == invalid_code_point ? replacement_character : cp;
+}
+
+char32_t decode_swapped_utf16_or_replace(const char16_t*& p, const char16_t* end) noexcept {
+    const auto cp = decode_utf16<true>(p, end);
+    return cp == invalid_code_point ? replacement_character : cp;
+}
+
+/**
+ * The number of leading ASCII bytes in [p, end)
+ */
+std::size_t ascii_run(const unsigned char* p, const unsigned char* end) noexcept {
+    const auto start = p;
+#if NEO_UNICODE_HAVE_SSE2
+    while (end - p >= 16) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(v));
+        if (mask) {
+            return static_cast<std::size_t>(p - start) + count_trailing_zeros(mask);
+        }
+        p += 16;
+    }
+#endif
+    while (p != end && *p < 0x80) {
+        ++p;
+    }
+    return static_cast<std::size_t>(p - start);
+}
+
+inline char16_t swapped(char16_t c) noexcept {
+    return static_cast<char16_t>(byte_swap(static_cast<std::uint16_t>(c)));
+}
+
+inline char32_t swapped(char32_t c) noexcept {
+    return static_cast<char32_t>(byte_swap(static_cast<std::uint32_t>(c)));
+}
+
+/**
+ * Load a byte-swapped UTF-32 code unit, with U+FFFD if it isn't a code point
+ * or is a surrogate
+ */
+inline char32_t load_swapped_utf32(const char32_t* p) noexcept {
+    const auto cp = swapped(*p);
+    return cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF) ? replacement_character : cp;
+}
+
+}  // namespace
+
+neo::utf16::buffer_type neo::unicode_detail::utf8_to_swapped_utf16(const char* ptr,
+                                                                    std::size_t size) {
+    const auto first = reinterpret_cast<const unsigned char*>(ptr);
+    const auto last = first + size;
+    // Measure, with U+FFFD for malformed sequences
+    std::size_t req_size = 0;
+    for (auto p = first; p != last;) {
+        const auto n_ascii = ascii_run(p, last);
+        req_size += n_ascii;
+        p += n_ascii;
+        if (p == last) {
+            break;
+        }
+        req_size += decode_utf8_or_replace(p, last) < 0x10000 ? 1 : 2;
+    }
+
+    return utf16::buffer_type::fill(req_size, [&](char16_t* out) {
+        for (auto p = first; p != last;) {
+#if NEO_UNICODE_HAVE_SSE2
+            // ASCII runs are widened sixteen at a time. Interleaving the zero
+            // byte *before* each input byte widens and byte-swaps at once.
+            const auto zero = _mm_setzero_si128();
+            while (last - p >= 16) {
+                const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                if (_mm_movemask_epi8(v)) {
+                    break;
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(zero, v));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(zero, v));
+                p += 16;
+                out += 16;
+            }
+            if (p == last) {
+                break;
+            }
+#endif
+            const auto cp = decode_utf8_or_replace(p, last);
+            if (cp < 0x10000) {
+                *out++ = swapped(static_cast<char16_t>(cp));
+            } else {
+                const auto off = cp - 0x10000;
+                *out++ = swapped(static_cast<char16_t>(0xD800 + (off >> 10)));
+                *out++ = swapped(static_cast<char16_t>(0xDC00 + (off & 0x3FF)));
+            }
+        }
+    });
+}
+
+neo::utf8::buffer_type neo::unicode_detail::swapped_utf16_to_utf8(const char16_t* ptr,
+                                                                   std::size_t size) {
+    const auto last = ptr + size;
+    std::size_t req_size = 0;
+    for (auto p = ptr; p != last;) {
+        req_size += utf8_length(decode_swapped_utf16_or_replace(p, last));
+    }
+
+    return utf8::buffer_type::fill(req_size, [&](char* out) {
+        for (auto p = ptr; p != last;) {
+#if NEO_UNICODE_HAVE_SSE2
+            // A swapped unit holds ASCII iff the natively loaded lane has a
+            // zero low byte and a high byte below 0x80. The ASCII byte is
+            // then the high half of the lane.
+            const auto ascii_mask = _mm_set1_epi16(static_cast<short>(0x80FF));
+            const auto zero = _mm_setzero_si128();
+            while (last - p >= 8) {
+                const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                const auto non_ascii = _mm_and_si128(v, ascii_mask);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(non_ascii, zero)) != 0xFFFF) {
+                    break;
+                }
+                const auto bytes = _mm_packus_epi16(_mm_srli_epi16(v, 8), zero);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out), bytes);
+                p += 8;
+                out += 8;
+            }
+            if (p == last) {
+                break;
+            }
+#endif
+            out += encode_utf8(decode_swapped_utf16_or_replace(p, last), out);
+        }
+    });
+}
+
+neo::utf32::buffer_type neo::unicode_detail::utf8_to_swapped_utf32(const char* ptr,
+                                                                    std::size_t size) {
+    const auto first = reinterpret_cast<const unsigned char*>(ptr);
+    const auto last = first + size;
+    std::size_t req_size = 0;
+    for (auto p = first; p != last;) {
+        const auto n_ascii = ascii_run(p, last);
+        req_size += n_ascii;
+        p += n_ascii;
+        if (p == last) {
+            break;
+        }
+        decode_utf8_or_replace(p, last);
+        ++req_size;
+    }
+
+    return utf32::buffer_type::fill(req_size, [&](char32_t* out) {
+        for (auto p = first; p != last;) {
+#if NEO_UNICODE_HAVE_SSE2
+            // Widen twice, each time putting the zeros first, so that the
+            // ASCII byte lands in the last byte of each 32-bit lane.
+            const auto zero = _mm_setzero_si128();
+            while (last - p >= 16) {
+                const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                if (_mm_movemask_epi8(v)) {
+                    break;
+                }
+                const auto lo = _mm_unpacklo_epi8(zero, v);
+                const auto hi = _mm_unpackhi_epi8(zero, v);
+                const auto dest = reinterpret_cast<__m128i*>(out);
+                _mm_storeu_si128(dest + 0, _mm_unpacklo_epi16(zero, lo));
+                _mm_storeu_si128(dest + 1, _mm_unpackhi_epi16(zero, lo));
+                _mm_storeu_si128(dest + 2, _mm_unpacklo_epi16(zero, hi));
+                _mm_storeu_si128(dest + 3, _mm_unpackhi_epi16(zero, hi));
+                p += 16;
+                out += 16;
+            }
+            if (p == last) {
+                break;
+            }
+#endif
+            *out++ = swapped(decode_utf8_or_replace(p, last));
+        }
+    });
+}
+
+neo::utf8::buffer_type neo::unicode_detail::swapped_utf32_to_utf8(const char32_t* ptr,
+                                                                   std::size_t size) {
+    const auto last = ptr + size;
+    std::size_t req_size = 0;
+    for (auto p = ptr; p != last; ++p) {
+        req_size += utf8_length(load_swapped_utf32(p));
+    }
+
+    return utf8::buffer_type::fill(req_size, [&](char* out) {
+        auto p = ptr;
+#if NEO_UNICODE_HAVE_SSE2
+        // Same trick as for UTF-16: ASCII sits in the high byte of the
+        // natively loaded lane, and everything else must be zero.
+        const auto ascii_mask = _mm_set1_epi32(static_cast<int>(0x80FFFFFF));
+        const auto zero = _mm_setzero_si128();
+#endif
+        while (p != last) {
+#if NEO_UNICODE_HAVE_SSE2
+            while (last - p >= 4) {
+                const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                const auto non_ascii = _mm_and_si128(v, ascii_mask);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi32(non_ascii, zero)) != 0xFFFF) {
+                    break;
+                }
+                const auto words = _mm_packs_epi32(_mm_srli_epi32(v, 24), zero);
+                const auto bytes = _mm_packus_epi16(words, zero);
+                const auto four = _mm_cvtsi128_si32(bytes);
+                std::memcpy(out, &four, 4);
+                p += 4;
+                out += 4;
+            }
+            if (p == last) {
+                break;
+            }
+#endif
+            out += encode_utf8(load_swapped_utf32(p++), out);
+        }
+    });
+}
+
+neo::utf16::buffer_type neo::unicode_detail::swap_utf16(const char16_t* ptr, std::size_t size) {
+    return utf16::buffer_type::fill(size, [&](char16_t* out) {
+        auto p = ptr;
+        const auto last = ptr + size;
+#if NEO_UNICODE_HAVE_SSE2
+        for (; last - p >= 8; p += 8, out += 8) {
+            const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                             _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+        }
+#endif
+        for (; p != last; ++p, ++out) {
+            *out = swapped(*p);
+        }
+    });
+}
+
+neo::utf32::buffer_type neo::unicode_detail::swap_utf32(const char32_t* ptr, std::size_t size) {
+    return utf32::buffer_type::fill(size, [&](char32_t* out) {
+        auto p = ptr;
+        const auto last = ptr + size;
+#if NEO_UNICODE_HAVE_SSE2
+        for (; last - p >= 4; p += 4, out += 4) {
+            auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            // Swap the 16-bit halves of each lane, then the bytes of each half
+            v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+            v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+        }
+#endif
+        for (; p != last; ++p, ++out) {
+            *out = swapped(*p);
+        }
+    });
+}
@@ -0,0 +1,202 @@
+#ifndef NEO_UNICODE_ENCODINGS_ENDIAN_HPP_INCLUDED
+#define NEO_UNICODE_ENCODINGS_ENDIAN_HPP_INCLUDED
+
+#include <neo/unicode/code_unit_buffer.hpp>
+#include <neo/unicode/repertoire.hpp>
+
+#include "encodings.hpp"
+#include "utf16.hpp"
+#include "utf32.hpp"
+#include "utf8.hpp"
+
+#include <type_traits>
+
+namespace neo {
+
+inline namespace encodings {
+
+/**
+ * The order in which the bytes of a multi-byte code unit are stored.
+ */
+enum class byte_order {
+    little,
+    big,
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)                                      \
+    && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    native = big,
+#else
+    native = little,
+#endif
+};
+
+/**
+ * UTF-16 with an explicit byte order. The code units are stored in the buffer
+ * exactly as they appear on the wire, so a `char16_t` read from the buffer of
+ * a `utf16be` text on a little-endian host is byte-swapped.
+ *
+ * When `Order` matches the host, every encoder for this encoding is the same
+ * as the one for plain `utf16`.
+ */
+template <byte_order Order> struct utf16_ordered {
+    using code_unit_type = char16_t;
+    using buffer_type = neo::code_unit_buffer<code_unit_type>;
+
+    static constexpr byte_order order = Order;
+
+    static const char* get_name() noexcept {
+        return Order == byte_order::little ? "utf-16le" : "utf-16be";
+    }
+};
+
+/**
+ * UTF-32 with an explicit byte order. See `utf16_ordered`.
+ */
+template <byte_order Order> struct utf32_ordered {
+    using code_unit_type = char32_t;
+    using buffer_type = neo::code_unit_buffer<code_unit_type>;
+
+    static constexpr byte_order order = Order;
+
+    static const char* get_name() noexcept {
+        return Order == byte_order::little ? "utf-32le" : "utf-32be";
+    }
+};
+
+template <byte_order Order>
+struct decoder<utf16_ordered<Order>>
+    : unicode_detail::utf16_decoder<Order != byte_order::native, char16_t> {
+    static constexpr bool is_fixed_width(neo::repertoire r) noexcept {
+        return decoder<utf16>::is_fixed_width(r);
+    }
+};
+
+template <byte_order Order>
+struct decoder<utf32_ordered<Order>>
+    : unicode_detail::utf32_decoder<Order != byte_order::native, char32_t> {
+    static constexpr bool is_fixed_width(neo::repertoire) noexcept {
+        return true;
+    }
+};
+
+using utf16le = utf16_ordered<byte_order::little>;
+using utf16be = utf16_ordered<byte_order::big>;
+using utf32le = utf32_ordered<byte_order::little>;
+using utf32be = utf32_ordered<byte_order::big>;
+
+}  // namespace encodings
+
+namespace unicode_detail {
+
+// Transcoders for code units in the opposite of the host byte order. The swap
+// happens in the same pass as the transcoding.
+utf16::buffer_type utf8_to_swapped_utf16(const char*, std::size_t);
+utf8::buffer_type swapped_utf16_to_utf8(const char16_t*, std::size_t);
+utf32::buffer_type utf8_to_swapped_utf32(const char*, std::size_t);
+utf8::buffer_type swapped_utf32_to_utf8(const char32_t*, std::size_t);
+utf16::buffer_type swap_utf16(const char16_t*, std::size_t);
+utf32::buffer_type swap_utf32(const char32_t*, std::size_t);
+
+/**
+ * Adapts one of the transcoding functions above to the `encoder` interface.
+ */
+template <typename ToBuffer, typename FromUnit, ToBuffer (*Transcode)(const FromUnit*, std::size_t)>
+struct function_encoder {
+    static ToBuffer do_encode(const FromUnit* ptr, std::size_t size) {
+        return Transcode(ptr, size);
+    }
+    template <typename FromBuffer> static ToBuffer encode(FromBuffer&& buf) {
+        return do_encode(buf.data(), buf.code_unit_size());
+    }
+};
+
+/**
+ * Encoder between two encodings with an identical representation. The
+ * buffer is shared, not copied.
+ */
+template <typename Buffer> struct identity_encoder {
+    static Buffer encode(const Buffer& buf) noexcept {
+        return buf;
+    }
+};
+
+template <byte_order Order>
+struct classified_in_host_order<utf16_ordered<Order>>
+    : std::integral_constant<bool, Order == byte_order::native> {};
+
+template <byte_order Order>
+struct classified_in_host_order<utf32_ordered<Order>>
+    : std::integral_constant<bool, Order == byte_order::native> {};
+
+template <byte_order Order, typename NativeEncoder, typename SwappingEncoder>
+using byte_order_encoder_t
+    = std::conditional_t<Order == byte_order::native, NativeEncoder, SwappingEncoder>;
+
+}  // namespace unicode_detail
+
+inline namespace encodings {
+
+template <byte_order Order>
+struct encoder<utf8, utf16_ordered<Order>>
+    : unicode_detail::byte_order_encoder_t<
+          Order,
+          encoder<utf8, utf16>,
+          unicode_detail::function_encoder<utf16::buffer_type,
+                                           char,
+                                           unicode_detail::utf8_to_swapped_utf16>> {};
+
+template <byte_order Order>
+struct encoder<utf16_ordered<Order>, utf8>
+    : unicode_detail::byte_order_encoder_t<
+          Order,
+          encoder<utf16, utf8>,
+          unicode_detail::function_encoder<utf8::buffer_type,
+                                           char16_t,
+                                           unicode_detail::swapped_utf16_to_utf8>> {};
+
+template <byte_order Order>
+struct encoder<utf16, utf16_ordered<Order>>
+    : unicode_detail::byte_order_encoder_t<
+          Order,
+          unicode_detail::identity_encoder<utf16::buffer_type>,
+          unicode_detail::function_encoder<utf16::buffer_type,
+                                           char16_t,
+                                           unicode_detail::swap_utf16>> {};
+
+template <byte_order Order>
+struct encoder<utf16_ordered<Order>, utf16> : encoder<utf16, utf16_ordered<Order>> {};
+
+template <byte_order Order>
+struct encoder<utf8, utf32_ordered<Order>>
+    : unicode_detail::byte_order_encoder_t<
+          Order,
+          encoder<utf8, utf32>,
+          unicode_detail::function_encoder<utf32::buffer_type,
+                                           char,
+                                           unicode_detail::utf8_to_swapped_utf32>> {};
+
+template <byte_order Order>
+struct encoder<utf32_ordered<Order>, utf8>
+    : unicode_detail::byte_order_encoder_t<
+          Order,
+          encoder<utf32, utf8>,
+          unicode_detail::function_encoder<utf8::buffer_type,
+                                           char32_t,
+                                           unicode_detail::swapped_utf32_to_utf8>> {};
+
+template <byte_order Order>
+struct encoder<utf32, utf32_ordered<Order>>
+    : unicode_detail::byte_order_encoder_t<
+          Order,
+          unicode_detail::identity_encoder<utf32::buffer_type>,
+          unicode_detail::function_encoder<utf32::buffer_type,
+                                           char32_t,
+                                           unicode_detail::swap_utf32>> {};
+
+template <byte_order Order>
+struct encoder<utf32_ordered<Order>, utf32> : encoder<utf32, utf32_ordered<Order>> {};
+
+}  // namespace encodings
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_ENCODINGS_ENDIAN_HPP_INCLUDED
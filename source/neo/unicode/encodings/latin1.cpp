@@ -0,0 +1,57 @@
+#include "latin1.hpp"
+
+#include <stdexcept>
+
+using namespace neo::unicode_detail;
+
+neo::utf8::buffer_type neo::encoder<neo::latin1, neo::utf8>::do_encode(const char* ptr,
+                                                                       std::size_t size) {
+    const auto first = reinterpret_cast<const unsigned char*>(ptr);
+    const auto last = first + size;
+    // Every byte above 0x7F becomes two bytes
+    std::size_t req_size = size;
+    for (auto p = first; p != last; ++p) {
+        req_size += *p >> 7;
+    }
+
+    return utf8::buffer_type::fill(req_size, [&](char* out) {
+        for (auto p = first; p != last;) {
+#if NEO_UNICODE_HAVE_SSE2
+            while (last - p >= 16) {
+                const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                if (_mm_movemask_epi8(v)) {
+                    break;
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+                p += 16;
+                out += 16;
+            }
+            if (p == last) {
+                break;
+            }
+#endif
+            out += encode_utf8(*p++, out);
+        }
+    });
+}
+
+neo::latin1::buffer_type neo::encoder<neo::utf8, neo::latin1>::do_encode(const char* ptr,
+                                                                         std::size_t size) {
+    const auto first = reinterpret_cast<const unsigned char*>(ptr);
+    const auto last = first + size;
+    std::size_t req_size = 0;
+    for (auto p = first; p != last; ++req_size) {
+        const auto cp = decode_utf8(p, last);
+        if (cp == invalid_code_point) {
+            throw std::runtime_error("Invalid UTF-8 input");
+        } else if (cp > 0xFF) {
+            throw std::runtime_error("Code point is not representable in ISO-8859-1");
+        }
+    }
+
+    return latin1::buffer_type::fill(req_size, [&](char* out) {
+        for (auto p = first; p != last;) {
+            *out++ = static_cast<char>(decode_utf8(p, last));
+        }
+    });
+}
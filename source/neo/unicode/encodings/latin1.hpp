@@ -0,0 +1,70 @@
+#ifndef NEO_UNICODE_ENCODINGS_LATIN1_HPP_INCLUDED
+#define NEO_UNICODE_ENCODINGS_LATIN1_HPP_INCLUDED
+
+#include <neo/unicode/code_unit_buffer.hpp>
+#include <neo/unicode/repertoire.hpp>
+
+#include "encodings.hpp"
+#include "utf8.hpp"
+
+namespace neo {
+
+inline namespace encodings {
+
+/**
+ * ISO-8859-1. Every byte is the code point of the same value, so there is no
+ * malformed input. ASCII text has the same bytes as in UTF-8, and the
+ * encoders share the buffer in that case.
+ */
+struct latin1 {
+    using code_unit_type = char;
+    using buffer_type = neo::code_unit_buffer<code_unit_type>;
+
+    static const char* get_name() noexcept {
+        return "iso-8859-1";
+    }
+};
+
+template <> struct decoder<latin1> {
+    static constexpr bool is_fixed_width(neo::repertoire) noexcept {
+        return true;
+    }
+
+    static char32_t next(const char*& p, const char*) noexcept {
+        return static_cast<unsigned char>(*p++);
+    }
+
+    static char32_t prev(const char*& p, const char*) noexcept {
+        return static_cast<unsigned char>(*--p);
+    }
+};
+
+template <> struct encoder<latin1, utf8> {
+    static utf8::buffer_type do_encode(const char*, std::size_t);
+    static utf8::buffer_type encode(const latin1::buffer_type& buf) {
+        if (buf.repertoire() == neo::repertoire::ascii) {
+            return buf;
+        }
+        return do_encode(buf.data(), buf.code_unit_size());
+    }
+};
+
+/**
+ * Throws `std::runtime_error` for malformed UTF-8 and for code points above
+ * U+00FF.
+ */
+template <> struct encoder<utf8, latin1> {
+    static latin1::buffer_type do_encode(const char*, std::size_t);
+    static latin1::buffer_type encode(const utf8::buffer_type& buf) {
+        if (buf.repertoire() == neo::repertoire::ascii) {
+            return buf;
+        }
+        return do_encode(buf.data(), buf.code_unit_size());
+    }
+};
+
+}  // namespace encodings
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_ENCODINGS_LATIN1_HPP_INCLUDED
@@ -2,11 +2,27 @@
 
 #include <utf8rewind.h>
 
-neo::utf16::buffer_type neo::encoder<neo::utf8, neo::utf16>::do_encode(const char* ptr, std::size_t size) {
+#include <stdexcept>
+
+neo::utf16::buffer_type neo::encoder<neo::utf8, neo::utf16>::do_encode(const char* ptr, std::size_t size, neo::repertoire rep) {
+    if (size == 0) {
+        return {};
+    }
+    if (rep == neo::repertoire::ascii) {
+        return neo::utf16::buffer_type::fill(size, [&](auto dest) {
+            neo::unicode_detail::widen_ascii(ptr, size, dest);
+        });
+    } else if (rep == neo::repertoire::latin1) {
+        return neo::utf16::buffer_type::fill(neo::unicode_detail::latin1_utf8_length(ptr, size),
+                                              [&](auto dest) {
+                                                  neo::unicode_detail::widen_latin1(ptr, size, dest);
+                                              });
+    }
+
     std::int32_t errors = 0;
     const auto req_size = ::utf8toutf16(ptr, size, nullptr, 0, &errors) / sizeof(char16_t);
-    if (req_size == 0 || errors != UTF8_ERR_NONE) {
-        throw std::runtime_error("??");  // todo. Probably define an error_category
+    if (errors != UTF8_ERR_NONE) {
+        throw std::runtime_error("Invalid UTF-8 input");
     }
 
     return neo::utf16::buffer_type::fill(req_size, [&](auto dest_) {
@@ -15,15 +31,24 @@ neo::utf16::buffer_type neo::encoder<neo::utf8, neo::utf16>::do_encode(const cha
     });
 }
 
-neo::utf8::buffer_type neo::encoder<neo::utf16, neo::utf8>::do_encode(const char16_t* ptr_, std::size_t size) {
+neo::utf8::buffer_type neo::encoder<neo::utf16, neo::utf8>::do_encode(const char16_t* ptr_, std::size_t size, neo::repertoire rep) {
+    if (size == 0) {
+        return {};
+    }
+    if (rep == neo::repertoire::ascii) {
+        return neo::utf8::buffer_type::fill(size, [&](auto dest) {
+            neo::unicode_detail::narrow_ascii(ptr_, size, dest);
+        });
+    }
+
     const auto ptr = reinterpret_cast<const ::utf16_t*>(ptr_);
     std::int32_t errors = 0;
     const auto req_size = ::utf16toutf8(ptr, size * sizeof(char16_t), nullptr, 0, &errors);
-    if (req_size == 0 || errors != UTF8_ERR_NONE) {
-        throw std::runtime_error("??");  // todo. Probably define an error_category
+    if (errors != UTF8_ERR_NONE) {
+        throw std::runtime_error("Invalid UTF-16 input");
     }
 
     return neo::utf8::buffer_type::fill(req_size, [&](auto dest) {
         ::utf16toutf8(ptr, size * sizeof(char16_t), dest, req_size, nullptr);
     });
-}
\ No newline at end of file
+}
@@ -2,12 +2,81 @@
 #define NEO_UNICODE_ENCODINGS_UTF16_HPP_INCLUDED
 
 #include <neo/unicode/code_unit_buffer.hpp>
+#include <neo/unicode/simd.hpp>
 
 #include "encodings.hpp"
 #include "utf8.hpp"
 
 namespace neo {
 
+namespace unicode_detail {
+
+/**
+ * Read a 16-bit code unit, swapping its bytes if `Swap`
+ */
+template <bool Swap, typename Unit> char32_t load_utf16(const Unit* p) noexcept {
+    const auto u = static_cast<std::uint16_t>(*p);
+    return Swap ? byte_swap(u) : u;
+}
+
+/**
+ * Decode the UTF-16 sequence at `p` and advance past it. Returns
+ * `invalid_code_point` for unpaired surrogates, after advancing past them.
+ * If `Swap`, the code units are in the opposite of the host byte order.
+ */
+template <bool Swap, typename Unit>
+char32_t decode_utf16(const Unit*& p, const Unit* end) noexcept {
+    const char32_t hi = load_utf16<Swap>(p++);
+    if (hi < 0xD800 || hi > 0xDFFF) {
+        return hi;
+    }
+    if (hi > 0xDBFF || p == end) {
+        return invalid_code_point;
+    }
+    const char32_t lo = load_utf16<Swap>(p);
+    if (lo < 0xDC00 || lo > 0xDFFF) {
+        return invalid_code_point;
+    }
+    ++p;
+    return 0x10000 + ((hi - 0xD800) << 10) + (lo - 0xDC00);
+}
+
+/**
+ * Write `cp` as UTF-16 to `out`, returning the number of code units written.
+ */
+template <typename Unit> std::size_t encode_utf16(char32_t cp, Unit* out) noexcept {
+    if (cp < 0x10000) {
+        out[0] = static_cast<Unit>(cp);
+        return 1;
+    }
+    cp -= 0x10000;
+    out[0] = static_cast<Unit>(0xD800 + (cp >> 10));
+    out[1] = static_cast<Unit>(0xDC00 + (cp & 0x3FF));
+    return 2;
+}
+
+template <bool Swap, typename Unit> struct utf16_decoder {
+    static char32_t next(const Unit*& p, const Unit* end) noexcept {
+        const auto cp = decode_utf16<Swap>(p, end);
+        return cp == invalid_code_point ? replacement_character : cp;
+    }
+
+    static char32_t prev(const Unit*& p, const Unit* begin) noexcept {
+        const auto last = load_utf16<Swap>(p - 1);
+        if (last >= 0xDC00 && last <= 0xDFFF && p - 1 != begin) {
+            const auto first = load_utf16<Swap>(p - 2);
+            if (first >= 0xD800 && first <= 0xDBFF) {
+                p -= 2;
+                return 0x10000 + ((first - 0xD800) << 10) + (last - 0xDC00);
+            }
+        }
+        --p;
+        return last >= 0xD800 && last <= 0xDFFF ? replacement_character : last;
+    }
+};
+
+}  // namespace unicode_detail
+
 inline namespace encodings {
 
 struct utf16 {
@@ -19,18 +88,26 @@ struct utf16 {
 
 template <> struct encoding_for_char_type<char16_t> { using type = utf16; };
 
+template <> struct decoder<utf16> : unicode_detail::utf16_decoder<false, char16_t> {
+    static constexpr bool is_fixed_width(neo::repertoire r) noexcept {
+        return r != neo::repertoire::any;
+    }
+};
+
 template <> struct encoder<utf8, utf16> {
-    static utf16::buffer_type do_encode(const char* ptr, std::size_t);
+    static utf16::buffer_type
+    do_encode(const char* ptr, std::size_t, neo::repertoire = neo::repertoire::any);
 
     template <typename FromBuffer> static utf16::buffer_type encode(FromBuffer&& buf) {
-        return do_encode(buf.data(), buf.code_unit_size());
+        return do_encode(buf.data(), buf.code_unit_size(), unicode_detail::repertoire_of(buf));
     }
 };
 
 template <> struct encoder<utf16, utf8> {
-    static utf8::buffer_type do_encode(const char16_t* ptr, std::size_t);
+    static utf8::buffer_type
+    do_encode(const char16_t* ptr, std::size_t, neo::repertoire = neo::repertoire::any);
     template <typename FromBuffer> static utf8::buffer_type encode(FromBuffer&& buf) {
-        return do_encode(buf.data(), buf.code_unit_size());
+        return do_encode(buf.data(), buf.code_unit_size(), unicode_detail::repertoire_of(buf));
     }
 };
 
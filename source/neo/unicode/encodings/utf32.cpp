@@ -0,0 +1,54 @@
+#include "utf32.hpp"
+
+#include <utf8rewind.h>
+
+#include <stdexcept>
+
+neo::utf32::buffer_type neo::encoder<neo::utf8, neo::utf32>::do_encode(const char* ptr, std::size_t size, neo::repertoire rep) {
+    if (size == 0) {
+        return {};
+    }
+    if (rep == neo::repertoire::ascii) {
+        return neo::utf32::buffer_type::fill(size, [&](auto dest) {
+            neo::unicode_detail::widen_ascii(ptr, size, dest);
+        });
+    } else if (rep == neo::repertoire::latin1) {
+        return neo::utf32::buffer_type::fill(neo::unicode_detail::latin1_utf8_length(ptr, size),
+                                              [&](auto dest) {
+                                                  neo::unicode_detail::widen_latin1(ptr, size, dest);
+                                              });
+    }
+
+    std::int32_t errors = 0;
+    const auto req_size = ::utf8toutf32(ptr, size, nullptr, 0, &errors) / sizeof(char32_t);
+    if (errors != UTF8_ERR_NONE) {
+        throw std::runtime_error("Invalid UTF-8 input");
+    }
+
+    return neo::utf32::buffer_type::fill(req_size, [&](auto dest_) {
+        const auto dest = reinterpret_cast<::unicode_t*>(dest_);
+        ::utf8toutf32(ptr, size, dest, req_size * sizeof(char32_t), nullptr);
+    });
+}
+
+neo::utf8::buffer_type neo::encoder<neo::utf32, neo::utf8>::do_encode(const char32_t* ptr_, std::size_t size, neo::repertoire rep) {
+    if (size == 0) {
+        return {};
+    }
+    if (rep == neo::repertoire::ascii) {
+        return neo::utf8::buffer_type::fill(size, [&](auto dest) {
+            neo::unicode_detail::narrow_ascii(ptr_, size, dest);
+        });
+    }
+
+    const auto ptr = reinterpret_cast<const ::unicode_t*>(ptr_);
+    std::int32_t errors = 0;
+    const auto req_size = ::utf32toutf8(ptr, size * sizeof(char32_t), nullptr, 0, &errors);
+    if (errors != UTF8_ERR_NONE) {
+        throw std::runtime_error("Invalid UTF-32 input");
+    }
+
+    return neo::utf8::buffer_type::fill(req_size, [&](auto dest) {
+        ::utf32toutf8(ptr, size * sizeof(char32_t), dest, req_size, nullptr);
+    });
+}
@@ -3,10 +3,38 @@
 
 #include <neo/unicode/code_unit_buffer.hpp>
 
+#include <neo/unicode/simd.hpp>
+
 #include "encodings.hpp"
+#include "utf8.hpp"
 
 namespace neo {
 
+namespace unicode_detail {
+
+/**
+ * Decodes UTF-32 from code units of type `Unit`, swapping their bytes if
+ * `Swap`.
+ */
+template <bool Swap, typename Unit> struct utf32_decoder {
+    static char32_t next(const Unit*& p, const Unit*) noexcept {
+        return load(p++);
+    }
+
+    static char32_t prev(const Unit*& p, const Unit*) noexcept {
+        return load(--p);
+    }
+
+private:
+    static char32_t load(const Unit* p) noexcept {
+        const auto u = static_cast<std::uint32_t>(*p);
+        const char32_t cp = Swap ? byte_swap(u) : u;
+        return cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF) ? replacement_character : cp;
+    }
+};
+
+}  // namespace unicode_detail
+
 inline namespace encodings {
 
 struct utf32 {
@@ -20,8 +48,26 @@ struct utf32 {
 
 template <> struct encoding_for_char_type<char32_t> { using type = utf32; };
 
-template <> struct encoder<struct utf8, utf32> {
-    template <typename FromBuffer> static utf32::buffer_type encode(const FromBuffer&);
+template <> struct decoder<utf32> : unicode_detail::utf32_decoder<false, char32_t> {
+    static constexpr bool is_fixed_width(neo::repertoire) noexcept {
+        return true;
+    }
+};
+
+template <> struct encoder<utf8, utf32> {
+    static utf32::buffer_type
+    do_encode(const char* ptr, std::size_t, neo::repertoire = neo::repertoire::any);
+    template <typename FromBuffer> static utf32::buffer_type encode(FromBuffer&& buf) {
+        return do_encode(buf.data(), buf.code_unit_size(), unicode_detail::repertoire_of(buf));
+    }
+};
+
+template <> struct encoder<utf32, utf8> {
+    static utf8::buffer_type
+    do_encode(const char32_t* ptr, std::size_t, neo::repertoire = neo::repertoire::any);
+    template <typename FromBuffer> static utf8::buffer_type encode(FromBuffer&& buf) {
+        return do_encode(buf.data(), buf.code_unit_size(), unicode_detail::repertoire_of(buf));
+    }
 };
 
 }  // namespace encodings
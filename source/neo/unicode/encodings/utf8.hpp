@@ -7,6 +7,92 @@
 
 namespace neo {
 
+namespace unicode_detail {
+
+/**
+ * U+FFFD, substituted for malformed input by the decoders
+ */
+constexpr char32_t replacement_character = 0xFFFD;
+
+/**
+ * Returned by the strict decoding functions for malformed input
+ */
+constexpr char32_t invalid_code_point = 0xFFFFFFFF;
+
+/**
+ * Decode the UTF-8 sequence at `p` and advance past it. Returns
+ * `invalid_code_point` for malformed, overlong and surrogate sequences, after
+ * advancing past the offending bytes.
+ */
+inline char32_t decode_utf8(const unsigned char*& p, const unsigned char* end) noexcept {
+    const unsigned lead = *p++;
+    if (lead < 0x80) {
+        return lead;
+    }
+    int n_trail;
+    char32_t cp;
+    char32_t min;
+    if ((lead & 0xE0) == 0xC0) {
+        n_trail = 1;
+        cp = lead & 0x1F;
+        min = 0x80;
+    } else if ((lead & 0xF0) == 0xE0) {
+        n_trail = 2;
+        cp = lead & 0x0F;
+        min = 0x800;
+    } else if ((lead & 0xF8) == 0xF0) {
+        n_trail = 3;
+        cp = lead & 0x07;
+        min = 0x10000;
+    } else {
+        return invalid_code_point;
+    }
+    for (; n_trail; --n_trail, ++p) {
+        if (p == end || (*p & 0xC0) != 0x80) {
+            return invalid_code_point;
+        }
+        cp = (cp << 6) | (*p & 0x3F);
+    }
+    if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+        return invalid_code_point;
+    }
+    return cp;
+}
+
+/**
+ * The number of bytes needed to encode `cp` as UTF-8
+ */
+constexpr std::size_t utf8_length(char32_t cp) noexcept {
+    return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+}
+
+/**
+ * Write `cp` as UTF-8 to `out`, returning the number of bytes written.
+ */
+inline std::size_t encode_utf8(char32_t cp, char* out) noexcept {
+    if (cp < 0x80) {
+        out[0] = static_cast<char>(cp);
+        return 1;
+    } else if (cp < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (cp >> 6));
+        out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 2;
+    } else if (cp < 0x10000) {
+        out[0] = static_cast<char>(0xE0 | (cp >> 12));
+        out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 3;
+    } else {
+        out[0] = static_cast<char>(0xF0 | (cp >> 18));
+        out[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 4;
+    }
+}
+
+}  // namespace unicode_detail
+
 inline namespace encodings {
 
 struct utf8 {
@@ -20,6 +106,43 @@ struct utf8 {
 
 template <> struct encoding_for_char_type<char> { using type = utf8; };
 
+template <> struct decoder<utf8> {
+    static constexpr bool is_fixed_width(neo::repertoire r) noexcept {
+        return r == neo::repertoire::ascii;
+    }
+
+    static char32_t next(const char*& p, const char* end) noexcept {
+        auto up = reinterpret_cast<const unsigned char*>(p);
+        const auto cp = unicode_detail::decode_utf8(up, reinterpret_cast<const unsigned char*>(end));
+        p = reinterpret_cast<const char*>(up);
+        return cp == unicode_detail::invalid_code_point ? unicode_detail::replacement_character : cp;
+    }
+
+    static char32_t prev(const char*& p, const char* begin) noexcept {
+        const auto end = reinterpret_cast<const unsigned char*>(p);
+        auto start = end - 1;
+        if (*start < 0x80) {
+            --p;
+            return *start;
+        }
+        // Back up to the lead byte, which is at most three continuation bytes
+        // back. If decoding from there doesn't end at `p`, then the last byte
+        // is a stray continuation byte and is a code point on its own.
+        const auto first = reinterpret_cast<const unsigned char*>(begin);
+        while (start != first && (*start & 0xC0) == 0x80 && end - start < 4) {
+            --start;
+        }
+        auto decoded_end = start;
+        auto cp = unicode_detail::decode_utf8(decoded_end, end);
+        if (decoded_end != end) {
+            start = end - 1;
+            cp = unicode_detail::invalid_code_point;
+        }
+        p = reinterpret_cast<const char*>(start);
+        return cp == unicode_detail::invalid_code_point ? unicode_detail::replacement_character : cp;
+    }
+};
+
 }  // namespace encodings
 
 }  // namespace neo
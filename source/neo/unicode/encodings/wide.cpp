@@ -2,12 +2,29 @@
 
 #include <utf8rewind.h>
 
+#include <stdexcept>
+
 neo::wide::buffer_type neo::encoder<neo::utf8, neo::wide>::do_encode(const char* ptr,
-                                                                     std::size_t size) {
+                                                                     std::size_t size,
+                                                                     neo::repertoire rep) {
+    if (size == 0) {
+        return {};
+    }
+    if (rep == neo::repertoire::ascii) {
+        return neo::wide::buffer_type::fill(size, [&](auto dest) {
+            neo::unicode_detail::widen_ascii(ptr, size, dest);
+        });
+    } else if (rep == neo::repertoire::latin1) {
+        return neo::wide::buffer_type::fill(neo::unicode_detail::latin1_utf8_length(ptr, size),
+                                              [&](auto dest) {
+                                                  neo::unicode_detail::widen_latin1(ptr, size, dest);
+                                              });
+    }
+
     std::int32_t errors = 0;
     const auto req_size = ::utf8towide(ptr, size, nullptr, 0, &errors) / sizeof(wchar_t);
-    if (req_size == 0 || errors != UTF8_ERR_NONE) {
-        throw std::runtime_error("??");  // todo. Probably define an error_category
+    if (errors != UTF8_ERR_NONE) {
+        throw std::runtime_error("Invalid UTF-8 input");
     }
 
     return neo::wide::buffer_type::fill(req_size, [&](auto dest) {
@@ -16,14 +33,24 @@ neo::wide::buffer_type neo::encoder<neo::utf8, neo::wide>::do_encode(const char*
 }
 
 neo::utf8::buffer_type neo::encoder<neo::wide, neo::utf8>::do_encode(const wchar_t* ptr,
-                                                                     std::size_t size) {
+                                                                     std::size_t size,
+                                                                     neo::repertoire rep) {
+    if (size == 0) {
+        return {};
+    }
+    if (rep == neo::repertoire::ascii) {
+        return neo::utf8::buffer_type::fill(size, [&](auto dest) {
+            neo::unicode_detail::narrow_ascii(ptr, size, dest);
+        });
+    }
+
     std::int32_t errors = 0;
     const auto req_size = ::widetoutf8(ptr, size * sizeof(wchar_t), nullptr, 0, &errors);
-    if (req_size == 0 || errors != UTF8_ERR_NONE) {
-        throw std::runtime_error("??");  // todo. Probably define an error_category
+    if (errors != UTF8_ERR_NONE) {
+        throw std::runtime_error("Invalid wide character input");
     }
 
     return neo::utf8::buffer_type::fill(req_size, [&](auto dest) {
         ::widetoutf8(ptr, size * sizeof(wchar_t), dest, req_size, nullptr);
     });
-}
\ No newline at end of file
+}
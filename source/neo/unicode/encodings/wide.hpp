@@ -29,17 +29,32 @@ struct wide {
 
 template <> struct encoding_for_char_type<wchar_t> { using type = wide; };
 
+template <>
+struct decoder<wide>
+#ifdef _WIN32
+    : unicode_detail::utf16_decoder<false, wchar_t>
+#else
+    : unicode_detail::utf32_decoder<false, wchar_t>
+#endif
+{
+    static constexpr bool is_fixed_width(neo::repertoire r) noexcept {
+        return decoder<wide::underlying>::is_fixed_width(r);
+    }
+};
+
 template <> struct encoder<utf8, wide> {
-    static wide::buffer_type do_encode(const char*, std::size_t);
+    static wide::buffer_type
+    do_encode(const char*, std::size_t, neo::repertoire = neo::repertoire::any);
     template <typename FromBuffer> static wide::buffer_type encode(FromBuffer&& buf) {
-        return do_encode(buf.data(), buf.code_unit_size());
+        return do_encode(buf.data(), buf.code_unit_size(), unicode_detail::repertoire_of(buf));
     }
 };
 
 template <> struct encoder<wide, utf8> {
-    static utf8::buffer_type do_encode(const wchar_t*, std::size_t);
+    static utf8::buffer_type
+    do_encode(const wchar_t*, std::size_t, neo::repertoire = neo::repertoire::any);
     template <typename FromBuffer> static utf8::buffer_type encode(FromBuffer&& buf) {
-        return do_encode(buf.data(), buf.code_unit_size());
+        return do_encode(buf.data(), buf.code_unit_size(), unicode_detail::repertoire_of(buf));
     }
 };
 
@@ -0,0 +1,442 @@
+#ifndef NEO_UNICODE_GRAPHEME_HPP_INCLUDED
+#define NEO_UNICODE_GRAPHEME_HPP_INCLUDED
+
+#include "search.hpp"
+#include "text.hpp"
+#include "text_view.hpp"
+#include "ucd_tables.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+namespace neo {
+
+namespace unicode_detail {
+
+constexpr std::uint16_t grapheme_bit(grapheme_break b) noexcept {
+    return static_cast<std::uint16_t>(1u << static_cast<unsigned>(b));
+}
+
+constexpr std::uint16_t grapheme_extenders = grapheme_bit(grapheme_break::extend)
+    | grapheme_bit(grapheme_break::zwj) | grapheme_bit(grapheme_break::spacing_mark);
+
+/**
+ * For each Grapheme_Cluster_Break, a bit for each break that can follow it
+ * in the same cluster, by the rules that look at no more than the pair: GB3
+ * to GB9b. Regional indicator pairs (GB12 and GB13) and emoji joined by ZWJ
+ * (GB11) need more context.
+ */
+constexpr std::uint16_t grapheme_joins[] = {
+    // other
+    grapheme_extenders,
+    // cr
+    grapheme_bit(grapheme_break::lf),
+    // lf
+    0,
+    // control
+    0,
+    // extend
+    grapheme_extenders,
+    // zwj
+    grapheme_extenders,
+    // regional_indicator
+    grapheme_extenders,
+    // prepend
+    static_cast<std::uint16_t>(0x3FFF & ~(grapheme_bit(grapheme_break::cr) | grapheme_bit(grapheme_break::lf)
+                                          | grapheme_bit(grapheme_break::control))),
+    // spacing_mark
+    grapheme_extenders,
+    // l
+    grapheme_extenders | grapheme_bit(grapheme_break::l) | grapheme_bit(grapheme_break::v)
+        | grapheme_bit(grapheme_break::lv) | grapheme_bit(grapheme_break::lvt),
+    // v
+    grapheme_extenders | grapheme_bit(grapheme_break::v) | grapheme_bit(grapheme_break::t),
+    // t
+    grapheme_extenders | grapheme_bit(grapheme_break::t),
+    // lv
+    grapheme_extenders | grapheme_bit(grapheme_break::v) | grapheme_bit(grapheme_break::t),
+    // lvt
+    grapheme_extenders | grapheme_bit(grapheme_break::t),
+};
+
+constexpr unsigned grapheme_break_of(std::uint8_t props) noexcept {
+    return props & 0x0F;
+}
+
+/**
+ * `grapheme_properties()` of an ASCII code point, without the tables
+ */
+constexpr std::uint8_t ascii_grapheme_properties(unsigned u) noexcept {
+    return static_cast<std::uint8_t>(u >= 0x20 && u != 0x7F
+                                         ? grapheme_break::other
+                                         : u == '\r' ? grapheme_break::cr
+                                                     : u == '\n' ? grapheme_break::lf : grapheme_break::control);
+}
+
+/**
+ * Whether a cluster may start between code points with properties `a` and
+ * `b`, whatever comes before `a`
+ */
+constexpr bool grapheme_break_always(std::uint8_t a, std::uint8_t b) noexcept {
+    return !((grapheme_joins[grapheme_break_of(a)] >> grapheme_break_of(b)) & 1)
+        && !(grapheme_break_of(a) == unsigned(grapheme_break::regional_indicator)
+             && grapheme_break_of(b) == unsigned(grapheme_break::regional_indicator))
+        && !(grapheme_break_of(a) == unsigned(grapheme_break::zwj) && (b & extended_pictographic_bit));
+}
+
+/**
+ * Decode the code point at `p` and get its grapheme properties. ASCII skips
+ * the tables.
+ */
+template <typename Encoding, typename Unit>
+std::uint8_t next_grapheme_properties(const Unit*& p, const Unit* last) noexcept {
+    const auto u = static_cast<std::make_unsigned_t<Unit>>(*p);
+    if (ascii_code_units<Encoding>::value && u < 0x80) {
+        ++p;
+        return ascii_grapheme_properties(u);
+    }
+    return grapheme_properties(decoder<Encoding>::next(p, last));
+}
+
+/**
+ * Find the end of the grapheme cluster that starts at `p`, which must be a
+ * cluster boundary before `last`. This is the state machine of UAX #29: the
+ * state is whether the cluster ends in an odd run of regional indicators,
+ * and how far it is through an emoji ZWJ sequence.
+ */
+template <typename Encoding, typename Unit>
+const Unit* next_grapheme_break(const Unit* p, const Unit* last) noexcept {
+    using unit = std::make_unsigned_t<Unit>;
+    if (ascii_code_units<Encoding>::value && unit(*p) < 0x80) {
+        // Between two ASCII code points, there is a break unless they are
+        // CR LF. Nothing joins ASCII but Prepend, which isn't ASCII.
+        if (*p == Unit('\r')) {
+            return p + 1 != last && p[1] == Unit('\n') ? p + 2 : p + 1;
+        }
+        if (p + 1 == last || unit(p[1]) < 0x80) {
+            return p + 1;
+        }
+    }
+    enum { no_emoji, emoji, emoji_zwj } emoji_state = no_emoji;
+    auto q = p;
+    auto prev = next_grapheme_properties<Encoding>(q, last);
+    bool odd_indicators = grapheme_break_of(prev) == unsigned(grapheme_break::regional_indicator);
+    if (prev & extended_pictographic_bit) {
+        emoji_state = emoji;
+    }
+    while (q != last) {
+        auto r = q;
+        const auto next = next_grapheme_properties<Encoding>(r, last);
+        const auto a = grapheme_break_of(prev);
+        const auto b = grapheme_break_of(next);
+        bool join;
+        if (a == unsigned(grapheme_break::regional_indicator)
+            && b == unsigned(grapheme_break::regional_indicator)) {
+            join = odd_indicators;
+        } else if (a == unsigned(grapheme_break::zwj) && (next & extended_pictographic_bit)) {
+            join = emoji_state == emoji_zwj;
+        } else {
+            join = (grapheme_joins[a] >> b) & 1;
+        }
+        if (!join) {
+            return q;
+        }
+        odd_indicators = b == unsigned(grapheme_break::regional_indicator) && !odd_indicators;
+        if (next & extended_pictographic_bit) {
+            emoji_state = emoji;
+        } else if (emoji_state == emoji && b == unsigned(grapheme_break::extend)) {
+            emoji_state = emoji;
+        } else if (emoji_state == emoji && b == unsigned(grapheme_break::zwj)) {
+            emoji_state = emoji_zwj;
+        } else {
+            emoji_state = no_emoji;
+        }
+        prev = next;
+        q = r;
+    }
+    return last;
+}
+
+/**
+ * Walk back from `p`, the start of a code point before `last`, to a position
+ * where a cluster starts whatever comes before it. From there,
+ * `next_grapheme_break()` finds the clusters up to `p`.
+ */
+template <typename Encoding, typename Unit>
+const Unit* grapheme_safe_start(const Unit* first, const Unit* p, const Unit* last) noexcept {
+    auto q = p;
+    auto b = next_grapheme_properties<Encoding>(q, last);
+    while (p != first) {
+        auto s = p;
+        decoder<Encoding>::prev(s, first);
+        auto t = s;
+        const auto a = next_grapheme_properties<Encoding>(t, last);
+        if (grapheme_break_always(a, b)) {
+            return p;
+        }
+        p = s;
+        b = a;
+    }
+    return first;
+}
+
+/**
+ * Find the start of the grapheme cluster that ends at `p`, which must be a
+ * cluster boundary after `first`
+ */
+template <typename Encoding, typename Unit>
+const Unit* prev_grapheme_break(const Unit* first, const Unit* p) noexcept {
+    using unit = std::make_unsigned_t<Unit>;
+    if (ascii_code_units<Encoding>::value && unit(p[-1]) < 0x80 && p[-1] != Unit('\n')) {
+        // Only Prepend, which isn't ASCII, joins an ASCII code point
+        if (p - 1 == first || unit(p[-2]) < 0x80) {
+            return p - 1;
+        }
+    }
+    auto s = p;
+    decoder<Encoding>::prev(s, first);
+    auto start = grapheme_safe_start<Encoding>(first, s, p);
+    while (true) {
+        const auto next = next_grapheme_break<Encoding>(start, p);
+        if (next == p) {
+            return start;
+        }
+        start = next;
+    }
+}
+
+/**
+ * Check whether a grapheme cluster starts at `p`, the start of a code point
+ * in [first, last]
+ */
+template <typename Encoding, typename Unit>
+bool is_grapheme_break(const Unit* first, const Unit* p, const Unit* last) noexcept {
+    if (p == first || p == last) {
+        return true;
+    }
+    auto start = grapheme_safe_start<Encoding>(first, p, last);
+    while (start < p) {
+        start = next_grapheme_break<Encoding>(start, last);
+    }
+    return start == p;
+}
+
+/**
+ * Find the start of the code point that has the code unit at `p` in
+ * [first, last). No code point is longer than four bytes, so decoding from
+ * that far back finds it.
+ */
+template <typename Encoding, typename Unit>
+const Unit* code_point_start(const Unit* first, const Unit* p, const Unit* last) noexcept {
+    constexpr std::ptrdiff_t longest = decoder<Encoding>::is_fixed_width(repertoire::any) ? 1 : 4 / sizeof(Unit);
+    auto q = p - first < longest ? first : p - (longest - 1);
+    while (true) {
+        auto next = q;
+        decoder<Encoding>::next(next, last);
+        if (next > p) {
+            return q;
+        }
+        q = next;
+    }
+}
+
+/**
+ * Find the last grapheme cluster boundary of [first, last) at most
+ * `max_size` code units from `first`
+ */
+template <typename Encoding, typename Unit>
+const Unit* grapheme_truncation(const Unit* first, const Unit* last, std::size_t max_size) noexcept {
+    using unit = std::make_unsigned_t<Unit>;
+    if (static_cast<std::size_t>(last - first) <= max_size) {
+        return last;
+    }
+    auto p = first + max_size;
+    if (ascii_code_units<Encoding>::value && p != first && unit(p[-1]) < 0x80 && unit(*p) < 0x80
+        && !(p[-1] == Unit('\r') && *p == Unit('\n'))) {
+        // A cluster always starts between two ASCII code points but CR LF
+        return p;
+    }
+    p = code_point_start<Encoding>(first, p, last);
+    auto start = grapheme_safe_start<Encoding>(first, p, last);
+    while (start != p) {
+        const auto next = next_grapheme_break<Encoding>(start, last);
+        if (next > p) {
+            break;
+        }
+        start = next;
+    }
+    return start;
+}
+
+}  // namespace unicode_detail
+
+/**
+ * A bidirectional iterator over the extended grapheme clusters of a text,
+ * the user-perceived characters of UAX #29. Dereferencing yields a
+ * `basic_text_view` of the cluster.
+ */
+template <typename Encoding> class grapheme_iterator {
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = basic_text_view<Encoding>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = value_type;
+    using code_unit_type = typename Encoding::code_unit_type;
+
+private:
+    const code_unit_type* _first = nullptr;
+    const code_unit_type* _pos = nullptr;
+    // The end of the cluster at `_pos`
+    const code_unit_type* _next = nullptr;
+    const code_unit_type* _last = nullptr;
+
+    void _find_next() noexcept {
+        _next = _pos == _last ? _last : unicode_detail::next_grapheme_break<Encoding>(_pos, _last);
+    }
+
+public:
+    grapheme_iterator() = default;
+
+    /**
+     * Construct an iterator at `pos`, which must be the start of a cluster in
+     * [first, last]
+     */
+    grapheme_iterator(const code_unit_type* first, const code_unit_type* pos, const code_unit_type* last) noexcept
+        : _first(first)
+        , _pos(pos)
+        , _last(last) {
+        _find_next();
+    }
+
+    /**
+     * Get a pointer to the first code unit of the current cluster
+     */
+    const code_unit_type* position() const noexcept {
+        return _pos;
+    }
+
+    value_type operator*() const noexcept {
+        return value_type(_pos, _next);
+    }
+
+    grapheme_iterator& operator++() noexcept {
+        _pos = _next;
+        _find_next();
+        return *this;
+    }
+
+    grapheme_iterator operator++(int) noexcept {
+        auto copy = *this;
+        ++*this;
+        return copy;
+    }
+
+    grapheme_iterator& operator--() noexcept {
+        _next = _pos;
+        _pos = unicode_detail::prev_grapheme_break<Encoding>(_first, _pos);
+        return *this;
+    }
+
+    grapheme_iterator operator--(int) noexcept {
+        auto copy = *this;
+        --*this;
+        return copy;
+    }
+
+    friend bool operator==(const grapheme_iterator& a, const grapheme_iterator& b) noexcept {
+        return a._pos == b._pos;
+    }
+
+    friend bool operator!=(const grapheme_iterator& a, const grapheme_iterator& b) noexcept {
+        return !(a == b);
+    }
+};
+
+/**
+ * The grapheme clusters of a text, as returned by `graphemes()`
+ */
+template <typename Encoding> class grapheme_range {
+public:
+    using iterator = grapheme_iterator<Encoding>;
+    using const_iterator = iterator;
+    using code_unit_type = typename Encoding::code_unit_type;
+
+private:
+    const code_unit_type* _first;
+    const code_unit_type* _last;
+
+public:
+    grapheme_range(const code_unit_type* first, const code_unit_type* last) noexcept
+        : _first(first)
+        , _last(last) {}
+
+    iterator begin() const noexcept {
+        return iterator(_first, _first, _last);
+    }
+
+    iterator end() const noexcept {
+        return iterator(_first, _last, _last);
+    }
+};
+
+/**
+ * Iterate the extended grapheme clusters of `text`. The range refers to the
+ * text, which must outlive it. CR LF and runs of ASCII are split without
+ * looking up any properties.
+ */
+template <typename Encoding, typename Buffer>
+grapheme_range<Encoding> graphemes(const basic_text<Encoding, Buffer>& text) noexcept {
+    return grapheme_range<Encoding>(text.data(), text.data() + text.code_unit_size());
+}
+
+template <typename Encoding, typename Buffer> void graphemes(const basic_text<Encoding, Buffer>&&) = delete;
+
+template <typename Encoding> grapheme_range<Encoding> graphemes(basic_text_view<Encoding> view) noexcept {
+    return grapheme_range<Encoding>(view.data(), view.data() + view.code_unit_size());
+}
+
+/**
+ * Check whether a grapheme cluster starts at `pos` in `text`. A cursor should
+ * only stop at these.
+ */
+template <typename Encoding, typename Buffer>
+bool is_grapheme_break(const basic_text<Encoding, Buffer>& text,
+                       typename basic_text<Encoding, Buffer>::iterator pos) noexcept {
+    return unicode_detail::is_grapheme_break<Encoding>(text.data(),
+                                                       pos.position(),
+                                                       text.data() + text.code_unit_size());
+}
+
+/**
+ * The longest prefix of `text` that is at most `max_code_units` long and
+ * doesn't split a grapheme cluster, as for a field with a size limit. Only
+ * the cluster at the limit is looked at, so the cost doesn't grow with the
+ * text.
+ */
+template <typename Encoding, typename Buffer>
+basic_text_view<Encoding> truncate_to(const basic_text<Encoding, Buffer>& text, std::size_t max_code_units) noexcept {
+    const auto first = text.data();
+    return basic_text_view<Encoding>(first,
+                                     unicode_detail::grapheme_truncation<Encoding>(first,
+                                                                                   first + text.code_unit_size(),
+                                                                                   max_code_units));
+}
+
+template <typename Encoding, typename Buffer>
+void truncate_to(const basic_text<Encoding, Buffer>&&, std::size_t) = delete;
+
+template <typename Encoding>
+basic_text_view<Encoding> truncate_to(basic_text_view<Encoding> view, std::size_t max_code_units) noexcept {
+    const auto first = view.data();
+    return basic_text_view<Encoding>(first,
+                                     unicode_detail::grapheme_truncation<Encoding>(first,
+                                                                                   first + view.code_unit_size(),
+                                                                                   max_code_units));
+}
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_GRAPHEME_HPP_INCLUDED
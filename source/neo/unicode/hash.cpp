@@ -0,0 +1,113 @@
+#include "hash.hpp"
+
+#include "simd.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace neo {
+
+namespace unicode_detail {
+
+namespace {
+
+constexpr std::uint64_t secret[4] = {0xa0761d6478bd642full,
+                                     0xe7037ed1a0b428dbull,
+                                     0x8ebc6af09c88c6e3ull,
+                                     0x589965cc75374cc3ull};
+
+/**
+ * Multiply to 128 bits and fold the halves together
+ */
+inline std::uint64_t mix(std::uint64_t a, std::uint64_t b) noexcept {
+#if defined(__SIZEOF_INT128__)
+    const auto r = static_cast<unsigned __int128>(a) * b;
+    return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+#else
+    const auto lo_lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+    const auto hi_lo = (a >> 32) * (b & 0xFFFFFFFF);
+    const auto lo_hi = (a & 0xFFFFFFFF) * (b >> 32);
+    const auto hi_hi = (a >> 32) * (b >> 32);
+    const auto cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    const auto hi = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    const auto lo = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+    return lo ^ hi;
+#endif
+}
+
+inline std::uint64_t read64(const unsigned char* p) noexcept {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline std::uint64_t read32(const unsigned char* p) noexcept {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+}  // namespace
+
+std::size_t hash_bytes(const void* data, std::size_t size) noexcept {
+    auto p = static_cast<const unsigned char*>(data);
+    std::uint64_t seed = mix(secret[0], secret[1]);
+    std::uint64_t a = 0;
+    std::uint64_t b = 0;
+    if (size <= 16) {
+        // Overlapping reads cover any size from 4 to 16
+        if (size >= 4) {
+            const auto step = (size >> 3) << 2;
+            a = (read32(p) << 32) | read32(p + step);
+            b = (read32(p + size - 4) << 32) | read32(p + size - 4 - step);
+        } else if (size > 0) {
+            a = (std::uint64_t(p[0]) << 16) | (std::uint64_t(p[size >> 1]) << 8) | p[size - 1];
+        }
+    } else {
+        auto n = size;
+#if NEO_UNICODE_HAVE_SSE42
+        // Three independent CRCs keep the CRC unit busy
+        if (n > 64) {
+            std::uint64_t c0 = seed;
+            std::uint64_t c1 = seed >> 32;
+            std::uint64_t c2 = ~seed;
+            do {
+                c0 = _mm_crc32_u64(c0, read64(p));
+                c1 = _mm_crc32_u64(c1, read64(p + 8));
+                c2 = _mm_crc32_u64(c2, read64(p + 16));
+                p += 24;
+                n -= 24;
+            } while (n > 24);
+            seed = mix(((c0 << 32) | c1) ^ secret[1], (c2 << 32 | n) ^ secret[2]);
+        }
+#else
+        if (n > 48) {
+            auto seed1 = seed;
+            auto seed2 = seed;
+            do {
+                seed = mix(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+                seed1 = mix(read64(p + 16) ^ secret[2], read64(p + 24) ^ seed1);
+                seed2 = mix(read64(p + 32) ^ secret[3], read64(p + 40) ^ seed2);
+                p += 48;
+                n -= 48;
+            } while (n > 48);
+            seed ^= seed1 ^ seed2;
+        }
+#endif
+        while (n > 16) {
+            seed = mix(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+            p += 16;
+            n -= 16;
+        }
+        // The last 16 bytes, which may overlap those already mixed in
+        a = read64(p + n - 16);
+        b = read64(p + n - 8);
+    }
+    const auto h = mix(secret[1] ^ size, mix(a ^ secret[1], b ^ seed));
+    const auto ret = static_cast<std::size_t>(sizeof(std::size_t) < 8 ? h ^ (h >> 32) : h);
+    return ret == 0 ? 1 : ret;
+}
+
+}  // namespace unicode_detail
+
+}  // namespace neo
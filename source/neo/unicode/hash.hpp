@@ -0,0 +1,55 @@
+#ifndef NEO_UNICODE_HASH_HPP_INCLUDED
+#define NEO_UNICODE_HASH_HPP_INCLUDED
+
+#include "concepts.hpp"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace neo {
+
+namespace unicode_detail {
+
+/**
+ * Hash `size` bytes from `data`, in the style of wyhash, with CRC32C for
+ * long inputs if the library is built for SSE 4.2. Never returns zero, which
+ * buffers use to mean that they have no hash yet.
+ *
+ * The same bytes always hash alike in a program, since the hash is only
+ * computed in the library, but the hash may change between builds.
+ */
+std::size_t hash_bytes(const void* data, std::size_t size) noexcept;
+
+template <typename Unit> std::size_t hash_code_units(const Unit* data, std::size_t size) noexcept {
+    return hash_bytes(data, size * sizeof(Unit));
+}
+
+template <typename T> using cached_hash_t = decltype(std::declval<const T&>().cached_hash());
+
+/**
+ * Hash the code units of a buffer, using and filling the buffer's cache if
+ * it has one
+ */
+template <typename Buffer, typename = std::enable_if_t<is_detected_v<cached_hash_t, Buffer>>>
+std::size_t hash_of(const Buffer& buf) noexcept {
+    auto h = buf.cached_hash();
+    if (h == Buffer::unhashed) {
+        h = hash_code_units(buf.data(), buf.code_unit_size());
+        buf.cache_hash(h);
+    }
+    return h;
+}
+
+template <typename Buffer,
+          typename = std::enable_if_t<!is_detected_v<cached_hash_t, Buffer>>,
+          typename = void>
+std::size_t hash_of(const Buffer& buf) noexcept {
+    return hash_code_units(buf.data(), buf.code_unit_size());
+}
+
+}  // namespace unicode_detail
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_HASH_HPP_INCLUDED
@@ -0,0 +1,418 @@
+#ifndef NEO_UNICODE_LINE_BREAK_HPP_INCLUDED
+#define NEO_UNICODE_LINE_BREAK_HPP_INCLUDED
+
+#include "search.hpp"
+#include "text.hpp"
+#include "text_view.hpp"
+#include "ucd_tables.hpp"
+#include "word.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+
+namespace neo {
+
+namespace unicode_detail {
+
+constexpr unsigned line_break_count = static_cast<unsigned>(line_break::ri) + 1;
+
+constexpr std::uint64_t line_bit(line_break b) noexcept {
+    return std::uint64_t(1) << static_cast<unsigned>(b);
+}
+
+template <typename... Breaks> constexpr std::uint64_t line_bits(Breaks... bs) noexcept {
+    std::uint64_t ret = 0;
+    for (const auto b : {bs...}) {
+        ret |= line_bit(b);
+    }
+    return ret;
+}
+
+constexpr bool line_in(line_break b, std::uint64_t set) noexcept {
+    return (line_bit(b) & set) != 0;
+}
+
+/**
+ * Whether the rules from LB11 to LB30b keep `b` on the same line as `a`,
+ * the last class before it that isn't a space, with `spaces` between them or
+ * not. `a` is SP for spaces at the start of the text. Rules that need more
+ * than the pair are left to `next_line_break()`: LB21a, LB30 for wide
+ * brackets, LB30a, and LB30b for unassigned emoji.
+ */
+constexpr bool line_pair_joins(line_break a, line_break b, bool spaces) noexcept {
+    using lb = line_break;
+    if (a == lb::zw) {
+        // LB8
+        return false;
+    }
+    // LB11, and LB13
+    if (line_in(b, line_bits(lb::wj, lb::cl, lb::cp, lb::ex, lb::is, lb::sy))) {
+        return true;
+    }
+    // LB14 to LB17, which allow spaces between
+    if (a == lb::op || (a == lb::qu && b == lb::op) || ((a == lb::cl || a == lb::cp) && b == lb::ns)
+        || (a == lb::b2 && b == lb::b2)) {
+        return true;
+    }
+    if (spaces || a == lb::sp) {
+        // LB18
+        return false;
+    }
+    // LB11, LB12 and LB12a
+    if (a == lb::wj || a == lb::gl || (b == lb::gl && a != lb::ba && a != lb::hy)) {
+        return true;
+    }
+    // LB19
+    if (a == lb::qu || b == lb::qu) {
+        return true;
+    }
+    // LB20
+    if (a == lb::cb || b == lb::cb) {
+        return false;
+    }
+    // LB21, LB21b and LB22
+    if (line_in(b, line_bits(lb::ba, lb::hy, lb::ns, lb::in)) || a == lb::bb || (a == lb::sy && b == lb::hl)) {
+        return true;
+    }
+    const auto letter = line_bits(lb::al, lb::hl);
+    const auto ideographic = line_bits(lb::id, lb::eb, lb::em);
+    const auto hangul = line_bits(lb::jl, lb::jv, lb::jt, lb::h2, lb::h3);
+    // LB23 and LB23a
+    if ((line_in(a, letter) && b == lb::nu) || (a == lb::nu && line_in(b, letter))
+        || (a == lb::pr && line_in(b, ideographic)) || (line_in(a, ideographic) && b == lb::po)) {
+        return true;
+    }
+    // LB24
+    if ((line_in(a, line_bits(lb::pr, lb::po)) && line_in(b, letter))
+        || (line_in(a, letter) && line_in(b, line_bits(lb::pr, lb::po)))) {
+        return true;
+    }
+    // LB25
+    if ((line_in(a, line_bits(lb::cl, lb::cp, lb::nu)) && line_in(b, line_bits(lb::po, lb::pr)))
+        || (line_in(a, line_bits(lb::po, lb::pr)) && line_in(b, line_bits(lb::op, lb::nu)))
+        || (line_in(a, line_bits(lb::hy, lb::is, lb::nu, lb::sy)) && b == lb::nu)) {
+        return true;
+    }
+    // LB26 and LB27
+    if ((a == lb::jl && line_in(b, line_bits(lb::jl, lb::jv, lb::h2, lb::h3)))
+        || (line_in(a, line_bits(lb::jv, lb::h2)) && line_in(b, line_bits(lb::jv, lb::jt)))
+        || (line_in(a, line_bits(lb::jt, lb::h3)) && b == lb::jt) || (line_in(a, hangul) && b == lb::po)
+        || (a == lb::pr && line_in(b, hangul))) {
+        return true;
+    }
+    // LB28 and LB29
+    if ((line_in(a, letter) || a == lb::is) && line_in(b, letter)) {
+        return true;
+    }
+    // LB30, LB30a and LB30b
+    return (line_in(a, letter | line_bit(lb::nu)) && b == lb::op)
+        || (a == lb::cp && line_in(b, letter | line_bit(lb::nu))) || (a == lb::ri && b == lb::ri)
+        || (a == lb::eb && b == lb::em);
+}
+
+/**
+ * For each class, the classes that `line_pair_joins()` keeps after it,
+ * without and with spaces between
+ */
+struct line_pair_table {
+    std::uint64_t joins[line_break_count];
+    std::uint64_t joins_after_spaces[line_break_count];
+};
+
+constexpr line_pair_table make_line_pair_table() noexcept {
+    line_pair_table ret = {};
+    for (unsigned a = 0; a < line_break_count; ++a) {
+        for (unsigned b = 0; b < line_break_count; ++b) {
+            if (line_pair_joins(line_break(a), line_break(b), false)) {
+                ret.joins[a] |= std::uint64_t(1) << b;
+            }
+            if (line_pair_joins(line_break(a), line_break(b), true)) {
+                ret.joins_after_spaces[a] |= std::uint64_t(1) << b;
+            }
+        }
+    }
+    return ret;
+}
+
+constexpr line_pair_table line_pairs = make_line_pair_table();
+
+constexpr line_break line_break_of(std::uint8_t props) noexcept {
+    return static_cast<line_break>(props & 0x3F);
+}
+
+template <typename Encoding, typename Unit>
+std::uint8_t next_line_properties(const Unit*& p, const Unit* last) noexcept {
+    const auto u = static_cast<std::make_unsigned_t<Unit>>(*p);
+    if (ascii_code_units<Encoding>::value && u < 0x80) {
+        ++p;
+        return line_properties(u);
+    }
+    return line_properties(decoder<Encoding>::next(p, last));
+}
+
+/**
+ * Find the next line break opportunity after `p`, which must be one itself,
+ * by the rules of UAX #14. Sets `mandatory` for a break after a line
+ * separator or at `last`. In ASCII, runs of letters and digits and the spaces
+ * after them are skipped without looking up their classes.
+ */
+template <typename Encoding, typename Unit>
+const Unit* next_line_break(const Unit* p, const Unit* last, bool& mandatory) noexcept {
+    using lb = line_break;
+    using unit = std::make_unsigned_t<Unit>;
+    constexpr bool ascii = ascii_code_units<Encoding>::value;
+    constexpr auto hard_breaks = line_bits(lb::bk, lb::cr, lb::lf, lb::nl);
+    const auto ascii_class = [](unit u) { return u - '0' < 10 ? lb::nu : lb::al; };
+
+    auto q = p;
+    // The properties of the last class that isn't a space, and the class of
+    // the code point before `q`
+    std::uint8_t props = next_line_properties<Encoding>(q, last);
+    lb raw = line_break_of(props);
+    lb before = raw;
+    if (raw == lb::cm || raw == lb::zwj) {
+        // LB10
+        before = lb::al;
+        props = static_cast<std::uint8_t>(lb::al);
+    }
+    bool spaces = false;
+    bool odd_indicators = before == lb::ri;
+    // Whether `before` is HY or BA right after HL, for LB21a
+    bool after_hebrew = false;
+    while (q != last) {
+        if (ascii && !spaces && line_in(before, line_bits(lb::al, lb::hl, lb::nu)) && is_ascii_alnum(unit(*q))) {
+            // LB23, LB25 and LB28 join letters and digits, and LB18 breaks
+            // after the spaces that follow them
+            q = skip_ascii_alnum(q + 1, last);
+            before = raw = ascii_class(unit(q[-1]));
+            props = static_cast<std::uint8_t>(before);
+            odd_indicators = after_hebrew = false;
+            if (q != last && *q == ' ') {
+                do {
+                    ++q;
+                } while (q != last && *q == ' ');
+                if (q != last && is_ascii_alnum(unit(*q))) {
+                    mandatory = false;
+                    return q;
+                }
+                spaces = true;
+                raw = lb::sp;
+            }
+            continue;
+        }
+        auto r = q;
+        const auto next = next_line_properties<Encoding>(r, last);
+        auto b = line_break_of(next);
+        if (raw == lb::cr && b == lb::lf) {
+            // LB5
+            raw = b;
+            q = r;
+            continue;
+        }
+        if (line_in(raw, hard_breaks)) {
+            // LB4 and LB5
+            mandatory = true;
+            return q;
+        }
+        if (line_in(b, hard_breaks | line_bits(lb::sp, lb::zw))) {
+            // LB6 and LB7
+            if (b == lb::sp) {
+                spaces = true;
+            } else {
+                before = b;
+                props = next;
+                spaces = odd_indicators = after_hebrew = false;
+            }
+            raw = b;
+            q = r;
+            continue;
+        }
+        const bool after_zwj = raw == lb::zwj;
+        raw = b;
+        auto b_props = next;
+        if (b == lb::cm || b == lb::zwj) {
+            if (!spaces && before != lb::zw && before != lb::sp) {
+                // LB9
+                q = r;
+                continue;
+            }
+            // LB10
+            b = lb::al;
+            b_props = static_cast<std::uint8_t>(lb::al);
+        }
+        bool join;
+        if (after_zwj) {
+            // LB8a
+            join = true;
+        } else if (spaces) {
+            join = line_in(b, line_pairs.joins_after_spaces[static_cast<unsigned>(before)]);
+        } else {
+            join = line_in(b, line_pairs.joins[static_cast<unsigned>(before)]);
+            if (after_hebrew && b != lb::cb) {
+                // LB21a
+                join = true;
+            } else if (b == lb::op && (b_props & line_east_asian_wide_bit)
+                       && line_in(before, line_bits(lb::al, lb::hl, lb::nu))) {
+                // LB30 is only for narrow brackets
+                join = false;
+            } else if (before == lb::cp && (props & line_east_asian_wide_bit)
+                       && line_in(b, line_bits(lb::al, lb::hl, lb::nu))) {
+                join = false;
+            } else if (before == lb::ri && b == lb::ri) {
+                // LB30a
+                join = odd_indicators;
+            } else if (b == lb::em && (props & line_pictographic_unassigned_bit)) {
+                // LB30b
+                join = true;
+            }
+        }
+        if (!join) {
+            mandatory = false;
+            return q;
+        }
+        odd_indicators = b == lb::ri && !(before == lb::ri && !spaces && odd_indicators);
+        after_hebrew = (b == lb::hy || b == lb::ba) && before == lb::hl && !spaces;
+        before = b;
+        props = b_props;
+        spaces = false;
+        q = r;
+    }
+    // LB3
+    mandatory = true;
+    return last;
+}
+
+}  // namespace unicode_detail
+
+/**
+ * A forward iterator over the line break opportunities of a text, by UAX
+ * #14. Dereferencing yields a `basic_text_view` of the text from one
+ * opportunity to the next, including its trailing spaces and line separator:
+ * the pieces that text wrapping may not split.
+ */
+template <typename Encoding> class line_break_iterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = basic_text_view<Encoding>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = value_type;
+    using code_unit_type = typename Encoding::code_unit_type;
+
+private:
+    const code_unit_type* _pos = nullptr;
+    // The next opportunity after `_pos`
+    const code_unit_type* _next = nullptr;
+    const code_unit_type* _last = nullptr;
+    bool _mandatory = false;
+
+    void _find_next() noexcept {
+        if (_pos == _last) {
+            _next = _last;
+        } else {
+            _next = unicode_detail::next_line_break<Encoding>(_pos, _last, _mandatory);
+        }
+    }
+
+public:
+    line_break_iterator() = default;
+
+    /**
+     * Construct an iterator at `pos`, which must be a line break opportunity
+     * or the start of the text, in [pos, last]
+     */
+    line_break_iterator(const code_unit_type* pos, const code_unit_type* last) noexcept
+        : _pos(pos)
+        , _last(last) {
+        _find_next();
+    }
+
+    /**
+     * Get a pointer to the first code unit of the current piece
+     */
+    const code_unit_type* position() const noexcept {
+        return _pos;
+    }
+
+    /**
+     * Whether the line must break after the current piece: after a line
+     * separator, and at the end of the text
+     */
+    bool mandatory() const noexcept {
+        return _mandatory;
+    }
+
+    value_type operator*() const noexcept {
+        return value_type(_pos, _next);
+    }
+
+    line_break_iterator& operator++() noexcept {
+        _pos = _next;
+        _find_next();
+        return *this;
+    }
+
+    line_break_iterator operator++(int) noexcept {
+        auto copy = *this;
+        ++*this;
+        return copy;
+    }
+
+    friend bool operator==(const line_break_iterator& a, const line_break_iterator& b) noexcept {
+        return a._pos == b._pos;
+    }
+
+    friend bool operator!=(const line_break_iterator& a, const line_break_iterator& b) noexcept {
+        return !(a == b);
+    }
+};
+
+/**
+ * The pieces between line break opportunities, as returned by
+ * `line_breaks()`
+ */
+template <typename Encoding> class line_break_range {
+public:
+    using iterator = line_break_iterator<Encoding>;
+    using const_iterator = iterator;
+    using code_unit_type = typename Encoding::code_unit_type;
+
+private:
+    const code_unit_type* _first;
+    const code_unit_type* _last;
+
+public:
+    line_break_range(const code_unit_type* first, const code_unit_type* last) noexcept
+        : _first(first)
+        , _last(last) {}
+
+    iterator begin() const noexcept {
+        return iterator(_first, _last);
+    }
+
+    iterator end() const noexcept {
+        return iterator(_last, _last);
+    }
+};
+
+/**
+ * Iterate the line break opportunities of `text`, by the default rules of
+ * UAX #14. The range refers to the text, which must outlive it.
+ */
+template <typename Encoding, typename Buffer>
+line_break_range<Encoding> line_breaks(const basic_text<Encoding, Buffer>& text) noexcept {
+    return line_break_range<Encoding>(text.data(), text.data() + text.code_unit_size());
+}
+
+template <typename Encoding, typename Buffer> void line_breaks(const basic_text<Encoding, Buffer>&&) = delete;
+
+template <typename Encoding> line_break_range<Encoding> line_breaks(basic_text_view<Encoding> view) noexcept {
+    return line_break_range<Encoding>(view.data(), view.data() + view.code_unit_size());
+}
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_LINE_BREAK_HPP_INCLUDED
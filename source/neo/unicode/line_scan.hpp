@@ -0,0 +1,193 @@
+#ifndef NEO_UNICODE_LINE_SCAN_HPP_INCLUDED
+#define NEO_UNICODE_LINE_SCAN_HPP_INCLUDED
+
+#include "search.hpp"
+#include "simd.hpp"
+#include "text.hpp"
+#include "text_view.hpp"
+
+#include "encodings/utf8.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace neo {
+
+/**
+ * What `for_each_line()` checks in each line
+ */
+enum class line_check : unsigned char {
+    none,
+    /// Check that each line is valid UTF-8
+    utf8,
+};
+
+/**
+ * A line found by `for_each_line()`, as byte offsets from the start of the
+ * data
+ */
+struct scanned_line {
+    /**
+     * The offset of the first byte of the line
+     */
+    std::size_t offset;
+    /**
+     * The size of the line, without its LF or CR LF
+     */
+    std::size_t size;
+    /**
+     * Whether the line is valid UTF-8. Always true if it wasn't checked.
+     */
+    bool valid;
+};
+
+namespace unicode_detail {
+
+/**
+ * Check that [p, last) is valid UTF-8, skipping ASCII 16 bytes at a time
+ */
+inline bool is_valid_utf8(const unsigned char* p, const unsigned char* last) noexcept {
+    while (p != last) {
+        if (*p >= 0x80) {
+            if (decode_utf8(p, last) == invalid_code_point) {
+                return false;
+            }
+            continue;
+        }
+        ++p;
+#if NEO_UNICODE_HAVE_SSE2
+        while (last - p >= 16 && !_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))) {
+            p += 16;
+        }
+#endif
+    }
+    return true;
+}
+
+/**
+ * Find the lines of [first, last) for `for_each_line()`. Newlines and, when
+ * checking, non-ASCII bytes are found 32 bytes at a time. A line is only
+ * decoded if it has non-ASCII bytes, from the first of them.
+ */
+template <typename Func>
+void scan_lines(const unsigned char* first, const unsigned char* last, Func& fn, line_check check) {
+    const bool validate = check == line_check::utf8;
+    auto start = first;
+    // The first non-ASCII byte of the current line, or null
+    const unsigned char* high = nullptr;
+    const auto emit = [&](const unsigned char* end) {
+        if (end != start && end[-1] == '\r') {
+            --end;
+        }
+        const bool valid = !high || is_valid_utf8(high, end);
+        return keep_going(fn,
+                          scanned_line{static_cast<std::size_t>(start - first),
+                                       static_cast<std::size_t>(end - start),
+                                       valid});
+    };
+    auto p = first;
+#if NEO_UNICODE_HAVE_SSE2
+    const auto newline = _mm_set1_epi8('\n');
+    for (; last - p >= 32; p += 32) {
+        const auto lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const auto hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+        auto newlines = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(lo, newline)))
+            | static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(hi, newline))) << 16;
+        std::uint32_t highs = 0;
+        if (validate) {
+            highs = static_cast<std::uint32_t>(_mm_movemask_epi8(lo))
+                | static_cast<std::uint32_t>(_mm_movemask_epi8(hi)) << 16;
+        }
+        while (newlines) {
+            const auto bit = count_trailing_zeros(newlines);
+            // The bytes up to and including the newline
+            const auto line_bits = bit == 31 ? ~std::uint32_t(0) : (std::uint32_t(2) << bit) - 1;
+            if (!high && (highs & line_bits)) {
+                high = p + count_trailing_zeros(highs);
+            }
+            if (!emit(p + bit)) {
+                return;
+            }
+            start = p + bit + 1;
+            high = nullptr;
+            highs &= ~line_bits;
+            newlines &= newlines - 1;
+        }
+        if (!high && highs) {
+            high = p + count_trailing_zeros(highs);
+        }
+    }
+#endif
+    for (; p != last; ++p) {
+        if (*p == '\n') {
+            if (!emit(p)) {
+                return;
+            }
+            start = p + 1;
+            high = nullptr;
+        } else if (validate && !high && *p >= 0x80) {
+            high = p;
+        }
+    }
+    if (start != last) {
+        emit(last);
+    }
+}
+
+}  // namespace unicode_detail
+
+/**
+ * Call `fn` with a `scanned_line` for each line of the `size` bytes at
+ * `data`, such as a log file that is read into memory or mapped, in order.
+ * Only LF ends a line, and a CR before it is left out of the line. As with
+ * `lines()`, a newline at the end of the data doesn't start another line.
+ * If `fn` returns a value, the scan stops once it returns false.
+ *
+ * With `line_check::utf8`, each line is checked for malformed UTF-8 in the
+ * same pass, so that such lines can be set aside. Lines of ASCII cost
+ * nothing more to check.
+ */
+template <typename Func>
+void for_each_line(const void* data, std::size_t size, Func&& fn, line_check check = line_check::none) {
+    const auto first = static_cast<const unsigned char*>(data);
+    unicode_detail::scan_lines(first, first + size, fn, check);
+}
+
+template <typename Buffer, typename Func>
+void for_each_line(const basic_text<utf8, Buffer>& text, Func&& fn, line_check check = line_check::none) {
+    for_each_line(text.data(), text.code_unit_size(), fn, check);
+}
+
+template <typename Func> void for_each_line(text_view view, Func&& fn, line_check check = line_check::none) {
+    for_each_line(view.data(), view.code_unit_size(), fn, check);
+}
+
+/**
+ * Get the lines of the `size` bytes at `data` that aren't valid UTF-8. See
+ * `for_each_line()`.
+ */
+inline std::vector<scanned_line> invalid_lines(const void* data, std::size_t size) {
+    std::vector<scanned_line> ret;
+    for_each_line(data,
+                  size,
+                  [&](const scanned_line& line) {
+                      if (!line.valid) {
+                          ret.push_back(line);
+                      }
+                  },
+                  line_check::utf8);
+    return ret;
+}
+
+template <typename Buffer> std::vector<scanned_line> invalid_lines(const basic_text<utf8, Buffer>& text) {
+    return invalid_lines(text.data(), text.code_unit_size());
+}
+
+inline std::vector<scanned_line> invalid_lines(text_view view) {
+    return invalid_lines(view.data(), view.code_unit_size());
+}
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_LINE_SCAN_HPP_INCLUDED
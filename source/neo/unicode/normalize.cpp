@@ -0,0 +1,107 @@
+#include "normalize.hpp"
+
+extern "C" {
+#include <internal/database.h>
+}
+
+namespace neo {
+
+namespace unicode_detail {
+
+namespace {
+
+// Hangul syllables decompose algorithmically. See Unicode section 3.12.
+constexpr char32_t hangul_s_first = 0xAC00;
+constexpr char32_t hangul_l_first = 0x1100;
+constexpr char32_t hangul_v_first = 0x1161;
+constexpr char32_t hangul_t_first = 0x11A7;
+constexpr char32_t hangul_t_count = 28;
+constexpr char32_t hangul_n_count = 21 * hangul_t_count;
+constexpr char32_t hangul_s_count = 19 * hangul_n_count;
+
+std::uint8_t combining_class(char32_t cp) noexcept {
+    return cp < 0x110000 ? PROPERTY_GET_CCC(cp) : 0;
+}
+
+// Hangul syllables decompose the same way in NFD and NFKD
+std::size_t decompose_hangul(char32_t cp, char32_t* out, std::uint8_t* ccc) noexcept {
+    const auto s_index = cp - hangul_s_first;
+    out[0] = hangul_l_first + s_index / hangul_n_count;
+    out[1] = hangul_v_first + (s_index % hangul_n_count) / hangul_t_count;
+    ccc[0] = ccc[1] = 0;
+    if (s_index % hangul_t_count == 0) {
+        return 2;
+    }
+    out[2] = hangul_t_first + s_index % hangul_t_count;
+    ccc[2] = 0;
+    return 3;
+}
+
+// Look up `cp` in one of the decomposition tables, which store the
+// decompositions as UTF-8
+std::size_t decompose_from(const std::uint32_t* index1,
+                           const std::uint32_t* index2,
+                           const std::uint32_t* data,
+                           std::size_t max_size,
+                           char32_t cp,
+                           char32_t* out,
+                           std::uint8_t* ccc) noexcept {
+    std::uint8_t length = 0;
+    auto decomposed
+        = database_querydecomposition(static_cast<unicode_t>(cp), index1, index2, data, &length);
+    if (!decomposed) {
+        out[0] = cp;
+        ccc[0] = combining_class(cp);
+        return 1;
+    }
+    const auto end = decomposed + length;
+    std::size_t n = 0;
+    while (decomposed != end && n < max_size) {
+        out[n] = decoder<utf8>::next(decomposed, end);
+        ccc[n] = combining_class(out[n]);
+        ++n;
+    }
+    return n;
+}
+
+}  // namespace
+
+std::size_t decompose_canonical_from_table(char32_t cp, char32_t* out, std::uint8_t* ccc) noexcept {
+    if (cp - hangul_s_first < hangul_s_count) {
+        return decompose_hangul(cp, out, ccc);
+    }
+    if (cp < 0x110000 && PROPERTY_GET_NFD(cp) != QuickCheckResult_Yes) {
+        return decompose_from(NFDIndex1Ptr,
+                              NFDIndex2Ptr,
+                              NFDDataPtr,
+                              max_canonical_decomposition_size,
+                              cp,
+                              out,
+                              ccc);
+    }
+    out[0] = cp;
+    ccc[0] = combining_class(cp);
+    return 1;
+}
+
+std::size_t decompose_compatible_from_table(char32_t cp, char32_t* out, std::uint8_t* ccc) noexcept {
+    if (cp - hangul_s_first < hangul_s_count) {
+        return decompose_hangul(cp, out, ccc);
+    }
+    if (cp < 0x110000 && PROPERTY_GET_NFKD(cp) != QuickCheckResult_Yes) {
+        return decompose_from(NFKDIndex1Ptr,
+                              NFKDIndex2Ptr,
+                              NFKDDataPtr,
+                              max_compatibility_decomposition_size,
+                              cp,
+                              out,
+                              ccc);
+    }
+    out[0] = cp;
+    ccc[0] = combining_class(cp);
+    return 1;
+}
+
+}  // namespace unicode_detail
+
+}  // namespace neo
@@ -0,0 +1,232 @@
+#ifndef NEO_UNICODE_NORMALIZE_HPP_INCLUDED
+#define NEO_UNICODE_NORMALIZE_HPP_INCLUDED
+
+#include "encodings/all.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace neo {
+
+namespace unicode_detail {
+
+/**
+ * The most code points in the canonical decomposition of one code point
+ */
+constexpr std::size_t max_canonical_decomposition_size = 4;
+
+/**
+ * The most code points in the compatibility decomposition of one code point
+ */
+constexpr std::size_t max_compatibility_decomposition_size = 18;
+
+/**
+ * Look up the full canonical decomposition of `cp` in the Unicode database,
+ * and write it to `out`, with the canonical combining class of each code
+ * point in `ccc`. Returns the number of code points written. Code points
+ * that are already decomposed are written as they are, and so are Hangul
+ * syllables, algorithmically.
+ */
+std::size_t decompose_canonical_from_table(char32_t cp, char32_t* out, std::uint8_t* ccc) noexcept;
+
+/**
+ * `decompose_canonical_from_table()`, with ASCII inline
+ */
+inline std::size_t decompose_canonical(char32_t cp, char32_t* out, std::uint8_t* ccc) noexcept {
+    if (cp < 0x80) {
+        out[0] = cp;
+        ccc[0] = 0;
+        return 1;
+    }
+    return decompose_canonical_from_table(cp, out, ccc);
+}
+
+/**
+ * Like `decompose_canonical_from_table()`, but with the full compatibility
+ * decomposition, as for NFKD.
+ */
+std::size_t decompose_compatible_from_table(char32_t cp, char32_t* out, std::uint8_t* ccc) noexcept;
+
+inline std::size_t decompose_compatible(char32_t cp, char32_t* out, std::uint8_t* ccc) noexcept {
+    if (cp < 0x80) {
+        out[0] = cp;
+        ccc[0] = 0;
+        return 1;
+    }
+    return decompose_compatible_from_table(cp, out, ccc);
+}
+
+/**
+ * Decomposes code units of `Encoding` to NFD, or to NFKD if it is
+ * `compatible`, one segment at a time, without allocating. A segment is a starter, a code point with a canonical
+ * combining class of zero, and the non-starters after it, put in canonical
+ * order.
+ *
+ * Every segment knows where it starts and ends in the text, unless the
+ * boundary falls inside the decomposition of a code point, as it does
+ * between the jamo of a Hangul syllable. Segments of more than `capacity`
+ * code points are split, as in the Stream-Safe Text Format.
+ */
+template <typename Encoding> class canonical_decomposer {
+public:
+    using unit = typename Encoding::code_unit_type;
+
+    static constexpr std::size_t capacity = 32;
+
+private:
+    const unit* _pos;
+    const unit* _last;
+    bool _compatible;
+
+    // The segment
+    char32_t _cps[capacity];
+    std::uint8_t _ccc[capacity];
+    std::size_t _size = 0;
+    const unit* _start = nullptr;
+    const unit* _end = nullptr;
+
+    // The rest of the decomposition of the last code point read
+    char32_t _pending[max_compatibility_decomposition_size];
+    std::uint8_t _pending_ccc[max_compatibility_decomposition_size];
+    std::size_t _pending_first = 0;
+    std::size_t _pending_size = 0;
+    // Where the code point came from, while none of it has been taken
+    const unit* _pending_origin = nullptr;
+
+    // Decompose the next code point of the text, if there is nothing pending
+    bool _fill() noexcept {
+        if (_pending_first != _pending_size) {
+            return true;
+        }
+        if (_pos == _last) {
+            return false;
+        }
+        _pending_origin = _pos;
+        _pending_first = 0;
+        const auto cp = decoder<Encoding>::next(_pos, _last);
+        _pending_size = _compatible ? decompose_compatible(cp, _pending, _pending_ccc)
+                                    : decompose_canonical(cp, _pending, _pending_ccc);
+        return true;
+    }
+
+    // The position in the text where the front of the pending code points
+    // is, or null if that is inside a decomposition
+    const unit* _pending_position() const noexcept {
+        if (_pending_first == _pending_size) {
+            return _pos;
+        }
+        return _pending_first == 0 ? _pending_origin : nullptr;
+    }
+
+    void _take() noexcept {
+        _cps[_size] = _pending[_pending_first];
+        _ccc[_size] = _pending_ccc[_pending_first];
+        ++_size;
+        ++_pending_first;
+    }
+
+public:
+    canonical_decomposer(const unit* first, const unit* last, bool compatible = false) noexcept
+        : _pos(first)
+        , _last(last)
+        , _compatible(compatible) {
+    }
+
+    /**
+     * Decompose the next segment. Returns false at the end of the text.
+     */
+    bool next() noexcept {
+        _size = 0;
+        if (!_fill()) {
+            return false;
+        }
+        _start = _pending_position();
+        _take();
+        while (_size < capacity) {
+            if (ascii_code_units<Encoding>::value && _pending_first == _pending_size && _pos != _last
+                && static_cast<std::make_unsigned_t<unit>>(*_pos) < 0x80) {
+                // ASCII is always a starter. Byte-swapped code units below
+                // 0x80 can be anything, such as U+0300 stored as 0x0003.
+                break;
+            }
+            if (!_fill() || _pending_ccc[_pending_first] == 0) {
+                break;
+            }
+            _take();
+        }
+        _end = _pending_position();
+        // Canonical ordering: a stable sort of the non-starters by their
+        // combining class
+        for (std::size_t i = 1; i < _size; ++i) {
+            const auto cp = _cps[i];
+            const auto ccc = _ccc[i];
+            auto j = i;
+            for (; j > 0 && _ccc[j - 1] > ccc; --j) {
+                _cps[j] = _cps[j - 1];
+                _ccc[j] = _ccc[j - 1];
+            }
+            _cps[j] = cp;
+            _ccc[j] = ccc;
+        }
+        return true;
+    }
+
+    /**
+     * The code points of the segment, in NFD
+     */
+    const char32_t* data() const noexcept {
+        return _cps;
+    }
+
+    std::size_t size() const noexcept {
+        return _size;
+    }
+
+    /**
+     * The canonical combining class of the `i`th code point of the segment
+     */
+    std::uint8_t combining_class(std::size_t i) const noexcept {
+        return _ccc[i];
+    }
+
+    /**
+     * Where the segment starts in the text, or null if that is inside the
+     * decomposition of a code point
+     */
+    const unit* start() const noexcept {
+        return _start;
+    }
+
+    /**
+     * Where the segment ends in the text, or null if that is inside the
+     * decomposition of a code point
+     */
+    const unit* end() const noexcept {
+        return _end;
+    }
+
+    /**
+     * Where the next segment starts in the text, if it starts on a code
+     * point boundary, or null
+     */
+    const unit* position() const noexcept {
+        return _pending_position();
+    }
+
+    /**
+     * Move ahead to `p`, which is at or after `position()`, skipping the
+     * code points in between. Only valid if `position()` isn't null, and if
+     * the skipped code points are starters that decompose to themselves.
+     */
+    void skip_to(const unit* p) noexcept {
+        _pos = p;
+        _pending_first = _pending_size = 0;
+    }
+};
+
+}  // namespace unicode_detail
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_NORMALIZE_HPP_INCLUDED
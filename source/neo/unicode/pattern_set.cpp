@@ -0,0 +1,198 @@
+#include "pattern_set.hpp"
+
+#include <algorithm>
+
+namespace neo {
+
+namespace unicode_detail {
+
+void start_units::finish() noexcept {
+    n_values = 0;
+    range_first = 255;
+    range_last = 0;
+    for (std::uint32_t u = 0; u < 256; ++u) {
+        if (table[u] && !(others && u >= 0x80)) {
+            if (n_values < 4) {
+                values[n_values] = u;
+            }
+            ++n_values;
+            range_first = std::min(range_first, u);
+            range_last = u;
+        }
+    }
+}
+
+namespace {
+
+char32_t first_code_point(const std::string& pattern) noexcept {
+    auto p = pattern.data();
+    return decoder<utf8>::next(p, p + pattern.size());
+}
+
+// Sort the distinct fingerprints of the patterns, so that similar ones share
+// a bucket, and give each bucket an eighth of them
+void build_teddy(const std::vector<std::string>& patterns, teddy_masks& teddy) {
+    std::size_t n_patterns = 0;
+    std::size_t width = teddy_masks::max_width;
+    for (const auto& pattern : patterns) {
+        if (!pattern.empty()) {
+            ++n_patterns;
+            width = std::min(width, pattern.size());
+        }
+    }
+    if (n_patterns == 0 || n_patterns > teddy_masks::max_patterns) {
+        return;
+    }
+    std::vector<std::string> prints;
+    for (const auto& pattern : patterns) {
+        if (!pattern.empty()) {
+            prints.push_back(pattern.substr(0, width));
+        }
+    }
+    std::sort(prints.begin(), prints.end());
+    prints.erase(std::unique(prints.begin(), prints.end()), prints.end());
+    teddy.width = width;
+    for (std::size_t i = 0; i < prints.size(); ++i) {
+        const auto bucket = static_cast<std::uint8_t>(1u << (i * 8 / prints.size()));
+        for (std::size_t j = 0; j < width; ++j) {
+            const auto b = static_cast<unsigned char>(prints[i][j]);
+            teddy.lo[j][b & 0xF] |= bucket;
+            teddy.hi[j][b >> 4] |= bucket;
+        }
+    }
+}
+
+}  // namespace
+
+void pattern_automaton::compile(match how) {
+    _lengths.clear();
+    _max_length = 0;
+    bool used[256] = {};
+    for (const auto& pattern : _patterns) {
+        _lengths.push_back(static_cast<std::uint32_t>(pattern.size()));
+        _max_length = std::max(_max_length, pattern.size());
+        for (const auto c : pattern) {
+            used[static_cast<unsigned char>(c)] = true;
+        }
+    }
+    _n_classes = 1;
+    for (std::size_t b = 0; b < 256; ++b) {
+        _classes[b] = used[b] ? static_cast<std::uint16_t>(_n_classes++) : 0;
+    }
+
+    // The trie, in which a missing edge goes to the start state, which no
+    // edge of the trie does
+    _delta.assign(_n_classes, 0);
+    std::vector<std::vector<std::uint32_t>> outputs(1);
+    for (std::size_t i = 0; i < _patterns.size(); ++i) {
+        const auto& pattern = _patterns[i];
+        if (pattern.empty()) {
+            continue;
+        }
+        std::uint32_t state = 0;
+        for (const auto c : pattern) {
+            const auto edge = state * _n_classes + _classes[static_cast<unsigned char>(c)];
+            if (_delta[edge] == 0) {
+                _delta[edge] = static_cast<std::uint32_t>(outputs.size());
+                outputs.emplace_back();
+                _delta.resize(_delta.size() + _n_classes, 0);
+            }
+            state = _delta[edge];
+        }
+        outputs[state].push_back(static_cast<std::uint32_t>(i));
+    }
+
+    // Breadth first, so the failure state of every state, which is shallower,
+    // is complete before it. A missing edge goes where the failure state's
+    // edge goes, and a state has the outputs of its failure state after its
+    // own.
+    const auto n_states = outputs.size();
+    std::vector<std::uint32_t> fail(n_states, 0);
+    std::vector<std::uint32_t> queue;
+    queue.reserve(n_states);
+    queue.push_back(0);
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        const auto state = queue[head];
+        for (std::size_t c = 0; c < _n_classes; ++c) {
+            const auto fallback = state == 0 ? 0 : _delta[fail[state] * _n_classes + c];
+            auto& next = _delta[state * _n_classes + c];
+            if (next == 0) {
+                next = fallback;
+                continue;
+            }
+            fail[next] = fallback;
+            const auto& inherited = outputs[fallback];
+            outputs[next].insert(outputs[next].end(), inherited.begin(), inherited.end());
+            queue.push_back(next);
+        }
+    }
+
+    // Renumber the states: the start state first, then those with outputs,
+    // then the rest, each as the index of its first transition
+    std::vector<std::uint32_t> order(1, 0);
+    for (std::uint32_t state = 1; state < n_states; ++state) {
+        if (!outputs[state].empty()) {
+            order.push_back(state);
+        }
+    }
+    _match_end = static_cast<std::uint32_t>(order.size()) * _n_classes;
+    for (std::uint32_t state = 1; state < n_states; ++state) {
+        if (outputs[state].empty()) {
+            order.push_back(state);
+        }
+    }
+    std::vector<std::uint32_t> renamed(n_states);
+    for (std::size_t i = 0; i < n_states; ++i) {
+        renamed[order[i]] = static_cast<std::uint32_t>(i * _n_classes);
+    }
+    std::vector<std::uint32_t> delta(_delta.size());
+    _out_first.assign(1, 0);
+    _out.clear();
+    for (std::size_t i = 0; i < n_states; ++i) {
+        for (std::size_t c = 0; c < _n_classes; ++c) {
+            delta[i * _n_classes + c] = renamed[_delta[order[i] * _n_classes + c]];
+        }
+        const auto& out = outputs[order[i]];
+        _out.insert(_out.end(), out.begin(), out.end());
+        _out_first.push_back(static_cast<std::uint32_t>(_out.size()));
+    }
+    _delta.swap(delta);
+
+    // Code units that can start a match. ASCII decomposes to itself, and an
+    // ASCII code point only folds to another if it is an upper case letter,
+    // but a non-ASCII code point can fold or decompose to anything.
+    utf8_starts = start_units();
+    starts = start_units();
+    starts.others = how != match::exact;
+    for (const auto& pattern : _patterns) {
+        if (pattern.empty()) {
+            continue;
+        }
+        utf8_starts.table[static_cast<unsigned char>(pattern[0])] = true;
+        const auto cp = first_code_point(pattern);
+        if (cp >= 0x80) {
+            starts.others = true;
+            continue;
+        }
+        starts.table[cp] = true;
+        if (how == match::case_insensitive && cp - U'a' < 26) {
+            starts.table[cp - 0x20] = true;
+        }
+    }
+    std::fill(starts.table + 0x80, starts.table + 256, starts.others);
+    utf8_starts.finish();
+    starts.finish();
+
+    teddy = teddy_masks();
+    if (how == match::exact) {
+        build_teddy(_patterns, teddy);
+    }
+
+    // The patterns are only needed to compile
+    _patterns.clear();
+    _patterns.shrink_to_fit();
+}
+
+}  // namespace unicode_detail
+
+}  // namespace neo
@@ -0,0 +1,702 @@
+#ifndef NEO_UNICODE_PATTERN_SET_HPP_INCLUDED
+#define NEO_UNICODE_PATTERN_SET_HPP_INCLUDED
+
+#include "case_fold.hpp"
+#include "encodings/all.hpp"
+#include "normalize.hpp"
+#include "search.hpp"
+#include "simd.hpp"
+#include "text.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace neo {
+
+namespace unicode_detail {
+
+/**
+ * The code units that can start a match, so that the ones that can't are
+ * skipped while no match is in progress. Code units below 256 are looked up
+ * in `table`, and `others` says whether the larger ones can start a match.
+ *
+ * The skip goes 16 bytes at a time with SIMD, apart from the non-ASCII code
+ * units when `others` is set, which are always wanted. If there are at most
+ * four code units left in the table, it compares with each of `values`.
+ * Otherwise, bytes are compared with the range from `range_first` to
+ * `range_last`, and any in it are looked up, but wider code units are only
+ * looked up one by one.
+ */
+struct start_units {
+    bool table[256] = {};
+    bool others = false;
+    std::uint32_t values[4] = {};
+    std::size_t n_values = 0;
+    std::uint32_t range_first = 0;
+    std::uint32_t range_last = 0;
+
+    /**
+     * Fill in `values` and the range from `table` and `others`
+     */
+    void finish() noexcept;
+
+    /**
+     * Whether the skip compares with `values`
+     */
+    bool few() const noexcept {
+        return n_values <= 4;
+    }
+
+    template <typename Unit> bool accepts(Unit u) const noexcept {
+        const auto v = unit_value(u);
+        return v < 256 ? table[v] : others;
+    }
+
+    /**
+     * Get the first code unit in [p, last) that can start a match, or `last`
+     */
+    template <typename Unit> const Unit* skip(const Unit* p, const Unit* last) const noexcept {
+#if NEO_UNICODE_HAVE_SSE2
+        if (few() || sizeof(Unit) == 1) {
+            using lanes = unit_lanes<sizeof(Unit)>;
+            constexpr std::size_t width = 16 / sizeof(Unit);
+            // Unused slots repeat the first value, and with no values at all
+            // only non-ASCII code units are wanted
+            const auto v0 = lanes::splat(values[0]);
+            const auto v1 = lanes::splat(values[n_values > 1 ? 1 : 0]);
+            const auto v2 = lanes::splat(values[n_values > 2 ? 2 : 0]);
+            const auto v3 = lanes::splat(values[n_values > 3 ? 3 : 0]);
+            const auto any_value = n_values ? _mm_set1_epi8(-1) : _mm_setzero_si128();
+            const auto non_ascii = others ? _mm_set1_epi8(-1) : _mm_setzero_si128();
+            const auto first = _mm_set1_epi8(static_cast<char>(range_first));
+            const auto span = _mm_set1_epi8(static_cast<char>(range_last - range_first));
+            while (last - p >= static_cast<std::ptrdiff_t>(width)) {
+                const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i wanted;
+                if (few()) {
+                    wanted = _mm_or_si128(_mm_or_si128(lanes::eq(v, v0), lanes::eq(v, v1)),
+                                          _mm_or_si128(lanes::eq(v, v2), lanes::eq(v, v3)));
+                    wanted = _mm_and_si128(wanted, any_value);
+                } else {
+                    // Bytes whose distance above the first is at most the span
+                    const auto above = _mm_sub_epi8(v, first);
+                    wanted = _mm_cmpeq_epi8(_mm_min_epu8(above, span), above);
+                }
+                wanted = _mm_or_si128(wanted, _mm_andnot_si128(lanes::ascii(v), non_ascii));
+                auto bits = static_cast<std::uint32_t>(_mm_movemask_epi8(wanted)) & lanes::lane_bits;
+                for (; bits; bits &= bits - 1) {
+                    const auto q = p + count_trailing_zeros(bits) / sizeof(Unit);
+                    if (accepts(*q)) {
+                        return q;
+                    }
+                }
+                p += width;
+            }
+        }
+#endif
+        for (; p != last && !accepts(*p); ++p) {
+        }
+        return p;
+    }
+};
+
+/**
+ * The nibble masks of a Teddy filter: each pattern is put in one of eight
+ * buckets, and a position is a candidate if the first `width` bytes there
+ * could all belong to a pattern of the same bucket. Each byte is split in
+ * two nibbles, which are looked up in `lo` and `hi` with a byte shuffle, 16
+ * positions at a time. `width` is zero if the filter isn't usable.
+ */
+struct teddy_masks {
+    static constexpr std::size_t max_width = 3;
+    static constexpr std::size_t max_patterns = 64;
+
+    std::size_t width = 0;
+    std::uint8_t lo[max_width][16] = {};
+    std::uint8_t hi[max_width][16] = {};
+
+    bool candidate(const char* p) const noexcept {
+        unsigned bits = 0xFF;
+        for (std::size_t i = 0; i < width; ++i) {
+            const auto b = static_cast<unsigned char>(p[i]);
+            bits &= lo[i][b & 0xF] & hi[i][b >> 4];
+        }
+        return bits != 0;
+    }
+
+#if NEO_UNICODE_HAVE_SSSE3
+    /**
+     * Get the first candidate in [p, last), or `last`
+     */
+    const char* next(const char* p, const char* last) const noexcept {
+        const auto nibble = _mm_set1_epi8(0x0F);
+        const auto zero = _mm_setzero_si128();
+        while (last - p >= static_cast<std::ptrdiff_t>(16 + width - 1)) {
+            auto found = _mm_set1_epi8(-1);
+            for (std::size_t i = 0; i < width; ++i) {
+                const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+                const auto lo_bits
+                    = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lo[i])),
+                                       _mm_and_si128(v, nibble));
+                const auto hi_bits
+                    = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hi[i])),
+                                       _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+                found = _mm_and_si128(found, _mm_and_si128(lo_bits, hi_bits));
+            }
+            const auto bits = ~static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(found, zero)))
+                & 0xFFFF;
+            if (bits) {
+                return p + count_trailing_zeros(bits);
+            }
+            p += 16;
+        }
+        // No pattern is shorter than `width`, so none starts in the last few
+        // bytes
+        for (; last - p >= static_cast<std::ptrdiff_t>(width); ++p) {
+            if (candidate(p)) {
+                return p;
+            }
+        }
+        return last;
+    }
+#endif
+};
+
+/**
+ * An Aho-Corasick automaton that finds a set of patterns in UTF-8, compiled
+ * to a DFA. Its transitions are on classes of bytes: each byte that occurs in
+ * the patterns has a class of its own, and all the others share class zero.
+ * A state knows every pattern that ends there, including those that are
+ * suffixes of others.
+ *
+ * A state is the index of its first transition, so stepping is one lookup.
+ * State zero is the start state, and the states in which patterns end come
+ * right after it, so a match is found with one comparison.
+ */
+class pattern_automaton {
+    std::vector<std::string> _patterns;
+    std::vector<std::uint32_t> _lengths;
+    std::uint16_t _classes[256] = {};
+    std::uint32_t _n_classes = 1;
+    std::vector<std::uint32_t> _delta;
+    // The states from `_n_classes` to `_match_end` have outputs
+    std::uint32_t _match_end = 0;
+    std::vector<std::uint32_t> _out_first;
+    std::vector<std::uint32_t> _out;
+    std::size_t _max_length = 0;
+
+public:
+    /**
+     * Code units that can start a match in the text, if it is UTF-8 and
+     * compared exactly
+     */
+    start_units utf8_starts;
+    /**
+     * Code units that can start a match in a text of any encoding, compared
+     * by code point
+     */
+    start_units starts;
+    teddy_masks teddy;
+
+    /**
+     * Add a pattern, as the UTF-8 of the code points it has to match. An
+     * empty pattern never matches.
+     */
+    void add(std::string pattern) {
+        _patterns.push_back(std::move(pattern));
+    }
+
+    /**
+     * Build the automaton and the filters once every pattern is added, for
+     * patterns compared as `how` says
+     */
+    void compile(match how);
+
+    std::size_t size() const noexcept {
+        return _lengths.size();
+    }
+
+    bool empty() const noexcept {
+        return _max_length == 0;
+    }
+
+    std::uint32_t next(std::uint32_t state, char c) const noexcept {
+        return _delta[state + _classes[static_cast<unsigned char>(c)]];
+    }
+
+    bool has_output(std::uint32_t state) const noexcept {
+        return state - _n_classes < _match_end - _n_classes;
+    }
+
+    /**
+     * The patterns that end in `state`, longest first
+     */
+    const std::uint32_t* outputs_begin(std::uint32_t state) const noexcept {
+        return _out.data() + _out_first[state / _n_classes];
+    }
+    const std::uint32_t* outputs_end(std::uint32_t state) const noexcept {
+        return _out.data() + _out_first[state / _n_classes + 1];
+    }
+
+    /**
+     * The length in bytes of the UTF-8 of a pattern
+     */
+    std::size_t length(std::uint32_t pattern) const noexcept {
+        return _lengths[pattern];
+    }
+
+    std::size_t max_length() const noexcept {
+        return _max_length;
+    }
+};
+
+/**
+ * Feeds the automaton the code points of a text after some transformation,
+ * such as case folding, in pieces that each come from a run of the text.
+ * Matches are only reported where they start at the start of a piece and
+ * end at the end of one, and the piece bounds are in the text.
+ */
+template <typename Unit> class pattern_stream {
+    const pattern_automaton& _automaton;
+    std::uint32_t _state = 0;
+    // The number of bytes fed so far
+    std::size_t _offset = 0;
+
+    // A ring of where the recent pieces start, in the stream and in the text:
+    // enough for the longest pattern
+    std::size_t _mask;
+    small_array<std::size_t, 64> _start_offsets;
+    small_array<const Unit*, 64> _starts;
+    std::size_t _n_starts = 0;
+
+    static std::size_t _ring_size(std::size_t n) noexcept {
+        std::size_t size = 1;
+        while (size < n) {
+            size *= 2;
+        }
+        return size;
+    }
+
+    const Unit* _start_at(std::size_t offset) const noexcept {
+        for (std::size_t i = _n_starts; i != 0 && _n_starts - i <= _mask; --i) {
+            const auto at = _start_offsets[(i - 1) & _mask];
+            if (at == offset) {
+                return _starts[(i - 1) & _mask];
+            }
+            if (at < offset) {
+                break;
+            }
+        }
+        return nullptr;
+    }
+
+public:
+    explicit pattern_stream(const pattern_automaton& automaton)
+        : _automaton(automaton)
+        , _mask(_ring_size(automaton.max_length() + 1) - 1)
+        , _start_offsets(_mask + 1)
+        , _starts(_mask + 1) {
+    }
+
+    /**
+     * Whether no match is in progress
+     */
+    bool idle() const noexcept {
+        return _state == 0;
+    }
+
+    /**
+     * Start a piece at `start` in the text, or at no position of its own if
+     * `start` is null
+     */
+    void begin_piece(const Unit* start) noexcept {
+        if (start) {
+            _start_offsets[_n_starts & _mask] = _offset;
+            _starts[_n_starts & _mask] = start;
+            ++_n_starts;
+        }
+    }
+
+    void feed_byte(char c) noexcept {
+        _state = _automaton.next(_state, c);
+        ++_offset;
+    }
+
+    void feed(char32_t cp) noexcept {
+        char buf[4];
+        const auto n = encode_utf8(cp, buf);
+        for (std::size_t i = 0; i < n; ++i) {
+            _state = _automaton.next(_state, buf[i]);
+        }
+        _offset += n;
+    }
+
+    /**
+     * End the piece at `end` in the text, or null, and report the patterns
+     * that match up to there. Returns false if `report` asks to stop.
+     */
+    template <typename Report> bool end_piece(const Unit* end, Report& report) {
+        if (!end || !_automaton.has_output(_state)) {
+            return true;
+        }
+        for (auto it = _automaton.outputs_begin(_state); it != _automaton.outputs_end(_state); ++it) {
+            const auto start = _start_at(_offset - _automaton.length(*it));
+            if (start && !report(*it, start, end)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * Find the patterns in UTF-8 compared exactly, on the bytes of the text. The
+ * patterns are whole UTF-8 sequences, so a match can only start on a code
+ * point boundary, but it can end before a stray continuation byte.
+ */
+template <typename Report>
+bool scan_utf8_exactly(const pattern_automaton& automaton,
+                       const char* p,
+                       const char* last,
+                       Report& report) {
+    const auto first = p;
+#if NEO_UNICODE_HAVE_SSSE3
+    // Comparing with the first bytes is cheaper, if there are only a few
+    const bool use_teddy = automaton.teddy.width != 0 && !automaton.utf8_starts.few();
+#endif
+    bool filter = NEO_UNICODE_HAVE_SSE2;
+    std::size_t n_skips = 0;
+    std::uint32_t state = 0;
+    while (p != last) {
+        if (state == 0 && filter) {
+#if NEO_UNICODE_HAVE_SSSE3
+            p = use_teddy ? automaton.teddy.next(p, last) : automaton.utf8_starts.skip(p, last);
+#else
+            p = automaton.utf8_starts.skip(p, last);
+#endif
+            if (p == last) {
+                break;
+            }
+            // Stop filtering once it stops at nearly every byte
+            filter = !filter_is_ineffective(++n_skips, static_cast<std::size_t>(p - first));
+        }
+        state = automaton.next(state, *p++);
+        if (automaton.has_output(state)) {
+            for (auto it = automaton.outputs_begin(state); it != automaton.outputs_end(state); ++it) {
+                const auto start = p - automaton.length(*it);
+                if (on_code_point_boundaries<utf8>(first, start, p, last) && !report(*it, start, p)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Find the patterns one code point of the text at a time, case-folded or
+ * not
+ */
+template <typename Encoding, typename Unit, typename Report>
+bool scan_code_points(const pattern_automaton& automaton,
+                      const Unit* p,
+                      const Unit* last,
+                      bool fold,
+                      Report& report) {
+    pattern_stream<Unit> stream(automaton);
+    const auto first = p;
+    bool filter = true;
+    std::size_t n_skips = 0;
+    while (p != last) {
+        if (ascii_code_units<Encoding>::value) {
+            if (stream.idle() && filter) {
+                p = automaton.starts.skip(p, last);
+                if (p == last) {
+                    break;
+                }
+                filter = !filter_is_ineffective(++n_skips, static_cast<std::size_t>(p - first));
+            }
+            if (unit_value(*p) < 0x80) {
+                // ASCII is its own code point, and folds without a lookup
+                auto c = static_cast<char>(*p);
+                if (fold && c - 'A' >= 0 && c - 'A' < 26) {
+                    c = static_cast<char>(c + 0x20);
+                }
+                stream.begin_piece(p);
+                stream.feed_byte(c);
+                if (!stream.end_piece(++p, report)) {
+                    return false;
+                }
+                continue;
+            }
+        }
+        const auto origin = p;
+        const auto cp = decoder<Encoding>::next(p, last);
+        stream.begin_piece(origin);
+        if (fold) {
+            char32_t folded[max_case_fold_size];
+            const auto n_folded = fold_case(cp, folded);
+            for (std::size_t i = 0; i < n_folded; ++i) {
+                stream.feed(folded[i]);
+            }
+        } else {
+            stream.feed(cp);
+        }
+        if (!stream.end_piece(p, report)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Find the patterns one segment of the decomposed text at a time
+ */
+template <typename Encoding, typename Unit, typename Report>
+bool scan_segments(const pattern_automaton& automaton,
+                   const Unit* p,
+                   const Unit* last,
+                   bool compatible,
+                   Report& report) {
+    pattern_stream<Unit> stream(automaton);
+    canonical_decomposer<Encoding> segments(p, last, compatible);
+    bool filter = true;
+    std::size_t n_skips = 0;
+    while (true) {
+        const auto pos = segments.position();
+        if (stream.idle() && pos && filter && ascii_code_units<Encoding>::value) {
+            const auto next = automaton.starts.skip(pos, last);
+            segments.skip_to(next);
+            filter = !filter_is_ineffective(++n_skips, static_cast<std::size_t>(next - p));
+        }
+        if (!segments.next()) {
+            break;
+        }
+        stream.begin_piece(segments.start());
+        for (std::size_t i = 0; i < segments.size(); ++i) {
+            stream.feed(segments.data()[i]);
+        }
+        if (!stream.end_piece(segments.end(), report)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Encoding, typename Report>
+bool scan_exactly(const pattern_automaton& automaton,
+                  const char* first,
+                  const char* last,
+                  Report& report,
+                  std::true_type /* is UTF-8 */) {
+    return scan_utf8_exactly(automaton, first, last, report);
+}
+
+template <typename Encoding, typename Unit, typename Report>
+bool scan_exactly(const pattern_automaton& automaton,
+                  const Unit* first,
+                  const Unit* last,
+                  Report& report,
+                  std::false_type) {
+    return scan_code_points<Encoding>(automaton, first, last, false, report);
+}
+
+/**
+ * Report every match of the patterns in [first, last) of `Encoding`, compared
+ * as `how` says, with `report(pattern, start, end)`, until it returns false.
+ */
+template <typename Encoding, typename Unit, typename Report>
+void scan_patterns(const pattern_automaton& automaton,
+                   match how,
+                   const Unit* first,
+                   const Unit* last,
+                   Report& report) {
+    if (automaton.empty()) {
+        return;
+    }
+    if (how == match::exact) {
+        scan_exactly<Encoding>(automaton, first, last, report, std::is_same<Encoding, utf8>{});
+    } else if (how == match::case_insensitive) {
+        scan_code_points<Encoding>(automaton, first, last, true, report);
+    } else {
+        scan_segments<Encoding>(automaton, first, last, how == match::compatible, report);
+    }
+}
+
+/**
+ * The UTF-8 of the code points that a pattern of `Encoding` has to match,
+ * once it is transformed as `how` says. A canonical or compatible pattern
+ * that starts with a non-starter never matches, and is left empty.
+ */
+template <typename Encoding, typename Unit>
+std::string transform_pattern(const Unit* p, const Unit* last, match how) {
+    std::string ret;
+    char buf[4];
+    const auto append = [&](char32_t cp) { ret.append(buf, encode_utf8(cp, buf)); };
+    if (how == match::canonical || how == match::compatible) {
+        canonical_decomposer<Encoding> segments(p, last, how == match::compatible);
+        for (bool first = true; segments.next(); first = false) {
+            if (first && segments.combining_class(0) != 0) {
+                return {};
+            }
+            for (std::size_t i = 0; i < segments.size(); ++i) {
+                append(segments.data()[i]);
+            }
+        }
+        return ret;
+    }
+    while (p != last) {
+        const auto cp = decoder<Encoding>::next(p, last);
+        if (how == match::case_insensitive) {
+            char32_t folded[max_case_fold_size];
+            const auto n_folded = fold_case(cp, folded);
+            for (std::size_t i = 0; i < n_folded; ++i) {
+                append(folded[i]);
+            }
+        } else {
+            append(cp);
+        }
+    }
+    return ret;
+}
+
+}  // namespace unicode_detail
+
+/**
+ * A match of one of the patterns of a `pattern_set` in a text
+ */
+template <typename Iterator> struct pattern_match {
+    /**
+     * The index of the pattern in the set
+     */
+    std::size_t pattern;
+    Iterator first;
+    Iterator last;
+};
+
+/**
+ * A set of patterns, such as keywords or blocked terms, that are found
+ * together in one pass over a text. The patterns are compiled once, when the
+ * set is built, to an Aho-Corasick automaton, so a scan takes time linear in
+ * the length of the text and in the number of matches, however many patterns
+ * there are.
+ *
+ * The patterns are compared with the text as `how` says, as in
+ * `basic_text::search()`: exactly, under case folding, or up to canonical or
+ * compatibility equivalence. A match starts and ends on code point
+ * boundaries, and where the text is decomposed, on segment boundaries. Empty
+ * patterns never match.
+ *
+ * While no match is in progress, a scan skips ahead with SIMD to the next
+ * code unit that can start one. If the patterns start with more than a few
+ * different bytes, exact scans of UTF-8 use a Teddy filter on the first
+ * three bytes of up to 64 patterns when SSSE3 is enabled, such as with
+ * `-mssse3`. The skip stops once it no longer skips much.
+ */
+class pattern_set {
+    match _how = match::exact;
+    unicode_detail::pattern_automaton _automaton;
+
+    template <typename Encoding, typename Buffer> void _add(const basic_text<Encoding, Buffer>& pattern) {
+        _automaton.add(unicode_detail::transform_pattern<Encoding>(
+            pattern.data(), pattern.data() + pattern.code_unit_size(), _how));
+    }
+
+public:
+    /**
+     * Construct an empty set, which never matches
+     */
+    pattern_set() {
+        _automaton.compile(_how);
+    }
+
+    /**
+     * Compile a set from a range of `basic_text`s, of any encoding, compared
+     * as `how` says. Each pattern is identified by its index in the range.
+     */
+    template <typename Range>
+    explicit pattern_set(const Range& patterns, match how = match::exact)
+        : _how(how) {
+        for (const auto& pattern : patterns) {
+            _add(pattern);
+        }
+        _automaton.compile(_how);
+    }
+
+    pattern_set(std::initializer_list<basic_text<utf8>> patterns, match how = match::exact)
+        : _how(how) {
+        for (const auto& pattern : patterns) {
+            _add(pattern);
+        }
+        _automaton.compile(_how);
+    }
+
+    /**
+     * The number of patterns in the set
+     */
+    std::size_t size() const noexcept {
+        return _automaton.size();
+    }
+
+    /**
+     * How the patterns are compared with a text
+     */
+    match how() const noexcept {
+        return _how;
+    }
+
+    /**
+     * Call `fn` with a `pattern_match` for every match of every pattern in
+     * `text`, including overlapping ones, in the order in which they end.
+     * Matches that end together come longest first. If `fn` returns a value,
+     * the scan stops once it returns false.
+     */
+    template <typename Encoding, typename Buffer, typename Func>
+    void for_each_match(const basic_text<Encoding, Buffer>& text, Func&& fn) const {
+        using iterator = typename basic_text<Encoding, Buffer>::iterator;
+        using unit = typename Encoding::code_unit_type;
+        const auto first = text.data();
+        const auto last = first + text.code_unit_size();
+        auto report = [&](std::size_t pattern, const unit* start, const unit* end) {
+            return unicode_detail::keep_going(fn,
+                                              pattern_match<iterator>{pattern,
+                                                                      iterator(first, start, last),
+                                                                      iterator(first, end, last)});
+        };
+        unicode_detail::scan_patterns<Encoding>(_automaton, _how, first, last, report);
+    }
+
+    /**
+     * Get every match in `text`. See `for_each_match()`.
+     */
+    template <typename Encoding, typename Buffer>
+    std::vector<pattern_match<typename basic_text<Encoding, Buffer>::iterator>>
+    find_all(const basic_text<Encoding, Buffer>& text) const {
+        std::vector<pattern_match<typename basic_text<Encoding, Buffer>::iterator>> ret;
+        for_each_match(text, [&](const auto& m) { ret.push_back(m); });
+        return ret;
+    }
+
+    /**
+     * Check whether any of the patterns occurs in `text`. The scan stops at
+     * the first match.
+     */
+    template <typename Encoding, typename Buffer>
+    bool found_in(const basic_text<Encoding, Buffer>& text) const {
+        bool found = false;
+        for_each_match(text, [&](const auto&) {
+            found = true;
+            return false;
+        });
+        return found;
+    }
+};
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_PATTERN_SET_HPP_INCLUDED
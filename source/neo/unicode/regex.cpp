@@ -0,0 +1,1481 @@
+#include "regex.hpp"
+
+#include "case_fold.hpp"
+#include "encodings/all.hpp"
+#include "search.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+extern "C" {
+#include <internal/database.h>
+}
+
+namespace neo {
+
+namespace unicode_detail {
+
+/**
+ * An instruction of a regex program, which matches UTF-8 a byte at a time.
+ * A split goes on to `next` first and to `alt` second.
+ */
+struct regex_instruction {
+    enum kind_type : std::uint8_t { byte_range, split, assert_start, assert_end, fail, accept };
+
+    kind_type kind = fail;
+    std::uint8_t lo = 0;
+    std::uint8_t hi = 0;
+    std::uint32_t next = 0;
+    std::uint32_t alt = 0;
+};
+
+/**
+ * A compiled regex, with programs for both directions that end in the same
+ * `accept` instruction. The reverse program matches the reversed bytes of
+ * what the forward one matches, with the anchors swapped.
+ */
+struct regex_program {
+    match how = match::exact;
+    std::size_t cache_limit = 0;
+    std::vector<regex_instruction> code;
+    std::uint32_t forward_start = 0;
+    // `forward_start` after a lazy loop over any byte
+    std::uint32_t unanchored_start = 0;
+    std::uint32_t reverse_start = 0;
+    // Whether every match starts at the start of the text
+    bool anchored = false;
+    bool has_start_assertion = false;
+    // A literal that every match starts with, and one that every match
+    // contains, as UTF-8
+    std::string prefix;
+    std::string required;
+    // The bytes in classes that every instruction treats alike
+    std::uint8_t classes[256] = {};
+    std::size_t n_classes = 0;
+};
+
+namespace {
+
+using cp_range = std::pair<char32_t, char32_t>;
+
+/**
+ * A set of code points, as sorted ranges that neither overlap nor touch,
+ * without surrogates
+ */
+using code_point_set = std::vector<cp_range>;
+
+constexpr char32_t max_code_point = 0x10FFFF;
+constexpr std::uint32_t unbounded = 0xFFFFFFFF;
+constexpr std::uint32_t max_repetition = 1000;
+constexpr std::size_t max_nesting = 250;
+constexpr std::size_t max_program_size = std::size_t(1) << 19;
+constexpr std::size_t max_literal_size = 256;
+
+void canonicalize(code_point_set& set) {
+    std::sort(set.begin(), set.end());
+    code_point_set ret;
+    for (auto r : set) {
+        if (!ret.empty() && r.first <= ret.back().second + 1) {
+            ret.back().second = std::max(ret.back().second, r.second);
+        } else {
+            ret.push_back(r);
+        }
+    }
+    set.clear();
+    for (auto r : ret) {
+        if (r.first < 0xD800 && r.second > 0xDFFF) {
+            set.emplace_back(r.first, 0xD7FF);
+            set.emplace_back(0xE000, r.second);
+        } else if (r.first < 0xD800) {
+            set.emplace_back(r.first, std::min<char32_t>(r.second, 0xD7FF));
+        } else if (r.second > 0xDFFF) {
+            set.emplace_back(std::max<char32_t>(r.first, 0xE000), r.second);
+        }
+    }
+}
+
+code_point_set negate(const code_point_set& set) {
+    code_point_set ret;
+    char32_t next = 0;
+    for (auto r : set) {
+        if (r.first > next) {
+            ret.emplace_back(next, r.first - 1);
+        }
+        next = r.second + 1;
+    }
+    if (next <= max_code_point) {
+        ret.emplace_back(next, max_code_point);
+    }
+    canonicalize(ret);
+    return ret;
+}
+
+bool contains(const code_point_set& set, char32_t cp) noexcept {
+    const auto it = std::upper_bound(set.begin(), set.end(), cp, [](char32_t c, const cp_range& r) {
+        return c < r.first;
+    });
+    return it != set.begin() && cp <= std::prev(it)->second;
+}
+
+/**
+ * The ranges of each general category, by the bit that utf8rewind uses for
+ * it, built on first use
+ */
+const std::vector<code_point_set>& category_sets() {
+    static const auto sets = [] {
+        std::vector<code_point_set> ret(30);
+        for (char32_t cp = 0; cp <= max_code_point; ++cp) {
+            auto category = PROPERTY_GET_GC(cp) & 0x3FFFFFFF;
+            if (category == 0) {
+                category = UTF8_CATEGORY_UNASSIGNED;
+            }
+            auto& set = ret[count_trailing_zeros(category)];
+            if (!set.empty() && set.back().second + 1 == cp) {
+                set.back().second = cp;
+            } else {
+                set.emplace_back(cp, cp);
+            }
+        }
+        for (auto& set : ret) {
+            canonicalize(set);
+        }
+        return ret;
+    }();
+    return sets;
+}
+
+code_point_set category_set(std::uint32_t categories) {
+    code_point_set ret;
+    const auto& sets = category_sets();
+    for (std::uint32_t bit = 0; bit < 30; ++bit) {
+        if (categories & (std::uint32_t(1) << bit)) {
+            ret.insert(ret.end(), sets[bit].begin(), sets[bit].end());
+        }
+    }
+    canonicalize(ret);
+    return ret;
+}
+
+/**
+ * The code points that case-fold alike, in groups, and the group of each
+ * code point that is in one. Built on first use.
+ */
+struct case_groups {
+    std::vector<std::vector<char32_t>> groups;
+    std::vector<std::pair<char32_t, std::size_t>> group_of;
+};
+
+const case_groups& case_groups_table() {
+    static const auto table = [] {
+        std::map<std::u32string, std::vector<char32_t>> by_folding;
+        char32_t folded[max_case_fold_size];
+        for (char32_t cp = 0; cp <= max_code_point; ++cp) {
+            const auto n = fold_case(cp, folded);
+            if (n != 1 || folded[0] != cp) {
+                by_folding[std::u32string(folded, n)].push_back(cp);
+            }
+        }
+        case_groups ret;
+        for (auto& entry : by_folding) {
+            auto& group = entry.second;
+            if (entry.first.size() == 1) {
+                group.push_back(entry.first[0]);
+            }
+            for (const auto cp : group) {
+                ret.group_of.emplace_back(cp, ret.groups.size());
+            }
+            ret.groups.push_back(std::move(group));
+        }
+        std::sort(ret.group_of.begin(), ret.group_of.end());
+        return ret;
+    }();
+    return table;
+}
+
+/**
+ * Add to `set` every code point that case-folds like one in it
+ */
+void close_over_case(code_point_set& set) {
+    const auto& table = case_groups_table();
+    code_point_set added;
+    for (const auto& entry : table.group_of) {
+        if (contains(set, entry.first)) {
+            for (const auto cp : table.groups[entry.second]) {
+                added.emplace_back(cp, cp);
+            }
+        }
+    }
+    set.insert(set.end(), added.begin(), added.end());
+    canonicalize(set);
+}
+
+struct regex_node {
+    enum kind_type { empty, set, concat, alternate, repeat, start, end };
+
+    kind_type kind = empty;
+    code_point_set code_points;
+    std::vector<regex_node> children;
+    std::uint32_t min = 0;
+    std::uint32_t max = 0;
+    bool greedy = true;
+};
+
+struct property_name {
+    const char* name;
+    const char* long_name;
+    std::uint32_t categories;
+};
+
+const property_name property_names[] = {
+    {"l", "letter", UTF8_CATEGORY_LETTER},
+    {"lc", "casedletter", UTF8_CATEGORY_CASE_MAPPED},
+    {"lu", "uppercaseletter", UTF8_CATEGORY_LETTER_UPPERCASE},
+    {"ll", "lowercaseletter", UTF8_CATEGORY_LETTER_LOWERCASE},
+    {"lt", "titlecaseletter", UTF8_CATEGORY_LETTER_TITLECASE},
+    {"lm", "modifierletter", UTF8_CATEGORY_LETTER_MODIFIER},
+    {"lo", "otherletter", UTF8_CATEGORY_LETTER_OTHER},
+    {"m", "mark", UTF8_CATEGORY_MARK},
+    {"mn", "nonspacingmark", UTF8_CATEGORY_MARK_NON_SPACING},
+    {"mc", "spacingmark", UTF8_CATEGORY_MARK_SPACING},
+    {"me", "enclosingmark", UTF8_CATEGORY_MARK_ENCLOSING},
+    {"n", "number", UTF8_CATEGORY_NUMBER},
+    {"nd", "decimalnumber", UTF8_CATEGORY_NUMBER_DECIMAL},
+    {"nl", "letternumber", UTF8_CATEGORY_NUMBER_LETTER},
+    {"no", "othernumber", UTF8_CATEGORY_NUMBER_OTHER},
+    {"p", "punctuation", UTF8_CATEGORY_PUNCTUATION},
+    {"pc", "connectorpunctuation", UTF8_CATEGORY_PUNCTUATION_CONNECTOR},
+    {"pd", "dashpunctuation", UTF8_CATEGORY_PUNCTUATION_DASH},
+    {"ps", "openpunctuation", UTF8_CATEGORY_PUNCTUATION_OPEN},
+    {"pe", "closepunctuation", UTF8_CATEGORY_PUNCTUATION_CLOSE},
+    {"pi", "initialpunctuation", UTF8_CATEGORY_PUNCTUATION_INITIAL},
+    {"pf", "finalpunctuation", UTF8_CATEGORY_PUNCTUATION_FINAL},
+    {"po", "otherpunctuation", UTF8_CATEGORY_PUNCTUATION_OTHER},
+    {"s", "symbol", UTF8_CATEGORY_SYMBOL},
+    {"sm", "mathsymbol", UTF8_CATEGORY_SYMBOL_MATH},
+    {"sc", "currencysymbol", UTF8_CATEGORY_SYMBOL_CURRENCY},
+    {"sk", "modifiersymbol", UTF8_CATEGORY_SYMBOL_MODIFIER},
+    {"so", "othersymbol", UTF8_CATEGORY_SYMBOL_OTHER},
+    {"z", "separator", UTF8_CATEGORY_SEPARATOR},
+    {"zs", "spaceseparator", UTF8_CATEGORY_SEPARATOR_SPACE},
+    {"zl", "lineseparator", UTF8_CATEGORY_SEPARATOR_LINE},
+    {"zp", "paragraphseparator", UTF8_CATEGORY_SEPARATOR_PARAGRAPH},
+    {"c", "other",
+     UTF8_CATEGORY_CONTROL | UTF8_CATEGORY_FORMAT | UTF8_CATEGORY_SURROGATE | UTF8_CATEGORY_PRIVATE_USE
+         | UTF8_CATEGORY_UNASSIGNED},
+    {"cc", "control", UTF8_CATEGORY_CONTROL},
+    {"cf", "format", UTF8_CATEGORY_FORMAT},
+    {"cs", "surrogate", UTF8_CATEGORY_SURROGATE},
+    {"co", "privateuse", UTF8_CATEGORY_PRIVATE_USE},
+    {"cn", "unassigned", UTF8_CATEGORY_UNASSIGNED},
+};
+
+code_point_set white_space() {
+    return {{0x09, 0x0D}, {0x20, 0x20}, {0x85, 0x85}, {0xA0, 0xA0}, {0x1680, 0x1680}, {0x2000, 0x200A},
+            {0x2028, 0x2029}, {0x202F, 0x202F}, {0x205F, 0x205F}, {0x3000, 0x3000}};
+}
+
+code_point_set word_characters() {
+    auto ret = category_set(UTF8_CATEGORY_LETTER | UTF8_CATEGORY_MARK | UTF8_CATEGORY_NUMBER_DECIMAL
+                            | UTF8_CATEGORY_PUNCTUATION_CONNECTOR);
+    ret.emplace_back(0x200C, 0x200D);
+    canonicalize(ret);
+    return ret;
+}
+
+bool is_ascii_alnum(char32_t c) noexcept {
+    return c - U'0' < 10 || c - U'a' < 26 || c - U'A' < 26;
+}
+
+/**
+ * A recursive descent parser of the syntax that `regex` describes
+ */
+class regex_parser {
+    const std::u32string& _pattern;
+    bool _fold;
+    std::size_t _pos = 0;
+    std::size_t _depth = 0;
+
+    [[noreturn]] void _fail(const char* what) const {
+        throw regex_error(what, _pos);
+    }
+
+    bool _done() const noexcept {
+        return _pos == _pattern.size();
+    }
+
+    bool _accept(char32_t c) noexcept {
+        if (!_done() && _pattern[_pos] == c) {
+            ++_pos;
+            return true;
+        }
+        return false;
+    }
+
+    char32_t _take() {
+        if (_done()) {
+            _fail("Unexpected end of pattern");
+        }
+        return _pattern[_pos++];
+    }
+
+    regex_node _set(code_point_set set, bool negated = false) const {
+        canonicalize(set);
+        if (_fold) {
+            close_over_case(set);
+        }
+        regex_node ret;
+        ret.kind = regex_node::set;
+        ret.code_points = negated ? negate(set) : std::move(set);
+        return ret;
+    }
+
+    std::uint32_t _number() {
+        std::uint32_t n = 0;
+        const auto start = _pos;
+        while (!_done() && _pattern[_pos] - U'0' < 10) {
+            n = n * 10 + (_pattern[_pos++] - U'0');
+            if (n > max_repetition) {
+                _fail("Repetition count is too large");
+            }
+        }
+        if (_pos == start) {
+            _fail("Bad repetition");
+        }
+        return n;
+    }
+
+    char32_t _hex(std::size_t max_digits) {
+        char32_t n = 0;
+        std::size_t digits = 0;
+        while (digits < max_digits && !_done()) {
+            const auto c = _pattern[_pos];
+            const auto digit = c - U'0' < 10 ? c - U'0'
+                : (c | 0x20) - U'a' < 6    ? (c | 0x20) - U'a' + 10
+                                           : 16u;
+            if (digit == 16) {
+                break;
+            }
+            n = n * 16 + digit;
+            if (n > max_code_point) {
+                _fail("Bad escape");
+            }
+            ++_pos;
+            ++digits;
+        }
+        if (digits == 0) {
+            _fail("Bad escape");
+        }
+        return n;
+    }
+
+    /**
+     * The set of a `\p` or `\P` escape, whose letter has been read. Names are
+     * compared loosely, ignoring case, spaces, hyphens and underscores.
+     */
+    code_point_set _property() {
+        std::string name;
+        auto add = [&](char32_t c) {
+            if (c >= 0x80) {
+                _fail("Unknown property");
+            }
+            if (c != U' ' && c != U'-' && c != U'_') {
+                name.push_back(static_cast<char>(c - U'A' < 26 ? c + 0x20 : c));
+            }
+        };
+        if (_accept(U'{')) {
+            while (!_accept(U'}')) {
+                if (_done()) {
+                    _fail("Missing '}'");
+                }
+                add(_take());
+            }
+        } else {
+            add(_take());
+        }
+        if (name == "any") {
+            return {{0, max_code_point}};
+        }
+        if (name == "ascii") {
+            return {{0, 0x7F}};
+        }
+        for (const auto& property : property_names) {
+            if (name == property.name || name == property.long_name) {
+                return category_set(property.categories);
+            }
+        }
+        _fail("Unknown property");
+    }
+
+    /**
+     * Read the escape after a backslash if it stands for a set of code
+     * points, and say whether it did
+     */
+    bool _class_escape(code_point_set& set, bool& negated) {
+        const auto c = _pattern[_pos];
+        negated = c - U'A' < 26;
+        switch (c | 0x20) {
+        case U'd':
+            set = category_set(UTF8_CATEGORY_NUMBER_DECIMAL);
+            break;
+        case U'w':
+            set = word_characters();
+            break;
+        case U's':
+            set = white_space();
+            break;
+        case U'p':
+            ++_pos;
+            set = _property();
+            return true;
+        default:
+            return false;
+        }
+        ++_pos;
+        return true;
+    }
+
+    char32_t _literal_escape() {
+        const auto c = _take();
+        switch (c) {
+        case U'n':
+            return U'\n';
+        case U't':
+            return U'\t';
+        case U'r':
+            return U'\r';
+        case U'f':
+            return U'\f';
+        case U'v':
+            return U'\v';
+        case U'a':
+            return 0x07;
+        case U'e':
+            return 0x1B;
+        case U'0':
+            return 0;
+        case U'x':
+            if (_accept(U'{')) {
+                const auto cp = _hex(8);
+                if (!_accept(U'}')) {
+                    _fail("Missing '}'");
+                }
+                return cp;
+            }
+            return _hex(2);
+        default:
+            if (c >= 0x80 || is_ascii_alnum(c)) {
+                --_pos;
+                _fail("Bad escape");
+            }
+            return c;
+        }
+    }
+
+    regex_node _bracket() {
+        const bool negated = _accept(U'^');
+        code_point_set set;
+        bool first = true;
+        while (first || !_accept(U']')) {
+            if (_done()) {
+                _fail("Missing ']'");
+            }
+            first = false;
+            char32_t lo = _take();
+            if (lo == U'\\') {
+                code_point_set escaped;
+                bool escape_negated = false;
+                if (!_done() && _class_escape(escaped, escape_negated)) {
+                    escaped = escape_negated ? negate(escaped) : escaped;
+                    set.insert(set.end(), escaped.begin(), escaped.end());
+                    continue;
+                }
+                lo = _literal_escape();
+            }
+            char32_t hi = lo;
+            if (_pos + 1 < _pattern.size() && _pattern[_pos] == U'-' && _pattern[_pos + 1] != U']') {
+                ++_pos;
+                hi = _take();
+                if (hi == U'\\') {
+                    code_point_set escaped;
+                    bool escape_negated = false;
+                    if (!_done() && _class_escape(escaped, escape_negated)) {
+                        _fail("Bad range");
+                    }
+                    hi = _literal_escape();
+                }
+                if (hi < lo) {
+                    _fail("Bad range");
+                }
+            }
+            set.emplace_back(lo, hi);
+        }
+        return _set(std::move(set), negated);
+    }
+
+    regex_node _atom() {
+        const auto c = _take();
+        regex_node ret;
+        switch (c) {
+        case U'(': {
+            if (++_depth > max_nesting) {
+                _fail("Groups are nested too deeply");
+            }
+            if (_accept(U'?') && !_accept(U':')) {
+                _fail("Unsupported group");
+            }
+            ret = _alternation();
+            if (!_accept(U')')) {
+                _fail("Missing ')'");
+            }
+            --_depth;
+            return ret;
+        }
+        case U'[':
+            return _bracket();
+        case U'.':
+            return _set({{0, U'\n' - 1}, {U'\n' + 1, max_code_point}});
+        case U'^':
+            ret.kind = regex_node::start;
+            return ret;
+        case U'$':
+            ret.kind = regex_node::end;
+            return ret;
+        case U'*':
+        case U'+':
+        case U'?':
+        case U'{':
+            --_pos;
+            _fail("Nothing to repeat");
+        case U'\\': {
+            if (_done()) {
+                _fail("Unexpected end of pattern");
+            }
+            const auto e = _pattern[_pos];
+            if (e == U'A' || e == U'z') {
+                ++_pos;
+                ret.kind = e == U'A' ? regex_node::start : regex_node::end;
+                return ret;
+            }
+            if (e == U'b' || e == U'B') {
+                _fail("Word boundaries are not supported");
+            }
+            code_point_set set;
+            bool negated = false;
+            if (_class_escape(set, negated)) {
+                return _set(std::move(set), negated);
+            }
+            const auto cp = _literal_escape();
+            return _set({{cp, cp}});
+        }
+        default:
+            return _set({{c, c}});
+        }
+    }
+
+    regex_node _repetition() {
+        auto ret = _atom();
+        bool repeated = false;
+        while (!_done()) {
+            std::uint32_t min = 0;
+            std::uint32_t max = unbounded;
+            const auto c = _pattern[_pos];
+            if (c == U'*') {
+                ++_pos;
+            } else if (c == U'+') {
+                ++_pos;
+                min = 1;
+            } else if (c == U'?') {
+                ++_pos;
+                max = 1;
+            } else if (c == U'{') {
+                ++_pos;
+                min = _number();
+                max = min;
+                if (_accept(U',')) {
+                    max = (!_done() && _pattern[_pos] == U'}') ? unbounded : _number();
+                }
+                if (!_accept(U'}') || max < min) {
+                    _fail("Bad repetition");
+                }
+            } else {
+                break;
+            }
+            if (repeated) {
+                --_pos;
+                _fail("Nothing to repeat");
+            }
+            repeated = true;
+            regex_node node;
+            node.kind = regex_node::repeat;
+            node.min = min;
+            node.max = max;
+            node.greedy = !_accept(U'?');
+            node.children.push_back(std::move(ret));
+            ret = std::move(node);
+        }
+        return ret;
+    }
+
+    regex_node _concatenation() {
+        regex_node ret;
+        ret.kind = regex_node::concat;
+        while (!_done() && _pattern[_pos] != U'|' && _pattern[_pos] != U')') {
+            ret.children.push_back(_repetition());
+        }
+        return ret;
+    }
+
+    regex_node _alternation() {
+        regex_node ret;
+        ret.kind = regex_node::alternate;
+        ret.children.push_back(_concatenation());
+        while (_accept(U'|')) {
+            ret.children.push_back(_concatenation());
+        }
+        return ret.children.size() == 1 ? std::move(ret.children[0]) : std::move(ret);
+    }
+
+public:
+    regex_parser(const std::u32string& pattern, bool fold)
+        : _pattern(pattern)
+        , _fold(fold) {}
+
+    regex_node parse() {
+        auto ret = _alternation();
+        if (!_done()) {
+            _fail("Unmatched ')'");
+        }
+        return ret;
+    }
+};
+
+/**
+ * The byte ranges of a UTF-8 sequence
+ */
+struct byte_sequence {
+    std::uint8_t lo[4];
+    std::uint8_t hi[4];
+    std::size_t size;
+};
+
+/**
+ * Split the code points from `first` to `last`, none of which is a
+ * surrogate, into sequences of byte ranges whose every combination is the
+ * UTF-8 of one of them, in order
+ */
+void utf8_sequences(char32_t first, char32_t last, std::vector<byte_sequence>& out) {
+    std::vector<cp_range> pending = {{first, last}};
+    while (!pending.empty()) {
+        auto r = pending.back();
+        pending.pop_back();
+        bool split = false;
+        // Code points of one length of encoding at a time
+        for (const char32_t max : {char32_t(0x7F), char32_t(0x7FF), char32_t(0xFFFF)}) {
+            if (r.first <= max && max < r.second) {
+                pending.emplace_back(max + 1, r.second);
+                r.second = max;
+            }
+        }
+        // Then ranges that cover whole blocks of continuation bytes
+        for (int i = 1; i < 4 && r.second >= 0x80; ++i) {
+            const char32_t m = (char32_t(1) << (6 * i)) - 1;
+            if ((r.first & ~m) != (r.second & ~m)) {
+                if ((r.first & m) != 0) {
+                    pending.emplace_back((r.first | m) + 1, r.second);
+                    pending.emplace_back(r.first, r.first | m);
+                    split = true;
+                    break;
+                }
+                if ((r.second & m) != m) {
+                    pending.emplace_back(r.second & ~m, r.second);
+                    pending.emplace_back(r.first, (r.second & ~m) - 1);
+                    split = true;
+                    break;
+                }
+            }
+        }
+        if (split) {
+            continue;
+        }
+        char lo[4];
+        char hi[4];
+        byte_sequence seq;
+        seq.size = encode_utf8(r.first, lo);
+        encode_utf8(r.second, hi);
+        for (std::size_t i = 0; i < seq.size; ++i) {
+            seq.lo[i] = static_cast<std::uint8_t>(lo[i]);
+            seq.hi[i] = static_cast<std::uint8_t>(hi[i]);
+        }
+        out.push_back(seq);
+    }
+}
+
+/**
+ * Compiles the nodes of a regex into instructions, from the last one
+ * matched to the first, so that every instruction is emitted after the one
+ * that it goes on to
+ */
+class regex_compiler {
+    std::vector<regex_instruction>& _code;
+    bool _reverse;
+
+    struct trie_node {
+        std::uint8_t lo;
+        std::uint8_t hi;
+        bool leaf;
+        std::vector<std::size_t> children;
+    };
+
+    std::uint32_t _emit(regex_instruction::kind_type kind, std::uint32_t next, std::uint32_t alt = 0) {
+        if (_code.size() >= max_program_size) {
+            throw regex_error("Pattern is too large", 0);
+        }
+        regex_instruction in;
+        in.kind = kind;
+        in.next = next;
+        in.alt = alt;
+        _code.push_back(in);
+        return static_cast<std::uint32_t>(_code.size() - 1);
+    }
+
+    std::uint32_t _emit_range(std::uint8_t lo, std::uint8_t hi, std::uint32_t next) {
+        const auto pc = _emit(regex_instruction::byte_range, next);
+        _code[pc].lo = lo;
+        _code[pc].hi = hi;
+        return pc;
+    }
+
+    std::uint32_t _emit_trie(const std::vector<trie_node>& trie, std::size_t node, std::uint32_t next) {
+        std::uint32_t ret = 0;
+        const auto& children = trie[node].children;
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+            const auto& child = trie[*it];
+            auto target = next;
+            if (!child.children.empty()) {
+                target = _emit_trie(trie, *it, next);
+                if (child.leaf) {
+                    target = _emit(regex_instruction::split, next, target);
+                }
+            }
+            const auto pc = _emit_range(child.lo, child.hi, target);
+            ret = it == children.rbegin() ? pc : _emit(regex_instruction::split, pc, ret);
+        }
+        return ret;
+    }
+
+    /**
+     * A set as a trie of the byte ranges of its UTF-8, or of their reverse,
+     * so that sequences share their common beginnings
+     */
+    std::uint32_t _compile_set(const code_point_set& set, std::uint32_t next) {
+        if (set.empty()) {
+            return _emit(regex_instruction::fail, 0);
+        }
+        std::vector<byte_sequence> sequences;
+        for (const auto& r : set) {
+            utf8_sequences(r.first, r.second, sequences);
+        }
+        std::vector<trie_node> trie(1, trie_node{0, 0, false, {}});
+        for (const auto& seq : sequences) {
+            std::size_t node = 0;
+            for (std::size_t i = 0; i < seq.size; ++i) {
+                const auto k = _reverse ? seq.size - 1 - i : i;
+                const auto& children = trie[node].children;
+                const auto found = std::find_if(children.begin(), children.end(), [&](std::size_t child) {
+                    return trie[child].lo == seq.lo[k] && trie[child].hi == seq.hi[k];
+                });
+                if (found != children.end()) {
+                    node = *found;
+                    continue;
+                }
+                trie.push_back(trie_node{seq.lo[k], seq.hi[k], false, {}});
+                trie[node].children.push_back(trie.size() - 1);
+                node = trie.size() - 1;
+            }
+            trie[node].leaf = true;
+        }
+        return _emit_trie(trie, 0, next);
+    }
+
+public:
+    regex_compiler(std::vector<regex_instruction>& code, bool reverse)
+        : _code(code)
+        , _reverse(reverse) {}
+
+    /**
+     * Emit `node`, followed by `next`, and return where it starts
+     */
+    std::uint32_t compile(const regex_node& node, std::uint32_t next) {
+        switch (node.kind) {
+        case regex_node::empty:
+            return next;
+        case regex_node::set:
+            return _compile_set(node.code_points, next);
+        case regex_node::start:
+        case regex_node::end:
+            return _emit((node.kind == regex_node::start) != _reverse ? regex_instruction::assert_start
+                                                                      : regex_instruction::assert_end,
+                         next);
+        case regex_node::concat:
+            if (_reverse) {
+                for (const auto& child : node.children) {
+                    next = compile(child, next);
+                }
+            } else {
+                for (auto it = node.children.rbegin(); it != node.children.rend(); ++it) {
+                    next = compile(*it, next);
+                }
+            }
+            return next;
+        case regex_node::alternate: {
+            auto ret = compile(node.children.back(), next);
+            for (auto it = std::next(node.children.rbegin()); it != node.children.rend(); ++it) {
+                ret = _emit(regex_instruction::split, compile(*it, next), ret);
+            }
+            return ret;
+        }
+        case regex_node::repeat: {
+            const auto& child = node.children[0];
+            auto ret = next;
+            if (node.max == unbounded) {
+                ret = _emit(regex_instruction::split, 0);
+                const auto body = compile(child, ret);
+                _code[ret].next = node.greedy ? body : next;
+                _code[ret].alt = node.greedy ? next : body;
+            } else {
+                for (auto n = node.min; n < node.max; ++n) {
+                    const auto body = compile(child, ret);
+                    ret = node.greedy ? _emit(regex_instruction::split, body, next)
+                                      : _emit(regex_instruction::split, next, body);
+                }
+            }
+            for (std::uint32_t n = 0; n < node.min; ++n) {
+                ret = compile(child, ret);
+            }
+            return ret;
+        }
+        }
+        return next;
+    }
+};
+
+/**
+ * What is known of the literals in the matches of a node: each of them
+ * starts with `prefix` and contains `required`, and if `exact`, each is
+ * `prefix`
+ */
+struct literal_info {
+    std::string prefix;
+    std::string required;
+    bool exact = false;
+};
+
+void keep_longer(std::string& best, const std::string& candidate) {
+    if (candidate.size() > best.size()) {
+        best = candidate.substr(0, max_literal_size);
+    }
+}
+
+literal_info literals(const regex_node& node) {
+    literal_info ret;
+    switch (node.kind) {
+    case regex_node::empty:
+    case regex_node::start:
+    case regex_node::end:
+        ret.exact = true;
+        return ret;
+    case regex_node::set:
+        if (node.code_points.size() == 1 && node.code_points[0].first == node.code_points[0].second) {
+            char buf[4];
+            ret.prefix.assign(buf, encode_utf8(node.code_points[0].first, buf));
+            ret.required = ret.prefix;
+            ret.exact = true;
+        }
+        return ret;
+    case regex_node::concat: {
+        ret.exact = true;
+        std::string run;
+        for (const auto& child : node.children) {
+            const auto info = literals(child);
+            if (ret.exact) {
+                ret.prefix += info.prefix;
+            }
+            keep_longer(ret.required, info.required);
+            if (info.exact) {
+                run += info.prefix;
+            } else {
+                keep_longer(ret.required, run + info.prefix);
+                run.clear();
+                ret.exact = false;
+            }
+        }
+        keep_longer(ret.required, run);
+        if (ret.prefix.size() > max_literal_size) {
+            ret.prefix.resize(max_literal_size);
+            ret.exact = false;
+        }
+        return ret;
+    }
+    case regex_node::alternate: {
+        ret = literals(node.children[0]);
+        for (std::size_t i = 1; i < node.children.size(); ++i) {
+            const auto info = literals(node.children[i]);
+            std::size_t n = 0;
+            while (n < ret.prefix.size() && n < info.prefix.size() && ret.prefix[n] == info.prefix[n]) {
+                ++n;
+            }
+            ret.exact = ret.exact && info.exact && ret.prefix == info.prefix;
+            ret.prefix.resize(n);
+        }
+        ret.required = ret.exact ? ret.prefix : std::string();
+        return ret;
+    }
+    case regex_node::repeat: {
+        if (node.min == 0) {
+            ret.exact = node.max == 0;
+            return ret;
+        }
+        const auto info = literals(node.children[0]);
+        ret.required = info.required;
+        ret.prefix = info.prefix;
+        if (info.exact) {
+            for (std::uint32_t n = 1; n < node.min && ret.prefix.size() <= max_literal_size; ++n) {
+                ret.prefix += info.prefix;
+            }
+            ret.exact = node.min == node.max && ret.prefix.size() <= max_literal_size;
+            ret.prefix.resize(std::min(ret.prefix.size(), max_literal_size));
+            keep_longer(ret.required, ret.prefix);
+        }
+        return ret;
+    }
+    }
+    return ret;
+}
+
+bool starts_anchored(const regex_node& node) {
+    switch (node.kind) {
+    case regex_node::start:
+        return true;
+    case regex_node::concat:
+        return !node.children.empty() && starts_anchored(node.children[0]);
+    case regex_node::alternate:
+        return std::all_of(node.children.begin(), node.children.end(), starts_anchored);
+    case regex_node::repeat:
+        return node.min > 0 && starts_anchored(node.children[0]);
+    default:
+        return false;
+    }
+}
+
+}  // namespace
+
+/**
+ * A DFA over the byte classes of a program, whose states are sets of its
+ * instructions, built as the search reaches them. A set lists the byte
+ * ranges that can match next, the end assertions that are waiting for the
+ * end of the text, and `accept` if the input so far matches, in the order
+ * of their priority, after a word of flags.
+ *
+ * If `_longest` is false, the set is cut after `accept`, since the threads
+ * after it can only find matches that a backtracking engine wouldn't.
+ *
+ * A state is the index of its first transition in `_table`. A transition
+ * to a state that matches, to the dead state, or to the idle state has a tag
+ * in its upper bits, so the search loop only has to look closer at those
+ * and at transitions that haven't been built yet.
+ */
+class lazy_dfa {
+public:
+    static constexpr std::uint32_t unknown = 0xFFFFFFFF;
+    static constexpr std::uint32_t match_tag = std::uint32_t(1) << 31;
+    static constexpr std::uint32_t dead_tag = std::uint32_t(1) << 30;
+    static constexpr std::uint32_t idle_tag = std::uint32_t(1) << 29;
+    static constexpr std::uint32_t special = idle_tag;
+    static constexpr std::uint32_t state_mask = idle_tag - 1;
+
+private:
+    using state_set = std::vector<std::uint32_t>;
+
+    struct set_hash {
+        std::size_t operator()(const state_set& set) const noexcept {
+            std::size_t h = 14695981039346656037ull;
+            for (const auto pc : set) {
+                h = (h ^ pc) * 1099511628211ull;
+            }
+            return h;
+        }
+    };
+
+    // The flags word of a state at the start of the text
+    static constexpr std::uint32_t at_start_flag = 1;
+
+    const regex_program& _program;
+    bool _longest;
+    std::size_t _limit;
+    std::size_t _stride;
+
+    std::unordered_map<state_set, std::uint32_t, set_hash> _ids;
+    std::vector<const state_set*> _sets;
+    std::vector<std::uint8_t> _matches_at_end;
+    std::vector<std::uint32_t> _table;
+    std::size_t _memory = 0;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> _starts;
+    state_set _idle;
+
+    // Scratch space for building sets
+    state_set _next;
+    state_set _eoi;
+    std::vector<std::uint32_t> _stack;
+    std::vector<std::uint32_t> _seen;
+    std::uint32_t _generation = 0;
+
+    void _new_generation() {
+        if (++_generation == 0) {
+            std::fill(_seen.begin(), _seen.end(), 0);
+            _generation = 1;
+        }
+    }
+
+    /**
+     * Add the threads from `pc` to `out`, highest priority first. Returns
+     * false if it stops at `accept`.
+     */
+    bool _add(std::uint32_t pc, bool at_start, bool at_end, state_set& out) {
+        _stack.push_back(pc);
+        while (!_stack.empty()) {
+            pc = _stack.back();
+            _stack.pop_back();
+            if (_seen[pc] == _generation) {
+                continue;
+            }
+            _seen[pc] = _generation;
+            const auto& in = _program.code[pc];
+            switch (in.kind) {
+            case regex_instruction::byte_range:
+                out.push_back(pc);
+                break;
+            case regex_instruction::split:
+                _stack.push_back(in.alt);
+                _stack.push_back(in.next);
+                break;
+            case regex_instruction::assert_start:
+                if (at_start) {
+                    _stack.push_back(in.next);
+                }
+                break;
+            case regex_instruction::assert_end:
+                if (at_end) {
+                    _stack.push_back(in.next);
+                } else {
+                    out.push_back(pc);
+                }
+                break;
+            case regex_instruction::fail:
+                break;
+            case regex_instruction::accept:
+                out.push_back(pc);
+                if (!_longest) {
+                    _stack.clear();
+                    return false;
+                }
+                break;
+            }
+        }
+        return true;
+    }
+
+    bool _is_accept(std::uint32_t pc) const noexcept {
+        return _program.code[pc].kind == regex_instruction::accept;
+    }
+
+    /**
+     * Whether the set matches once the end assertions that it waits on hold
+     */
+    bool _accepts_at_end(const state_set& set) {
+        _new_generation();
+        for (std::size_t i = 1; i < set.size(); ++i) {
+            const auto& in = _program.code[set[i]];
+            if (in.kind == regex_instruction::accept) {
+                return true;
+            }
+            if (in.kind == regex_instruction::assert_end) {
+                _eoi.clear();
+                _add(in.next, (set[0] & at_start_flag) != 0, true, _eoi);
+                if (std::any_of(_eoi.begin(), _eoi.end(), [&](std::uint32_t pc) { return _is_accept(pc); })) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    std::uint32_t _intern(const state_set& set) {
+        const auto found = _ids.find(set);
+        if (found != _ids.end()) {
+            return found->second;
+        }
+        auto id = static_cast<std::uint32_t>(_table.size());
+        if (set.size() == 1) {
+            id |= dead_tag;
+        } else if (std::any_of(set.begin() + 1, set.end(), [&](std::uint32_t pc) { return _is_accept(pc); })) {
+            id |= match_tag;
+        }
+        if (set == _idle) {
+            id |= idle_tag;
+        }
+        const auto inserted = _ids.emplace(set, id).first;
+        _sets.push_back(&inserted->first);
+        _matches_at_end.push_back(_accepts_at_end(set));
+        _table.resize(_table.size() + _stride, unknown);
+        _memory += set.size() * sizeof(std::uint32_t) + _stride * sizeof(std::uint32_t) + 96;
+        return id;
+    }
+
+    bool _full() const noexcept {
+        return _memory > _limit || _table.size() + _stride > state_mask;
+    }
+
+    void _clear() {
+        _ids.clear();
+        _sets.clear();
+        _matches_at_end.clear();
+        _table.clear();
+        _starts.clear();
+        _memory = 0;
+        // The dead state is always the first
+        _intern(state_set(1, 0));
+    }
+
+public:
+    lazy_dfa(const regex_program& program, bool longest, std::size_t limit)
+        : _program(program)
+        , _longest(longest)
+        , _limit(limit)
+        , _stride(program.n_classes)
+        , _seen(program.code.size(), 0) {
+        if (!longest && !program.prefix.empty()) {
+            _new_generation();
+            _idle.assign(1, 0);
+            _add(program.unanchored_start, false, false, _idle);
+        }
+        _clear();
+    }
+
+    const std::uint32_t* table() const noexcept {
+        return _table.data();
+    }
+
+    /**
+     * The state that a search from `pc` starts in, with its tags
+     */
+    std::uint32_t start(std::uint32_t pc, bool at_start) {
+        const auto key = pc * 2 + (at_start ? 1 : 0);
+        for (const auto& entry : _starts) {
+            if (entry.first == key) {
+                return entry.second;
+            }
+        }
+        if (_full()) {
+            _clear();
+        }
+        _new_generation();
+        _next.assign(1, at_start && _program.has_start_assertion ? at_start_flag : 0);
+        _add(pc, at_start, false, _next);
+        const auto id = _intern(_next);
+        _starts.emplace_back(key, id);
+        return id;
+    }
+
+    /**
+     * Build the transition from `state` on `byte`, and return its target
+     * with its tags. If the cache is full, it is cleared, and `state` gets
+     * the new number of its state.
+     */
+    std::uint32_t step(std::uint32_t& state, unsigned char byte) {
+        const auto& from = *_sets[state / _stride];
+        _new_generation();
+        _next.assign(1, 0);
+        for (std::size_t i = 1; i < from.size(); ++i) {
+            const auto& in = _program.code[from[i]];
+            if (in.kind == regex_instruction::byte_range && in.lo <= byte && byte <= in.hi
+                && !_add(in.next, false, false, _next)) {
+                break;
+            }
+        }
+        if (_full()) {
+            const auto current = from;
+            _clear();
+            state = _intern(current) & state_mask;
+        }
+        const auto next = _intern(_next);
+        _table[state + _program.classes[byte]] = next;
+        return next;
+    }
+
+    /**
+     * Whether `state` matches at the end of the text
+     */
+    bool matches_at_end(std::uint32_t state) const noexcept {
+        return _matches_at_end[state / _stride] != 0;
+    }
+};
+
+struct regex_cache {
+    std::mutex mutex;
+    lazy_dfa forward;
+    lazy_dfa reverse;
+
+    explicit regex_cache(const regex_program& program)
+        : forward(program, false, program.cache_limit / 2)
+        , reverse(program, true, program.cache_limit / 2) {}
+};
+
+namespace {
+
+/**
+ * Run the forward DFA from `from`, and find where the leftmost match ends,
+ * or if `earliest`, where the first match to end does. Skips to the
+ * occurrences of the prefix while no match is in progress, until that turns
+ * out not to skip much.
+ */
+bool forward_scan(lazy_dfa& dfa,
+                  const regex_program& program,
+                  const char* first,
+                  const char* from,
+                  const char* last,
+                  bool earliest,
+                  const char*& end) {
+    if (program.anchored && from != first) {
+        return false;
+    }
+    const auto& prefix = program.prefix;
+    std::size_t skips = 0;
+    std::size_t skipped = 0;
+    bool use_prefix = !prefix.empty();
+    bool found = false;
+    const auto classes = program.classes;
+    auto p = from;
+    auto next = dfa.start(program.anchored ? program.forward_start : program.unanchored_start, from == first);
+    auto table = dfa.table();
+    std::uint32_t state = 0;
+    while (true) {
+        if (next & lazy_dfa::dead_tag) {
+            return found;
+        }
+        state = next & lazy_dfa::state_mask;
+        if (next & lazy_dfa::match_tag) {
+            found = true;
+            end = p;
+            if (earliest) {
+                return true;
+            }
+        }
+        if ((next & lazy_dfa::idle_tag) && use_prefix) {
+            const auto q = find_units(p, last, prefix.data(), prefix.size());
+            if (!q) {
+                return found;
+            }
+            ++skips;
+            skipped += static_cast<std::size_t>(q - p);
+            use_prefix = !filter_is_ineffective(skips, skipped);
+            p = q;
+        }
+        while (p != last) {
+            next = table[state + classes[static_cast<unsigned char>(*p)]];
+            if (next >= lazy_dfa::special) {
+                break;
+            }
+            state = next;
+            ++p;
+        }
+        if (p == last) {
+            break;
+        }
+        if (next == lazy_dfa::unknown) {
+            next = dfa.step(state, static_cast<unsigned char>(*p));
+            table = dfa.table();
+        }
+        ++p;
+    }
+    if (dfa.matches_at_end(state)) {
+        found = true;
+        end = last;
+    }
+    return found;
+}
+
+/**
+ * Run the reverse DFA from `match_end` back to `from`, and find the first
+ * position from which the pattern matches up to `match_end`, or null
+ */
+const char* reverse_scan(lazy_dfa& dfa,
+                         const regex_program& program,
+                         const char* first,
+                         const char* from,
+                         const char* match_end,
+                         const char* last) {
+    const char* ret = nullptr;
+    const auto classes = program.classes;
+    auto p = match_end;
+    auto next = dfa.start(program.reverse_start, match_end == last);
+    auto table = dfa.table();
+    std::uint32_t state = 0;
+    while (true) {
+        if (next & lazy_dfa::dead_tag) {
+            return ret;
+        }
+        state = next & lazy_dfa::state_mask;
+        if (next & lazy_dfa::match_tag) {
+            ret = p;
+        }
+        while (p != from) {
+            next = table[state + classes[static_cast<unsigned char>(p[-1])]];
+            if (next >= lazy_dfa::special) {
+                break;
+            }
+            state = next;
+            --p;
+        }
+        if (p == from) {
+            break;
+        }
+        if (next == lazy_dfa::unknown) {
+            next = dfa.step(state, static_cast<unsigned char>(p[-1]));
+            table = dfa.table();
+        }
+        --p;
+    }
+    if (from == first && dfa.matches_at_end(state)) {
+        ret = from;
+    }
+    return ret;
+}
+
+bool lacks_required(const regex_program& program, const char* from, const char* last) noexcept {
+    const auto& required = program.required;
+    return program.prefix.empty() && !required.empty()
+        && !find_units(from, last, required.data(), required.size());
+}
+
+}  // namespace
+
+}  // namespace unicode_detail
+
+regex::regex(const std::u32string& pattern, match how, std::size_t cache_limit) {
+    using namespace unicode_detail;
+    if (how != match::exact && how != match::case_insensitive) {
+        throw std::invalid_argument("A regex can only match exactly or ignoring case");
+    }
+    const auto root = regex_parser(pattern, how == match::case_insensitive).parse();
+
+    auto program = std::make_shared<regex_program>();
+    program->how = how;
+    program->cache_limit = cache_limit;
+    auto& code = program->code;
+    const auto accept = static_cast<std::uint32_t>(code.size());
+    code.emplace_back();
+    code.back().kind = regex_instruction::accept;
+    program->forward_start = regex_compiler(code, false).compile(root, accept);
+    program->reverse_start = regex_compiler(code, true).compile(root, accept);
+    const auto any = static_cast<std::uint32_t>(code.size());
+    code.emplace_back();
+    code.back().kind = regex_instruction::byte_range;
+    code.back().hi = 0xFF;
+    code.back().next = any + 1;
+    code.emplace_back();
+    code.back().kind = regex_instruction::split;
+    code.back().next = program->forward_start;
+    code.back().alt = any;
+    program->unanchored_start = any + 1;
+
+    program->anchored = starts_anchored(root);
+    program->has_start_assertion = std::any_of(code.begin(), code.end(), [](const regex_instruction& in) {
+        return in.kind == regex_instruction::assert_start;
+    });
+    auto info = literals(root);
+    if (!program->anchored) {
+        program->prefix = std::move(info.prefix);
+    }
+    program->required = std::move(info.required);
+
+    bool boundary[257] = {};
+    for (const auto& in : code) {
+        if (in.kind == regex_instruction::byte_range) {
+            boundary[in.lo] = true;
+            boundary[in.hi + 1] = true;
+        }
+    }
+    std::size_t n_classes = 0;
+    for (std::size_t b = 0; b < 256; ++b) {
+        if (b > 0 && boundary[b]) {
+            ++n_classes;
+        }
+        program->classes[b] = static_cast<std::uint8_t>(n_classes);
+    }
+    program->n_classes = n_classes + 1;
+
+    _program = std::move(program);
+    _cache = std::make_unique<regex_cache>(*_program);
+}
+
+regex::regex(const regex& other)
+    : _program(other._program)
+    , _cache(std::make_unique<unicode_detail::regex_cache>(*_program)) {}
+
+regex& regex::operator=(const regex& other) {
+    if (this != &other) {
+        _program = other._program;
+        _cache = std::make_unique<unicode_detail::regex_cache>(*_program);
+    }
+    return *this;
+}
+
+regex::regex(regex&&) noexcept = default;
+regex& regex::operator=(regex&&) noexcept = default;
+regex::~regex() = default;
+
+match regex::how() const noexcept {
+    return _program->how;
+}
+
+unicode_detail::regex_span regex::_search(const char* first, const char* from, const char* last) const {
+    using namespace unicode_detail;
+    regex_span ret;
+    if (lacks_required(*_program, from, last)) {
+        return ret;
+    }
+    std::lock_guard<std::mutex> lock(_cache->mutex);
+    if (!forward_scan(_cache->forward, *_program, first, from, last, false, ret.last)) {
+        return ret;
+    }
+    ret.found = true;
+    ret.first = _program->anchored ? first
+                                   : reverse_scan(_cache->reverse, *_program, first, from, ret.last, last);
+    return ret;
+}
+
+bool regex::_found_in(const char* first, const char* last) const {
+    using namespace unicode_detail;
+    if (lacks_required(*_program, first, last)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(_cache->mutex);
+    const char* end = nullptr;
+    return forward_scan(_cache->forward, *_program, first, first, last, true, end);
+}
+
+bool regex::_matches(const char* first, const char* last) const {
+    using namespace unicode_detail;
+    if (lacks_required(*_program, first, last)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(_cache->mutex);
+    return reverse_scan(_cache->reverse, *_program, first, first, last, last) == first;
+}
+
+}  // namespace neo
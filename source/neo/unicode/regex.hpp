@@ -0,0 +1,233 @@
+#ifndef NEO_UNICODE_REGEX_HPP_INCLUDED
+#define NEO_UNICODE_REGEX_HPP_INCLUDED
+
+#include "search.hpp"
+#include "text.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace neo {
+
+namespace unicode_detail {
+
+struct regex_program;
+struct regex_cache;
+
+/**
+ * Where a regex matched, as UTF-8 code unit pointers
+ */
+struct regex_span {
+    bool found = false;
+    const char* first = nullptr;
+    const char* last = nullptr;
+};
+
+}  // namespace unicode_detail
+
+/**
+ * Thrown for a pattern that a `regex` can't compile
+ */
+class regex_error : public std::runtime_error {
+    std::size_t _offset;
+
+public:
+    regex_error(const std::string& what, std::size_t offset)
+        : std::runtime_error(what)
+        , _offset(offset) {}
+
+    /**
+     * The offset of the problem in the pattern, in code points
+     */
+    std::size_t offset() const noexcept {
+        return _offset;
+    }
+};
+
+/**
+ * A match of a `regex`. If nothing matched, `found` is false and both
+ * iterators are the end of the text.
+ */
+template <typename Iterator> struct regex_match {
+    bool found = false;
+    Iterator first;
+    Iterator last;
+
+    explicit operator bool() const noexcept {
+        return found;
+    }
+};
+
+/**
+ * A regular expression over Unicode text.
+ *
+ * The syntax is the common one: literals, `.` (any code point but a line
+ * feed), classes such as `[a-zà-ÿ]` and `[^\d]`, groups with `(...)` or
+ * `(?:...)`, alternation, the quantifiers `*`, `+`, `?`, `{n}`, `{n,}` and
+ * `{n,m}`, each of which can be followed by `?` to make it lazy, and the
+ * anchors `^` and `\A` for the start of the text and `$` and `\z` for its end.
+ * `\p{Lu}` or `\p{Uppercase_Letter}` matches a general category, and `\P`
+ * the rest. `\d`, `\w` and `\s` are decimal digits, word characters and white
+ * space, all in the Unicode sense. Groups don't capture.
+ *
+ * Ignoring case, a code point matches every code point that case-folds to
+ * the same code points, so `k` matches the Kelvin sign and `ß` matches `ẞ`,
+ * but one code point never matches several, so `ß` doesn't match `ss`.
+ *
+ * A pattern is compiled to an automaton over the bytes of UTF-8, which is
+ * run as a lazy DFA, so the text is never decoded. Its states are built as
+ * they are reached, and kept in a cache of at most `cache_limit` bytes,
+ * which is cleared when it fills up. The search takes time linear in the
+ * text. If every match starts with the same literal, the search skips to
+ * its occurrences, and if every match contains some literal, a text without
+ * it is rejected before the DFA runs.
+ *
+ * A `regex` can be searched from several threads at once, but they take
+ * turns over the cache. A copy shares the compiled pattern but has a cache
+ * of its own, so copy the regex to search in parallel.
+ */
+class regex {
+    std::shared_ptr<const unicode_detail::regex_program> _program;
+    std::unique_ptr<unicode_detail::regex_cache> _cache;
+
+    template <typename Text> static std::u32string _code_points(const Text& text) {
+        std::u32string ret;
+        for (const auto cp : text) {
+            ret.push_back(cp);
+        }
+        return ret;
+    }
+
+    regex(const std::u32string& pattern, match how, std::size_t cache_limit);
+    unicode_detail::regex_span _search(const char* first, const char* from, const char* last) const;
+    bool _found_in(const char* first, const char* last) const;
+    bool _matches(const char* first, const char* last) const;
+
+public:
+    /**
+     * The default size of the DFA cache, in bytes
+     */
+    static constexpr std::size_t default_cache_limit = std::size_t(2) << 20;
+
+    /**
+     * Compile `pattern`, of any encoding. `how` is either `match::exact` or
+     * `match::case_insensitive`. Throws `regex_error` if the pattern is
+     * malformed or too large, and `std::invalid_argument` for any other
+     * `how`.
+     */
+    template <typename Encoding, typename Buffer>
+    explicit regex(const basic_text<Encoding, Buffer>& pattern,
+                   match how = match::exact,
+                   std::size_t cache_limit = default_cache_limit)
+        : regex(_code_points(pattern), how, cache_limit) {}
+
+    template <typename CharPointer,
+              typename = std::enable_if_t<std::is_convertible<CharPointer, const char*>::value>>
+    explicit regex(CharPointer pattern, match how = match::exact, std::size_t cache_limit = default_cache_limit)
+        : regex(basic_text<utf8>(pattern), how, cache_limit) {}
+
+    /**
+     * A copy shares the compiled pattern, but not the cache
+     */
+    regex(const regex& other);
+    regex& operator=(const regex& other);
+    regex(regex&&) noexcept;
+    regex& operator=(regex&&) noexcept;
+    ~regex();
+
+    /**
+     * How the pattern is compared with a text
+     */
+    match how() const noexcept;
+
+    /**
+     * Find the leftmost match that starts at or after `from`. Among the
+     * matches that start there, the one found is the one that a backtracking
+     * engine would find: alternatives are tried from left to right, greedy
+     * quantifiers take as much as they can and lazy ones as little.
+     */
+    template <typename Buffer>
+    regex_match<typename basic_text<utf8, Buffer>::iterator>
+    search(const basic_text<utf8, Buffer>& text, typename basic_text<utf8, Buffer>::iterator from) const {
+        using iterator = typename basic_text<utf8, Buffer>::iterator;
+        const auto first = text.data();
+        const auto last = first + text.code_unit_size();
+        const auto found = _search(first, from.position(), last);
+        if (!found.found) {
+            return {false, text.end(), text.end()};
+        }
+        return {true, iterator(first, found.first, last), iterator(first, found.last, last)};
+    }
+
+    template <typename Buffer>
+    regex_match<typename basic_text<utf8, Buffer>::iterator> search(const basic_text<utf8, Buffer>& text) const {
+        return search(text, text.begin());
+    }
+
+    /**
+     * Call `fn` with a `regex_match` for every match in `text` from left to
+     * right, without overlaps. After an empty match, the next search starts
+     * one code point later. If `fn` returns a value, the scan stops once it
+     * returns false.
+     */
+    template <typename Buffer, typename Func>
+    void for_each_match(const basic_text<utf8, Buffer>& text, Func&& fn) const {
+        using iterator = typename basic_text<utf8, Buffer>::iterator;
+        const auto first = text.data();
+        const auto last = first + text.code_unit_size();
+        auto from = first;
+        while (true) {
+            const auto found = _search(first, from, last);
+            if (!found.found) {
+                return;
+            }
+            if (!unicode_detail::keep_going(fn,
+                                            regex_match<iterator>{true,
+                                                                  iterator(first, found.first, last),
+                                                                  iterator(first, found.last, last)})) {
+                return;
+            }
+            from = found.last;
+            if (found.first == found.last) {
+                if (from == last) {
+                    return;
+                }
+                decoder<utf8>::next(from, last);
+            }
+        }
+    }
+
+    /**
+     * Get every match in `text`. See `for_each_match()`.
+     */
+    template <typename Buffer>
+    std::vector<regex_match<typename basic_text<utf8, Buffer>::iterator>>
+    find_all(const basic_text<utf8, Buffer>& text) const {
+        std::vector<regex_match<typename basic_text<utf8, Buffer>::iterator>> ret;
+        for_each_match(text, [&](const auto& m) { ret.push_back(m); });
+        return ret;
+    }
+
+    /**
+     * Check whether the pattern matches anywhere in `text`. The scan stops
+     * at the first position where some match ends.
+     */
+    template <typename Buffer> bool found_in(const basic_text<utf8, Buffer>& text) const {
+        return _found_in(text.data(), text.data() + text.code_unit_size());
+    }
+
+    /**
+     * Check whether the pattern matches the whole of `text`
+     */
+    template <typename Buffer> bool matches(const basic_text<utf8, Buffer>& text) const {
+        return _matches(text.data(), text.data() + text.code_unit_size());
+    }
+};
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_REGEX_HPP_INCLUDED
@@ -0,0 +1,285 @@
+#ifndef NEO_UNICODE_REPERTOIRE_HPP_INCLUDED
+#define NEO_UNICODE_REPERTOIRE_HPP_INCLUDED
+
+#include "concepts.hpp"
+#include "simd.hpp"
+
+#include <cinttypes>
+#include <cstddef>
+#include <utility>
+
+namespace neo {
+
+/**
+ * The smallest character repertoire that covers the contents of a code unit
+ * sequence. The enumerators are ordered from the smallest repertoire to the
+ * largest.
+ *
+ * For UTF-8 data only `ascii`, `latin1` and `any` are reported, and `latin1`
+ * is only reported if the data is also well-formed. For 16 and 32-bit code
+ * units the classification is made on the code unit values, in host byte
+ * order.
+ */
+enum class repertoire : unsigned char {
+    /// Every code point is below U+0080
+    ascii,
+    /// Every code point is below U+0100
+    latin1,
+    /// Every code point is in the Basic Multilingual Plane, and there are no
+    /// surrogate code units
+    bmp,
+    /// Anything at all
+    any,
+};
+
+namespace unicode_detail {
+
+/**
+ * Classify a UTF-8 code unit sequence.
+ */
+inline repertoire classify(const char* ptr, std::size_t size) noexcept {
+    auto p = reinterpret_cast<const unsigned char*>(ptr);
+    const auto end = p + size;
+    // The largest byte decides between the repertoires: Anything above 0xC3
+    // is the lead byte of a code point beyond U+00FF.
+    unsigned max = 0;
+#if NEO_UNICODE_HAVE_SSE2
+    auto acc = _mm_setzero_si128();
+    for (; end - p >= 16; p += 16) {
+        acc = _mm_max_epu8(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    }
+    if (_mm_movemask_epi8(acc)) {
+        const auto above_latin1 = _mm_subs_epu8(acc, _mm_set1_epi8(static_cast<char>(0xC3)));
+        const auto zero = _mm_setzero_si128();
+        max = _mm_movemask_epi8(_mm_cmpeq_epi8(above_latin1, zero)) == 0xFFFF ? 0xC3 : 0xFF;
+    }
+#endif
+    for (; p != end; ++p) {
+        max = *p > max ? *p : max;
+    }
+    if (max < 0x80) {
+        return repertoire::ascii;
+    } else if (max > 0xC3) {
+        return repertoire::any;
+    }
+    // Only U+0080 through U+00FF can appear. Check that they are well-formed.
+    p = reinterpret_cast<const unsigned char*>(ptr);
+    while (p != end) {
+        const auto b = *p++;
+        if (b < 0x80) {
+            continue;
+        }
+        if (b < 0xC2 || p == end || (*p & 0xC0) != 0x80) {
+            return repertoire::any;
+        }
+        ++p;
+    }
+    return repertoire::latin1;
+}
+
+/**
+ * Classify a UTF-16 code unit sequence.
+ */
+inline repertoire classify(const char16_t* p, std::size_t size) noexcept {
+    const auto end = p + size;
+    std::uint16_t bits = 0;
+    bool surrogates = false;
+#if NEO_UNICODE_HAVE_SSE2
+    auto acc = _mm_setzero_si128();
+    auto surr = _mm_setzero_si128();
+    const auto surr_mask = _mm_set1_epi16(static_cast<short>(0xF800));
+    const auto surr_value = _mm_set1_epi16(static_cast<short>(0xD800));
+    for (; end - p >= 8; p += 8) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        acc = _mm_or_si128(acc, v);
+        surr = _mm_or_si128(surr, _mm_cmpeq_epi16(_mm_and_si128(v, surr_mask), surr_value));
+    }
+    alignas(16) std::uint16_t lanes[8];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    for (auto lane : lanes) {
+        bits |= lane;
+    }
+    surrogates = _mm_movemask_epi8(surr) != 0;
+#endif
+    for (; p != end; ++p) {
+        bits |= static_cast<std::uint16_t>(*p);
+        surrogates = surrogates || (*p & 0xF800) == 0xD800;
+    }
+    if (surrogates) {
+        return repertoire::any;
+    }
+    return bits < 0x80 ? repertoire::ascii : bits < 0x100 ? repertoire::latin1 : repertoire::bmp;
+}
+
+/**
+ * Classify a UTF-32 code unit sequence.
+ */
+inline repertoire classify(const char32_t* p, std::size_t size) noexcept {
+    const auto end = p + size;
+    std::uint32_t bits = 0;
+#if NEO_UNICODE_HAVE_SSE2
+    auto acc = _mm_setzero_si128();
+    for (; end - p >= 4; p += 4) {
+        acc = _mm_or_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    }
+    alignas(16) std::uint32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    bits = lanes[0] | lanes[1] | lanes[2] | lanes[3];
+#endif
+    for (; p != end; ++p) {
+        bits |= static_cast<std::uint32_t>(*p);
+    }
+    return bits < 0x80
+        ? repertoire::ascii
+        : bits < 0x100 ? repertoire::latin1 : bits < 0x10000 ? repertoire::bmp : repertoire::any;
+}
+
+/**
+ * Classify a `wchar_t` sequence as whichever of UTF-16 or UTF-32 fits it.
+ */
+inline repertoire classify(const wchar_t* p, std::size_t size) noexcept {
+    using unit = std::conditional_t<sizeof(wchar_t) == 2, char16_t, char32_t>;
+    return classify(reinterpret_cast<const unit*>(p), size);
+}
+
+/**
+ * Code units of any other type have no known encoding.
+ */
+template <typename T> repertoire classify(const T*, std::size_t) noexcept {
+    return repertoire::any;
+}
+
+/**
+ * Whether classifying the code units of `Encoding` in host byte order gives
+ * the repertoire of the text. It doesn't if they are stored byte-swapped.
+ */
+template <typename Encoding> struct classified_in_host_order : std::true_type {};
+
+/**
+ * Whether code units of `Encoding` below 0x80 are ASCII code points, as the
+ * shortcuts that skip ASCII without decoding it assume: an ASCII code point
+ * must be one code unit with its own value, and every other code unit must be
+ * at least 0x80. That holds for all of the encodings here, unless their code
+ * units are byte-swapped.
+ */
+template <typename Encoding>
+struct ascii_code_units : classified_in_host_order<Encoding> {};
+
+template <typename T> using repertoire_t = decltype(std::declval<const T&>().repertoire());
+
+/**
+ * Get the repertoire of a buffer, or `repertoire::any` if the buffer type
+ * doesn't track it.
+ */
+template <typename Buffer,
+          typename = std::enable_if_t<is_detected_v<repertoire_t, Buffer>>>
+repertoire repertoire_of(const Buffer& buf) noexcept {
+    return buf.repertoire();
+}
+
+template <typename Buffer,
+          typename = std::enable_if_t<!is_detected_v<repertoire_t, Buffer>>,
+          typename = void>
+repertoire repertoire_of(const Buffer&) noexcept {
+    return repertoire::any;
+}
+
+/**
+ * Widen ASCII bytes to code units of type `Unit`.
+ */
+template <typename Unit> void widen_ascii(const char* in, std::size_t size, Unit* out) noexcept {
+    const auto end = in + size;
+#if NEO_UNICODE_HAVE_SSE2
+    const auto zero = _mm_setzero_si128();
+    for (; end - in >= 16; in += 16, out += 16) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        const auto lo = _mm_unpacklo_epi8(v, zero);
+        const auto hi = _mm_unpackhi_epi8(v, zero);
+        const auto dest = reinterpret_cast<__m128i*>(out);
+        if (sizeof(Unit) == 2) {
+            _mm_storeu_si128(dest + 0, lo);
+            _mm_storeu_si128(dest + 1, hi);
+        } else if (sizeof(Unit) == 4) {
+            _mm_storeu_si128(dest + 0, _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128(dest + 1, _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128(dest + 2, _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128(dest + 3, _mm_unpackhi_epi16(hi, zero));
+        } else {
+            break;
+        }
+    }
+#endif
+    for (; in != end; ++in, ++out) {
+        *out = static_cast<Unit>(static_cast<unsigned char>(*in));
+    }
+}
+
+/**
+ * Narrow ASCII code units of type `Unit` to bytes.
+ */
+template <typename Unit> void narrow_ascii(const Unit* in, std::size_t size, char* out) noexcept {
+    const auto end = in + size;
+#if NEO_UNICODE_HAVE_SSE2
+    for (; end - in >= 16; in += 16, out += 16) {
+        const auto src = reinterpret_cast<const __m128i*>(in);
+        __m128i packed;
+        if (sizeof(Unit) == 2) {
+            packed = _mm_packus_epi16(_mm_loadu_si128(src), _mm_loadu_si128(src + 1));
+        } else if (sizeof(Unit) == 4) {
+            const auto lo = _mm_packs_epi32(_mm_loadu_si128(src), _mm_loadu_si128(src + 1));
+            const auto hi = _mm_packs_epi32(_mm_loadu_si128(src + 2), _mm_loadu_si128(src + 3));
+            packed = _mm_packus_epi16(lo, hi);
+        } else {
+            break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+    }
+#endif
+    for (; in != end; ++in, ++out) {
+        *out = static_cast<char>(*in);
+    }
+}
+
+/**
+ * The number of code points in well-formed UTF-8 of the `latin1` repertoire.
+ */
+inline std::size_t latin1_utf8_length(const char* in, std::size_t size) noexcept {
+    // Every two-byte sequence has one lead byte of 0xC2 or 0xC3
+    std::size_t n_leads = 0;
+    for (auto p = in; p != in + size; ++p) {
+        n_leads += static_cast<unsigned char>(*p) >= 0xC2;
+    }
+    return size - n_leads;
+}
+
+/**
+ * Decode well-formed UTF-8 of the `latin1` repertoire to code units of type
+ * `Unit`.
+ */
+template <typename Unit> void widen_latin1(const char* in, std::size_t size, Unit* out) noexcept {
+    auto p = reinterpret_cast<const unsigned char*>(in);
+    const auto end = p + size;
+    while (p != end) {
+#if NEO_UNICODE_HAVE_SSE2
+        if (end - p >= 16
+            && !_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))) {
+            widen_ascii(reinterpret_cast<const char*>(p), 16, out);
+            p += 16;
+            out += 16;
+            continue;
+        }
+#endif
+        const unsigned b = *p++;
+        if (b < 0x80) {
+            *out++ = static_cast<Unit>(b);
+        } else {
+            *out++ = static_cast<Unit>(((b & 0x03) << 6) | (*p++ & 0x3F));
+        }
+    }
+}
+
+}  // namespace unicode_detail
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_REPERTOIRE_HPP_INCLUDED
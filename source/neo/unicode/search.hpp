@@ -0,0 +1,787 @@
+#ifndef NEO_UNICODE_SEARCH_HPP_INCLUDED
+#define NEO_UNICODE_SEARCH_HPP_INCLUDED
+
+#include "case_fold.hpp"
+#include "counting.hpp"
+#include "encodings/all.hpp"
+#include "normalize.hpp"
+#include "repertoire.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace neo {
+
+/**
+ * How a search compares the needle with the text
+ */
+enum class match {
+    /// Code unit for code unit
+    exact,
+    /// Under Unicode full case folding, so "STRASSE" matches "straße"
+    case_insensitive,
+    /// Up to canonical equivalence, so "é" matches "e" followed by U+0301
+    canonical,
+    /// Up to compatibility equivalence, as after NFKC or NFKD, so "ﬁ" matches
+    /// "fi" and "²" matches "2"
+    compatible,
+};
+
+namespace unicode_detail {
+
+template <typename Unit> std::uint32_t unit_value(Unit u) noexcept {
+    return static_cast<std::uint32_t>(static_cast<std::make_unsigned_t<Unit>>(u));
+}
+
+template <typename Unit> bool units_equal(const Unit* a, const Unit* b, std::size_t n) noexcept {
+    return std::memcmp(a, b, n * sizeof(Unit)) == 0;
+}
+
+#if NEO_UNICODE_HAVE_SSE2
+/**
+ * Mask of the positions in the block at `p` where the first and the last code
+ * unit of a needle of length `m` both match.
+ */
+template <typename Unit>
+std::uint32_t candidate_mask(const Unit* p, std::size_t m, __m128i head, __m128i tail) noexcept {
+    using lanes = unit_lanes<sizeof(Unit)>;
+    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + m - 1));
+    const auto both = _mm_and_si128(lanes::eq(a, head), lanes::eq(b, tail));
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(both)) & lanes::lane_bits;
+}
+#endif
+
+/**
+ * Needles at least this long fall back to the Two-Way algorithm when the
+ * candidate filter stops paying off. For shorter needles, a false candidate
+ * is never expensive to reject.
+ */
+constexpr std::size_t long_needle_size = 32;
+
+/**
+ * Whether the candidate filter should give up after `misses` false candidates
+ * in a stretch of `scanned` code units: once there is a candidate in every
+ * few code units, the filter no longer skips anything.
+ */
+inline bool filter_is_ineffective(std::size_t misses, std::size_t scanned) noexcept {
+    return misses > 64 && misses * 8 > scanned;
+}
+
+/**
+ * Find the first occurrence of the `m` code units at `needle` in [first,
+ * last). Two blocks of the haystack at a time are compared against the first
+ * and the last code unit of the needle, and only positions where both match
+ * are compared in full.
+ *
+ * If `gave_up` isn't null and too many candidates turn out to be false, this
+ * stops, points `gave_up` where the search should resume, and returns null.
+ */
+template <typename Unit>
+const Unit* find_units_filtered(const Unit* first,
+                                const Unit* last,
+                                const Unit* needle,
+                                std::size_t m,
+                                const Unit** gave_up) noexcept {
+    auto p = first;
+#if NEO_UNICODE_HAVE_SSE2
+    using lanes = unit_lanes<sizeof(Unit)>;
+    constexpr std::size_t width = 16 / sizeof(Unit);
+    const auto head = lanes::splat(unit_value(needle[0]));
+    const auto tail = lanes::splat(unit_value(needle[m - 1]));
+    std::size_t misses = 0;
+    while (static_cast<std::size_t>(last - p) >= m - 1 + 2 * width) {
+        auto mask = candidate_mask(p, m, head, tail) | (candidate_mask(p + width, m, head, tail) << 16);
+        for (; mask; mask &= mask - 1) {
+            const auto cand = p + count_trailing_zeros(mask) / sizeof(Unit);
+            if (m <= 2 || units_equal(cand + 1, needle + 1, m - 2)) {
+                return cand;
+            }
+            if (gave_up && filter_is_ineffective(++misses, static_cast<std::size_t>(cand - first))) {
+                *gave_up = cand + 1;
+                return nullptr;
+            }
+        }
+        p += 2 * width;
+    }
+#else
+    (void)gave_up;
+#endif
+    for (; static_cast<std::size_t>(last - p) >= m; ++p) {
+        if (*p == *needle && units_equal(p, needle, m)) {
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Like `find_units_filtered()`, but finds the last occurrence. If it gives
+ * up, the search should resume with the matches that start before
+ * `*gave_up`.
+ */
+template <typename Unit>
+const Unit* rfind_units_filtered(const Unit* first,
+                                 const Unit* last,
+                                 const Unit* needle,
+                                 std::size_t m,
+                                 const Unit** gave_up) noexcept {
+    const auto size = static_cast<std::size_t>(last - first);
+    if (size < m) {
+        return nullptr;
+    }
+    // The candidates not yet looked at start in [first, first + n_left)
+    auto n_left = size - m + 1;
+#if NEO_UNICODE_HAVE_SSE2
+    using lanes = unit_lanes<sizeof(Unit)>;
+    constexpr std::size_t width = 16 / sizeof(Unit);
+    const auto head = lanes::splat(unit_value(needle[0]));
+    const auto tail = lanes::splat(unit_value(needle[m - 1]));
+    std::size_t misses = 0;
+    for (; n_left >= 2 * width; n_left -= 2 * width) {
+        const auto block = first + (n_left - 2 * width);
+        auto mask = candidate_mask(block, m, head, tail)
+            | (candidate_mask(block + width, m, head, tail) << 16);
+        while (mask) {
+            const auto bit = highest_set_bit(mask);
+            const auto cand = block + bit / sizeof(Unit);
+            if (m <= 2 || units_equal(cand + 1, needle + 1, m - 2)) {
+                return cand;
+            }
+            if (gave_up && filter_is_ineffective(++misses, static_cast<std::size_t>(last - cand))) {
+                *gave_up = cand;
+                return nullptr;
+            }
+            mask &= ~(std::uint32_t(1) << bit);
+        }
+    }
+#else
+    (void)gave_up;
+#endif
+    while (n_left) {
+        const auto p = first + --n_left;
+        if (*p == *needle && units_equal(p, needle, m)) {
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+constexpr std::size_t no_match = static_cast<std::size_t>(-1);
+
+/**
+ * A sequence of code units read back to front, from the one before `end`
+ */
+template <typename Unit> struct reversed_units {
+    const Unit* end;
+
+    Unit operator[](std::size_t i) const noexcept {
+        return *(end - 1 - i);
+    }
+};
+
+/**
+ * Crochemore and Perrin's Two-Way algorithm, which takes linear time and
+ * constant space no matter how repetitive the needle and the haystack are.
+ * `Units` is a pointer, or `reversed_units` to find the last occurrence.
+ * Returns the offset of the first match, or `no_match`.
+ *
+ * A table of 256 shifts on the low byte of the haystack's code unit under
+ * the end of the needle skips ahead where that code unit can't be part of a
+ * match. Code units that share a low byte share the smallest shift.
+ */
+template <typename Units>
+std::size_t two_way_search(Units hay, std::size_t n, Units needle, std::size_t m) noexcept {
+    // Find the critical factorization of the needle: the maximal suffix for
+    // both orderings of the code units, and the period of the needle
+    std::size_t ms = 0;
+    std::size_t period = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        std::size_t ip = no_match;
+        std::size_t jp = 0;
+        std::size_t k = 1;
+        std::size_t p = 1;
+        while (jp + k < m) {
+            const auto a = unit_value(needle[ip + k]);
+            const auto b = unit_value(needle[jp + k]);
+            if (a == b) {
+                if (k == p) {
+                    jp += p;
+                    k = 1;
+                } else {
+                    ++k;
+                }
+            } else if ((a > b) == (pass == 0)) {
+                jp += k;
+                k = 1;
+                p = jp - ip;
+            } else {
+                ip = jp++;
+                k = p = 1;
+            }
+        }
+        if (pass == 0 || ip + 1 > ms + 1) {
+            ms = ip;
+            period = p;
+        }
+    }
+
+    bool periodic = true;
+    for (std::size_t i = 0; i < ms + 1; ++i) {
+        if (needle[i] != needle[i + period]) {
+            periodic = false;
+            break;
+        }
+    }
+    std::size_t mem0 = 0;
+    if (periodic) {
+        mem0 = m - period;
+    } else {
+        period = std::max(ms, m - ms - 1) + 1;
+    }
+
+    std::size_t shift[256] = {};
+    for (std::size_t i = 0; i < m; ++i) {
+        shift[unit_value(needle[i]) & 0xFF] = i + 1;
+    }
+
+    std::size_t mem = 0;
+    for (std::size_t pos = 0; n - pos >= m;) {
+        auto k = m - shift[unit_value(hay[pos + m - 1]) & 0xFF];
+        if (k) {
+            pos += std::max(k, mem);
+            mem = 0;
+            continue;
+        }
+        // Compare the right half, then the left half
+        for (k = std::max(ms + 1, mem); k < m && needle[k] == hay[pos + k]; ++k) {
+        }
+        if (k < m) {
+            pos += k - ms;
+            mem = 0;
+            continue;
+        }
+        for (k = ms + 1; k > mem && needle[k - 1] == hay[pos + k - 1]; --k) {
+        }
+        if (k <= mem) {
+            return pos;
+        }
+        pos += period;
+        mem = mem0;
+    }
+    return no_match;
+}
+
+/**
+ * Find the first occurrence of a non-empty needle in [first, last), or null
+ */
+template <typename Unit>
+const Unit* find_units(const Unit* first, const Unit* last, const Unit* needle, std::size_t m) noexcept {
+    if (sizeof(Unit) == 1 && m == 1) {
+        return static_cast<const Unit*>(
+            std::memchr(first, static_cast<int>(*needle), static_cast<std::size_t>(last - first)));
+    }
+    if (m < long_needle_size) {
+        return find_units_filtered<Unit>(first, last, needle, m, nullptr);
+    }
+    const Unit* resume = nullptr;
+    if (const auto p = find_units_filtered(first, last, needle, m, &resume)) {
+        return p;
+    }
+    if (!resume) {
+        return nullptr;
+    }
+    const auto i = two_way_search(resume, static_cast<std::size_t>(last - resume), needle, m);
+    return i == no_match ? nullptr : resume + i;
+}
+
+/**
+ * Find the last occurrence of a non-empty needle in [first, last), or null
+ */
+template <typename Unit>
+const Unit* rfind_units(const Unit* first, const Unit* last, const Unit* needle, std::size_t m) noexcept {
+    if (m < long_needle_size) {
+        return rfind_units_filtered<Unit>(first, last, needle, m, nullptr);
+    }
+    const Unit* resume = nullptr;
+    if (const auto p = rfind_units_filtered(first, last, needle, m, &resume)) {
+        return p;
+    }
+    if (!resume) {
+        return nullptr;
+    }
+    // The matches left to look at end before `hay_end`
+    const auto hay_end = resume + m - 1;
+    const auto i = two_way_search(reversed_units<Unit>{hay_end},
+                                  static_cast<std::size_t>(hay_end - first),
+                                  reversed_units<Unit>{needle + m},
+                                  m);
+    return i == no_match ? nullptr : hay_end - i - m;
+}
+
+/**
+ * Check that the code units [match, match_end) of a text in [first, last)
+ * start and end on code point boundaries. A well-formed needle can only fail
+ * this in malformed text, or for encodings where one code unit sequence can
+ * be the tail of another.
+ */
+template <typename Encoding, typename Unit>
+bool on_code_point_boundaries(const Unit* first, const Unit* match, const Unit* match_end, const Unit* last) noexcept {
+    using counter = code_point_counter<Encoding>;
+    return counter::starts_code_point(first, match)
+        && (match_end == last || counter::starts_code_point(first, match_end));
+}
+
+/**
+ * Find the first occurrence of the `m` code units at `needle` in [first, last)
+ * that starts and ends on code point boundaries of `Encoding`. Returns
+ * `first` for an empty needle, and null if there is no match.
+ */
+template <typename Encoding, typename Unit>
+const Unit* find_text(const Unit* first, const Unit* last, const Unit* needle, std::size_t m) noexcept {
+    if (m == 0) {
+        return first;
+    }
+    auto from = first;
+    while (const auto p = find_units(from, last, needle, m)) {
+        if (on_code_point_boundaries<Encoding>(first, p, p + m, last)) {
+            return p;
+        }
+        from = p + 1;
+    }
+    return nullptr;
+}
+
+/**
+ * Like `find_text()`, but finds the last occurrence. Returns `last` for an
+ * empty needle.
+ */
+template <typename Encoding, typename Unit>
+const Unit* rfind_text(const Unit* first, const Unit* last, const Unit* needle, std::size_t m) noexcept {
+    if (m == 0) {
+        return last;
+    }
+    const auto text_end = last;
+    while (const auto p = rfind_units(first, last, needle, m)) {
+        if (on_code_point_boundaries<Encoding>(first, p, p + m, text_end)) {
+            return p;
+        }
+        // Only matches that start before `p` are left
+        last = p + m - 1;
+    }
+    return nullptr;
+}
+
+/**
+ * Count the non-overlapping occurrences of a non-empty needle that
+ * `find_text()` would find, from left to right.
+ */
+template <typename Encoding, typename Unit>
+std::size_t count_text(const Unit* first, const Unit* last, const Unit* needle, std::size_t m) noexcept {
+    std::size_t n = 0;
+    while (const auto p = find_text<Encoding>(first, last, needle, m)) {
+        ++n;
+        first = p + m;
+    }
+    return n;
+}
+
+/**
+ * An array of `n` elements that lives inside the object for up to `N`
+ * elements, and on the heap beyond that.
+ */
+template <typename T, std::size_t N> class small_array {
+    T _local[N];
+    std::unique_ptr<T[]> _heap;
+    T* _data;
+
+public:
+    explicit small_array(std::size_t n)
+        : _heap(n > N ? new T[n] : nullptr)
+        , _data(n > N ? _heap.get() : _local) {
+    }
+
+    small_array(const small_array&) = delete;
+    small_array& operator=(const small_array&) = delete;
+
+    T& operator[](std::size_t i) noexcept {
+        return _data[i];
+    }
+    const T& operator[](std::size_t i) const noexcept {
+        return _data[i];
+    }
+};
+
+/**
+ * Skip the code units in [p, last) that are below 0x80 and are neither `a`
+ * nor `b`. Those are ASCII code points, which fold to themselves or to
+ * another ASCII code point.
+ */
+template <typename Unit>
+const Unit* skip_ascii_except(const Unit* p, const Unit* last, Unit a, Unit b) noexcept {
+#if NEO_UNICODE_HAVE_SSE2
+    using lanes = unit_lanes<sizeof(Unit)>;
+    constexpr std::size_t width = 16 / sizeof(Unit);
+    const auto va = lanes::splat(static_cast<std::uint32_t>(a));
+    const auto vb = lanes::splat(static_cast<std::uint32_t>(b));
+    while (last - p >= static_cast<std::ptrdiff_t>(width)) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const auto wanted = _mm_or_si128(lanes::eq(v, va), lanes::eq(v, vb));
+        const auto skip = static_cast<std::uint32_t>(
+                              _mm_movemask_epi8(_mm_andnot_si128(wanted, lanes::ascii(v))))
+            & lanes::lane_bits;
+        if (skip != lanes::lane_bits) {
+            return p + count_trailing_zeros(~skip & lanes::lane_bits) / sizeof(Unit);
+        }
+        p += width;
+    }
+#endif
+    for (; p != last; ++p) {
+        const auto u = *p;
+        if (u == a || u == b || static_cast<std::make_unsigned_t<Unit>>(u) >= 0x80) {
+            break;
+        }
+    }
+    return p;
+}
+
+/**
+ * Knuth-Morris-Pratt over a stream of code points. The code points come from
+ * a text after some transformation, such as case folding, so a match is
+ * only reported where it starts and ends on code point boundaries of the
+ * text.
+ *
+ * The pattern lives inside the matcher for up to `inline_size` code points.
+ */
+template <typename Unit> class code_point_matcher {
+public:
+    static constexpr std::size_t inline_size = 64;
+
+private:
+    std::size_t _size;
+    small_array<char32_t, inline_size> _pattern;
+    // _fail[i] is the length of the longest proper border of _pattern[0..i]
+    small_array<std::size_t, inline_size> _fail;
+    // Where in the text each of the last `_size` code points starts, or null
+    // if that isn't a code point boundary of the text. It is a ring, and
+    // `_slot` is the oldest entry.
+    small_array<const Unit*, inline_size> _origins;
+    std::size_t _slot = 0;
+    std::size_t _matched = 0;
+
+public:
+    /**
+     * Construct a matcher for `size` code points, which `fill(out)` writes
+     * to `out`.
+     */
+    template <typename Fill>
+    code_point_matcher(std::size_t size, Fill&& fill)
+        : _size(size)
+        , _pattern(size)
+        , _fail(size)
+        , _origins(size) {
+        if (_size == 0) {
+            return;
+        }
+        fill(&_pattern[0]);
+        _fail[0] = 0;
+        for (std::size_t i = 1, k = 0; i < _size; ++i) {
+            while (k && _pattern[i] != _pattern[k]) {
+                k = _fail[k - 1];
+            }
+            if (_pattern[i] == _pattern[k]) {
+                ++k;
+            }
+            _fail[i] = k;
+        }
+    }
+
+    std::size_t size() const noexcept {
+        return _size;
+    }
+
+    const char32_t& operator[](std::size_t i) const noexcept {
+        return _pattern[i];
+    }
+
+    /**
+     * Check that no partial match is in progress
+     */
+    bool idle() const noexcept {
+        return _matched == 0;
+    }
+
+    void reset() noexcept {
+        _matched = 0;
+    }
+
+    /**
+     * Feed the next code point of the stream. `origin` is where it starts in
+     * the text, if that is a code point boundary, and `can_end` says whether
+     * it ends on one. Returns the start of a match that ends with this code
+     * point, or null. The pattern must not be empty.
+     */
+    const Unit* feed(char32_t c, const Unit* origin, bool can_end) noexcept {
+        while (_matched && _pattern[_matched] != c) {
+            _matched = _fail[_matched - 1];
+        }
+        if (_pattern[_matched] == c) {
+            ++_matched;
+        }
+        _origins[_slot] = origin;
+        _slot = _slot + 1 == _size ? 0 : _slot + 1;
+        if (_matched != _size) {
+            return nullptr;
+        }
+        _matched = _fail[_size - 1];
+        // The ring is full, so the oldest entry is the start of the match
+        return can_end ? _origins[_slot] : nullptr;
+    }
+};
+
+/**
+ * Finds a needle in a text under full case folding. The needle is folded
+ * once, and the text is folded one code point at a time while it is
+ * searched, so the search is linear in the size of the text.
+ *
+ * A match starts and ends on code point boundaries of the text: a code point
+ * that folds to several code points matches all of them or none, so "s" is
+ * not found in "ß", which folds to "ss", but "SS" is.
+ */
+template <typename Encoding> class case_insensitive_searcher {
+public:
+    using unit = typename Encoding::code_unit_type;
+
+private:
+    using decoder_type = decoder<Encoding>;
+
+    static std::size_t _folded_size(const unit* p, const unit* last) noexcept {
+        std::size_t n = 0;
+        char32_t folded[max_case_fold_size];
+        while (p != last) {
+            n += fold_case(decoder_type::next(p, last), folded);
+        }
+        return n;
+    }
+
+    code_point_matcher<unit> _matcher;
+    unit _first_lower = 0x80;
+    unit _first_upper = 0x80;
+
+public:
+    case_insensitive_searcher(const unit* needle, const unit* needle_end)
+        : _matcher(_folded_size(needle, needle_end), [&](char32_t* out) {
+            while (needle != needle_end) {
+                out += fold_case(decoder_type::next(needle, needle_end), out);
+            }
+        }) {
+        // Only ASCII code points fold to an ASCII code point, apart from
+        // KELVIN SIGN and friends, which are not ASCII in the text
+        if (_matcher.size() && _matcher[0] < 0x80) {
+            _first_lower = static_cast<unit>(_matcher[0]);
+            _first_upper = static_cast<unit>(
+                (_matcher[0] - U'a' < 26) ? _matcher[0] - 0x20 : _matcher[0]);
+        }
+    }
+
+    /**
+     * Find the first match in [p, last), which must start on a code point
+     * boundary. Returns the bounds of the match in the text, or a pair of
+     * nulls. An empty needle matches at `p`.
+     */
+    std::pair<const unit*, const unit*> search(const unit* p, const unit* last) noexcept {
+        if (_matcher.size() == 0) {
+            return {p, p};
+        }
+        _matcher.reset();
+        while (p != last) {
+            if (_matcher.idle() && ascii_code_units<Encoding>::value) {
+                p = skip_ascii_except(p, last, _first_lower, _first_upper);
+                if (p == last) {
+                    break;
+                }
+            }
+            const auto origin = p;
+            char32_t folded[max_case_fold_size];
+            const auto n_folded = fold_case(decoder_type::next(p, last), folded);
+            for (std::size_t i = 0; i < n_folded; ++i) {
+                const auto start = _matcher.feed(folded[i], i == 0 ? origin : nullptr, i + 1 == n_folded);
+                if (start) {
+                    return {start, p};
+                }
+            }
+        }
+        return {nullptr, nullptr};
+    }
+};
+
+/**
+ * Finds a needle in a text up to canonical equivalence, so that "é" matches
+ * both U+00E9 and "e" followed by U+0301. The needle is decomposed to NFD
+ * once, and the text is decomposed one segment at a time while it is
+ * searched, so the search is linear in the size of the text and doesn't
+ * allocate.
+ *
+ * A match starts and ends on segment boundaries, so it never splits a
+ * combining sequence: "e" is not found in "é". A needle that starts with a
+ * non-starter never matches. Runs of ASCII, which decomposes to itself, are
+ * skipped without being decomposed.
+ *
+ * If it is `compatible`, the needle and the text are decomposed to NFKD
+ * instead, and the needle is found up to compatibility equivalence.
+ */
+template <typename Encoding> class canonical_searcher {
+public:
+    using unit = typename Encoding::code_unit_type;
+
+private:
+    static std::size_t _decomposed_size(const unit* p, const unit* last, bool compatible) noexcept {
+        std::size_t n = 0;
+        for (canonical_decomposer<Encoding> segments(p, last, compatible); segments.next();) {
+            n += segments.size();
+        }
+        return n;
+    }
+
+    // Set while the matcher is constructed, so it comes first
+    bool _starts_with_starter = true;
+    code_point_matcher<unit> _matcher;
+    unit _first = 0x80;
+    bool _compatible;
+
+public:
+    canonical_searcher(const unit* needle, const unit* needle_end, bool compatible = false)
+        : _matcher(_decomposed_size(needle, needle_end, compatible), [&](char32_t* out) {
+            canonical_decomposer<Encoding> segments(needle, needle_end, compatible);
+            for (bool first = true; segments.next(); first = false) {
+                if (first) {
+                    _starts_with_starter = segments.combining_class(0) == 0;
+                }
+                out = std::copy(segments.data(), segments.data() + segments.size(), out);
+            }
+        })
+        , _compatible(compatible) {
+        if (_matcher.size() && _matcher[0] < 0x80) {
+            _first = static_cast<unit>(_matcher[0]);
+        }
+    }
+
+    /**
+     * Find the first match in [p, last), which must start on a code point
+     * boundary. See `case_insensitive_searcher::search()`.
+     */
+    std::pair<const unit*, const unit*> search(const unit* p, const unit* last) noexcept {
+        if (_matcher.size() == 0) {
+            return {p, p};
+        }
+        if (!_starts_with_starter) {
+            return {nullptr, nullptr};
+        }
+        _matcher.reset();
+        canonical_decomposer<Encoding> segments(p, last, _compatible);
+        while (true) {
+            const auto pos = segments.position();
+            if (_matcher.idle() && pos && ascii_code_units<Encoding>::value) {
+                segments.skip_to(skip_ascii_except(pos, last, _first, _first));
+            }
+            if (!segments.next()) {
+                break;
+            }
+            const auto n = segments.size();
+            for (std::size_t i = 0; i < n; ++i) {
+                const auto start = _matcher.feed(segments.data()[i],
+                                                 i == 0 ? segments.start() : nullptr,
+                                                 i + 1 == n && segments.end());
+                if (start) {
+                    return {start, segments.end()};
+                }
+            }
+        }
+        return {nullptr, nullptr};
+    }
+};
+
+/**
+ * Find the first match of the needle [needle, needle_end) in [from, last),
+ * compared as `how` says. Returns the bounds of the match, or a pair of
+ * nulls.
+ */
+template <typename Encoding, typename Unit>
+std::pair<const Unit*, const Unit*> search_text(const Unit* from,
+                                                const Unit* last,
+                                                const Unit* needle,
+                                                const Unit* needle_end,
+                                                match how) {
+    if (how == match::case_insensitive) {
+        return case_insensitive_searcher<Encoding>(needle, needle_end).search(from, last);
+    }
+    if (how == match::canonical || how == match::compatible) {
+        return canonical_searcher<Encoding>(needle, needle_end, how == match::compatible)
+            .search(from, last);
+    }
+    const auto m = static_cast<std::size_t>(needle_end - needle);
+    const auto p = find_text<Encoding>(from, last, needle, m);
+    return {p, p ? p + m : nullptr};
+}
+
+template <typename Searcher, typename Unit>
+std::size_t count_matches(Searcher&& searcher, const Unit* first, const Unit* last) noexcept {
+    std::size_t n = 0;
+    for (auto found = searcher.search(first, last); found.first;
+         found = searcher.search(found.second, last)) {
+        ++n;
+    }
+    return n;
+}
+
+/**
+ * Count the non-overlapping matches that `search_text()` finds, from left to
+ * right. The needle must not be empty.
+ */
+template <typename Encoding, typename Unit>
+std::size_t count_text(const Unit* first,
+                       const Unit* last,
+                       const Unit* needle,
+                       const Unit* needle_end,
+                       match how) {
+    if (how == match::exact) {
+        return count_text<Encoding>(first,
+                                    last,
+                                    needle,
+                                    static_cast<std::size_t>(needle_end - needle));
+    }
+    if (how == match::case_insensitive) {
+        return count_matches(case_insensitive_searcher<Encoding>(needle, needle_end), first, last);
+    }
+    return count_matches(canonical_searcher<Encoding>(needle,
+                                                      needle_end,
+                                                      how == match::compatible),
+                         first,
+                         last);
+}
+
+/**
+ * Call `fn` with `arg` and say whether a scan should go on: always if `fn`
+ * returns nothing, or else as its result says.
+ */
+template <typename Func, typename Arg>
+auto keep_going(Func& fn, Arg&& arg) -> std::enable_if_t<std::is_void<decltype(fn(arg))>::value, bool> {
+    fn(arg);
+    return true;
+}
+
+template <typename Func, typename Arg>
+auto keep_going(Func& fn, Arg&& arg) -> std::enable_if_t<!std::is_void<decltype(fn(arg))>::value, bool> {
+    return static_cast<bool>(fn(arg));
+}
+
+}  // namespace unicode_detail
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_SEARCH_HPP_INCLUDED
@@ -0,0 +1,518 @@
+#ifndef NEO_UNICODE_SENTENCE_HPP_INCLUDED
+#define NEO_UNICODE_SENTENCE_HPP_INCLUDED
+
+#include "search.hpp"
+#include "simd.hpp"
+#include "text.hpp"
+#include "text_view.hpp"
+#include "ucd_tables.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+namespace neo {
+
+namespace unicode_detail {
+
+/**
+ * What a code point means for the sentence boundaries, as decided by
+ * `sentence_breaker::next()`
+ */
+enum class sentence_step {
+    /// It is in the same sentence as the code point before it
+    join,
+    /// It starts a sentence
+    split,
+    /// It starts a sentence unless a lowercase letter follows (SB8)
+    hold,
+    /// It decides that the held code point doesn't start a sentence
+    drop_held,
+    /// It decides that the held code point starts a sentence
+    split_held,
+};
+
+constexpr bool is_paragraph_separator(sentence_break b) noexcept {
+    return b == sentence_break::sep || b == sentence_break::cr || b == sentence_break::lf;
+}
+
+constexpr bool is_sentence_terminator(sentence_break b) noexcept {
+    return b == sentence_break::aterm || b == sentence_break::sterm;
+}
+
+/**
+ * The sentence boundary rules of UAX #29 as a state machine that is given
+ * one Sentence_Break at a time. The state is a handful of bytes, so text can
+ * be segmented in pieces of any size. The lookahead of SB8 becomes the
+ * `hold` step: nothing that comes before the lowercase letter it looks for
+ * matters, so it is enough to remember where the decision is pending.
+ */
+class sentence_breaker {
+    static constexpr auto none = sentence_break::other;
+
+    // The last Sentence_Break, and the last that SB5 doesn't ignore
+    sentence_break _raw = none;
+    sentence_break _prev = none;
+    // The terminator of the open `SATerm Close* Sp*` sequence, if any
+    sentence_break _term = none;
+    bool _in_term = false;
+    bool _after_space = false;
+    // Whether the terminator came after Upper or Lower, for SB7
+    bool _cased_before_term = false;
+    bool _holding = false;
+
+    void _take(sentence_break b) noexcept {
+        if (is_sentence_terminator(b)) {
+            _cased_before_term = _prev == sentence_break::upper || _prev == sentence_break::lower;
+            _term = b;
+            _in_term = true;
+            _after_space = false;
+        } else {
+            _in_term = false;
+        }
+        _prev = b;
+    }
+
+public:
+    /**
+     * Whether the next code point joins unless it is a terminator or a
+     * paragraph separator
+     */
+    bool plain() const noexcept {
+        return !_in_term && !_holding && !is_paragraph_separator(_raw);
+    }
+
+    /**
+     * Skip code points that `plain()` says join, the last of which was `last`
+     */
+    void skipped(sentence_break last) noexcept {
+        _raw = last;
+        _prev = last;
+    }
+
+    sentence_step next(sentence_break b) noexcept {
+        using sb = sentence_break;
+        const auto a = _raw;
+        _raw = b;
+        if (a == sb::cr && b == sb::lf) {
+            return sentence_step::join;
+        }
+        if (is_paragraph_separator(a)) {
+            _take(b);
+            return sentence_step::split;
+        }
+        if (b == sb::extend || b == sb::format) {
+            return sentence_step::join;
+        }
+        if (_holding) {
+            _holding = b == sb::other || b == sb::sp || b == sb::numeric || b == sb::scontinue || b == sb::close;
+            _take(b);
+            if (_holding) {
+                return sentence_step::join;
+            }
+            return b == sb::lower ? sentence_step::drop_held : sentence_step::split_held;
+        }
+        if (!_in_term) {
+            _take(b);
+            return sentence_step::join;
+        }
+        const bool aterm = _term == sb::aterm;
+        if (aterm && _prev == sb::aterm
+            && (b == sb::numeric || (b == sb::upper && _cased_before_term))) {
+            // SB6 and SB7
+            _take(b);
+            return sentence_step::join;
+        }
+        if (b == sb::scontinue || is_sentence_terminator(b) || is_paragraph_separator(b)) {
+            // SB8a, and SB9 and SB10 for the paragraph separator
+            _take(b);
+            return sentence_step::join;
+        }
+        if ((b == sb::close && !_after_space) || b == sb::sp) {
+            // SB9 and SB10
+            _after_space = _after_space || b == sb::sp;
+            _prev = b;
+            return sentence_step::join;
+        }
+        if (aterm && b != sb::oletter && b != sb::upper) {
+            // SB8
+            _take(b);
+            if (b == sb::lower) {
+                return sentence_step::join;
+            }
+            _holding = true;
+            return sentence_step::hold;
+        }
+        // SB11
+        _take(b);
+        return sentence_step::split;
+    }
+};
+
+template <typename Encoding, typename Unit>
+sentence_break next_sentence_break_of(const Unit*& p, const Unit* last) noexcept {
+    const auto u = static_cast<std::make_unsigned_t<Unit>>(*p);
+    if (ascii_code_units<Encoding>::value && u < 0x80) {
+        ++p;
+        return sentence_break_of(u);
+    }
+    return sentence_break_of(decoder<Encoding>::next(p, last));
+}
+
+constexpr bool ends_plain_ascii(unsigned u) noexcept {
+    return u >= 0x80 || u == '.' || u == '!' || u == '?' || u == '\r' || u == '\n';
+}
+
+/**
+ * Skip the ASCII from `p` that can't end a sentence: all but terminators and
+ * line breaks
+ */
+template <typename Unit> const Unit* skip_plain_ascii(const Unit* p, const Unit* last) noexcept {
+#if NEO_UNICODE_HAVE_SSE2
+    using lanes = unit_lanes<sizeof(Unit)>;
+    constexpr std::size_t width = 16 / sizeof(Unit);
+    const auto dot = lanes::splat('.');
+    const auto bang = lanes::splat('!');
+    const auto question = lanes::splat('?');
+    const auto cr = lanes::splat('\r');
+    const auto lf = lanes::splat('\n');
+    while (last - p >= static_cast<std::ptrdiff_t>(width)) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const auto ends = _mm_or_si128(_mm_or_si128(lanes::eq(v, dot), lanes::eq(v, bang)),
+                                       _mm_or_si128(_mm_or_si128(lanes::eq(v, question), lanes::eq(v, cr)),
+                                                    lanes::eq(v, lf)));
+        const auto plain = _mm_andnot_si128(ends, lanes::ascii(v));
+        const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(plain)) & lanes::lane_bits;
+        if (mask != lanes::lane_bits) {
+            return p + count_trailing_zeros(~mask & lanes::lane_bits) / sizeof(Unit);
+        }
+        p += width;
+    }
+#endif
+    while (p != last && !ends_plain_ascii(static_cast<std::make_unsigned_t<Unit>>(*p))) {
+        ++p;
+    }
+    return p;
+}
+
+/**
+ * Give `state` the code points of [p, last), calling `on_step(pos, step)` for
+ * every step but `join`, with `pos` at the code point of the step. Stops
+ * early if `on_step` returns false. With `hold_last`, a code point that
+ * might continue after `last` is left out. Returns where it stopped.
+ */
+template <typename Encoding, typename Unit, typename OnStep>
+const Unit*
+run_sentence_breaker(sentence_breaker& state, const Unit* p, const Unit* last, OnStep&& on_step, bool hold_last = false) {
+    while (p != last) {
+        if (ascii_code_units<Encoding>::value && state.plain()) {
+            const auto q = skip_plain_ascii(p, last);
+            if (q != p) {
+                state.skipped(sentence_break_of(static_cast<std::make_unsigned_t<Unit>>(q[-1])));
+                p = q;
+                continue;
+            }
+        }
+        auto q = p;
+        const auto b = next_sentence_break_of<Encoding>(q, last);
+        if (hold_last && q == last) {
+            break;
+        }
+        const auto step = state.next(b);
+        if (step != sentence_step::join && !on_step(p, step)) {
+            break;
+        }
+        p = q;
+    }
+    return p;
+}
+
+/**
+ * Find the end of the sentence that starts at `p`, which must be a sentence
+ * boundary before `last`
+ */
+template <typename Encoding, typename Unit> const Unit* next_sentence_break(const Unit* p, const Unit* last) noexcept {
+    sentence_breaker state;
+    const Unit* held = nullptr;
+    const Unit* found = last;
+    // The first code point always joins, as nothing comes before it
+    run_sentence_breaker<Encoding>(state, p, last, [&](const Unit* pos, sentence_step step) {
+        switch (step) {
+        case sentence_step::hold:
+            held = pos;
+            return true;
+        case sentence_step::drop_held:
+            held = nullptr;
+            return true;
+        case sentence_step::split_held:
+            found = held;
+            return false;
+        default:
+            found = pos;
+            return false;
+        }
+    });
+    // SB8 found no lowercase letter before the end
+    return found == last && held ? held : found;
+}
+
+}  // namespace unicode_detail
+
+/**
+ * A forward iterator over the sentences of a text, by the sentence
+ * boundaries of UAX #29. Dereferencing yields a `basic_text_view` of the
+ * sentence, with its trailing spaces and line break.
+ */
+template <typename Encoding> class sentence_iterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = basic_text_view<Encoding>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = value_type;
+    using code_unit_type = typename Encoding::code_unit_type;
+
+private:
+    const code_unit_type* _pos = nullptr;
+    // The end of the sentence at `_pos`
+    const code_unit_type* _next = nullptr;
+    const code_unit_type* _last = nullptr;
+
+    void _find_next() noexcept {
+        _next = _pos == _last ? _last : unicode_detail::next_sentence_break<Encoding>(_pos, _last);
+    }
+
+public:
+    sentence_iterator() = default;
+
+    /**
+     * Construct an iterator at `pos`, which must be the start of a sentence in
+     * [pos, last]
+     */
+    sentence_iterator(const code_unit_type* pos, const code_unit_type* last) noexcept
+        : _pos(pos)
+        , _last(last) {
+        _find_next();
+    }
+
+    /**
+     * Get a pointer to the first code unit of the current sentence
+     */
+    const code_unit_type* position() const noexcept {
+        return _pos;
+    }
+
+    value_type operator*() const noexcept {
+        return value_type(_pos, _next);
+    }
+
+    sentence_iterator& operator++() noexcept {
+        _pos = _next;
+        _find_next();
+        return *this;
+    }
+
+    sentence_iterator operator++(int) noexcept {
+        auto copy = *this;
+        ++*this;
+        return copy;
+    }
+
+    friend bool operator==(const sentence_iterator& a, const sentence_iterator& b) noexcept {
+        return a._pos == b._pos;
+    }
+
+    friend bool operator!=(const sentence_iterator& a, const sentence_iterator& b) noexcept {
+        return !(a == b);
+    }
+};
+
+/**
+ * The sentences of a text, as returned by `sentences()`
+ */
+template <typename Encoding> class sentence_range {
+public:
+    using iterator = sentence_iterator<Encoding>;
+    using const_iterator = iterator;
+    using code_unit_type = typename Encoding::code_unit_type;
+
+private:
+    const code_unit_type* _first;
+    const code_unit_type* _last;
+
+public:
+    sentence_range(const code_unit_type* first, const code_unit_type* last) noexcept
+        : _first(first)
+        , _last(last) {}
+
+    iterator begin() const noexcept {
+        return iterator(_first, _last);
+    }
+
+    iterator end() const noexcept {
+        return iterator(_last, _last);
+    }
+};
+
+/**
+ * Iterate the sentences of `text`, by the sentence boundaries of UAX #29.
+ * The range refers to the text, which must outlive it. Runs of ASCII without
+ * terminators or line breaks are skipped a block at a time.
+ */
+template <typename Encoding, typename Buffer>
+sentence_range<Encoding> sentences(const basic_text<Encoding, Buffer>& text) noexcept {
+    return sentence_range<Encoding>(text.data(), text.data() + text.code_unit_size());
+}
+
+template <typename Encoding, typename Buffer> void sentences(const basic_text<Encoding, Buffer>&&) = delete;
+
+template <typename Encoding> sentence_range<Encoding> sentences(basic_text_view<Encoding> view) noexcept {
+    return sentence_range<Encoding>(view.data(), view.data() + view.code_unit_size());
+}
+
+/**
+ * Find sentence boundaries in text that arrives in pieces, such as a file
+ * read a block at a time. The pieces may split code points anywhere. Only a
+ * few bytes of state are kept between pieces: a boundary that depends on
+ * text to come is reported once that text arrives.
+ *
+ * Boundaries are reported to a callback as the offset, in code units from
+ * the start of the stream, of the end of each sentence.
+ */
+template <typename Encoding = utf8> class sentence_stream {
+public:
+    using code_unit_type = typename Encoding::code_unit_type;
+
+private:
+    // The longest code point, which is as much as is held back from a piece
+    static constexpr std::size_t max_code_units = sizeof(code_unit_type) < 4 ? 4 / sizeof(code_unit_type) : 1;
+
+    unicode_detail::sentence_breaker _state;
+    // The code units of a code point that might continue in the next piece
+    code_unit_type _carry[max_code_units] = {};
+    std::size_t _carry_size = 0;
+    // The offset of `_carry`, and of the first code unit fed
+    std::size_t _offset = 0;
+    std::size_t _held = 0;
+    bool _holding = false;
+
+    /**
+     * Run the code points of [first, last), which starts at `offset` in the
+     * stream, returning where it stopped
+     */
+    template <typename Fn>
+    const code_unit_type*
+    _run(const code_unit_type* first, const code_unit_type* last, std::size_t offset, Fn& fn, bool hold_last) {
+        using unicode_detail::sentence_step;
+        const auto on_step = [&](const code_unit_type* pos, sentence_step step) {
+            const auto at = offset + static_cast<std::size_t>(pos - first);
+            switch (step) {
+            case sentence_step::hold:
+                _holding = true;
+                _held = at;
+                break;
+            case sentence_step::drop_held:
+                _holding = false;
+                break;
+            case sentence_step::split_held:
+                _holding = false;
+                fn(_held);
+                break;
+            default:
+                fn(at);
+                break;
+            }
+            return true;
+        };
+        return unicode_detail::run_sentence_breaker<Encoding>(_state, first, last, on_step, hold_last);
+    }
+
+public:
+    /**
+     * Feed the next `size` code units, calling `fn(end)` for every sentence
+     * that is found to end
+     */
+    template <typename Fn> void feed(const code_unit_type* data, std::size_t size, Fn&& fn) {
+        auto p = data;
+        const auto last = data + size;
+        if (_carry_size != 0 && p != last) {
+            // Decode what the last piece held back, with enough of this one to
+            // finish its code points
+            code_unit_type buf[2 * max_code_units];
+            std::size_t n = 0;
+            for (; n < _carry_size; ++n) {
+                buf[n] = _carry[n];
+            }
+            const auto rest = static_cast<std::size_t>(last - p);
+            const auto taken = rest < max_code_units ? rest : std::size_t(max_code_units);
+            for (std::size_t i = 0; i < taken; ++i) {
+                buf[n++] = p[i];
+            }
+            const code_unit_type* cursor = buf;
+            while (cursor < buf + _carry_size) {
+                auto q = cursor;
+                decoder<Encoding>::next(q, buf + n);
+                if (q == buf + n && taken == rest) {
+                    break;
+                }
+                cursor = q;
+            }
+            const auto used = static_cast<std::size_t>(cursor - buf);
+            _run(buf, cursor, _offset, fn, false);
+            _offset += used;
+            if (used < _carry_size) {
+                // The last code point of everything fed so far is held back
+                _carry_size = 0;
+                for (auto q = cursor; q != buf + n; ++q) {
+                    _carry[_carry_size++] = *q;
+                }
+                return;
+            }
+            p += used - _carry_size;
+            _carry_size = 0;
+        }
+        const auto stop = _run(p, last, _offset, fn, true);
+        _offset += static_cast<std::size_t>(stop - p);
+        for (p = stop; p != last; ++p) {
+            _carry[_carry_size++] = *p;
+        }
+    }
+
+    template <typename Fn> void feed(basic_text_view<Encoding> view, Fn&& fn) {
+        feed(view.data(), view.code_unit_size(), fn);
+    }
+
+    /**
+     * End the stream, calling `fn(end)` for the sentences that are left. The
+     * last ends at the end of the stream. The stream can then be fed anew.
+     */
+    template <typename Fn> void finish(Fn&& fn) {
+        if (_carry_size != 0) {
+            code_unit_type buf[max_code_units];
+            for (std::size_t i = 0; i < _carry_size; ++i) {
+                buf[i] = _carry[i];
+            }
+            _run(buf, buf + _carry_size, _offset, fn, false);
+            _offset += _carry_size;
+        }
+        if (_holding) {
+            fn(_held);
+        }
+        if (_offset != 0) {
+            fn(_offset);
+        }
+        *this = sentence_stream();
+    }
+
+    /**
+     * The number of code units fed so far
+     */
+    std::size_t size() const noexcept {
+        return _offset + _carry_size;
+    }
+};
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_SENTENCE_HPP_INCLUDED
@@ -0,0 +1,190 @@
+#ifndef NEO_UNICODE_SIMD_HPP_INCLUDED
+#define NEO_UNICODE_SIMD_HPP_INCLUDED
+
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+
+/**
+ * neo::unicode uses SSE2 when it is available, which is always the case for
+ * x86-64. Everything has a portable scalar fallback. Define
+ * NEO_UNICODE_NO_SIMD to force the fallback.
+ */
+#if !defined(NEO_UNICODE_NO_SIMD)                                                                  \
+    && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define NEO_UNICODE_HAVE_SSE2 1
+#include <emmintrin.h>
+#else
+#define NEO_UNICODE_HAVE_SSE2 0
+#endif
+
+/**
+ * A few searches also use the byte shuffles of SSSE3, if the compiler
+ * targets it, as with -mssse3 or -march=native. They fall back to SSE2.
+ */
+#if NEO_UNICODE_HAVE_SSE2 && (defined(__SSSE3__) || defined(__AVX__))
+#define NEO_UNICODE_HAVE_SSSE3 1
+#include <tmmintrin.h>
+#else
+#define NEO_UNICODE_HAVE_SSSE3 0
+#endif
+
+/**
+ * Hashing uses the CRC32C instruction of SSE 4.2 for long inputs, if the
+ * compiler targets it, as with -msse4.2 or -march=native.
+ */
+#if NEO_UNICODE_HAVE_SSE2 && defined(__SSE4_2__)
+#define NEO_UNICODE_HAVE_SSE42 1
+#include <nmmintrin.h>
+#else
+#define NEO_UNICODE_HAVE_SSE42 0
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace neo {
+
+namespace unicode_detail {
+
+inline std::uint16_t byte_swap(std::uint16_t v) noexcept {
+    return static_cast<std::uint16_t>((v << 8) | (v >> 8));
+}
+
+inline std::uint32_t byte_swap(std::uint32_t v) noexcept {
+#if defined(__GNUC__)
+    return __builtin_bswap32(v);
+#elif defined(_MSC_VER)
+    return _byteswap_ulong(v);
+#else
+    return ((v & 0xff) << 24) | ((v & 0xff00) << 8) | ((v >> 8) & 0xff00) | (v >> 24);
+#endif
+}
+
+/**
+ * Index of the lowest set bit. `v` must not be zero.
+ */
+inline unsigned count_trailing_zeros(std::uint32_t v) noexcept {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctz(v));
+#elif defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward(&idx, v);
+    return static_cast<unsigned>(idx);
+#else
+    unsigned n = 0;
+    while (!(v & 1)) {
+        v >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/**
+ * Index of the highest set bit. `v` must not be zero.
+ */
+inline unsigned highest_set_bit(std::uint32_t v) noexcept {
+#if defined(__GNUC__)
+    return 31u - static_cast<unsigned>(__builtin_clz(v));
+#elif defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanReverse(&idx, v);
+    return static_cast<unsigned>(idx);
+#else
+    unsigned n = 0;
+    while (v >>= 1) {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/**
+ * The number of set bits in `v`
+ */
+inline unsigned population_count(std::uint32_t v) noexcept {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_popcount(v));
+#else
+    v = v - ((v >> 1) & 0x55555555);
+    v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+    return (((v + (v >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#endif
+}
+
+/**
+ * Copy a trivially-copyable value out of possibly unaligned memory.
+ */
+template <typename T> inline T load_unaligned(const void* ptr) noexcept {
+    T ret;
+    std::memcpy(&ret, ptr, sizeof ret);
+    return ret;
+}
+
+#if NEO_UNICODE_HAVE_SSE2
+/**
+ * Lane-wise operations on code units of `Size` bytes. Comparisons set every
+ * bit of the lanes where they hold, `gt()` comparing the lanes as signed
+ * numbers, and `ascii()` holds for units below 0x80.
+ * `_mm_movemask_epi8` gives one bit per byte, so `lane_bits` keeps the lowest
+ * bit of each unit.
+ */
+template <std::size_t Size> struct unit_lanes;
+
+template <> struct unit_lanes<1> {
+    static constexpr std::uint32_t lane_bits = 0xFFFF;
+    static __m128i splat(std::uint32_t u) noexcept {
+        return _mm_set1_epi8(static_cast<char>(u));
+    }
+    static __m128i eq(__m128i a, __m128i b) noexcept {
+        return _mm_cmpeq_epi8(a, b);
+    }
+    static __m128i gt(__m128i a, __m128i b) noexcept {
+        return _mm_cmpgt_epi8(a, b);
+    }
+    static __m128i ascii(__m128i v) noexcept {
+        return _mm_cmpgt_epi8(v, _mm_set1_epi8(-1));
+    }
+};
+
+template <> struct unit_lanes<2> {
+    static constexpr std::uint32_t lane_bits = 0x5555;
+    static __m128i splat(std::uint32_t u) noexcept {
+        return _mm_set1_epi16(static_cast<short>(u));
+    }
+    static __m128i eq(__m128i a, __m128i b) noexcept {
+        return _mm_cmpeq_epi16(a, b);
+    }
+    static __m128i gt(__m128i a, __m128i b) noexcept {
+        return _mm_cmpgt_epi16(a, b);
+    }
+    static __m128i ascii(__m128i v) noexcept {
+        return _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(-0x80)), _mm_setzero_si128());
+    }
+};
+
+template <> struct unit_lanes<4> {
+    static constexpr std::uint32_t lane_bits = 0x1111;
+    static __m128i splat(std::uint32_t u) noexcept {
+        return _mm_set1_epi32(static_cast<int>(u));
+    }
+    static __m128i eq(__m128i a, __m128i b) noexcept {
+        return _mm_cmpeq_epi32(a, b);
+    }
+    static __m128i gt(__m128i a, __m128i b) noexcept {
+        return _mm_cmpgt_epi32(a, b);
+    }
+    static __m128i ascii(__m128i v) noexcept {
+        return _mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(-0x80)), _mm_setzero_si128());
+    }
+};
+
+#endif
+
+}  // namespace unicode_detail
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_SIMD_HPP_INCLUDED
@@ -0,0 +1,458 @@
+#ifndef NEO_UNICODE_SPLIT_HPP_INCLUDED
+#define NEO_UNICODE_SPLIT_HPP_INCLUDED
+
+#include "search.hpp"
+#include "simd.hpp"
+#include "text.hpp"
+#include "text_view.hpp"
+
+#include "encodings/utf8.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace neo {
+
+namespace unicode_detail {
+
+/**
+ * `basic_text<Encoding>`, for parameters that shouldn't take part in
+ * deducing `Encoding`, so that they can be given as string literals
+ */
+template <typename Encoding> struct text_of { using type = basic_text<Encoding>; };
+
+/**
+ * The most code units that `find_unit_of()` looks for at once
+ */
+constexpr std::size_t max_scanned_units = 8;
+
+/**
+ * Find the first code unit in [p, last) that is one of the `n` code units at
+ * `units`, or that is in [low, high] if `low <= high`. The range must be
+ * within ASCII, and `n` at most `max_scanned_units`. Returns `last` if there
+ * is none.
+ */
+template <typename Unit>
+const Unit* find_unit_of(const Unit* p,
+                         const Unit* last,
+                         const std::uint32_t* units,
+                         std::size_t n,
+                         std::uint32_t low = 1,
+                         std::uint32_t high = 0) noexcept {
+#if NEO_UNICODE_HAVE_SSE2
+    using lanes = unit_lanes<sizeof(Unit)>;
+    constexpr std::size_t width = 16 / sizeof(Unit);
+    __m128i wanted[max_scanned_units];
+    for (std::size_t i = 0; i < n; ++i) {
+        wanted[i] = lanes::splat(units[i]);
+    }
+    const bool in_range = low <= high;
+    const auto below = lanes::splat(low - 1);
+    const auto above = lanes::splat(high);
+    while (last - p >= static_cast<std::ptrdiff_t>(width)) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        // Signed comparison is fine, since units of 0x80 and up are either
+        // negative or above `high`
+        auto found = in_range ? _mm_andnot_si128(lanes::gt(v, above), lanes::gt(v, below)) : _mm_setzero_si128();
+        for (std::size_t i = 0; i < n; ++i) {
+            found = _mm_or_si128(found, lanes::eq(v, wanted[i]));
+        }
+        const auto bits = static_cast<std::uint32_t>(_mm_movemask_epi8(found)) & lanes::lane_bits;
+        if (bits) {
+            return p + count_trailing_zeros(bits) / sizeof(Unit);
+        }
+        p += width;
+    }
+#endif
+    for (; p != last; ++p) {
+        const std::uint32_t u = static_cast<std::make_unsigned_t<Unit>>(*p);
+        if (u - low <= high - low && low <= high) {
+            return p;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            if (u == units[i]) {
+                return p;
+            }
+        }
+    }
+    return last;
+}
+
+/**
+ * Finds the occurrences of a delimiter text, for `split()`. An empty
+ * delimiter is never found.
+ */
+template <typename Encoding> class delimiter_finder {
+public:
+    using unit = typename Encoding::code_unit_type;
+    static constexpr bool keeps_empty_end = true;
+
+private:
+    basic_text<Encoding> _delimiter;
+
+public:
+    explicit delimiter_finder(basic_text<Encoding> delimiter) noexcept
+        : _delimiter(std::move(delimiter)) {}
+
+    /**
+     * The bounds of the first delimiter in [p, last), or `last` and null
+     */
+    std::pair<const unit*, const unit*> find(const unit* p, const unit* last) const noexcept {
+        const auto m = _delimiter.code_unit_size();
+        if (m == 1 && ascii_code_units<Encoding>::value) {
+            // Pieces are often short, so this scans inline rather than
+            // calling memchr(). A single code unit is a whole code point.
+            const std::uint32_t u = static_cast<std::make_unsigned_t<unit>>(*_delimiter.data());
+            const auto found = find_unit_of(p, last, &u, 1);
+            return {found, found == last ? nullptr : found + 1};
+        }
+        const auto found = m ? find_text<Encoding>(p, last, _delimiter.data(), m) : nullptr;
+        if (!found) {
+            return {last, nullptr};
+        }
+        return {found, found + m};
+    }
+};
+
+/**
+ * Finds the code points of a set, for `split_any()`. Where the code units
+ * are in host order and the members start with at most `max_scanned_units`
+ * distinct code units, those are scanned for and only the code points they
+ * start are decoded. U+FFFD, which malformed members decode to, stands for
+ * any malformed code units, which can be in the middle of a code point, so
+ * then every code point is decoded.
+ */
+template <typename Encoding> class code_point_set_finder {
+public:
+    using unit = typename Encoding::code_unit_type;
+    static constexpr bool keeps_empty_end = true;
+
+private:
+    std::vector<char32_t> _members;
+    std::uint32_t _leads[max_scanned_units];
+    std::size_t _lead_count = 0;
+    bool _scan = ascii_code_units<Encoding>::value;
+
+    bool _contains(char32_t cp) const noexcept {
+        return std::binary_search(_members.begin(), _members.end(), cp);
+    }
+
+public:
+    explicit code_point_set_finder(basic_text_view<Encoding> members) {
+        const auto last = members.data() + members.code_unit_size();
+        for (auto p = members.data(); p != last;) {
+            const std::uint32_t lead = static_cast<std::make_unsigned_t<unit>>(*p);
+            const auto cp = decoder<Encoding>::next(p, last);
+            _members.push_back(cp);
+            if (cp == replacement_character) {
+                _scan = false;
+            }
+            if (std::find(_leads, _leads + _lead_count, lead) != _leads + _lead_count) {
+                continue;
+            }
+            if (_lead_count == max_scanned_units) {
+                _scan = false;
+            } else {
+                _leads[_lead_count++] = lead;
+            }
+        }
+        std::sort(_members.begin(), _members.end());
+        _members.erase(std::unique(_members.begin(), _members.end()), _members.end());
+    }
+
+    /**
+     * The bounds of the first member in [p, last), or `last` and null
+     */
+    std::pair<const unit*, const unit*> find(const unit* p, const unit* last) const noexcept {
+        if (_members.empty()) {
+            return {last, nullptr};
+        }
+        while (p != last) {
+            if (_scan) {
+                p = find_unit_of(p, last, _leads, _lead_count);
+                if (p == last) {
+                    break;
+                }
+            }
+            const auto start = p;
+            if (_contains(decoder<Encoding>::next(p, last))) {
+                return {start, p};
+            }
+        }
+        return {last, nullptr};
+    }
+};
+
+/**
+ * The first code units of NEL, LINE SEPARATOR and PARAGRAPH SEPARATOR, where
+ * their code units are their code points: UTF-16, UTF-32 and ISO-8859-1
+ */
+template <typename Encoding> struct line_separator_leads {
+    static constexpr std::uint32_t nel = 0x85;
+    static constexpr std::uint32_t ls = 0x2028;
+    static constexpr std::uint32_t ps = 0x2029;
+};
+
+template <> struct line_separator_leads<utf8> {
+    static constexpr std::uint32_t nel = 0xC2;
+    static constexpr std::uint32_t ls = 0xE2;
+    static constexpr std::uint32_t ps = 0xE2;
+};
+
+/**
+ * Finds line terminators, for `lines()`: the mandatory breaks of UAX #14,
+ * with CR LF as one terminator. A line is not started at the end of the
+ * text.
+ */
+template <typename Encoding> class line_terminator_finder {
+public:
+    using unit = typename Encoding::code_unit_type;
+    static constexpr bool keeps_empty_end = false;
+
+    static bool is_terminator(char32_t cp) noexcept {
+        return (cp - 0x0A < 4) || cp == 0x85 || cp == 0x2028 || cp == 0x2029;
+    }
+
+    /**
+     * The bounds of the first terminator in [p, last), or `last` and null
+     */
+    std::pair<const unit*, const unit*> find(const unit* p, const unit* last) const noexcept {
+        using leads = line_separator_leads<Encoding>;
+        // UTF-8 starts both separators with the same byte, and a byte of
+        // ISO-8859-1 holds neither
+        const std::uint32_t units[] = {leads::nel, leads::ls, leads::ps};
+        const std::size_t n = leads::ls == leads::ps ? 2 : sizeof(unit) == 1 ? 1 : 3;
+        while (p != last) {
+            if (ascii_code_units<Encoding>::value) {
+                p = find_unit_of(p, last, units, n, 0x0A, 0x0D);
+                if (p == last) {
+                    break;
+                }
+            }
+            const auto start = p;
+            const auto cp = decoder<Encoding>::next(p, last);
+            if (is_terminator(cp)) {
+                auto after = p;
+                if (cp == 0x0D && p != last && decoder<Encoding>::next(after, last) == 0x0A) {
+                    p = after;
+                }
+                return {start, p};
+            }
+        }
+        return {last, nullptr};
+    }
+};
+
+}  // namespace unicode_detail
+
+/**
+ * A forward iterator over the pieces of a text between the separators that
+ * `Finder` finds. Dereferencing yields a `basic_text_view` of a piece,
+ * without its separator.
+ */
+template <typename Encoding, typename Finder> class split_iterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = basic_text_view<Encoding>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = value_type;
+    using code_unit_type = typename Encoding::code_unit_type;
+
+private:
+    // Null at the end
+    const Finder* _finder = nullptr;
+    const code_unit_type* _pos = nullptr;
+    const code_unit_type* _piece_end = nullptr;
+    // The start of the next piece, or null after the last piece
+    const code_unit_type* _next = nullptr;
+    const code_unit_type* _last = nullptr;
+
+    void _find_next() noexcept {
+        const auto separator = _finder->find(_pos, _last);
+        _piece_end = separator.first;
+        _next = separator.second;
+    }
+
+public:
+    split_iterator() = default;
+
+    /**
+     * Construct an iterator at the piece starting at `pos`, in [pos, last]
+     */
+    split_iterator(const Finder& finder, const code_unit_type* pos, const code_unit_type* last) noexcept
+        : _finder(&finder)
+        , _pos(pos)
+        , _last(last) {
+        _find_next();
+    }
+
+    /**
+     * Get a pointer to the first code unit of the current piece
+     */
+    const code_unit_type* position() const noexcept {
+        return _pos;
+    }
+
+    value_type operator*() const noexcept {
+        return value_type(_pos, _piece_end);
+    }
+
+    split_iterator& operator++() noexcept {
+        if (!_next || (_next == _last && !Finder::keeps_empty_end)) {
+            *this = split_iterator();
+        } else {
+            _pos = _next;
+            _find_next();
+        }
+        return *this;
+    }
+
+    split_iterator operator++(int) noexcept {
+        auto copy = *this;
+        ++*this;
+        return copy;
+    }
+
+    friend bool operator==(const split_iterator& a, const split_iterator& b) noexcept {
+        return a._finder == b._finder && a._pos == b._pos;
+    }
+
+    friend bool operator!=(const split_iterator& a, const split_iterator& b) noexcept {
+        return !(a == b);
+    }
+};
+
+/**
+ * The pieces of a text, as returned by `split()`, `split_any()` and
+ * `lines()`. Each pass over the range searches the text again. Iterators
+ * refer to the range, so it must outlive them.
+ */
+template <typename Encoding, typename Finder> class split_range {
+public:
+    using iterator = split_iterator<Encoding, Finder>;
+    using const_iterator = iterator;
+    using code_unit_type = typename Encoding::code_unit_type;
+
+private:
+    Finder _finder;
+    const code_unit_type* _first;
+    const code_unit_type* _last;
+
+public:
+    split_range(Finder finder, const code_unit_type* first, const code_unit_type* last) noexcept
+        : _finder(std::move(finder))
+        , _first(first)
+        , _last(last) {}
+
+    iterator begin() const noexcept {
+        if (_first == _last && !Finder::keeps_empty_end) {
+            return end();
+        }
+        return iterator(_finder, _first, _last);
+    }
+
+    iterator end() const noexcept {
+        return iterator();
+    }
+};
+
+template <typename Encoding>
+using text_split_range = split_range<Encoding, unicode_detail::delimiter_finder<Encoding>>;
+
+template <typename Encoding>
+using text_split_any_range = split_range<Encoding, unicode_detail::code_point_set_finder<Encoding>>;
+
+template <typename Encoding>
+using text_line_range = split_range<Encoding, unicode_detail::line_terminator_finder<Encoding>>;
+
+/**
+ * Split `text` at each occurrence of `delimiter`, as `basic_text::find()`
+ * finds them. The pieces are views of the text, so the range refers to it
+ * and the text must outlive it. There is one more piece than there are
+ * delimiters, so an empty text is one empty piece, as is the end of a text
+ * that ends with the delimiter. An empty delimiter doesn't split.
+ *
+ * A delimiter of a single code unit, such as an ASCII character, is found by
+ * comparing 16 bytes of the text at a time, and longer ones as `find()` finds
+ * them.
+ */
+template <typename Encoding, typename Buffer>
+text_split_range<Encoding> split(const basic_text<Encoding, Buffer>& text,
+                                 typename unicode_detail::text_of<Encoding>::type delimiter) noexcept {
+    return text_split_range<Encoding>(unicode_detail::delimiter_finder<Encoding>(std::move(delimiter)),
+                                      text.data(),
+                                      text.data() + text.code_unit_size());
+}
+
+template <typename Encoding, typename Buffer, typename Delimiter>
+void split(const basic_text<Encoding, Buffer>&&, Delimiter&&) = delete;
+
+template <typename Encoding>
+text_split_range<Encoding> split(basic_text_view<Encoding> view,
+                                 typename unicode_detail::text_of<Encoding>::type delimiter) noexcept {
+    return text_split_range<Encoding>(unicode_detail::delimiter_finder<Encoding>(std::move(delimiter)),
+                                      view.data(),
+                                      view.data() + view.code_unit_size());
+}
+
+/**
+ * Split `text` at each of its code points that is one of the code points of
+ * `delimiters`, as `split()` does. The set is copied into the range.
+ */
+template <typename Encoding, typename Buffer>
+text_split_any_range<Encoding> split_any(const basic_text<Encoding, Buffer>& text,
+                                         basic_text_view<Encoding> delimiters) {
+    return text_split_any_range<Encoding>(unicode_detail::code_point_set_finder<Encoding>(delimiters),
+                                          text.data(),
+                                          text.data() + text.code_unit_size());
+}
+
+template <typename Encoding, typename Buffer>
+text_split_any_range<Encoding> split_any(const basic_text<Encoding, Buffer>& text,
+                                         const typename unicode_detail::text_of<Encoding>::type& delimiters) {
+    return split_any(text, basic_text_view<Encoding>(delimiters));
+}
+
+template <typename Encoding, typename Buffer, typename Delimiters>
+void split_any(const basic_text<Encoding, Buffer>&&, Delimiters&&) = delete;
+
+template <typename Encoding>
+text_split_any_range<Encoding> split_any(basic_text_view<Encoding> view, basic_text_view<Encoding> delimiters) {
+    return text_split_any_range<Encoding>(unicode_detail::code_point_set_finder<Encoding>(delimiters),
+                                          view.data(),
+                                          view.data() + view.code_unit_size());
+}
+
+template <typename Encoding>
+text_split_any_range<Encoding> split_any(basic_text_view<Encoding> view,
+                                         const typename unicode_detail::text_of<Encoding>::type& delimiters) {
+    return split_any(view, basic_text_view<Encoding>(delimiters));
+}
+
+/**
+ * Iterate the lines of `text`, without their terminators. A line ends at
+ * LF, CR LF, CR, VT, FF, NEL, LINE SEPARATOR or PARAGRAPH SEPARATOR: the
+ * mandatory breaks of UAX #14. A terminator at the end of the text doesn't
+ * start another line, so an empty text has no lines. The range refers to the
+ * text, which must outlive it.
+ */
+template <typename Encoding, typename Buffer>
+text_line_range<Encoding> lines(const basic_text<Encoding, Buffer>& text) noexcept {
+    return text_line_range<Encoding>({}, text.data(), text.data() + text.code_unit_size());
+}
+
+template <typename Encoding, typename Buffer> void lines(const basic_text<Encoding, Buffer>&&) = delete;
+
+template <typename Encoding> text_line_range<Encoding> lines(basic_text_view<Encoding> view) noexcept {
+    return text_line_range<Encoding>({}, view.data(), view.data() + view.code_unit_size());
+}
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_SPLIT_HPP_INCLUDED
@@ -1,10 +1,31 @@
 #ifndef NEO_UNICODE_TEXT_HPP_INCLUDED
 #define NEO_UNICODE_TEXT_HPP_INCLUDED
 
+#include "code_point_index.hpp"
+#include "code_point_iterator.hpp"
+#include "compare.hpp"
 #include "concepts.hpp"
 #include "encodings/all.hpp"
+#include "hash.hpp"
+#include "repertoire.hpp"
+#include "search.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <ostream>
 #include <string>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+#if __cplusplus > 201703L && __has_include(<compare>)
+#include <compare>
+#endif
 
 namespace neo {
 
@@ -43,6 +64,14 @@ public:
      */
     using size_type = size_type_t<buffer_type>;
 
+    /**
+     * Bidirectional iterator over the code points of the text
+     */
+    using iterator = code_point_iterator<internal_encoding>;
+    using const_iterator = iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = reverse_iterator;
+
     // Check that the value type of the buffer is convertible to the type used
     // by the encoding class
     static_assert(unicode_detail::Convertible<value_type_t<BufferType>,
@@ -79,6 +108,14 @@ public:
         : _buffer(ptr, ptr + std::char_traits<value_type_t<buffer_type>>::length(ptr)) {
     }
 
+    /**
+     * Buffer constructor. Takes code units that are already in the internal
+     * encoding. The buffer is shared, not copied.
+     */
+    explicit basic_text(buffer_type buf) noexcept
+        : _buffer(std::move(buf)) {
+    }
+
     template <typename OtherCharType,
               typename OtherEncoding = encoding_for_char_type_t<OtherCharType>,
               typename = std::enable_if_t<!std::is_convertible<OtherCharType*, const_pointer>::value>>
@@ -106,6 +143,246 @@ public:
         return _buffer.code_unit_size();
     }
 
+    /**
+     * Get the smallest repertoire covering the code units of the text. This is
+     * recorded when the text is created.
+     */
+    neo::repertoire repertoire() const noexcept {
+        return unicode_detail::classified_in_host_order<internal_encoding>::value
+            ? unicode_detail::repertoire_of(_buffer)
+            : neo::repertoire::any;
+    }
+
+    /**
+     * Check whether the text has exactly one code unit per code point, in
+     * which case code point operations take constant time.
+     */
+    bool is_fixed_width() const noexcept {
+        return decoder<internal_encoding>::is_fixed_width(repertoire());
+    }
+
+    /**
+     * Get the number of code points in the text. The first call counts them
+     * with `neo::count_code_points()` and the count is kept with the buffer,
+     * where copies of the text share it.
+     */
+    size_type code_point_size() const noexcept {
+        if (is_fixed_width()) {
+            return code_unit_size();
+        }
+        return unicode_detail::code_point_count_of<internal_encoding>(_buffer);
+    }
+
+    /**
+     * Hash the text, so that texts that are equal hash alike. That is a hash
+     * of the code units, unless they are byte-swapped, when equal texts can
+     * differ in how their malformed code units are stored and the code points
+     * are hashed instead. A hash of the code units is kept with the buffer,
+     * like the code point count, so copies of a long text hash it only once.
+     */
+    std::size_t hash() const noexcept {
+        return unicode_detail::hash_code_points<internal_encoding>(_buffer);
+    }
+
+    /**
+     * Compare with a text of any encoding in code point order, without
+     * transcoding either one. Returns a negative number, zero, or a positive
+     * number as this text sorts before, with, or after `other`.
+     */
+    template <typename OtherEncoding, typename OtherBuffer>
+    int compare(const basic_text<OtherEncoding, OtherBuffer>& other) const noexcept {
+        return unicode_detail::compare_code_points<internal_encoding, OtherEncoding>(data(),
+                                                                                     code_unit_size(),
+                                                                                     other.data(),
+                                                                                     other.code_unit_size());
+    }
+
+    /**
+     * Get an iterator to the code point at index `n`, or `end()` if there are
+     * fewer than `n + 1` code points. Takes constant time if
+     * `is_fixed_width()`. Otherwise, takes time proportional to the stride of
+     * the code point index if there is one, and to `n` if there isn't.
+     */
+    iterator seek(size_type n) const noexcept {
+        const auto first = data();
+        const auto last = first + code_unit_size();
+        if (is_fixed_width()) {
+            return iterator(first, first + std::min(n, code_unit_size()), last);
+        }
+        auto ptr = first;
+        std::size_t remaining = n;
+        if (const auto index = unicode_detail::code_point_index_of(_buffer)) {
+            ptr += index->checkpoint(remaining);
+        }
+        ptr = unicode_detail::code_point_counter<internal_encoding>::advance(ptr, last, remaining);
+        return iterator(first, ptr, last);
+    }
+
+    /**
+     * Build an index of the code units of every `stride`th code point, so that
+     * `seek()` and `code_point_at()` no longer take time proportional to the
+     * length of the text. The index is built in one pass and kept with the
+     * buffer, where all copies of the text share it. A `stride` of zero is
+     * taken as one.
+     *
+     * Does nothing if the text is fixed-width, if it already has an index, or
+     * if its buffer isn't dynamically allocated.
+     */
+    void index_code_points(size_type stride = 1024) const {
+        if (!is_fixed_width()) {
+            unicode_detail::attach_code_point_index<internal_encoding>(_buffer, stride);
+        }
+    }
+
+    /**
+     * Get the code point at index `n`, counted in code points. Takes as long as
+     * `seek(n)`.
+     *
+     * @pre n < code_point_size()
+     */
+    char32_t code_point_at(size_type n) const noexcept {
+        return *seek(n);
+    }
+
+    /**
+     * Get an iterator to the first code point
+     */
+    iterator begin() const noexcept {
+        return iterator(data(), data(), data() + code_unit_size());
+    }
+
+    /**
+     * Get an iterator past the last code point
+     */
+    iterator end() const noexcept {
+        const auto last = data() + code_unit_size();
+        return iterator(data(), last, last);
+    }
+
+    reverse_iterator rbegin() const noexcept {
+        return reverse_iterator(end());
+    }
+
+    reverse_iterator rend() const noexcept {
+        return reverse_iterator(begin());
+    }
+
+    /**
+     * Find the first occurrence of `needle` that starts at or after `from`.
+     * A match always starts and ends on code point boundaries, so a needle
+     * never matches part of an encoded code point. An empty needle matches at
+     * `from`. Returns `end()` if there is no match. Never allocates.
+     */
+    iterator find(const basic_text& needle, iterator from) const noexcept {
+        const auto first = data();
+        const auto last = first + code_unit_size();
+        const auto p = unicode_detail::find_text<internal_encoding>(from.position(),
+                                                                    last,
+                                                                    needle.data(),
+                                                                    needle.code_unit_size());
+        return iterator(first, p ? p : last, last);
+    }
+
+    iterator find(const basic_text& needle) const noexcept {
+        return find(needle, begin());
+    }
+
+    /**
+     * Find the first match of `needle` at or after `from`, compared as `how`
+     * says, and get its bounds. A match that isn't `match::exact` can be
+     * longer or shorter than the needle. Returns a pair of `end()` if there
+     * is no match.
+     *
+     * Exact searches never allocate. The others allocate only if the needle
+     * is longer than 64 code points once it is case-folded or decomposed.
+     */
+    std::pair<iterator, iterator> search(const basic_text& needle, iterator from, match how) const {
+        const auto first = data();
+        const auto last = first + code_unit_size();
+        const auto found = unicode_detail::search_text<internal_encoding>(
+            from.position(), last, needle.data(), needle.data() + needle.code_unit_size(), how);
+        if (!found.first) {
+            return {end(), end()};
+        }
+        return {iterator(first, found.first, last), iterator(first, found.second, last)};
+    }
+
+    std::pair<iterator, iterator> search(const basic_text& needle, match how = match::exact) const {
+        return search(needle, begin(), how);
+    }
+
+    /**
+     * Find the first match of `needle`, compared as `how` says. See
+     * `search()`.
+     */
+    iterator find(const basic_text& needle, match how) const {
+        return search(needle, how).first;
+    }
+
+    /**
+     * Find the last occurrence of `needle`. See `find()`. An empty needle
+     * matches at `end()`.
+     */
+    iterator rfind(const basic_text& needle) const noexcept {
+        const auto first = data();
+        const auto last = first + code_unit_size();
+        const auto p = unicode_detail::rfind_text<internal_encoding>(first,
+                                                                     last,
+                                                                     needle.data(),
+                                                                     needle.code_unit_size());
+        return iterator(first, p ? p : last, last);
+    }
+
+    /**
+     * Check whether `needle` occurs in the text. See `find()`.
+     */
+    bool contains(const basic_text& needle) const noexcept {
+        return unicode_detail::find_text<internal_encoding>(data(),
+                                                            data() + code_unit_size(),
+                                                            needle.data(),
+                                                            needle.code_unit_size())
+            != nullptr;
+    }
+
+    /**
+     * Check whether `needle` matches anywhere in the text, compared as `how`
+     * says. See `search()`.
+     */
+    bool contains(const basic_text& needle, match how) const {
+        return search(needle, how).first != end() || needle.code_unit_size() == 0;
+    }
+
+    /**
+     * Count the non-overlapping occurrences of `needle`, from left to right.
+     * See `find()`. An empty needle matches between every two code points,
+     * and at both ends.
+     */
+    size_type count(const basic_text& needle) const noexcept {
+        if (needle.code_unit_size() == 0) {
+            return code_point_size() + 1;
+        }
+        return unicode_detail::count_text<internal_encoding>(data(),
+                                                             data() + code_unit_size(),
+                                                             needle.data(),
+                                                             needle.code_unit_size());
+    }
+
+    /**
+     * Count the non-overlapping matches of `needle`, compared as `how` says.
+     * See `search()` and `count()`.
+     */
+    size_type count(const basic_text& needle, match how) const {
+        if (needle.code_unit_size() == 0) {
+            return code_point_size() + 1;
+        }
+        return unicode_detail::count_text<internal_encoding>(data(),
+                                                             data() + code_unit_size(),
+                                                             needle.data(),
+                                                             needle.data()
+                                                                 + needle.code_unit_size(),
+                                                             how);
+    }
+
     /**
      * Name constructor for creating from a string literal
      */
@@ -135,17 +412,245 @@ public:
     }
 };
 
+namespace unicode_detail {
+
+/**
+ * Encode a code point as code units of a stream character type. Returns the
+ * number of code units written.
+ */
+inline std::size_t encode_to(char32_t cp, char* out) noexcept {
+    return encode_utf8(cp, out);
+}
+
+inline std::size_t encode_to(char32_t cp, char16_t* out) noexcept {
+    return encode_utf16(cp, out);
+}
+
+inline std::size_t encode_to(char32_t cp, char32_t* out) noexcept {
+    *out = cp;
+    return 1;
+}
+
+inline std::size_t encode_to(char32_t cp, wchar_t* out) noexcept {
+    if (sizeof(wchar_t) == 2) {
+        return encode_utf16(cp, out);
+    }
+    *out = static_cast<wchar_t>(cp);
+    return 1;
+}
+
+/**
+ * The number of code units transcoded on the stack per write to a stream
+ */
+constexpr std::size_t stream_chunk_size = 256;
+
+/**
+ * Write text to a stream with the same encoding. No transcoding necessary.
+ */
+template <typename CharT, typename Traits, typename Text>
+void write_text(std::basic_ostream<CharT, Traits>& o, const Text& u, std::true_type) {
+    o.write(u.data(), u.code_unit_size());
+}
+
+/**
+ * Write text to a stream with a different encoding. We transcode one chunk at
+ * a time into a buffer on the stack, so this never allocates.
+ */
+template <typename CharT, typename Traits, typename Text>
+void write_text(std::basic_ostream<CharT, Traits>& o, const Text& u, std::false_type) {
+    using text_decoder = decoder<typename Text::internal_encoding>;
+    CharT chunk[stream_chunk_size];
+    auto ptr = u.data();
+    const auto end = ptr + u.code_unit_size();
+    if (u.repertoire() == repertoire::ascii) {
+        // Every code unit is a code point that fits in a single CharT
+        while (ptr != end && o) {
+            const auto n = std::min<std::size_t>(stream_chunk_size, end - ptr);
+            for (std::size_t i = 0; i < n; ++i) {
+                chunk[i] = static_cast<CharT>(ptr[i]);
+            }
+            o.write(chunk, n);
+            ptr += n;
+        }
+        return;
+    }
+    while (ptr != end && o) {
+        std::size_t n = 0;
+        // Stop while there is still room for the longest encoding of a code
+        // point, which is four code units of UTF-8
+        while (ptr != end && n + 4 <= stream_chunk_size) {
+            n += encode_to(text_decoder::next(ptr, end), chunk + n);
+        }
+        o.write(chunk, n);
+    }
+}
+
+}  // namespace unicode_detail
+
+/**
+ * Texts of any encodings are equal if they have the same code points
+ */
+template <typename LEnc, typename LBuf, typename REnc, typename RBuf>
+bool operator==(const basic_text<LEnc, LBuf>& a, const basic_text<REnc, RBuf>& b) noexcept {
+    return unicode_detail::equal_code_points<LEnc, REnc>(a.data(),
+                                                         a.code_unit_size(),
+                                                         b.data(),
+                                                         b.code_unit_size());
+}
+
+template <typename LEnc, typename LBuf, typename REnc, typename RBuf>
+bool operator!=(const basic_text<LEnc, LBuf>& a, const basic_text<REnc, RBuf>& b) noexcept {
+    return !(a == b);
+}
+
+/**
+ * Texts of any encodings are ordered by their code points. See
+ * `basic_text::compare()`.
+ */
+template <typename LEnc, typename LBuf, typename REnc, typename RBuf>
+bool operator<(const basic_text<LEnc, LBuf>& a, const basic_text<REnc, RBuf>& b) noexcept {
+    return a.compare(b) < 0;
+}
+
+template <typename LEnc, typename LBuf, typename REnc, typename RBuf>
+bool operator>(const basic_text<LEnc, LBuf>& a, const basic_text<REnc, RBuf>& b) noexcept {
+    return a.compare(b) > 0;
+}
+
+template <typename LEnc, typename LBuf, typename REnc, typename RBuf>
+bool operator<=(const basic_text<LEnc, LBuf>& a, const basic_text<REnc, RBuf>& b) noexcept {
+    return a.compare(b) <= 0;
+}
+
+template <typename LEnc, typename LBuf, typename REnc, typename RBuf>
+bool operator>=(const basic_text<LEnc, LBuf>& a, const basic_text<REnc, RBuf>& b) noexcept {
+    return a.compare(b) >= 0;
+}
+
+#if __cpp_impl_three_way_comparison >= 201907L && __cpp_lib_three_way_comparison >= 201907L
+template <typename LEnc, typename LBuf, typename REnc, typename RBuf>
+std::strong_ordering operator<=>(const basic_text<LEnc, LBuf>& a, const basic_text<REnc, RBuf>& b) noexcept {
+    return a.compare(b) <=> 0;
+}
+#endif
+
+namespace unicode_detail {
+
+/**
+ * The code units of a text or a string, as a pointer and a size
+ */
+template <typename Unit> struct code_unit_span {
+    const Unit* data;
+    std::size_t size;
+};
+
+template <typename Encoding, typename Buffer>
+auto code_units_of(const basic_text<Encoding, Buffer>& t) noexcept {
+    return code_unit_span<std::decay_t<decltype(*t.data())>>{t.data(), t.code_unit_size()};
+}
+
+template <typename CharT> code_unit_span<CharT> code_units_of(const CharT* str) noexcept {
+    return {str, std::char_traits<CharT>::length(str)};
+}
+
+template <typename CharT, typename Traits, typename Alloc>
+code_unit_span<CharT> code_units_of(const std::basic_string<CharT, Traits, Alloc>& str) noexcept {
+    return {str.data(), str.size()};
+}
+
+#ifdef __cpp_lib_string_view
+template <typename CharT, typename Traits>
+code_unit_span<CharT> code_units_of(std::basic_string_view<CharT, Traits> str) noexcept {
+    return {str.data(), str.size()};
+}
+#endif
+
+template <typename T>
+using code_unit_type_t = std::decay_t<decltype(*code_units_of(std::declval<const T&>()).data)>;
+
+template <typename T> struct is_text : std::false_type {};
+template <typename Encoding, typename Buffer> struct is_text<basic_text<Encoding, Buffer>> : std::true_type {};
+
+/**
+ * Two texts can only be compared by their code units if they have the same
+ * encoding. A string is taken to be in the encoding of the text.
+ */
+template <typename Left, typename Right>
+struct comparable_code_units : std::is_same<code_unit_type_t<Left>, code_unit_type_t<Right>> {};
+template <typename LEnc, typename LBuf, typename REnc, typename RBuf>
+struct comparable_code_units<basic_text<LEnc, LBuf>, basic_text<REnc, RBuf>> : std::is_same<LEnc, REnc> {};
+
+}  // namespace unicode_detail
+
+/**
+ * A hash for texts and strings, for unordered containers. A string hashes
+ * like a text with the same code units, so a container keyed on text can be
+ * searched with a `const char*`, `std::string` or `std::string_view` without
+ * building a text from it. Texts hash by their code units, to go with
+ * `text_equal`.
+ */
+struct text_hash {
+    using is_transparent = void;
+
+    template <typename Encoding, typename Buffer>
+    std::size_t operator()(const basic_text<Encoding, Buffer>& t) const noexcept {
+        return unicode_detail::hash_of(t.template encode<Encoding>());
+    }
+
+    template <typename String,
+              typename = std::enable_if_t<!unicode_detail::is_text<String>::value>,
+              typename = unicode_detail::code_unit_type_t<String>>
+    std::size_t operator()(const String& str) const noexcept {
+        const auto units = unicode_detail::code_units_of(str);
+        return unicode_detail::hash_code_units(units.data, units.size);
+    }
+};
+
 /**
- * Stream ouput for text objects.
+ * Equality of texts and strings by their code units, to go with `text_hash`.
+ * Either side may be a text or a string with the same code unit type, but
+ * two texts must have the same encoding.
+ */
+struct text_equal {
+    using is_transparent = void;
+
+    template <typename Left,
+              typename Right,
+              typename = std::enable_if_t<unicode_detail::comparable_code_units<Left, Right>::value>>
+    bool operator()(const Left& left, const Right& right) const noexcept {
+        const auto l = unicode_detail::code_units_of(left);
+        const auto r = unicode_detail::code_units_of(right);
+        return l.size == r.size && std::equal(l.data, l.data + l.size, r.data);
+    }
+};
+
+/**
+ * Stream ouput for text objects. Text is written in the stream's encoding,
+ * transcoding on the fly.
  */
 template <typename CharT, typename Traits, typename InternalEncoding, typename BufferType>
 std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& o,
                                               const basic_text<InternalEncoding, BufferType>& u) {
-    auto buf = u.template encode<neo::encoding_for_char_type_t<CharT>>();
-    auto size = buf.code_unit_size();
-    return o.write(buf.data(), size);
+    unicode_detail::write_text(
+        o,
+        u,
+        std::is_same<InternalEncoding, neo::encoding_for_char_type_t<CharT>>{});
+    return o;
 }
 
 }  // namespace neo
 
+namespace std {
+
+/**
+ * Texts hash like they compare. See `basic_text::hash()`.
+ */
+template <typename Encoding, typename Buffer> struct hash<neo::basic_text<Encoding, Buffer>> {
+    std::size_t operator()(const neo::basic_text<Encoding, Buffer>& t) const noexcept {
+        return t.hash();
+    }
+};
+
+}  // namespace std
+
 #endif  // NEO_UNICODE_TEXT_HPP_INCLUDED
\ No newline at end of file
@@ -0,0 +1,137 @@
+#ifndef NEO_UNICODE_TEXT_VIEW_HPP_INCLUDED
+#define NEO_UNICODE_TEXT_VIEW_HPP_INCLUDED
+
+#include "compare.hpp"
+#include "text.hpp"
+
+#include <cstddef>
+
+namespace neo {
+
+/**
+ * A view of a run of code units of a text, such as a grapheme cluster or a
+ * word. It holds two pointers and copies nothing, so it is only valid as long
+ * as the text it views. Iterating it yields code points, and it never looks
+ * outside of its own code units.
+ */
+template <typename Encoding> class basic_text_view {
+public:
+    using internal_encoding = Encoding;
+    using code_unit_type = typename Encoding::code_unit_type;
+    using iterator = code_point_iterator<Encoding>;
+    using const_iterator = iterator;
+    using size_type = std::size_t;
+
+private:
+    const code_unit_type* _first = nullptr;
+    const code_unit_type* _last = nullptr;
+
+public:
+    basic_text_view() = default;
+
+    /**
+     * View [first, last), which must start and end on code point boundaries
+     */
+    basic_text_view(const code_unit_type* first, const code_unit_type* last) noexcept
+        : _first(first)
+        , _last(last) {}
+
+    /**
+     * View the whole of `text`
+     */
+    template <typename Buffer>
+    basic_text_view(const basic_text<Encoding, Buffer>& text) noexcept
+        : _first(text.data())
+        , _last(text.data() + text.code_unit_size()) {}
+
+    const code_unit_type* data() const noexcept {
+        return _first;
+    }
+
+    size_type code_unit_size() const noexcept {
+        return static_cast<size_type>(_last - _first);
+    }
+
+    bool empty() const noexcept {
+        return _first == _last;
+    }
+
+    iterator begin() const noexcept {
+        return iterator(_first, _first, _last);
+    }
+
+    iterator end() const noexcept {
+        return iterator(_first, _last, _last);
+    }
+
+    /**
+     * Copy the viewed code units into a text of their own
+     */
+    basic_text<Encoding> to_text() const {
+        using buffer_type = typename basic_text<Encoding>::buffer_type;
+        return basic_text<Encoding>(buffer_type(_first, _last));
+    }
+
+    /**
+     * Compare with a view of any encoding in code point order. See
+     * `basic_text::compare()`.
+     */
+    template <typename OtherEncoding> int compare(const basic_text_view<OtherEncoding>& other) const noexcept {
+        return unicode_detail::compare_code_points<Encoding, OtherEncoding>(_first,
+                                                                            code_unit_size(),
+                                                                            other.data(),
+                                                                            other.code_unit_size());
+    }
+
+    template <typename OtherEncoding, typename OtherBuffer>
+    int compare(const basic_text<OtherEncoding, OtherBuffer>& other) const noexcept {
+        return compare(basic_text_view<OtherEncoding>(other));
+    }
+};
+
+using text_view = basic_text_view<utf8>;
+
+/**
+ * Views compare with views and texts of any encoding by their code points
+ */
+template <typename LEnc, typename REnc>
+bool operator==(const basic_text_view<LEnc>& a, const basic_text_view<REnc>& b) noexcept {
+    return unicode_detail::equal_code_points<LEnc, REnc>(a.data(),
+                                                         a.code_unit_size(),
+                                                         b.data(),
+                                                         b.code_unit_size());
+}
+
+template <typename LEnc, typename REnc, typename RBuf>
+bool operator==(const basic_text_view<LEnc>& a, const basic_text<REnc, RBuf>& b) noexcept {
+    return a == basic_text_view<REnc>(b);
+}
+
+template <typename LEnc, typename LBuf, typename REnc>
+bool operator==(const basic_text<LEnc, LBuf>& a, const basic_text_view<REnc>& b) noexcept {
+    return basic_text_view<LEnc>(a) == b;
+}
+
+template <typename LEnc, typename REnc>
+bool operator!=(const basic_text_view<LEnc>& a, const basic_text_view<REnc>& b) noexcept {
+    return !(a == b);
+}
+
+template <typename LEnc, typename REnc, typename RBuf>
+bool operator!=(const basic_text_view<LEnc>& a, const basic_text<REnc, RBuf>& b) noexcept {
+    return !(a == b);
+}
+
+template <typename LEnc, typename LBuf, typename REnc>
+bool operator!=(const basic_text<LEnc, LBuf>& a, const basic_text_view<REnc>& b) noexcept {
+    return !(a == b);
+}
+
+template <typename LEnc, typename REnc>
+bool operator<(const basic_text_view<LEnc>& a, const basic_text_view<REnc>& b) noexcept {
+    return a.compare(b) < 0;
+}
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_TEXT_VIEW_HPP_INCLUDED
@@ -0,0 +1,199 @@
+#ifndef NEO_UNICODE_TRIM_HPP_INCLUDED
+#define NEO_UNICODE_TRIM_HPP_INCLUDED
+
+#include "search.hpp"
+#include "simd.hpp"
+#include "text.hpp"
+#include "text_view.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace neo {
+
+namespace unicode_detail {
+
+/**
+ * The White_Space code points in U+2000..U+203F, one bit each: the spaces
+ * of U+2000..U+200A, LINE SEPARATOR, PARAGRAPH SEPARATOR and NARROW NO-BREAK
+ * SPACE
+ */
+constexpr std::uint64_t general_punctuation_spaces = 0x7FF | (std::uint64_t(0x83) << 0x28);
+
+constexpr bool is_ascii_white_space(std::uint32_t u) noexcept {
+    return u == 0x20 || u - 0x09 < 5;
+}
+
+}  // namespace unicode_detail
+
+/**
+ * Whether `cp` has the Unicode White_Space property. There are 25 such code
+ * points, so they are checked by range rather than looked up.
+ */
+constexpr bool is_white_space(char32_t cp) noexcept {
+    return cp < 0x80 ? unicode_detail::is_ascii_white_space(cp)
+        : cp < 0x2000 ? cp == 0x85 || cp == 0xA0 || cp == 0x1680
+        : cp < 0x2040 ? ((unicode_detail::general_punctuation_spaces >> (cp - 0x2000)) & 1) != 0
+        : cp == 0x205F || cp == 0x3000;
+}
+
+namespace unicode_detail {
+
+#if NEO_UNICODE_HAVE_SSE2
+/**
+ * The lanes of `v` that hold ASCII white space. Signed comparison is fine,
+ * since units of 0x80 and up are either negative or above 0x0D.
+ */
+template <typename Unit> std::uint32_t ascii_white_space_lanes(__m128i v) noexcept {
+    using lanes = unit_lanes<sizeof(Unit)>;
+    const auto controls = _mm_andnot_si128(lanes::gt(v, lanes::splat(0x0D)), lanes::gt(v, lanes::splat(0x08)));
+    const auto space = _mm_or_si128(controls, lanes::eq(v, lanes::splat(0x20)));
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(space)) & lanes::lane_bits;
+}
+#endif
+
+/**
+ * Skip the ASCII white space from `p`, 16 bytes at a time
+ */
+template <typename Unit> const Unit* skip_ascii_white_space(const Unit* p, const Unit* last) noexcept {
+#if NEO_UNICODE_HAVE_SSE2
+    using lanes = unit_lanes<sizeof(Unit)>;
+    constexpr std::size_t width = 16 / sizeof(Unit);
+    while (last - p >= static_cast<std::ptrdiff_t>(width)) {
+        const auto space = ascii_white_space_lanes<Unit>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        if (space != lanes::lane_bits) {
+            return p + count_trailing_zeros(~space & lanes::lane_bits) / sizeof(Unit);
+        }
+        p += width;
+    }
+#endif
+    while (p != last && is_ascii_white_space(static_cast<std::make_unsigned_t<Unit>>(*p))) {
+        ++p;
+    }
+    return p;
+}
+
+/**
+ * Skip the ASCII white space that ends at `last` backwards, 16 bytes at a
+ * time, and return where it starts
+ */
+template <typename Unit> const Unit* skip_ascii_white_space_back(const Unit* first, const Unit* last) noexcept {
+#if NEO_UNICODE_HAVE_SSE2
+    using lanes = unit_lanes<sizeof(Unit)>;
+    constexpr std::size_t width = 16 / sizeof(Unit);
+    while (last - first >= static_cast<std::ptrdiff_t>(width)) {
+        const auto space
+            = ascii_white_space_lanes<Unit>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(last - width)));
+        if (space != lanes::lane_bits) {
+            return last - width + highest_set_bit(~space & lanes::lane_bits) / sizeof(Unit) + 1;
+        }
+        last -= width;
+    }
+#endif
+    while (last != first && is_ascii_white_space(static_cast<std::make_unsigned_t<Unit>>(last[-1]))) {
+        --last;
+    }
+    return last;
+}
+
+/**
+ * Skip the White_Space code points from `p`. ASCII that isn't white space
+ * stops it without decoding anything.
+ */
+template <typename Encoding, typename Unit> const Unit* trim_start(const Unit* p, const Unit* last) noexcept {
+    while (p != last) {
+        const auto u = static_cast<std::make_unsigned_t<Unit>>(*p);
+        if (ascii_code_units<Encoding>::value && u < 0x80) {
+            if (!is_ascii_white_space(u)) {
+                return p;
+            }
+            p = skip_ascii_white_space(p, last);
+            continue;
+        }
+        auto next = p;
+        if (!is_white_space(decoder<Encoding>::next(next, last))) {
+            return p;
+        }
+        p = next;
+    }
+    return p;
+}
+
+/**
+ * Skip the White_Space code points that end at `last` backwards, and return
+ * where they start
+ */
+template <typename Encoding, typename Unit> const Unit* trim_end(const Unit* first, const Unit* last) noexcept {
+    while (last != first) {
+        const auto u = static_cast<std::make_unsigned_t<Unit>>(last[-1]);
+        if (ascii_code_units<Encoding>::value && u < 0x80) {
+            if (!is_ascii_white_space(u)) {
+                return last;
+            }
+            last = skip_ascii_white_space_back(first, last);
+            continue;
+        }
+        auto prev = last;
+        if (!is_white_space(decoder<Encoding>::prev(prev, first))) {
+            return last;
+        }
+        last = prev;
+    }
+    return last;
+}
+
+}  // namespace unicode_detail
+
+/**
+ * View `text` without the White_Space code points at its start and end. The
+ * view refers to the text, which must outlive it. Trimming text that starts
+ * and ends with ASCII other than white space looks at two code units; runs of
+ * ASCII white space are skipped 16 bytes at a time.
+ */
+template <typename Encoding, typename Buffer>
+basic_text_view<Encoding> trim(const basic_text<Encoding, Buffer>& text) noexcept {
+    return trim(basic_text_view<Encoding>(text));
+}
+
+template <typename Encoding, typename Buffer> void trim(const basic_text<Encoding, Buffer>&&) = delete;
+
+template <typename Encoding> basic_text_view<Encoding> trim(basic_text_view<Encoding> view) noexcept {
+    const auto last = view.data() + view.code_unit_size();
+    const auto start = unicode_detail::trim_start<Encoding>(view.data(), last);
+    return basic_text_view<Encoding>(start, unicode_detail::trim_end<Encoding>(start, last));
+}
+
+/**
+ * View `text` without the White_Space code points at its start. See `trim()`.
+ */
+template <typename Encoding, typename Buffer>
+basic_text_view<Encoding> trim_start(const basic_text<Encoding, Buffer>& text) noexcept {
+    return trim_start(basic_text_view<Encoding>(text));
+}
+
+template <typename Encoding, typename Buffer> void trim_start(const basic_text<Encoding, Buffer>&&) = delete;
+
+template <typename Encoding> basic_text_view<Encoding> trim_start(basic_text_view<Encoding> view) noexcept {
+    const auto last = view.data() + view.code_unit_size();
+    return basic_text_view<Encoding>(unicode_detail::trim_start<Encoding>(view.data(), last), last);
+}
+
+/**
+ * View `text` without the White_Space code points at its end. See `trim()`.
+ */
+template <typename Encoding, typename Buffer>
+basic_text_view<Encoding> trim_end(const basic_text<Encoding, Buffer>& text) noexcept {
+    return trim_end(basic_text_view<Encoding>(text));
+}
+
+template <typename Encoding, typename Buffer> void trim_end(const basic_text<Encoding, Buffer>&&) = delete;
+
+template <typename Encoding> basic_text_view<Encoding> trim_end(basic_text_view<Encoding> view) noexcept {
+    const auto last = view.data() + view.code_unit_size();
+    return basic_text_view<Encoding>(view.data(), unicode_detail::trim_end<Encoding>(view.data(), last));
+}
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_TRIM_HPP_INCLUDED
@@ -0,0 +1,295 @@
+#ifndef NEO_UNICODE_UCD_TABLES_HPP_INCLUDED
+#define NEO_UNICODE_UCD_TABLES_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+namespace neo {
+
+namespace unicode_detail {
+
+/**
+ * Properties from the Unicode Character Database that utf8rewind doesn't
+ * have. The tables are generated by tools/ucd_tables.py, and each is two
+ * stages: the high bits of a code point pick a block, and the low bits a
+ * byte in that block. The enumerators are in the order that the generator
+ * numbers them.
+ */
+
+/**
+ * The Grapheme_Cluster_Break property of UAX #29
+ */
+enum class grapheme_break : std::uint8_t {
+    other,
+    cr,
+    lf,
+    control,
+    extend,
+    zwj,
+    regional_indicator,
+    prepend,
+    spacing_mark,
+    l,
+    v,
+    t,
+    lv,
+    lvt,
+};
+
+constexpr unsigned grapheme_table_shift = 7;
+extern const std::uint8_t grapheme_stage1[];
+extern const std::uint8_t grapheme_stage2[];
+
+/**
+ * The Word_Break property of UAX #29
+ */
+enum class word_break : std::uint8_t {
+    other,
+    cr,
+    lf,
+    newline,
+    extend,
+    zwj,
+    regional_indicator,
+    format,
+    katakana,
+    hebrew_letter,
+    aletter,
+    single_quote,
+    double_quote,
+    mid_num_let,
+    mid_letter,
+    mid_num,
+    numeric,
+    extend_num_let,
+    wseg_space,
+};
+
+constexpr unsigned word_table_shift = 7;
+extern const std::uint8_t word_stage1[];
+extern const std::uint8_t word_stage2[];
+
+/**
+ * The Sentence_Break property of UAX #29
+ */
+enum class sentence_break : std::uint8_t {
+    other,
+    cr,
+    lf,
+    extend,
+    sep,
+    format,
+    sp,
+    lower,
+    upper,
+    oletter,
+    numeric,
+    aterm,
+    scontinue,
+    sterm,
+    close,
+};
+
+constexpr unsigned sentence_table_shift = 7;
+extern const std::uint8_t sentence_stage1[];
+extern const std::uint8_t sentence_stage2[];
+
+/**
+ * The Line_Break property of UAX #14, as resolved by LB1: AI, SG and XX are
+ * AL, SA is CM or AL, and CJ is NS
+ */
+enum class line_break : std::uint8_t {
+    bk,
+    cr,
+    lf,
+    cm,
+    nl,
+    wj,
+    zw,
+    gl,
+    sp,
+    zwj,
+    b2,
+    ba,
+    bb,
+    hy,
+    cb,
+    cl,
+    cp,
+    ex,
+    in,
+    ns,
+    op,
+    qu,
+    is,
+    nu,
+    po,
+    pr,
+    sy,
+    al,
+    eb,
+    em,
+    h2,
+    h3,
+    hl,
+    id,
+    jl,
+    jv,
+    jt,
+    ri,
+};
+
+constexpr unsigned line_table_shift = 7;
+extern const std::uint8_t line_stage1[];
+extern const std::uint8_t line_stage2[];
+
+/**
+ * The Bidi_Class property of UAX #9
+ */
+enum class bidi_class : std::uint8_t {
+    l,
+    r,
+    al,
+    en,
+    es,
+    et,
+    an,
+    cs,
+    nsm,
+    bn,
+    b,
+    s,
+    ws,
+    on,
+    lre,
+    lro,
+    rle,
+    rlo,
+    pdf,
+    lri,
+    rli,
+    fsi,
+    pdi,
+};
+
+constexpr unsigned bidi_table_shift = 7;
+extern const std::uint8_t bidi_stage1[];
+extern const std::uint8_t bidi_stage2[];
+
+/**
+ * A code point with a Bidi_Paired_Bracket, and whether it opens or closes
+ */
+struct bidi_bracket {
+    char16_t code_point;
+    char16_t pair;
+    bool opening;
+};
+
+/**
+ * Every paired bracket, sorted by code point
+ */
+constexpr std::size_t bidi_bracket_count = 128;
+extern const bidi_bracket bidi_brackets[];
+
+/**
+ * The columns a code point takes in a monospace display, from its
+ * East_Asian_Width, General_Category and Emoji_Presentation
+ */
+constexpr unsigned width_table_shift = 7;
+extern const std::uint8_t width_stage1[];
+extern const std::uint8_t width_stage2[];
+
+/**
+ * The byte for `cp` in a two-stage table
+ */
+template <unsigned Shift>
+std::uint8_t two_stage_lookup(const std::uint8_t* stage1, const std::uint8_t* stage2, char32_t cp) noexcept {
+    if (cp > 0x10FFFF) {
+        return 0;
+    }
+    constexpr std::uint32_t mask = (1u << Shift) - 1;
+    return stage2[(std::uint32_t(stage1[cp >> Shift]) << Shift) | (cp & mask)];
+}
+
+/**
+ * Set in `grapheme_properties()` for Extended_Pictographic
+ */
+constexpr std::uint8_t extended_pictographic_bit = 0x10;
+
+/**
+ * The Grapheme_Cluster_Break of `cp` in the low four bits, or'ed with
+ * `extended_pictographic_bit`
+ */
+inline std::uint8_t grapheme_properties(char32_t cp) noexcept {
+    return two_stage_lookup<grapheme_table_shift>(grapheme_stage1, grapheme_stage2, cp);
+}
+
+/**
+ * Set in `word_properties()` for Extended_Pictographic, and for White_Space
+ * or punctuation
+ */
+constexpr std::uint8_t word_pictographic_bit = 0x20;
+constexpr std::uint8_t word_space_or_punctuation_bit = 0x40;
+
+/**
+ * The Word_Break of `cp` in the low five bits, or'ed with
+ * `word_pictographic_bit` and `word_space_or_punctuation_bit`
+ */
+inline std::uint8_t word_properties(char32_t cp) noexcept {
+    return two_stage_lookup<word_table_shift>(word_stage1, word_stage2, cp);
+}
+
+/**
+ * The Sentence_Break of `cp`
+ */
+inline sentence_break sentence_break_of(char32_t cp) noexcept {
+    return static_cast<sentence_break>(
+        two_stage_lookup<sentence_table_shift>(sentence_stage1, sentence_stage2, cp));
+}
+
+/**
+ * Set in `line_properties()` for unassigned Extended_Pictographic code
+ * points, and for East_Asian_Width F, W and H
+ */
+constexpr std::uint8_t line_pictographic_unassigned_bit = 0x40;
+constexpr std::uint8_t line_east_asian_wide_bit = 0x80;
+
+/**
+ * The Line_Break of `cp` in the low six bits, or'ed with
+ * `line_pictographic_unassigned_bit` and `line_east_asian_wide_bit`
+ */
+inline std::uint8_t line_properties(char32_t cp) noexcept {
+    return two_stage_lookup<line_table_shift>(line_stage1, line_stage2, cp);
+}
+
+/**
+ * Set in `bidi_properties()` for code points with a Bidi_Paired_Bracket
+ */
+constexpr std::uint8_t bidi_bracket_bit = 0x20;
+
+/**
+ * The Bidi_Class of `cp` in the low five bits, or'ed with `bidi_bracket_bit`
+ */
+inline std::uint8_t bidi_properties(char32_t cp) noexcept {
+    return two_stage_lookup<bidi_table_shift>(bidi_stage1, bidi_stage2, cp);
+}
+
+/**
+ * Set in `width_properties()` for code points with the Emoji property, which
+ * a variation selector can show as emoji
+ */
+constexpr std::uint8_t width_emoji_bit = 0x04;
+
+/**
+ * The display width of `cp`, 0, 1 or 2, in the low two bits, or'ed with
+ * `width_emoji_bit`
+ */
+inline std::uint8_t width_properties(char32_t cp) noexcept {
+    return two_stage_lookup<width_table_shift>(width_stage1, width_stage2, cp);
+}
+
+}  // namespace unicode_detail
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_UCD_TABLES_HPP_INCLUDED
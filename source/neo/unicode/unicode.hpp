@@ -1,7 +1,21 @@
 #ifndef NEO_UNICODE_UNICODE_HPP_INCLUDED
 #define NEO_UNICODE_UNICODE_HPP_INCLUDED
 
+#include "any_text.hpp"
+#include "bidi.hpp"
+#include "detect.hpp"
+#include "display_width.hpp"
+#include "grapheme.hpp"
+#include "line_break.hpp"
+#include "line_scan.hpp"
+#include "pattern_set.hpp"
+#include "regex.hpp"
+#include "sentence.hpp"
+#include "split.hpp"
 #include "text.hpp"
+#include "text_view.hpp"
+#include "trim.hpp"
+#include "word.hpp"
 
 #include "encodings/utf8.hpp"
 
@@ -0,0 +1,392 @@
+#ifndef NEO_UNICODE_WORD_HPP_INCLUDED
+#define NEO_UNICODE_WORD_HPP_INCLUDED
+
+#include "search.hpp"
+#include "simd.hpp"
+#include "text.hpp"
+#include "text_view.hpp"
+#include "ucd_tables.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+namespace neo {
+
+/**
+ * Which segments `words()` yields
+ */
+enum class word_segments {
+    /**
+     * Every segment, so that they cover the whole text
+     */
+    all,
+    /**
+     * Only segments with something besides white space and punctuation
+     */
+    skip_space_and_punctuation,
+};
+
+namespace unicode_detail {
+
+constexpr bool is_ascii_alnum(unsigned u) noexcept {
+    return (u - '0' < 10) || ((u | 0x20) - 'a' < 26);
+}
+
+/**
+ * Skip the ASCII letters and digits from `p`
+ */
+template <typename Unit> const Unit* skip_ascii_alnum(const Unit* p, const Unit* last) noexcept {
+#if NEO_UNICODE_HAVE_SSE2
+    using lanes = unit_lanes<sizeof(Unit)>;
+    constexpr std::size_t width = 16 / sizeof(Unit);
+    const auto case_bit = lanes::splat(0x20);
+    const auto below_a = lanes::splat('a' - 1);
+    const auto above_z = lanes::splat('z' + 1);
+    const auto below_0 = lanes::splat('0' - 1);
+    const auto above_9 = lanes::splat('9' + 1);
+    while (last - p >= static_cast<std::ptrdiff_t>(width)) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const auto lower = _mm_or_si128(v, case_bit);
+        const auto letter = _mm_and_si128(lanes::gt(lower, below_a), lanes::gt(above_z, lower));
+        const auto digit = _mm_and_si128(lanes::gt(v, below_0), lanes::gt(above_9, v));
+        const auto alnum = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_or_si128(letter, digit)))
+            & lanes::lane_bits;
+        if (alnum != lanes::lane_bits) {
+            return p + count_trailing_zeros(~alnum & lanes::lane_bits) / sizeof(Unit);
+        }
+        p += width;
+    }
+#endif
+    while (p != last && is_ascii_alnum(static_cast<std::make_unsigned_t<Unit>>(*p))) {
+        ++p;
+    }
+    return p;
+}
+
+constexpr unsigned word_break_of(std::uint8_t props) noexcept {
+    return props & 0x1F;
+}
+
+constexpr bool is_ahletter(unsigned w) noexcept {
+    return w == unsigned(word_break::aletter) || w == unsigned(word_break::hebrew_letter);
+}
+
+constexpr bool is_mid_num_let_q(unsigned w) noexcept {
+    return w == unsigned(word_break::mid_num_let) || w == unsigned(word_break::single_quote);
+}
+
+constexpr bool is_word_ignorable(unsigned w) noexcept {
+    return w == unsigned(word_break::extend) || w == unsigned(word_break::format) || w == unsigned(word_break::zwj);
+}
+
+constexpr bool is_word_newline(unsigned w) noexcept {
+    return w == unsigned(word_break::cr) || w == unsigned(word_break::lf) || w == unsigned(word_break::newline);
+}
+
+/**
+ * The properties of an ASCII letter or digit, without the tables
+ */
+constexpr std::uint8_t ascii_alnum_word_properties(unsigned u) noexcept {
+    return static_cast<std::uint8_t>(u - '0' < 10 ? word_break::numeric : word_break::aletter);
+}
+
+/**
+ * No code point has this Word_Break
+ */
+constexpr unsigned no_word_break = 0xFF;
+
+template <typename Encoding, typename Unit>
+std::uint8_t next_word_properties(const Unit*& p, const Unit* last) noexcept {
+    const auto u = static_cast<std::make_unsigned_t<Unit>>(*p);
+    if (ascii_code_units<Encoding>::value && u < 0x80) {
+        ++p;
+        return word_properties(u);
+    }
+    return word_properties(decoder<Encoding>::next(p, last));
+}
+
+/**
+ * The Word_Break of the first code point from `p` that WB4 doesn't ignore,
+ * or `no_word_break` at the end
+ */
+template <typename Encoding, typename Unit> unsigned word_break_ahead(const Unit* p, const Unit* last) noexcept {
+    while (p != last) {
+        const auto w = word_break_of(next_word_properties<Encoding>(p, last));
+        if (!is_word_ignorable(w)) {
+            return w;
+        }
+    }
+    return no_word_break;
+}
+
+/**
+ * Whether the rules from WB5 to WB13b keep `b` in the same segment as what
+ * comes before it: `prev` and `prev2` are the last two Word_Breaks that WB4
+ * doesn't ignore, and `ahead` gives the one after `b`.
+ */
+template <typename Ahead>
+bool word_joins(unsigned prev2, unsigned prev, unsigned b, Ahead&& ahead) noexcept {
+    using wb = word_break;
+    const bool mid_letter = b == unsigned(wb::mid_letter) || is_mid_num_let_q(b);
+    const bool mid_num = b == unsigned(wb::mid_num) || is_mid_num_let_q(b);
+    if (is_ahletter(prev)) {
+        if (is_ahletter(b) || b == unsigned(wb::numeric) || b == unsigned(wb::extend_num_let)) {
+            return true;
+        }
+        if (prev == unsigned(wb::hebrew_letter) && b == unsigned(wb::single_quote)) {
+            return true;
+        }
+        if (mid_letter && is_ahletter(ahead())) {
+            return true;
+        }
+        return prev == unsigned(wb::hebrew_letter) && b == unsigned(wb::double_quote)
+            && ahead() == unsigned(wb::hebrew_letter);
+    }
+    if (prev == unsigned(wb::numeric)) {
+        if (is_ahletter(b) || b == unsigned(wb::numeric) || b == unsigned(wb::extend_num_let)) {
+            return true;
+        }
+        return mid_num && ahead() == unsigned(wb::numeric);
+    }
+    if (prev == unsigned(wb::katakana)) {
+        return b == unsigned(wb::katakana) || b == unsigned(wb::extend_num_let);
+    }
+    if (prev == unsigned(wb::extend_num_let)) {
+        return is_ahletter(b) || b == unsigned(wb::numeric) || b == unsigned(wb::katakana)
+            || b == unsigned(wb::extend_num_let);
+    }
+    if (prev == unsigned(wb::mid_letter) || is_mid_num_let_q(prev)) {
+        if (is_ahletter(prev2) && is_ahletter(b)) {
+            return true;
+        }
+    }
+    if (prev == unsigned(wb::mid_num) || is_mid_num_let_q(prev)) {
+        if (prev2 == unsigned(wb::numeric) && b == unsigned(wb::numeric)) {
+            return true;
+        }
+    }
+    return prev == unsigned(wb::double_quote) && prev2 == unsigned(wb::hebrew_letter)
+        && b == unsigned(wb::hebrew_letter);
+}
+
+/**
+ * Find the end of the word segment that starts at `p`, which must be a
+ * segment boundary before `last`, by the rules of UAX #29. Sets
+ * `space_or_punctuation` to whether the segment has nothing else. Runs of
+ * ASCII letters and digits are skipped a block at a time.
+ */
+template <typename Encoding, typename Unit>
+const Unit* next_word_break(const Unit* p, const Unit* last, bool& space_or_punctuation) noexcept {
+    using unit = std::make_unsigned_t<Unit>;
+    constexpr bool ascii = ascii_code_units<Encoding>::value;
+    // The properties of the code point before `q`, and the last two
+    // Word_Breaks that WB4 doesn't ignore
+    std::uint8_t raw;
+    unsigned prev2 = no_word_break;
+    unsigned prev;
+    bool odd_indicators = false;
+    auto q = p;
+    raw = next_word_properties<Encoding>(q, last);
+    prev = word_break_of(raw);
+    odd_indicators = prev == unsigned(word_break::regional_indicator);
+    space_or_punctuation = (raw & word_space_or_punctuation_bit) != 0;
+    if (ascii && unit(*p) < 0x80 && *p != '_' && !is_ascii_alnum(unit(*p)) && q != last
+        && is_ascii_alnum(unit(*q))) {
+        // No rule joins a letter or digit to other ASCII that starts a
+        // segment
+        return q;
+    }
+    while (q != last) {
+        if (ascii && is_ascii_alnum(unit(*q)) && (is_ahletter(prev) || prev == unsigned(word_break::numeric))) {
+            // WB5, WB8, WB9 and WB10 join every ASCII letter and digit
+            const auto run = skip_ascii_alnum(q + 1, last);
+            prev2 = run - q >= 2 ? ascii_alnum_word_properties(unit(run[-2])) : prev;
+            raw = ascii_alnum_word_properties(unit(run[-1]));
+            prev = word_break_of(raw);
+            space_or_punctuation = false;
+            q = run;
+            if (q != last && unit(*q) < 0x80) {
+                // Only connectors and the Mid* classes might join the run to
+                // more ASCII
+                const auto w = word_break_of(word_properties(unit(*q)));
+                if (w == unsigned(word_break::other) || w == unsigned(word_break::wseg_space)
+                    || is_word_newline(w)) {
+                    return q;
+                }
+            }
+            continue;
+        }
+        auto r = q;
+        const auto next = next_word_properties<Encoding>(r, last);
+        const auto a = word_break_of(raw);
+        const auto b = word_break_of(next);
+        bool join;
+        bool ignored = false;
+        if (a == unsigned(word_break::cr) && b == unsigned(word_break::lf)) {
+            join = true;
+        } else if (is_word_newline(a) || is_word_newline(b)) {
+            join = false;
+        } else if (a == unsigned(word_break::zwj) && (next & word_pictographic_bit)) {
+            join = true;
+        } else if (a == unsigned(word_break::wseg_space) && b == unsigned(word_break::wseg_space)) {
+            join = true;
+        } else if (is_word_ignorable(b)) {
+            join = true;
+            ignored = true;
+        } else if (prev == unsigned(word_break::regional_indicator)
+                   && b == unsigned(word_break::regional_indicator)) {
+            join = odd_indicators;
+        } else {
+            join = word_joins(prev2, prev, b, [&] { return word_break_ahead<Encoding>(r, last); });
+        }
+        if (!join) {
+            return q;
+        }
+        if (!ignored) {
+            odd_indicators = b == unsigned(word_break::regional_indicator) && !odd_indicators;
+            prev2 = prev;
+            prev = b;
+        }
+        raw = next;
+        space_or_punctuation = space_or_punctuation && (next & word_space_or_punctuation_bit);
+        q = r;
+    }
+    return last;
+}
+
+}  // namespace unicode_detail
+
+/**
+ * A forward iterator over the word segments of a text, by the word
+ * boundaries of UAX #29. Dereferencing yields a `basic_text_view` of the
+ * segment.
+ */
+template <typename Encoding> class word_iterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = basic_text_view<Encoding>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = value_type;
+    using code_unit_type = typename Encoding::code_unit_type;
+
+private:
+    const code_unit_type* _pos = nullptr;
+    // The end of the segment at `_pos`
+    const code_unit_type* _next = nullptr;
+    const code_unit_type* _last = nullptr;
+    word_segments _segments = word_segments::all;
+
+    void _find_next() noexcept {
+        while (_pos != _last) {
+            bool space_or_punctuation;
+            _next = unicode_detail::next_word_break<Encoding>(_pos, _last, space_or_punctuation);
+            if (_segments == word_segments::all || !space_or_punctuation) {
+                return;
+            }
+            _pos = _next;
+        }
+        _next = _last;
+    }
+
+public:
+    word_iterator() = default;
+
+    /**
+     * Construct an iterator at `pos`, which must be a segment boundary in
+     * [pos, last]. Segments that `segments` excludes are skipped.
+     */
+    word_iterator(const code_unit_type* pos, const code_unit_type* last, word_segments segments) noexcept
+        : _pos(pos)
+        , _last(last)
+        , _segments(segments) {
+        _find_next();
+    }
+
+    /**
+     * Get a pointer to the first code unit of the current segment
+     */
+    const code_unit_type* position() const noexcept {
+        return _pos;
+    }
+
+    value_type operator*() const noexcept {
+        return value_type(_pos, _next);
+    }
+
+    word_iterator& operator++() noexcept {
+        _pos = _next;
+        _find_next();
+        return *this;
+    }
+
+    word_iterator operator++(int) noexcept {
+        auto copy = *this;
+        ++*this;
+        return copy;
+    }
+
+    friend bool operator==(const word_iterator& a, const word_iterator& b) noexcept {
+        return a._pos == b._pos;
+    }
+
+    friend bool operator!=(const word_iterator& a, const word_iterator& b) noexcept {
+        return !(a == b);
+    }
+};
+
+/**
+ * The word segments of a text, as returned by `words()`
+ */
+template <typename Encoding> class word_range {
+public:
+    using iterator = word_iterator<Encoding>;
+    using const_iterator = iterator;
+    using code_unit_type = typename Encoding::code_unit_type;
+
+private:
+    const code_unit_type* _first;
+    const code_unit_type* _last;
+    word_segments _segments;
+
+public:
+    word_range(const code_unit_type* first, const code_unit_type* last, word_segments segments) noexcept
+        : _first(first)
+        , _last(last)
+        , _segments(segments) {}
+
+    iterator begin() const noexcept {
+        return iterator(_first, _last, _segments);
+    }
+
+    iterator end() const noexcept {
+        return iterator(_last, _last, _segments);
+    }
+};
+
+/**
+ * Iterate the word segments of `text`, by the word boundaries of UAX #29.
+ * Words, runs of white space, and punctuation are segments of their own. With
+ * `word_segments::skip_space_and_punctuation`, segments of nothing but white
+ * space and punctuation are passed over. The range refers to the text, which
+ * must outlive it.
+ */
+template <typename Encoding, typename Buffer>
+word_range<Encoding> words(const basic_text<Encoding, Buffer>& text,
+                           word_segments segments = word_segments::all) noexcept {
+    return word_range<Encoding>(text.data(), text.data() + text.code_unit_size(), segments);
+}
+
+template <typename Encoding, typename Buffer>
+void words(const basic_text<Encoding, Buffer>&&, word_segments = word_segments::all) = delete;
+
+template <typename Encoding>
+word_range<Encoding> words(basic_text_view<Encoding> view, word_segments segments = word_segments::all) noexcept {
+    return word_range<Encoding>(view.data(), view.data() + view.code_unit_size(), segments);
+}
+
+}  // namespace neo
+
+#endif  // NEO_UNICODE_WORD_HPP_INCLUDED
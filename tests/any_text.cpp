@@ -0,0 +1,53 @@
+#include <neo/unicode.hpp>
+
+#include <catch/catch.hpp>
+
+#include <sstream>
+#include <string>
+
+using namespace neo;
+
+TEST_CASE("Same-encoding round trip shares the buffer") {
+    basic_text<utf16> u16 = u"Long enough to be stored in a shared dynamic buffer";
+    any_text t = u16;
+    CHECK(t.encoding() == encoding_id_of<utf16>::value);
+    CHECK(t.byte_size() == u16.byte_size());
+    CHECK(t.encode<utf16>().data() == u16.data());
+    CHECK(t.as<utf16>().data() == u16.data());
+    CHECK_FALSE(t.has_encoding(encoding_id::utf8));
+}
+
+TEST_CASE("Transcoding is cached") {
+    basic_text<utf16> u16 = u"Long enough to be stored in a shared dynamic buffer é";
+    any_text t = u16;
+    const auto first = t.encode<utf8>();
+    CHECK(t.has_encoding(encoding_id::utf8));
+    CHECK(t.encode<utf8>().data() == first.data());
+    CHECK(std::string(first.data())
+          == "Long enough to be stored in a shared dynamic buffer \xc3\xa9");
+
+    // Copies share the cached buffers too
+    const auto copy = t;
+    CHECK(copy.encode<utf8>().data() == first.data());
+    CHECK(copy.encode<utf16>().data() == u16.data());
+
+    // No direct encoder from UTF-16 to ISO-8859-1, so this goes through UTF-8
+    const auto l1 = t.encode<latin1>();
+    CHECK(l1.code_unit_size() == 53);
+    CHECK(static_cast<unsigned char>(l1.data()[52]) == 0xE9);
+}
+
+TEST_CASE("Construct from bytes of detected encoding") {
+    const std::string bytes("\xff\xfeH\x00i\x00!\x00", 8);
+    auto t = any_text::from_bytes(bytes.data(), bytes.size());
+    CHECK(t.encoding() == encoding_id::utf16le);
+    CHECK(t.byte_size() == 6);
+
+    std::ostringstream out;
+    out << t;
+    CHECK(out.str() == "Hi!");
+    CHECK_FALSE(t.has_encoding(encoding_id::utf8));
+
+    any_text moved = std::move(t);
+    CHECK(std::string(moved.encode<utf8>().data()) == "Hi!");
+}
@@ -0,0 +1,128 @@
+#include <neo/unicode.hpp>
+
+#include <catch/catch.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace neo;
+
+namespace {
+
+using text16 = basic_text<utf16>;
+
+std::vector<int> levels_of(const text16& text, text_direction direction = text_direction::automatic) {
+    const auto levels = resolve_bidi(text, direction);
+    std::vector<int> ret;
+    for (std::size_t i = 0; i < text.code_unit_size(); ++i) {
+        ret.push_back(levels.level(i));
+    }
+    return ret;
+}
+
+/**
+ * The code units of `text` in the order of a reordering map
+ */
+std::u16string reorder(const text16& text, const std::vector<std::size_t>& order) {
+    std::u16string ret;
+    for (const auto offset : order) {
+        ret += text.data()[offset];
+    }
+    return ret;
+}
+
+std::u16string visual(const text16& text, text_direction direction = text_direction::automatic) {
+    return reorder(text, resolve_bidi(text, direction).visual_order());
+}
+
+}  // namespace
+
+TEST_CASE("Resolve bidi levels") {
+    // Nothing to resolve without right-to-left characters
+    const unicode ascii = "Hello, world! 123";
+    const auto ltr = resolve_bidi(ascii);
+    CHECK(ltr.is_left_to_right());
+    CHECK(ltr.level(5) == 0);
+    CHECK(ltr.visual_order().size() == ascii.code_unit_size());
+    const unicode others = "caf\xc3\xa9 \xe6\xbc\xa2\xe5\xad\x97 \xe2\x80\x9cq\xe2\x80\x9d";
+    CHECK(resolve_bidi(others).is_left_to_right());
+
+    // Hebrew in English, and English in Arabic with digits
+    CHECK(levels_of(u"ab \u05d0\u05d1 cd") == (std::vector<int>{0, 0, 0, 1, 1, 0, 0, 0}));
+    CHECK(visual(u"ab \u05d0\u05d1 cd") == u"ab \u05d1\u05d0 cd");
+    CHECK(levels_of(u"\u0645\u0631 12 ab") == (std::vector<int>{1, 1, 1, 2, 2, 1, 2, 2}));
+    CHECK(visual(u"\u0645\u0631 12 ab") == u"ab 12 \u0631\u0645");
+    // Arabic digits are never left-to-right
+    CHECK(levels_of(u"\u0661\u0662") == (std::vector<int>{2, 2}));
+    const text16 digit = u"\u0661";
+    CHECK_FALSE(resolve_bidi(digit).is_left_to_right());
+
+    // The paragraph direction can be given
+    CHECK(levels_of(u"ab \u05d0", text_direction::right_to_left) == (std::vector<int>{2, 2, 1, 1}));
+    CHECK(levels_of(u"\u05d0 ab", text_direction::left_to_right) == (std::vector<int>{1, 0, 0, 0}));
+    CHECK(levels_of(u"! ?", text_direction::right_to_left) == (std::vector<int>{1, 1, 1}));
+
+    // Every code unit of a code point has its level
+    const unicode mixed = "a\xd7\x90\xf0\x90\xa4\x80 b";
+    const auto levels = resolve_bidi(mixed);
+    std::vector<int> units;
+    for (std::size_t i = 0; i < mixed.code_unit_size(); ++i) {
+        units.push_back(levels.level(i));
+    }
+    CHECK(units == (std::vector<int>{0, 1, 1, 1, 1, 1, 1, 0, 0}));
+    CHECK(levels.visual_order() == (std::vector<std::size_t>{0, 3, 1, 7, 8}));
+}
+
+TEST_CASE("Resolve explicit formatting and brackets") {
+    // An isolate doesn't affect what is around it
+    CHECK(levels_of(u"a \u2067b c\u2069 d") == (std::vector<int>{0, 0, 0, 2, 2, 2, 0, 0, 0}));
+    CHECK(visual(u"\u05d0 \u2066b c\u2069") == u"\u2069b c\u2066 \u05d0");
+    // First strong isolates take the direction of their contents
+    CHECK(levels_of(u"a\u2068\u05d0\u2069") == (std::vector<int>{0, 0, 1, 0}));
+    // Embeddings and overrides
+    CHECK(levels_of(u"a\u202bb\u202cc") == (std::vector<int>{0, 0, 2, 2, 0}));
+    CHECK(visual(u"ab\u202ecd\u202c") == u"ab\u202edc\u202c");
+
+    // Brackets take the direction of what they enclose if it matches the
+    // embedding, and otherwise of what is before them
+    CHECK(levels_of(u"a (\u05d1) c") == (std::vector<int>{0, 0, 0, 1, 0, 0, 0}));
+    CHECK(levels_of(u"\u05d0 (\u05d1) c", text_direction::left_to_right) ==
+          (std::vector<int>{1, 1, 1, 1, 1, 0, 0}));
+    // Reordering doesn't mirror
+    CHECK(visual(u"\u05d0 (\u05d1) c", text_direction::left_to_right) == u")\u05d1( \u05d0 c");
+    // The canonical equivalents of angle brackets pair
+    CHECK(levels_of(u"\u05d0 \u2329\u05d1\u3009 c", text_direction::left_to_right) ==
+          (std::vector<int>{1, 1, 1, 1, 1, 0, 0}));
+
+    // Each paragraph has its own direction
+    const text16 paragraphs = u"\u05d0\u05d1.\r\nab.";
+    const auto levels = resolve_bidi(paragraphs);
+    CHECK(levels.paragraph_level(0) == 1);
+    CHECK(levels.paragraph_level(4) == 1);
+    CHECK(levels.paragraph_level(5) == 0);
+    CHECK(levels_of(paragraphs) == (std::vector<int>{1, 1, 1, 1, 1, 0, 0, 0}));
+    CHECK(reorder(paragraphs, levels.visual_order(0, 3)) == u".\u05d1\u05d0");
+    CHECK(visual(paragraphs) == u"\n\r.\u05d1\u05d0ab.");
+}
+
+TEST_CASE("Reorder lines of bidi text") {
+    const text16 text = u"\u05d0\u05d1 \u05d2\u05d3 ab";
+    const auto levels = resolve_bidi(text);
+    CHECK(levels.paragraph_level(0) == 1);
+    // Whitespace at the end of a line takes the paragraph level, wherever
+    // the line breaks
+    CHECK(reorder(text, levels.visual_order(0, 3)) == u" \u05d1\u05d0");
+    CHECK(reorder(text, levels.visual_order(3, 8)) == u"ab \u05d3\u05d2");
+    CHECK(reorder(text, levels.visual_order()) == u"ab \u05d3\u05d2 \u05d1\u05d0");
+
+    // Views, and lines of UTF-8 found by line breaking
+    const unicode line = "one \xd7\xa9\xd7\xaa\xd7\x99\xd7\x9d three";
+    std::vector<std::size_t> order;
+    const auto line_levels = resolve_bidi(text_view(line));
+    for (const auto piece : line_breaks(line)) {
+        const auto first = static_cast<std::size_t>(piece.data() - line.data());
+        const auto part = line_levels.visual_order(first, first + piece.code_unit_size());
+        order.insert(order.end(), part.begin(), part.end());
+    }
+    CHECK(order == (std::vector<std::size_t>{0, 1, 2, 3, 10, 8, 6, 4, 12, 13, 14, 15, 16, 17}));
+}
@@ -0,0 +1,82 @@
+#include <neo/unicode.hpp>
+
+#include <catch/catch.hpp>
+
+#include <string>
+
+using namespace neo;
+
+namespace {
+
+std::string bytes_of(const char16_t* str, bool big_endian) {
+    std::string ret;
+    for (; *str; ++str) {
+        const auto hi = static_cast<char>(*str >> 8);
+        const auto lo = static_cast<char>(*str & 0xFF);
+        ret += big_endian ? hi : lo;
+        ret += big_endian ? lo : hi;
+    }
+    return ret;
+}
+
+}  // namespace
+
+TEST_CASE("Byte order marks are certain") {
+    const std::string utf8_bom = "\xef\xbb\xbfHello";
+    auto found = detect_encoding(utf8_bom);
+    CHECK(found.encoding() == encoding_id::utf8);
+    CHECK(found.confidence() == detection_confidence::certain);
+    CHECK(found.bom_size == 3);
+
+    const auto be = "\xfe\xff" + bytes_of(u"Hello", true);
+    found = detect_encoding(be);
+    CHECK(found.encoding() == encoding_id::utf16be);
+    CHECK(found.bom_size == 2);
+
+    const std::string utf32le_bom("\xff\xfe\x00\x00H\x00\x00\x00", 8);
+    found = detect_encoding(utf32le_bom);
+    CHECK(found.encoding() == encoding_id::utf32le);
+    CHECK(found.candidates[1].encoding == encoding_id::utf16le);
+}
+
+TEST_CASE("UTF-8 and ISO-8859-1 are told apart") {
+    const std::string utf8_str = "Long enough for a vector pass: na\xc3\xafve caf\xc3\xa9";
+    auto found = detect_encoding(utf8_str);
+    CHECK(found.encoding() == encoding_id::utf8);
+    CHECK(found.confidence() == detection_confidence::high);
+
+    // A multi-byte sequence split across two blocks
+    const std::string split = "Fifteen bytes..\xe2\x82\xac and more";
+    CHECK(detect_encoding(split).encoding() == encoding_id::utf8);
+
+    const std::string latin1_str = "Long enough for a vector pass: na\xefve caf\xe9";
+    found = detect_encoding(latin1_str);
+    CHECK(found.encoding() == encoding_id::latin1);
+    CHECK(found.candidates[1].encoding == encoding_id::unknown);
+
+    const auto text = decode_bytes<utf8>(latin1_str.data(), latin1_str.size());
+    CHECK(std::string(text.data()) == utf8_str);
+}
+
+TEST_CASE("UTF-16 and UTF-32 without a byte order mark") {
+    const auto le = bytes_of(u"Some text in UTF-16, little-endian é中", false);
+    auto found = detect_encoding(le);
+    CHECK(found.encoding() == encoding_id::utf16le);
+    CHECK(found.confidence() == detection_confidence::high);
+
+    const auto be = bytes_of(u"Some text in UTF-16, big-endian", true);
+    CHECK(detect_encoding(be).encoding() == encoding_id::utf16be);
+
+    const std::string utf32be("\x00\x00\x00H\x00\x00\x00i\x00\x01\xf6\x00\x00\x00\x00!", 16);
+    found = detect_encoding(utf32be);
+    CHECK(found.encoding() == encoding_id::utf32be);
+
+    const auto text = transcode_bytes<utf8>(found.encoding(), utf32be.data(), utf32be.size());
+    CHECK(std::string(text.data()) == "Hi\xf0\x9f\x98\x80!");
+
+    // Unaligned input is fine
+    const auto shifted = " " + le;
+    const auto u16 = transcode_bytes<utf16>(encoding_id::utf16le, shifted.data() + 1, le.size());
+    CHECK(u16.code_unit_size() == le.size() / 2);
+    CHECK(u16.data()[0] == u'S');
+}
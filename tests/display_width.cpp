@@ -0,0 +1,81 @@
+#include <neo/unicode.hpp>
+
+#include <catch/catch.hpp>
+
+#include <string>
+
+using namespace neo;
+
+namespace {
+
+std::size_t width(const char* s) {
+    return display_width(unicode(s));
+}
+
+}  // namespace
+
+TEST_CASE("Measure the display width of ASCII") {
+    CHECK(width("") == 0);
+    CHECK(width("Hello, world!") == 13);
+    // Control characters take no columns
+    CHECK(width("a\tb\r\n\x7f") == 2);
+    const std::string line = "The quick brown fox\tjumps over the lazy dog\n";
+    CHECK(width((line + line + line).data()) == 3 * (line.size() - 2));
+
+    // The same in UTF-16 and UTF-32
+    const basic_text<utf16> text16 = u"The quick brown fox\tjumps over the lazy dog\n";
+    CHECK(display_width(text16) == line.size() - 2);
+    const basic_text<utf32> text32 = U"The quick brown fox\tjumps over the lazy dog\n";
+    CHECK(display_width(text32) == line.size() - 2);
+}
+
+TEST_CASE("Measure the display width of other scripts") {
+    // Wide and fullwidth characters take two columns, halfwidth and
+    // ambiguous ones one
+    CHECK(width("\xe6\xbc\xa2\xe5\xad\x97") == 4);
+    CHECK(width("\xef\xbc\xa1\xef\xbc\xa2") == 4);
+    CHECK(width("\xef\xbd\xb1 \xc2\xb1") == 3);
+    // Marks don't add to the cluster they are in, even a spacing one
+    CHECK(width("e\xcc\x81 caf\xc3\xa9") == 6);
+    CHECK(width("\xe0\xa4\x95\xe0\xa4\xbf") == 1);
+    CHECK(width("\xcc\x81") == 0);
+    // Conjoining Hangul is as wide as the syllable it makes
+    CHECK(width("\xe1\x84\x80\xe1\x85\xa1\xe1\x86\xa8") == 2);
+    CHECK(width("\xed\x95\x9c") == 2);
+    // Zero width space and soft hyphen
+    CHECK(width("a\xe2\x80\x8b" "b\xc2\xad") == 3);
+
+    // Emoji, with modifiers, joiners, flags and variation selectors
+    CHECK(width("\xf0\x9f\x91\x8d") == 2);
+    CHECK(width("\xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd") == 2);
+    CHECK(width("\xf0\x9f\x91\xa8\xe2\x80\x8d\xf0\x9f\x91\xa9\xe2\x80\x8d\xf0\x9f\x91\xa7") == 2);
+    CHECK(width("\xf0\x9f\x87\xab\xf0\x9f\x87\xb7") == 2);
+    CHECK(width("\xe2\x9d\xa4") == 1);
+    CHECK(width("\xe2\x9d\xa4\xef\xb8\x8f") == 2);
+    CHECK(width("1#\xef\xb8\x8f\xe2\x83\xa3") == 3);
+    const basic_text<utf16> text16 = u"\u6f22 \u2764\ufe0f \u00e9";
+    CHECK(display_width(text16) == 7);
+}
+
+TEST_CASE("Fit text in a display width") {
+    const unicode hello = "Hello, world!";
+    CHECK(fit_display_width(hello, 5).offset == 5);
+    CHECK(fit_display_width(hello, 5).width == 5);
+    CHECK(fit_display_width(hello, 100).offset == 13);
+    CHECK(fit_display_width(hello, 100).width == 13);
+    CHECK(fit_display_width(hello, 0).offset == 0);
+    const unicode longer = "The quick brown fox jumps over the lazy dog";
+    CHECK(fit_display_width(longer, 33).offset == 33);
+    CHECK(fit_display_width(text_view(longer), 40).width == 40);
+
+    // A cluster is never split, and a wide one that doesn't fit is left out
+    const unicode wide = "ab\xe6\xbc\xa2\xe5\xad\x97";
+    CHECK(fit_display_width(wide, 3).offset == 2);
+    CHECK(fit_display_width(wide, 3).width == 2);
+    CHECK(fit_display_width(wide, 4).offset == 5);
+    const unicode marks = "e\xcc\x81" "e\xcc\x81";
+    CHECK(fit_display_width(marks, 1).offset == 3);
+    const unicode keycap = "1#\xef\xb8\x8f\xe2\x83\xa3";
+    CHECK(fit_display_width(keycap, 2).offset == 1);
+    CHECK(fit_display_width(keycap, 2).width == 1);
+}
@@ -0,0 +1,95 @@
+#include <neo/unicode.hpp>
+
+#include <catch/catch.hpp>
+
+#include <string>
+
+using namespace neo;
+
+TEST_CASE("Native byte order encoders share the buffer") {
+    utf16::buffer_type buf(u"Shared buffer, no copy, more than thirty-two units");
+    auto native = encoder<utf16,
+                          utf16_ordered<byte_order::native>>::encode(buf);
+    CHECK(native.data() == buf.data());
+}
+
+TEST_CASE("UTF-8 to big-endian UTF-16") {
+    // Long enough to go through the vectorized ASCII path, with non-ASCII
+    // code points and a surrogate pair mixed in
+    unicode u = "Plain ASCII prefix that is long enough \xc3\xa9 and \xf0\x9f\x98\x80 done";
+    auto be = u.encode<utf16be>();
+    const auto bytes = reinterpret_cast<const unsigned char*>(be.data());
+    REQUIRE(be.code_unit_size() == 52);
+    CHECK(bytes[0] == 0x00);
+    CHECK(bytes[1] == 'P');
+    CHECK(bytes[39 * 2] == 0x00);
+    CHECK(bytes[39 * 2 + 1] == 0xE9);
+    CHECK(bytes[45 * 2] == 0xD8);
+    CHECK(bytes[45 * 2 + 1] == 0x3D);
+
+    basic_text<utf16be> round_trip = be.data();
+    auto back = round_trip.encode<utf8>();
+    CHECK(std::string(back.data()) == u.data());
+}
+
+TEST_CASE("UTF-32 byte orders round trip") {
+    unicode u = "Twenty-two ASCII units \xe2\x82\xac";
+    auto be = u.encode<utf32be>();
+    auto le = u.encode<utf32le>();
+    REQUIRE(be.code_unit_size() == 24);
+    REQUIRE(le.code_unit_size() == 24);
+    const auto be_bytes = reinterpret_cast<const unsigned char*>(be.data());
+    const auto le_bytes = reinterpret_cast<const unsigned char*>(le.data());
+    CHECK(be_bytes[3] == 'T');
+    CHECK(le_bytes[0] == 'T');
+    CHECK(be_bytes[23 * 4 + 2] == 0x20);
+    CHECK(le_bytes[23 * 4 + 1] == 0x20);
+
+    auto swapped = encoder<utf32be, utf32>::encode(be);
+    CHECK(swapped.data()[23] == U'€');
+    CHECK(std::string(encoder<utf32be, utf8>::encode(be).data()) == u.data());
+    CHECK(std::string(encoder<utf32le, utf8>::encode(le).data()) == u.data());
+
+    // Empty input encodes to nothing, and malformed UTF-8 is replaced
+    using from_utf8 = encoder<utf8, utf32>;
+    using to_utf8 = encoder<utf32, utf8>;
+    CHECK(from_utf8::do_encode("", 0).code_unit_size() == 0);
+    CHECK(to_utf8::do_encode(U"", 0).code_unit_size() == 0);
+    CHECK((encoder<utf8, utf16>::do_encode("", 0).code_unit_size() == 0));
+    CHECK((encoder<utf16, utf8>::do_encode(u"", 0).code_unit_size() == 0));
+    CHECK((encoder<utf8, wide>::do_encode("", 0).code_unit_size() == 0));
+    CHECK((encoder<wide, utf8>::do_encode(L"", 0).code_unit_size() == 0));
+    const auto replaced = from_utf8::do_encode("caf\xc3", 4);
+    REQUIRE(replaced.code_unit_size() == 4);
+    CHECK(replaced.data()[3] == U'\ufffd');
+}
+
+namespace {
+
+/**
+ * Encode `bytes` as `Encoding` and back to UTF-8
+ */
+template <typename Encoding> std::string round_trip(const char* bytes) {
+    const basic_text<Encoding> text(encoder<utf8, Encoding>::encode(utf8::buffer_type(bytes)));
+    return text.template encode<utf8>().data();
+}
+
+}  // namespace
+
+TEST_CASE("Malformed input is replaced in either byte order") {
+    // Long enough that the vectorized ASCII paths run on both sides
+    const char* bad = "ab\xff" "cd, then enough ASCII for a few vectors";
+    const std::string replaced = "ab\xef\xbf\xbd" "cd, then enough ASCII for a few vectors";
+    CHECK(round_trip<utf16le>(bad) == replaced);
+    CHECK(round_trip<utf16be>(bad) == replaced);
+    CHECK(round_trip<utf32le>(bad) == replaced);
+    CHECK(round_trip<utf32be>(bad) == replaced);
+
+    // Unpaired surrogates and values past U+10FFFF are replaced on the way back
+    constexpr auto foreign_order
+        = byte_order::native == byte_order::little ? byte_order::big : byte_order::little;
+    const char16_t units16[] = {0x7800, 0x00D8, 0x7900, 0};
+    const char32_t units32[] = {0x78000000, 0x00001100, 0x79000000, 0};
+    CHECK(std::string(basic_text<utf16_ordered<foreign_order>>(units16).encode<utf8>().data()) == "x\xef\xbf\xbdy");
+    CHECK(std::string(basic_text<utf32_ordered<foreign_order>>(units32).encode<utf8>().data()) == "x\xef\xbf\xbdy");
+}
@@ -0,0 +1,133 @@
+#include <neo/unicode.hpp>
+
+#include <catch/catch.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace neo;
+
+namespace {
+
+/**
+ * The clusters of `text`, found forwards and checked against the clusters
+ * found backwards and against `is_grapheme_break()`
+ */
+template <typename Encoding, typename String = std::basic_string<typename Encoding::code_unit_type>>
+std::vector<String> clusters(const basic_text<Encoding>& text) {
+    using string = String;
+    std::vector<string> ret;
+    for (const auto g : graphemes(text)) {
+        ret.emplace_back(g.data(), g.code_unit_size());
+    }
+    std::vector<string> backward;
+    const auto range = graphemes(text);
+    for (auto it = range.end(); it != range.begin();) {
+        --it;
+        backward.insert(backward.begin(), string((*it).data(), (*it).code_unit_size()));
+    }
+    CHECK(backward == ret);
+    std::size_t breaks = 0;
+    for (auto it = text.begin(); it != text.end(); ++it) {
+        breaks += is_grapheme_break(text, it);
+    }
+    CHECK(breaks == ret.size());
+    return ret;
+}
+
+using strings = std::vector<std::string>;
+
+}  // namespace
+
+TEST_CASE("Split ASCII into grapheme clusters") {
+    CHECK(clusters(unicode("")).empty());
+    CHECK(clusters(unicode("ab c")) == (strings{"a", "b", " ", "c"}));
+    CHECK(clusters(unicode("a\r\nb\n\rc")) == (strings{"a", "\r\n", "b", "\n", "\r", "c"}));
+    CHECK(clusters(unicode("\r\r\n\n")) == (strings{"\r", "\r\n", "\n"}));
+}
+
+TEST_CASE("Split marks, Hangul and Indic scripts into grapheme clusters") {
+    // Combining marks, and marks after controls
+    CHECK(clusters(unicode("e\xcc\x81\xcc\xa3x")) == (strings{"e\xcc\x81\xcc\xa3", "x"}));
+    CHECK(clusters(unicode("\n\xcc\x81")) == (strings{"\n", "\xcc\x81"}));
+    // Hangul syllables from jamo: L V T, and LV T
+    CHECK(clusters(unicode("\xe1\x84\x80\xe1\x85\xa1\xe1\x86\xa8\xea\xb0\x80\xe1\x86\xa8\xea\xb0\x80"))
+          == (strings{"\xe1\x84\x80\xe1\x85\xa1\xe1\x86\xa8", "\xea\xb0\x80\xe1\x86\xa8", "\xea\xb0\x80"}));
+    // A spacing mark: DEVANAGARI LETTER KA, VOWEL SIGN I
+    CHECK(clusters(unicode("\xe0\xa4\x95\xe0\xa4\xbf\xe0\xa4\x95"))
+          == (strings{"\xe0\xa4\x95\xe0\xa4\xbf", "\xe0\xa4\x95"}));
+    // A prepended concatenation mark: ARABIC NUMBER SIGN joins what follows,
+    // but not a control
+    CHECK(clusters(unicode("\xd8\x80" "1\xd8\x80\n")) == (strings{"\xd8\x80" "1", "\xd8\x80", "\n"}));
+}
+
+TEST_CASE("Split emoji into grapheme clusters") {
+    // Flags are pairs of regional indicators
+    const unicode flags = "\xf0\x9f\x87\xab\xf0\x9f\x87\xb7\xf0\x9f\x87\xa9\xf0\x9f\x87\xaa\xf0\x9f\x87\xaf";
+    CHECK(clusters(flags)
+          == (strings{"\xf0\x9f\x87\xab\xf0\x9f\x87\xb7", "\xf0\x9f\x87\xa9\xf0\x9f\x87\xaa", "\xf0\x9f\x87\xaf"}));
+    // A family joined with ZWJ, skin tones, and a ZWJ that joins no emoji
+    const unicode family = "\xf0\x9f\x91\xa8\xe2\x80\x8d\xf0\x9f\x91\xa9\xe2\x80\x8d\xf0\x9f\x91\xa7!";
+    CHECK(clusters(family)
+          == (strings{"\xf0\x9f\x91\xa8\xe2\x80\x8d\xf0\x9f\x91\xa9\xe2\x80\x8d\xf0\x9f\x91\xa7", "!"}));
+    CHECK(clusters(unicode("\xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd\xe2\x80\x8d\xe2\x9d\xa4"))
+          == (strings{"\xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd\xe2\x80\x8d\xe2\x9d\xa4"}));
+    CHECK(clusters(unicode("a\xe2\x80\x8d\xf0\x9f\x91\xa7")) == (strings{"a\xe2\x80\x8d", "\xf0\x9f\x91\xa7"}));
+
+    // The same clusters in UTF-16
+    const auto u16 = family.encode<utf16>();
+    CHECK(clusters(basic_text<utf16>(u16.data())).size() == 2);
+}
+
+TEST_CASE("Grapheme iterators") {
+    const unicode u = "e\xcc\x81t\xc3\xa9 \xf0\x9f\x87\xab\xf0\x9f\x87\xb7";
+    const auto range = graphemes(u);
+    CHECK(std::distance(range.begin(), range.end()) == 5);
+    auto it = range.begin();
+    CHECK(*it == unicode("e\xcc\x81"));
+    CHECK((*it).to_text() == unicode("e\xcc\x81"));
+    ++it;
+    CHECK(it.position() == u.data() + 3);
+    CHECK(*std::prev(range.end()) == unicode("\xf0\x9f\x87\xab\xf0\x9f\x87\xb7"));
+    // A view can be split again, and doesn't look outside of itself
+    const text_view view(u.data() + 1, u.data() + u.code_unit_size());
+    CHECK(std::distance(graphemes(view).begin(), graphemes(view).end()) == 5);
+    CHECK_FALSE(is_grapheme_break(u, std::next(u.begin())));
+    CHECK(is_grapheme_break(u, std::next(u.begin(), 2)));
+}
+
+TEST_CASE("Truncate text between grapheme clusters") {
+    const unicode hello = "Hello, world!";
+    CHECK(truncate_to(hello, 5) == unicode("Hello"));
+    CHECK(truncate_to(hello, 100).code_unit_size() == 13);
+    CHECK(truncate_to(hello, 0).code_unit_size() == 0);
+    CHECK(truncate_to(hello, 5).data() == hello.data());
+    const unicode crlf = "ab\r\ncd";
+    CHECK(truncate_to(crlf, 3) == unicode("ab"));
+
+    // Neither code points nor clusters are split
+    const unicode cafe = "caf\xc3\xa9";
+    CHECK(truncate_to(cafe, 4) == unicode("caf"));
+    const unicode mark = "e\xcc\x81x";
+    CHECK(truncate_to(mark, 2).code_unit_size() == 0);
+    const unicode flags = "\xf0\x9f\x87\xab\xf0\x9f\x87\xb7\xf0\x9f\x87\xa9\xf0\x9f\x87\xaa";
+    CHECK(truncate_to(flags, 15).code_unit_size() == 8);
+    const unicode stray = "ab\x80\x80\x80\x80" "c";
+    CHECK(truncate_to(stray, 4).code_unit_size() == 4);
+    const basic_text<utf16> text16 = u"a\U0001f600b";
+    CHECK(truncate_to(text16, 2).code_unit_size() == 1);
+
+    // Every limit gives the last cluster boundary within it
+    const unicode mixed = "e\xcc\x81t\xc3\xa9 \xf0\x9f\x91\xa8\xe2\x80\x8d\xf0\x9f\x91\xa9 \xe1\x84\x80\xe1\x85\xa1!\r\n";
+    std::vector<std::size_t> breaks;
+    for (const auto g : graphemes(mixed)) {
+        breaks.push_back(static_cast<std::size_t>(g.data() - mixed.data()));
+    }
+    breaks.push_back(mixed.code_unit_size());
+    for (std::size_t n = 0; n <= mixed.code_unit_size(); ++n) {
+        const auto expected = *std::prev(std::upper_bound(breaks.begin(), breaks.end(), n));
+        CHECK(truncate_to(text_view(mixed), n).code_unit_size() == expected);
+    }
+}
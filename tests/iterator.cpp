@@ -0,0 +1,150 @@
+#include <neo/unicode.hpp>
+
+#include <catch/catch.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace neo;
+
+namespace {
+
+template <typename Text> std::vector<char32_t> forward(const Text& t) {
+    return std::vector<char32_t>(t.begin(), t.end());
+}
+
+template <typename Text> std::vector<char32_t> backward(const Text& t) {
+    std::vector<char32_t> ret(t.rbegin(), t.rend());
+    std::reverse(ret.begin(), ret.end());
+    return ret;
+}
+
+}  // namespace
+
+TEST_CASE("Iterate UTF-8 code points") {
+    unicode u = "a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80z";
+    const std::vector<char32_t> expected = {U'a', U'é', U'€', U'\U0001F600', U'z'};
+    CHECK(forward(u) == expected);
+    CHECK(backward(u) == expected);
+    CHECK(std::distance(u.begin(), u.end()) == 5);
+    CHECK(std::count(u.begin(), u.end(), U'€') == 1);
+
+    auto it = std::find(u.begin(), u.end(), U'\U0001F600');
+    REQUIRE(it != u.end());
+    CHECK(it.position() == u.data() + 6);
+    --it;
+    CHECK(*it == U'€');
+    CHECK(*std::prev(u.end()) == U'z');
+}
+
+TEST_CASE("Malformed UTF-8 steps the same way in both directions") {
+    const unicode samples[] = {
+        "\xe2\x82 truncated",
+        "stray \x80\x80 continuations",
+        "\xc3\xa9\xa9 extra continuation",
+        "\xf0\x9f\x98\x80\x80 after a four-byte sequence",
+        "\xe0\x80\x80 overlong",
+        "\xe2\xc3\xa9 new lead",
+        "\xff\xfe invalid leads",
+        "ends truncated \xf0\x9f\x98",
+    };
+    for (const auto& u : samples) {
+        const auto fwd = forward(u);
+        CHECK(fwd == backward(u));
+        CHECK(std::count(fwd.begin(), fwd.end(), U'�') > 0);
+    }
+}
+
+TEST_CASE("Iterate UTF-16 code points") {
+    basic_text<utf16> u = u"a\U0001F600é";
+    const std::vector<char32_t> expected = {U'a', U'\U0001F600', U'é'};
+    CHECK(forward(u) == expected);
+    CHECK(backward(u) == expected);
+
+    basic_text<utf16> unpaired = u"x\xDC00\xD800y\xD800";
+    const std::vector<char32_t> replaced = {U'x', U'�', U'�', U'y', U'�'};
+    CHECK(forward(unpaired) == replaced);
+    CHECK(backward(unpaired) == replaced);
+
+    basic_text<utf16be> be(unicode("a\xf0\x9f\x98\x80").encode<utf16be>());
+    CHECK(forward(be) == (std::vector<char32_t>{U'a', U'\U0001F600'}));
+    CHECK(backward(be) == (std::vector<char32_t>{U'a', U'\U0001F600'}));
+}
+
+TEST_CASE("Range-based for over text") {
+    basic_text<utf32> u = U"abc";
+    std::u32string str;
+    for (char32_t c : u) {
+        str += c;
+    }
+    CHECK(str == U"abc");
+    const unicode empty;
+    CHECK(empty.begin() == empty.end());
+}
+
+TEST_CASE("Seek to a code point") {
+    std::string str;
+    for (auto i = 0; i < 100; ++i) {
+        str += "ascii \xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80 ";
+    }
+    const unicode u = str.c_str();
+    const basic_text<utf16> u16(u.encode<utf16>());
+    const auto n_code_points = static_cast<std::size_t>(std::distance(u.begin(), u.end()));
+
+    const auto check_seeks = [&] {
+        auto it = u.begin();
+        auto it16 = u16.begin();
+        for (std::size_t n = 0; n < n_code_points; ++n, ++it, ++it16) {
+            REQUIRE(u.seek(n) == it);
+            REQUIRE(u16.seek(n) == it16);
+        }
+        CHECK(u.seek(n_code_points) == u.end());
+        CHECK(u.seek(n_code_points + 1000) == u.end());
+        CHECK(u16.seek(n_code_points + 1000) == u16.end());
+    };
+    check_seeks();
+
+    u.index_code_points(7);
+    u16.index_code_points(5);
+    CHECK(u.encode<utf8>().attachment() != nullptr);
+    // Copies share the index
+    const auto copy = u;
+    CHECK(copy.encode<utf8>().attachment() == u.encode<utf8>().attachment());
+    check_seeks();
+    CHECK(u.code_point_at(17) == U'€');
+
+    // A stride of zero indexes every code point
+    const basic_text<utf16> every(u.encode<utf16>());
+    every.index_code_points(0);
+    CHECK(every.encode<utf16>().attachment() != nullptr);
+    CHECK(every.code_point_at(17) == U'\u20ac');
+    CHECK(every.seek(n_code_points) == every.end());
+
+    // Seeking steps over malformed code units as iteration does
+    std::string malformed;
+    for (auto i = 0; i < 50; ++i) {
+        malformed += "\x80\xc3\xa9\xa9\xe2\x82z\xf0\x9f\x98\x80\x80";
+    }
+    const unicode bad = malformed.c_str();
+    const auto check_malformed_seeks = [&] {
+        std::size_t n = 0;
+        for (auto it = bad.begin(); it != bad.end(); ++it, ++n) {
+            REQUIRE(bad.seek(n) == it);
+        }
+        CHECK(bad.seek(n) == bad.end());
+    };
+    check_malformed_seeks();
+    bad.index_code_points(7);
+    check_malformed_seeks();
+    const unicode cut = (std::string(65, 'a') + "\xe2" "x" "\x80" + std::string(100, 'a')).c_str();
+    CHECK(cut.code_point_at(67) == U'\ufffd');
+    CHECK(cut.code_point_at(68) == U'a');
+
+    // Small and fixed-width texts have no use for an index
+    const unicode small = "small";
+    small.index_code_points();
+    CHECK(small.encode<utf8>().attachment() == nullptr);
+    CHECK(small.code_point_at(4) == U'l');
+}
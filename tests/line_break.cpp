@@ -0,0 +1,101 @@
+#include <neo/unicode.hpp>
+
+#include <catch/catch.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace neo;
+
+namespace {
+
+using strings = std::vector<std::string>;
+
+strings split(const unicode& text) {
+    strings ret;
+    for (const auto s : line_breaks(text)) {
+        ret.emplace_back(s.data(), s.code_unit_size());
+    }
+    return ret;
+}
+
+/**
+ * The pieces of `text` after which the line must break
+ */
+strings mandatory(const unicode& text) {
+    strings ret;
+    const auto range = line_breaks(text);
+    for (auto it = range.begin(); it != range.end(); ++it) {
+        if (it.mandatory()) {
+            const auto s = *it;
+            ret.emplace_back(s.data(), s.code_unit_size());
+        }
+    }
+    return ret;
+}
+
+}  // namespace
+
+TEST_CASE("Find line break opportunities in ASCII") {
+    CHECK(split(unicode("")).empty());
+    CHECK(split(unicode("The quick  fox")) == (strings{"The ", "quick  ", "fox"}));
+    CHECK(mandatory(unicode("The quick  fox")) == (strings{"fox"}));
+    // Hard line breaks, with CR LF together
+    CHECK(split(unicode("one\ntwo\r\nthree\r\r")) == (strings{"one\n", "two\r\n", "three\r", "\r"}));
+    CHECK(mandatory(unicode("one\ntwo three\r\n")) == (strings{"one\n", "three\r\n"}));
+    // No break before closing punctuation or after opening punctuation
+    CHECK(split(unicode("Wow! (so) [much], \"quoted\"; a/b")) ==
+          (strings{"Wow! ", "(so) ", "[much], ", "\"quoted\"; ", "a/", "b"}));
+    // Breaks after hyphens, but not inside numbers
+    CHECK(split(unicode("well-known 3.14 -5 $10 20%")) ==
+          (strings{"well-", "known ", "3.14 ", "-5 ", "$10 ", "20%"}));
+    // Long words cross the blocks that are skipped at once
+    const std::string longer = "Supercalifragilisticexpialidocious1234567890abcdefghijklm";
+    CHECK(split(unicode((longer + "   " + longer + ".").data())) == (strings{longer + "   ", longer + "."}));
+}
+
+TEST_CASE("Find line break opportunities in other scripts") {
+    // No-break space and word joiner glue; zero width space breaks
+    CHECK(split(unicode("a\xc2\xa0" "b c\xe2\x81\xa0" "d e\xe2\x80\x8b" "f"))
+          == (strings{"a\xc2\xa0" "b ", "c\xe2\x81\xa0" "d ", "e\xe2\x80\x8b", "f"}));
+    // A line separator is a mandatory break
+    CHECK(mandatory(unicode("a\xe2\x80\xa8" "b")) == (strings{"a\xe2\x80\xa8", "b"}));
+    // A break between ideographs, but not before an ideographic full stop
+    CHECK(split(unicode("\xe4\xbd\xa0\xe5\xa5\xbd\xe3\x80\x82\xe8\xb0\xa2"))
+          == (strings{"\xe4\xbd\xa0", "\xe5\xa5\xbd\xe3\x80\x82", "\xe8\xb0\xa2"}));
+    // Wide brackets break from letters; narrow ones do not
+    CHECK(split(unicode("a\xef\xbc\x88" "b\xef\xbc\x89" "c(d)e"))
+          == (strings{"a", "\xef\xbc\x88" "b\xef\xbc\x89", "c(d)e"}));
+    // Combining marks stay with their base, and a mark after a space is a
+    // letter
+    CHECK(split(unicode("e\xcc\x81 \xcc\x81x")) == (strings{"e\xcc\x81 ", "\xcc\x81x"}));
+    // Emoji modifiers join their base; flags pair up
+    CHECK(split(unicode("\xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd\xf0\x9f\x91\x8d"))
+          == (strings{"\xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd", "\xf0\x9f\x91\x8d"}));
+    CHECK(split(unicode("\xf0\x9f\x87\xab\xf0\x9f\x87\xb7\xf0\x9f\x87\xa9\xf0\x9f\x87\xaa\xf0\x9f\x87\xa9"))
+          == (strings{"\xf0\x9f\x87\xab\xf0\x9f\x87\xb7", "\xf0\x9f\x87\xa9\xf0\x9f\x87\xaa", "\xf0\x9f\x87\xa9"}));
+
+    // The same opportunities in UTF-16
+    const unicode text = "na\xc3\xafve caf\xc3\xa9-bar \xe6\xbc\xa2\xe5\xad\x97";
+    const auto u16 = text.encode<utf16>();
+    const basic_text<utf16> text16 = u16.data();
+    std::vector<std::u16string> parts;
+    for (const auto s : line_breaks(text16)) {
+        parts.emplace_back(s.data(), s.code_unit_size());
+    }
+    CHECK(parts == (std::vector<std::u16string>{u"na\u00efve ", u"caf\u00e9-", u"bar ", u"\u6f22", u"\u5b57"}));
+}
+
+TEST_CASE("Line break iterators point into the text") {
+    const unicode text = "Hello, world!\nBye";
+    const auto range = line_breaks(text);
+    auto it = range.begin();
+    CHECK((*it).data() == text.data());
+    CHECK_FALSE(it.mandatory());
+    ++it;
+    CHECK(*it == unicode("world!\n"));
+    CHECK(it.position() == text.data() + 7);
+    CHECK(it.mandatory());
+    CHECK(*line_breaks(text_view(*it)).begin() == unicode("world!\n"));
+    CHECK(std::distance(range.begin(), range.end()) == 3);
+}
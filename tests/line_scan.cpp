@@ -0,0 +1,106 @@
+#include <neo/unicode.hpp>
+
+#include <catch/catch.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace neo;
+
+namespace {
+
+struct line {
+    std::string text;
+    bool valid;
+
+    friend bool operator==(const line& a, const line& b) {
+        return a.text == b.text && a.valid == b.valid;
+    }
+};
+
+std::vector<line> scan(const std::string& data, line_check check = line_check::utf8) {
+    std::vector<line> ret;
+    for_each_line(data.data(),
+                  data.size(),
+                  [&](const scanned_line& l) { ret.push_back({data.substr(l.offset, l.size), l.valid}); },
+                  check);
+    return ret;
+}
+
+}  // namespace
+
+TEST_CASE("Scan the lines of a log") {
+    CHECK(scan("one\ntwo\r\n\nthree")
+          == (std::vector<line>{{"one", true}, {"two", true}, {"", true}, {"three", true}}));
+    CHECK(scan("one\n") == (std::vector<line>{{"one", true}}));
+    CHECK(scan("\n") == (std::vector<line>{{"", true}}));
+    CHECK(scan("").empty());
+    // Only LF ends a line
+    CHECK(scan("a\rb\x0b" "c\xc2\x85" "d\n") == (std::vector<line>{{"a\rb\x0b" "c\xc2\x85" "d", true}}));
+
+    // Long lines, and lines that cross blocks
+    std::string log;
+    for (int i = 0; i < 200; ++i) {
+        log += std::string(static_cast<std::size_t>(i % 70), 'x') + "\r\n";
+    }
+    const auto lines = scan(log, line_check::none);
+    REQUIRE(lines.size() == 200);
+    for (std::size_t i = 0; i < lines.size(); ++i) {
+        CHECK(lines[i].text.size() == i % 70);
+    }
+
+    // Texts and views, and stopping early
+    const unicode text = "first\nsecond\nthird\n";
+    std::size_t count = 0;
+    for_each_line(text, [&](const scanned_line&) { ++count; });
+    CHECK(count == 3);
+    std::vector<std::size_t> offsets;
+    for_each_line(text_view(text), [&](const scanned_line& l) {
+        offsets.push_back(l.offset);
+        return l.offset == 0;
+    });
+    CHECK(offsets == (std::vector<std::size_t>{0, 6}));
+}
+
+TEST_CASE("Check each line of a log for malformed UTF-8") {
+    CHECK(scan("caf\xc3\xa9\n\xe6\xbc\xa2\n\xf0\x9f\x98\x80\r\n")
+          == (std::vector<line>{{"caf\xc3\xa9", true}, {"\xe6\xbc\xa2", true}, {"\xf0\x9f\x98\x80", true}}));
+    // Stray continuation bytes, overlong forms, surrogates, and sequences
+    // cut short by the end of the line or of the data
+    CHECK(scan("a\x80\nok\n\xc0\xaf\n\xed\xa0\x80\n\xe6\xbc\n\xbc\xa2\n\xf0\x9f")
+          == (std::vector<line>{{"a\x80", false},
+                                {"ok", true},
+                                {"\xc0\xaf", false},
+                                {"\xed\xa0\x80", false},
+                                {"\xe6\xbc", false},
+                                {"\xbc\xa2", false},
+                                {"\xf0\x9f", false}}));
+    // Nothing is checked unless asked
+    CHECK(scan("a\x80\n", line_check::none) == (std::vector<line>{{"a\x80", true}}));
+
+    // Malformed bytes anywhere in long lines are found, and only their lines
+    // are reported
+    std::string log;
+    for (int i = 0; i < 100; ++i) {
+        std::string l = std::string(static_cast<std::size_t>(i), 'x') + "\xc3\xa9 " + std::to_string(i);
+        if (i % 7 == 3) {
+            l[static_cast<std::size_t>(i / 2)] = '\xff';
+        }
+        log += l + "\n";
+    }
+    std::vector<std::size_t> bad;
+    std::size_t offset = 0;
+    std::size_t i = 0;
+    for (const auto& l : invalid_lines(log.data(), log.size())) {
+        while (offset != l.offset) {
+            offset = log.find('\n', offset) + 1;
+            ++i;
+        }
+        bad.push_back(i);
+    }
+    CHECK(bad == (std::vector<std::size_t>{3, 10, 17, 24, 31, 38, 45, 52, 59, 66, 73, 80, 87, 94}));
+    const unicode text = "good\nb\xe6" "d\n";
+    REQUIRE(invalid_lines(text).size() == 1);
+    CHECK(invalid_lines(text)[0].offset == 5);
+    CHECK(invalid_lines(text_view(text))[0].size == 3);
+}
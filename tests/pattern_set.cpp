@@ -0,0 +1,190 @@
+#include <neo/unicode.hpp>
+
+#include <catch/catch.hpp>
+
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace neo;
+
+namespace {
+
+using span = std::tuple<std::size_t, std::size_t, std::size_t>;
+
+/**
+ * The matches as (pattern, start, end), in code units
+ */
+template <typename Text> std::vector<span> spans(const pattern_set& set, const Text& t) {
+    std::vector<span> ret;
+    for (const auto& m : set.find_all(t)) {
+        ret.emplace_back(m.pattern,
+                         static_cast<std::size_t>(m.first.position() - t.data()),
+                         static_cast<std::size_t>(m.last.position() - t.data()));
+    }
+    return ret;
+}
+
+/**
+ * Every occurrence of every needle, in the order in which the matches end,
+ * longest first
+ */
+template <typename String>
+std::vector<span> naive_spans(const std::vector<String>& needles, const String& hay) {
+    std::vector<span> ret;
+    for (std::size_t end = 1; end <= hay.size(); ++end) {
+        std::vector<span> here;
+        for (std::size_t i = 0; i < needles.size(); ++i) {
+            const auto m = needles[i].size();
+            if (m && m <= end && hay.compare(end - m, m, needles[i]) == 0) {
+                here.emplace_back(i, end - m, end);
+            }
+        }
+        std::stable_sort(here.begin(), here.end(), [](const span& a, const span& b) {
+            return std::get<1>(a) < std::get<1>(b);
+        });
+        ret.insert(ret.end(), here.begin(), here.end());
+    }
+    return ret;
+}
+
+template <typename String> String random_string(std::uint32_t& seed, std::size_t size, unsigned n_letters) {
+    String ret;
+    for (std::size_t i = 0; i < size; ++i) {
+        seed = seed * 1103515245 + 12345;
+        ret.push_back(static_cast<typename String::value_type>('a' + ((seed >> 16) % n_letters)));
+    }
+    return ret;
+}
+
+template <typename String> String lower(String s) {
+    for (auto& c : s) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<typename String::value_type>(c + 0x20);
+        }
+    }
+    return s;
+}
+
+/**
+ * Compare with a naive search for sets of a few to a few hundred patterns,
+ * which covers the Teddy filter, the start unit filter and neither. Ignoring
+ * case, every third letter is upper case.
+ */
+template <typename Text, typename String> void check_against_naive(match how = match::exact) {
+    const auto mixed_case = [&](String s) {
+        for (std::size_t i = 0; how == match::case_insensitive && i < s.size(); i += 3) {
+            if (s[i] >= 'a' && s[i] <= 'z') {
+                s[i] = static_cast<typename String::value_type>(s[i] - 0x20);
+            }
+        }
+        return s;
+    };
+    std::uint32_t seed = 1234;
+    for (std::size_t n_patterns : {1, 3, 9, 40, 64, 65, 300}) {
+        for (unsigned n_letters : {2u, 4u, 20u}) {
+            const auto hay = mixed_case(random_string<String>(seed, 500, n_letters));
+            std::vector<String> needles;
+            std::vector<Text> patterns;
+            for (std::size_t i = 0; i < n_patterns; ++i) {
+                seed = seed * 1103515245 + 12345;
+                const auto m = 1 + (seed >> 16) % 6;
+                needles.push_back(i % 2 ? hay.substr((seed >> 8) % 490, m)
+                                        : random_string<String>(seed, m, n_letters));
+                patterns.emplace_back(mixed_case(needles.back()).c_str());
+                needles.back() = lower(needles.back());
+            }
+            const pattern_set set(patterns, how);
+            CHECK(spans(set, Text(hay.c_str())) == naive_spans(needles, lower(hay)));
+        }
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Find a set of patterns") {
+    const pattern_set set = {"he", "she", "his", "hers"};
+    CHECK(set.size() == 4);
+    CHECK(set.how() == match::exact);
+    CHECK(spans(set, unicode("ushers"))
+          == (std::vector<span>{span{1, 1, 4}, span{0, 2, 4}, span{3, 2, 6}}));
+    CHECK(set.found_in(unicode("this")));
+    CHECK(set.found_in(unicode("hello")));
+    CHECK_FALSE(set.found_in(unicode("nothing at all")));
+    CHECK_FALSE(set.found_in(unicode("")));
+
+    auto m = set.find_all(unicode("ushers"));
+    CHECK(*m[0].first == U's');
+
+    // The scan stops once the callback returns false
+    std::size_t n = 0;
+    set.for_each_match(unicode("she sells his shells"), [&](const pattern_match<unicode::iterator>&) {
+        return ++n < 2;
+    });
+    CHECK(n == 2);
+}
+
+TEST_CASE("Pattern matches are on code point boundaries") {
+    const pattern_set set = {"é", "\xc3\xa9t\xc3\xa9", "t"};
+    unicode u = "l'été";
+    CHECK(spans(set, u) == (std::vector<span>{span{0, 2, 4}, span{2, 4, 5}, span{1, 2, 7}, span{0, 5, 7}}));
+
+    basic_text<utf16> w = u"été";
+    CHECK(spans(set, w) == (std::vector<span>{span{0, 0, 1}, span{2, 1, 2}, span{1, 0, 3}, span{0, 2, 3}}));
+
+    const char16_t smile[] = {u'a', 0xD83D, 0xDE00, u'b', 0};
+    const pattern_set emoji = {"\xf0\x9f\x98\x80", "b"};
+    CHECK(spans(emoji, basic_text<utf16>(smile)) == (std::vector<span>{span{0, 1, 3}, span{1, 3, 4}}));
+}
+
+TEST_CASE("Empty pattern sets and patterns") {
+    const pattern_set none;
+    CHECK(none.size() == 0);
+    CHECK_FALSE(none.found_in(unicode("anything")));
+    const pattern_set empty = {"", "a"};
+    CHECK(empty.size() == 2);
+    CHECK(spans(empty, unicode("bab")) == (std::vector<span>{span{1, 1, 2}}));
+}
+
+TEST_CASE("Patterns of other encodings") {
+    const std::vector<basic_text<utf16>> patterns = {u"κόσμε", u"world"};
+    const pattern_set set(patterns);
+    unicode u = "hello world, καλημέρα κόσμε";
+    const auto found = set.find_all(u);
+    REQUIRE(found.size() == 2);
+    CHECK(found[0].pattern == 1);
+    CHECK(found[1].pattern == 0);
+    CHECK(found[1].last == u.end());
+}
+
+TEST_CASE("Find a set of patterns ignoring case") {
+    const pattern_set set({"straße", "KÖLN", "k"}, match::case_insensitive);
+    unicode u = "Die STRASSE nach Köln";
+    CHECK(spans(set, u) == (std::vector<span>{span{0, 4, 11}, span{2, 17, 18}, span{1, 17, 22}}));
+    // KELVIN SIGN folds to "k"
+    CHECK(set.found_in(unicode("300 \xe2\x84\xaa")));
+    CHECK_FALSE(set.found_in(unicode("Strass")));
+    basic_text<utf16> w = u"straSSe";
+    CHECK(set.found_in(w));
+}
+
+TEST_CASE("Find a set of patterns up to equivalence") {
+    const pattern_set canonical({"café", "\xe1\xba\xb9\xcc\x81"}, match::canonical);
+    unicode u = "cafe\xcc\x81 x e\xcc\x81\xcc\xa3";
+    CHECK(spans(canonical, u) == (std::vector<span>{span{0, 0, 6}, span{1, 9, 14}}));
+    CHECK_FALSE(canonical.found_in(unicode("caf\xc3\xa9\xcc\xa8")));
+
+    const pattern_set compatible({"fi", "2", "\xcc\x81"}, match::compatible);
+    unicode v = "\xef\xac\x81ne x\xc2\xb2";
+    CHECK(spans(compatible, v) == (std::vector<span>{span{0, 0, 3}, span{1, 7, 9}}));
+    // A match ends on segment boundaries, so "fi" isn't in "ﬁ" U+0301
+    CHECK_FALSE(compatible.found_in(unicode("\xef\xac\x81\xcc\x81")));
+}
+
+TEST_CASE("Pattern sets agree with a naive search") {
+    check_against_naive<unicode, std::string>();
+    check_against_naive<basic_text<utf16>, std::u16string>();
+    check_against_naive<unicode, std::string>(match::case_insensitive);
+    check_against_naive<basic_text<utf16>, std::u16string>(match::case_insensitive);
+}
@@ -0,0 +1,222 @@
+#include <neo/unicode.hpp>
+
+#include <catch/catch.hpp>
+
+#include <cstdint>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace neo;
+
+namespace {
+
+using span = std::pair<std::size_t, std::size_t>;
+
+/**
+ * The bounds of the first match in code units, or (npos, npos)
+ */
+span first_span(const regex& re, const unicode& t) {
+    const auto m = re.search(t);
+    if (!m) {
+        return {std::string::npos, std::string::npos};
+    }
+    return {static_cast<std::size_t>(m.first.position() - t.data()),
+            static_cast<std::size_t>(m.last.position() - t.data())};
+}
+
+std::vector<span> spans(const regex& re, const unicode& t) {
+    std::vector<span> ret;
+    for (const auto& m : re.find_all(t)) {
+        ret.emplace_back(static_cast<std::size_t>(m.first.position() - t.data()),
+                         static_cast<std::size_t>(m.last.position() - t.data()));
+    }
+    return ret;
+}
+
+std::uint32_t next_random(std::uint32_t& seed) {
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+/**
+ * A random pattern over "abc" that a backtracking engine treats the same:
+ * nothing that can match the empty string is repeated
+ */
+std::string random_pattern(std::uint32_t& seed) {
+    static const char* const atoms[] = {"a", "b", "c", ".", "[ab]", "[^a]", "(?:ab|a)", "(b|ca|c)", "\\w"};
+    static const char* const quantifiers[] = {"", "", "", "*", "+", "?", "{1,2}", "{0,2}", "{2}", "*?", "+?", "??"};
+    std::string ret;
+    if (next_random(seed) % 8 == 0) {
+        ret += '^';
+    }
+    const auto n = 1 + next_random(seed) % 4;
+    for (std::uint32_t i = 0; i < n; ++i) {
+        ret += atoms[next_random(seed) % 9];
+        ret += quantifiers[next_random(seed) % 12];
+    }
+    if (next_random(seed) % 5 == 0) {
+        ret += "|" + std::string(atoms[next_random(seed) % 9]);
+    }
+    if (next_random(seed) % 8 == 0) {
+        ret += '$';
+    }
+    return ret;
+}
+
+}  // namespace
+
+TEST_CASE("Find a regex") {
+    const regex re("colou?r");
+    CHECK(re.how() == match::exact);
+    unicode u = "The color, or colour, of colr";
+    CHECK(first_span(re, u) == span(4, 9));
+    CHECK(spans(re, u) == (std::vector<span>{{4, 9}, {14, 20}}));
+    CHECK(re.found_in(u));
+    CHECK_FALSE(re.matches(u));
+    CHECK(re.matches(unicode("colour")));
+    CHECK_FALSE(re.found_in(unicode("col or")));
+
+    // Leftmost first, with greedy and lazy quantifiers
+    CHECK(first_span(regex("a|ab"), "xab") == span(1, 2));
+    CHECK(first_span(regex("ab|a"), "xab") == span(1, 3));
+    CHECK(first_span(regex("<.+>"), "<a><b>") == span(0, 6));
+    CHECK(first_span(regex("<.+?>"), "<a><b>") == span(0, 3));
+    CHECK(first_span(regex("a{2,3}"), "aaaa") == span(0, 3));
+    CHECK(first_span(regex("a{2,}?"), "aaaa") == span(0, 2));
+
+    // Searching on from a position
+    const auto m = re.search(u, re.search(u).last);
+    CHECK(m.found);
+    CHECK(m.first.position() - u.data() == 14);
+
+    // The scan stops once the callback returns false
+    std::size_t n = 0;
+    re.for_each_match(u, [&](const regex_match<unicode::iterator>&) { return ++n < 1; });
+    CHECK(n == 1);
+}
+
+TEST_CASE("Anchors and empty matches") {
+    CHECK(first_span(regex("^ab"), "abab") == span(0, 2));
+    CHECK(first_span(regex("ab$"), "abab") == span(2, 4));
+    CHECK(first_span(regex("\\Aa|b\\z"), "bab") == span(2, 3));
+    CHECK(first_span(regex("^$"), "") == span(0, 0));
+    CHECK_FALSE(regex("^$").found_in(unicode("a")));
+    CHECK(spans(regex("x*"), "ab") == (std::vector<span>{{0, 0}, {1, 1}, {2, 2}}));
+    CHECK(spans(regex("a*"), "baab") == (std::vector<span>{{0, 0}, {1, 3}, {3, 3}, {4, 4}}));
+    CHECK(spans(regex(""), "é") == (std::vector<span>{{0, 0}, {2, 2}}));
+
+    unicode u = "abab";
+    const regex start("^ab");
+    CHECK_FALSE(start.search(u, std::next(u.begin(), 2)).found);
+    CHECK(start.search(u, std::next(u.begin(), 2)).first == u.end());
+}
+
+TEST_CASE("Regexes over code points") {
+    CHECK(regex("^.$").matches(unicode("\xf0\x9f\x98\x80")));
+    CHECK(regex("^...$").matches(unicode("été")));
+    CHECK_FALSE(regex(".").found_in(unicode("\n")));
+    CHECK(first_span(regex("[à-ÿ]+"), "voilà, déjà") == span(4, 6));
+    CHECK(first_span(regex("[^a-z ]"), "abc été") == span(4, 6));
+    CHECK(first_span(regex("\\x{1F600}|\\xe9"), "abc \xc3\xa9") == span(4, 6));
+
+    unicode u = "élan vital, Über Ωmega 42 ٤٢";
+    CHECK(spans(regex("\\p{Lu}\\p{Ll}+"), u) == (std::vector<span>{{13, 18}, {19, 25}}));
+    CHECK(spans(regex("\\p{Nd}+"), u) == (std::vector<span>{{26, 28}, {29, 33}}));
+    CHECK(spans(regex("\\d+"), u) == spans(regex("\\p{Decimal_Number}+"), u));
+    CHECK(spans(regex("\\w+"), u).size() == 6);
+    CHECK(spans(regex("[\\p{L}\\d]+"), u).size() == 6);
+    CHECK(spans(regex("\\PL+"), "ab, cd") == (std::vector<span>{{2, 4}}));
+    CHECK(spans(regex("\\s+"), "a\xe3\x80\x80 b") == (std::vector<span>{{1, 5}}));
+    CHECK(spans(regex("\\S+"), "a\xe3\x80\x80 b") == (std::vector<span>{{0, 1}, {5, 6}}));
+}
+
+TEST_CASE("Regexes ignoring case") {
+    const regex re("straße|[a-c]+\\d", match::case_insensitive);
+    CHECK(re.how() == match::case_insensitive);
+    CHECK(first_span(re, "Die STRAẞE") == span(4, 12));
+    CHECK_FALSE(re.found_in(unicode("STRASSE")));
+    CHECK(first_span(re, "xx ABc1") == span(3, 7));
+    // KELVIN SIGN folds to "k"
+    CHECK(regex("^k$", match::case_insensitive).matches(unicode("\xe2\x84\xaa")));
+    CHECK(regex("^σ+$", match::case_insensitive).matches(unicode("Σσς")));
+    CHECK_FALSE(regex("[^k]", match::case_insensitive).found_in(unicode("kK\xe2\x84\xaa")));
+    CHECK(regex("\\p{Lu}", match::case_insensitive).found_in(unicode("a")));
+}
+
+TEST_CASE("Malformed regexes") {
+    auto offset = [](const char* pattern) {
+        try {
+            regex re(pattern);
+        } catch (const regex_error& e) {
+            return e.offset();
+        }
+        return std::string::npos;
+    };
+    CHECK(offset("(a") == 2);
+    CHECK(offset("a)") == 1);
+    CHECK(offset("a**") == 2);
+    CHECK(offset("*a") == 0);
+    CHECK(offset("[b-a]") == 4);
+    CHECK(offset("[ab") == 3);
+    CHECK(offset("a{3,2}") == 6);
+    CHECK(offset("\\p{Nope}") == 8);
+    CHECK(offset("\\q") == 1);
+    CHECK(offset("\\b") == 1);
+    CHECK(offset("(?<name>a)") == 2);
+    CHECK(offset("a{1001}") == 6);
+    CHECK_THROWS_AS(regex("\\w{1000}"), const regex_error&);
+    CHECK_THROWS_AS(regex("a", match::canonical), const std::invalid_argument&);
+    CHECK(offset("[]a]\\{\\}\\x{10FFFF}") == std::string::npos);
+}
+
+TEST_CASE("Regexes with literal prefilters") {
+    std::string hay;
+    for (int i = 0; i < 200; ++i) {
+        hay += "Darth Vader and Luke Skywalker; ";
+    }
+    unicode u = (hay + "Darth Sidious").c_str();
+    const regex prefix("Darth S\\w+");
+    CHECK(first_span(prefix, u) == span(hay.size(), hay.size() + 13));
+    CHECK(prefix.find_all(u).size() == 1);
+    const regex required("\\w+ Sidious");
+    CHECK(first_span(required, u) == span(hay.size(), hay.size() + 13));
+    CHECK_FALSE(required.found_in(unicode(hay.c_str())));
+    CHECK(regex("(?:Vader|Luke) ").find_all(u).size() == 400);
+}
+
+TEST_CASE("Regexes agree with std::regex") {
+    std::uint32_t seed = 42;
+    for (int i = 0; i < 400; ++i) {
+        const auto pattern = random_pattern(seed);
+        const regex re(pattern.c_str());
+        const regex small(pattern.c_str(), match::exact, 0);
+        const std::regex expected(pattern);
+        for (int j = 0; j < 10; ++j) {
+            std::string hay;
+            const auto size = next_random(seed) % 12;
+            for (std::uint32_t k = 0; k < size; ++k) {
+                hay += static_cast<char>('a' + next_random(seed) % 3);
+            }
+            std::smatch m;
+            const auto want = std::regex_search(hay, m, expected)
+                ? span(static_cast<std::size_t>(m.position(0)),
+                       static_cast<std::size_t>(m.position(0) + m.length(0)))
+                : span(std::string::npos, std::string::npos);
+            INFO(pattern << " in " << hay);
+            unicode u = hay.c_str();
+            CHECK(first_span(re, u) == want);
+            CHECK(first_span(small, u) == want);
+            CHECK(re.found_in(u) == (want.first != std::string::npos));
+            CHECK(re.matches(u) == std::regex_match(hay, expected));
+        }
+    }
+
+    // Copies share the pattern but not the cache
+    regex a("b+");
+    const regex b = a;
+    a = regex("c");
+    CHECK(first_span(b, "abbc") == span(1, 3));
+    CHECK(first_span(a, "abbc") == span(3, 4));
+}
@@ -0,0 +1,292 @@
+#include <neo/unicode.hpp>
+
+#include <catch/catch.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+using namespace neo;
+
+namespace {
+
+template <typename Text> std::size_t offset(const Text& t, typename Text::iterator it) {
+    return static_cast<std::size_t>(it.position() - t.data());
+}
+
+/**
+ * Haystacks and needles drawn from a tiny alphabet, so that there are lots of
+ * partial matches
+ */
+template <typename String>
+String random_string(std::uint32_t& seed, std::size_t size, unsigned n_letters = 3) {
+    String ret;
+    for (std::size_t i = 0; i < size; ++i) {
+        seed = seed * 1103515245 + 12345;
+        ret.push_back(static_cast<typename String::value_type>('a' + ((seed >> 16) % n_letters)));
+    }
+    return ret;
+}
+
+/**
+ * Compare against std::basic_string for every needle length, which covers
+ * both the candidate filter and Horspool
+ */
+template <typename Text, typename String> void check_against_string() {
+    std::uint32_t seed = 42;
+    for (std::size_t size = 0; size < 120; size += 7) {
+        const auto hay = random_string<String>(seed, size);
+        const Text text(hay.c_str());
+        for (std::size_t m = 1; m < 48; ++m) {
+            // Take half the needles from the haystack, so they are found
+            const auto needle = (m < size && m % 2) ? hay.substr(size / 3, m)
+                                                    : random_string<String>(seed, m);
+            const Text tneedle(needle.c_str());
+            const auto expect_first = hay.find(needle);
+            const auto expect_last = hay.rfind(needle);
+            CHECK(offset(text, text.find(tneedle))
+                  == (expect_first == String::npos ? size : expect_first));
+            CHECK(offset(text, text.rfind(tneedle))
+                  == (expect_last == String::npos ? size : expect_last));
+            CHECK(text.contains(tneedle) == (expect_first != String::npos));
+        }
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Find in UTF-8 text") {
+    unicode u = "Je suis allé à l'école, où j'ai appris à écrire";
+    CHECK(u.contains("école"));
+    CHECK_FALSE(u.contains("ecole"));
+    CHECK(offset(u, u.find("é")) == 11);
+    CHECK(offset(u, u.rfind("é")) == 46);
+    CHECK(u.count("é") == 3);
+    CHECK(u.count("à") == 2);
+    CHECK(u.count("z") == 0);
+
+    auto it = u.find("à");
+    CHECK(*it == U'à');
+    it = u.find("à", std::next(it));
+    CHECK(offset(u, it) == 43);
+    CHECK(u.find("à", std::next(it)) == u.end());
+
+    CHECK(u.find("") == u.begin());
+    CHECK(u.rfind("") == u.end());
+    CHECK(unicode("aéb").count("") == 4);
+    CHECK(unicode("").find("a") == unicode("").end());
+}
+
+TEST_CASE("Matches are on code point boundaries") {
+    // The trailing byte of "é" isn't a code point of its own
+    unicode u = "caf\xc3\xa9";
+    CHECK_FALSE(u.contains("\xa9"));
+    CHECK(u.find("\xa9") == u.end());
+    // A needle that ends in a lead byte can't take the rest of a sequence
+    CHECK_FALSE(u.contains("f\xc3"));
+    CHECK_FALSE(u.contains("\xc3"));
+    CHECK(u.contains("f\xc3\xa9"));
+    // ... but in malformed text it can match a lead byte on its own
+    unicode bad = "f\xc3z \xc3\xa9";
+    CHECK(offset(bad, bad.find("\xc3")) == 1);
+    CHECK(offset(bad, bad.rfind("\xc3")) == 1);
+    CHECK(bad.count("\xc3") == 1);
+
+    const char16_t smile[] = {u'a', 0xD83D, 0xDE00, u'b', 0};
+    basic_text<utf16> t = smile;
+    const char16_t high[] = {0xD83D, 0};
+    const char16_t low[] = {0xDE00, u'b', 0};
+    CHECK_FALSE(t.contains(high));
+    CHECK_FALSE(t.contains(low));
+    CHECK(t.contains(u"\U0001F600b"));
+    CHECK(offset(t, t.find(u"\U0001F600")) == 1);
+}
+
+TEST_CASE("Search agrees with std::string") {
+    check_against_string<unicode, std::string>();
+    check_against_string<basic_text<utf16>, std::u16string>();
+    check_against_string<basic_text<utf32>, std::u32string>();
+}
+
+TEST_CASE("Long needles in repetitive text") {
+    // Most positions are candidates, so the search falls back to Two-Way
+    std::uint32_t seed = 7;
+    const auto hay = std::string(3000, 'a') + random_string<std::string>(seed, 3000, 2);
+    const unicode text = hay.c_str();
+    for (std::size_t m = 32; m < 100; m += 3) {
+        for (const auto& needle : {std::string(m, 'a') + "b",
+                                   std::string(m, 'a'),
+                                   "b" + std::string(m, 'a'),
+                                   hay.substr(2990, m),
+                                   hay.substr(4000, m),
+                                   random_string<std::string>(seed, m, 2)}) {
+            const unicode tneedle = needle.c_str();
+            const auto expect_first = hay.find(needle);
+            const auto expect_last = hay.rfind(needle);
+            CHECK(offset(text, text.find(tneedle))
+                  == (expect_first == std::string::npos ? hay.size() : expect_first));
+            CHECK(offset(text, text.rfind(tneedle))
+                  == (expect_last == std::string::npos ? hay.size() : expect_last));
+        }
+    }
+    const std::u16string hay16(hay.begin(), hay.end());
+    const basic_text<utf16> text16 = hay16.c_str();
+    const auto needle16 = hay16.substr(4321, 77);
+    CHECK(offset(text16, text16.find(needle16.c_str())) == hay16.find(needle16));
+    CHECK(offset(text16, text16.rfind(needle16.c_str())) == hay16.rfind(needle16));
+}
+
+TEST_CASE("Count occurrences") {
+    unicode u = "aaaa";
+    CHECK(u.count("aa") == 2);
+    CHECK(u.count("a") == 4);
+    CHECK(u.count("aaaaa") == 0);
+    basic_text<utf16> w = u"abéabéab";
+    CHECK(w.count(u"ab") == 3);
+    CHECK(w.count(u"é") == 2);
+}
+
+TEST_CASE("Find ignoring case") {
+    unicode u = "Die Straße nach Köln, KÖLN und köln";
+    CHECK(u.contains("STRASSE", match::case_insensitive));
+    CHECK_FALSE(u.contains("STRASSE"));
+    CHECK(u.count("Köln", match::case_insensitive) == 3);
+    CHECK(u.count("KÖLN", match::case_insensitive) == 3);
+    CHECK(u.count("Köln") == 1);
+
+    const auto found = u.search("strasse", match::case_insensitive);
+    CHECK(offset(u, found.first) == 4);
+    CHECK(offset(u, found.second) == 11);
+    CHECK(offset(u, u.find("KÖLN", match::case_insensitive)) == 17);
+
+    // A code point that folds to several must match all of them
+    CHECK_FALSE(unicode("ß").contains("s", match::case_insensitive));
+    CHECK(unicode("ß").contains("SS", match::case_insensitive));
+    CHECK_FALSE(unicode("ß").contains("SSS", match::case_insensitive));
+    CHECK(unicode("sß").count("ss", match::case_insensitive) == 1);
+
+    // Non-ASCII code points that fold to ASCII
+    CHECK(unicode("300 K").contains("k", match::case_insensitive));
+    CHECK(unicode("ſun").contains("SUN", match::case_insensitive));
+    CHECK(unicode("ΣΊΣΥΦΟΣ").contains("σίσυφος", match::case_insensitive));
+
+    CHECK(u.search("", match::case_insensitive).first == u.begin());
+    CHECK(u.search("Paris", match::case_insensitive).first == u.end());
+    CHECK(u.count("", match::case_insensitive) == u.code_point_size() + 1);
+
+    auto second = u.search("köln", std::next(u.find("köln", match::case_insensitive)), match::case_insensitive);
+    CHECK(offset(u, second.first) == 24);
+}
+
+TEST_CASE("Find ignoring case in other encodings") {
+    basic_text<utf16> w = u"Die Straße nach KÖLN";
+    CHECK(offset(w, w.find(u"köln", match::case_insensitive)) == 16);
+    CHECK(w.contains(u"STRASSE", match::case_insensitive));
+
+    basic_text<utf16be> be = basic_text<utf16be>(convert_encoding<utf16, utf16be>(w.encode<utf16>()));
+    CHECK(be.contains(basic_text<utf16be>(convert_encoding<utf16, utf16be>(utf16::buffer_type(u"KöLN"))),
+                      match::case_insensitive));
+
+    basic_text<utf32> t = U"ΣΊΣΥΦΟΣ";
+    CHECK(t.contains(U"σίσυφος", match::case_insensitive));
+}
+
+TEST_CASE("Case-insensitive search agrees with folded std::string") {
+    const auto lower = [](std::string s) {
+        for (auto& c : s) {
+            if (c >= 'A' && c <= 'Z') {
+                c = static_cast<char>(c + 0x20);
+            }
+        }
+        return s;
+    };
+    std::uint32_t seed = 99;
+    for (std::size_t size = 0; size < 300; size += 13) {
+        // Letters from "aAbB", so that case differs and there are many
+        // partial matches
+        auto hay = random_string<std::string>(seed, size, 4);
+        for (auto& c : hay) {
+            c = "aAbB"[c - 'a'];
+        }
+        const unicode text = hay.c_str();
+        for (std::size_t m = 1; m < 90; m += 4) {
+            auto needle = m < size ? hay.substr(size / 2, m) : random_string<std::string>(seed, m, 2);
+            std::reverse(needle.begin(), needle.begin() + needle.size() / 3);
+            const auto expected = lower(hay).find(lower(needle));
+            const auto found = text.search(needle.c_str(), match::case_insensitive);
+            if (expected == std::string::npos) {
+                CHECK(found.first == text.end());
+            } else {
+                CHECK(offset(text, found.first) == expected);
+                CHECK(offset(text, found.second) == expected + needle.size());
+            }
+        }
+    }
+}
+
+TEST_CASE("Find up to canonical equivalence") {
+    // "é" precomposed, then decomposed
+    unicode u = "caf\xc3\xa9 et cafe\xcc\x81";
+    CHECK(u.count("é", match::canonical) == 2);
+    CHECK(u.count("e\xcc\x81", match::canonical) == 2);
+    CHECK(u.count("é") == 1);
+
+    const auto first = u.search("café", match::canonical);
+    CHECK(offset(u, first.first) == 0);
+    CHECK(offset(u, first.second) == 5);
+    const auto second = u.search("café", first.second, match::canonical);
+    CHECK(offset(u, second.first) == 9);
+    CHECK(offset(u, second.second) == 15);
+
+    // A match never splits a combining sequence
+    CHECK(u.contains("caf", match::canonical));
+    CHECK(u.count("e", match::canonical) == 1);
+    CHECK_FALSE(unicode("\xc3\xa9").contains("e", match::canonical));
+    CHECK_FALSE(unicode("\xc3\xa9").contains("\xcc\x81", match::canonical));
+
+    // Combining marks in either order: dot below (220) and acute (230)
+    unicode marks = "x e\xcc\x81\xcc\xa3 y";
+    CHECK(marks.contains("e\xcc\xa3\xcc\x81", match::canonical));
+    CHECK(marks.contains("\xe1\xba\xb9\xcc\x81", match::canonical));
+    CHECK_FALSE(marks.contains("e\xcc\x81", match::canonical));
+
+    // ANGSTROM SIGN and LATIN CAPITAL LETTER A WITH RING ABOVE
+    CHECK(unicode("10 \xe2\x84\xab").contains("\xc3\x85", match::canonical));
+
+    // Hangul syllables and their jamo
+    unicode hangul = "\xed\x95\x9c\xea\xb8\x80";
+    CHECK(hangul.contains("\xe1\x84\x92\xe1\x85\xa1\xe1\x86\xab", match::canonical));
+    // Only the leading jamo of the first syllable: it splits a code point
+    CHECK_FALSE(hangul.contains("\xe1\x84\x92", match::canonical));
+
+    CHECK(u.search("", match::canonical).first == u.begin());
+    CHECK(u.search("the", match::canonical).first == u.end());
+}
+
+TEST_CASE("Canonical search in UTF-16") {
+    basic_text<utf16> w = u"café et café";
+    CHECK(w.count(u"café", match::canonical) == 2);
+    CHECK(offset(w, w.find(u"café", match::canonical)) == 0);
+
+    // Byte-swapped code units below 0x80 need not be ASCII: U+0300 is 0x0003
+    // in the wrong byte order
+    constexpr auto foreign_order
+        = byte_order::native == byte_order::little ? byte_order::big : byte_order::little;
+    using swapped = basic_text<utf16_ordered<foreign_order>>;
+    const auto swap = [](const unicode& t) { return swapped(t.encode<utf16_ordered<foreign_order>>()); };
+    const auto text = swap("xe\xcc\x80y");
+    CHECK_FALSE(text.contains(swap("e"), match::canonical));
+    CHECK(text.contains(swap("\xc3\xa8"), match::canonical));
+    CHECK(text.contains(swap("xe\xcc\x80"), match::canonical));
+}
+
+TEST_CASE("Find up to compatibility equivalence") {
+    unicode u = "\xef\xac\x81ne, x\xc2\xb2 and fine";
+    CHECK(u.count("fine", match::compatible) == 2);
+    CHECK(u.count("fine", match::canonical) == 1);
+    CHECK(offset(u, u.find("x2", match::compatible)) == 7);
+    // Compatibility decompositions are also canonical ones
+    CHECK(unicode("cafe\xcc\x81").contains("café", match::compatible));
+    // "ﬁ" is one code point, so "f" alone doesn't match it
+    CHECK_FALSE(unicode("\xef\xac\x81").contains("f", match::compatible));
+}
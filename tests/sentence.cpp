@@ -0,0 +1,101 @@
+#include <neo/unicode.hpp>
+
+#include <catch/catch.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace neo;
+
+namespace {
+
+using strings = std::vector<std::string>;
+
+strings split(const unicode& text) {
+    strings ret;
+    for (const auto s : sentences(text)) {
+        ret.emplace_back(s.data(), s.code_unit_size());
+    }
+    return ret;
+}
+
+/**
+ * The ends of the sentences of `text` found by a `sentence_stream` fed
+ * `piece` code units at a time
+ */
+std::vector<std::size_t> stream_ends(const std::string& text, std::size_t piece) {
+    std::vector<std::size_t> ret;
+    const auto push = [&](std::size_t end) { ret.push_back(end); };
+    sentence_stream<utf8> stream;
+    for (std::size_t i = 0; i < text.size(); i += piece) {
+        stream.feed(text.data() + i, std::min(piece, text.size() - i), push);
+    }
+    stream.finish(push);
+    return ret;
+}
+
+}  // namespace
+
+TEST_CASE("Split text into sentences") {
+    CHECK(split(unicode("")).empty());
+    CHECK(split(unicode("Hello there. How are you? Fine!")) == (strings{"Hello there. ", "How are you? ", "Fine!"}));
+    // Closing punctuation and spaces stay with the sentence they end
+    CHECK(split(unicode("He said \"Stop.\"  Then he left.")) == (strings{"He said \"Stop.\"  ", "Then he left."}));
+    // Periods that don't end sentences: numbers, initials, and lowercase
+    // after an abbreviation
+    CHECK(split(unicode("Pi is 3.14 or so. U.S. law, e.g. this one. Etc.")) ==
+          (strings{"Pi is 3.14 or so. ", "U.S. law, e.g. this one. ", "Etc."}));
+    // Paragraph separators end sentences, CR LF together
+    CHECK(split(unicode("No period\r\nNext line\n\nx")) == (strings{"No period\r\n", "Next line\n", "\n", "x"}));
+}
+
+TEST_CASE("Split non-ASCII text into sentences") {
+    // IDEOGRAPHIC FULL STOP, and a paragraph separator
+    CHECK(split(unicode("\xe4\xbd\xa0\xe5\xa5\xbd\xe3\x80\x82\xe8\xb0\xa2\xe8\xb0\xa2\xe3\x80\x82"))
+          == (strings{"\xe4\xbd\xa0\xe5\xa5\xbd\xe3\x80\x82", "\xe8\xb0\xa2\xe8\xb0\xa2\xe3\x80\x82"}));
+    CHECK(split(unicode("a\xe2\x80\xa9" "b")) == (strings{"a\xe2\x80\xa9", "b"}));
+    // An accented capital starts a sentence; a mark stays with its letter
+    CHECK(split(unicode("Fin. \xc3\x89t\xc3\xa9. e\xcc\x81t\xc3\xa9")) ==
+          (strings{"Fin. ", "\xc3\x89t\xc3\xa9. e\xcc\x81t\xc3\xa9"}));
+
+    const unicode text = "Qu'est-ce que c'est? \xc3\x87" "a va.";
+    const auto u16 = text.encode<utf16>();
+    const basic_text<utf16> text16 = u16.data();
+    std::vector<std::u16string> parts;
+    for (const auto s : sentences(text16)) {
+        parts.emplace_back(s.data(), s.code_unit_size());
+    }
+    CHECK(parts == (std::vector<std::u16string>{u"Qu'est-ce que c'est? ", u"\u00c7a va."}));
+}
+
+TEST_CASE("Split a stream into sentences") {
+    const std::string text = "Mr. Smith went to Washington. \xe2\x80\x9cWhy?\xe2\x80\x9d he asked\xe2\x80\xa6 "
+                             "It was 5 p.m. when he left. caf\xc3\xa9. \xc3\x89t\xc3\xa9 etc.) 12 ab.";
+    const unicode whole = text.data();
+    std::vector<std::size_t> ends;
+    for (const auto s : sentences(whole)) {
+        ends.push_back(static_cast<std::size_t>(s.data() + s.code_unit_size() - whole.data()));
+    }
+    REQUIRE(ends.size() == 5);
+    CHECK(ends.back() == text.size());
+    // Pieces of every size split code points and hold SB8 lookahead
+    for (std::size_t piece = 1; piece <= text.size(); ++piece) {
+        CHECK(stream_ends(text, piece) == ends);
+    }
+    // Only the end is reported for text without boundaries, and nothing for
+    // no text
+    CHECK(stream_ends("one sentence", 5) == (std::vector<std::size_t>{12}));
+    CHECK(stream_ends("", 5).empty());
+
+    // A stream can be reused once it is finished
+    sentence_stream<utf8> stream;
+    std::vector<std::size_t> got;
+    const auto push = [&](std::size_t end) { got.push_back(end); };
+    stream.feed(text_view(unicode("Hi. Yo")), push);
+    CHECK(stream.size() == 6);
+    stream.finish(push);
+    stream.feed("A. B", 4, push);
+    stream.finish(push);
+    CHECK(got == (std::vector<std::size_t>{4, 6, 3, 4}));
+}
@@ -0,0 +1,138 @@
+#include <neo/unicode.hpp>
+
+#include <catch/catch.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace neo;
+
+namespace {
+
+template <typename Range> std::vector<std::string> pieces(const Range& range) {
+    std::vector<std::string> ret;
+    for (const auto piece : range) {
+        ret.emplace_back(piece.data(), piece.code_unit_size());
+    }
+    return ret;
+}
+
+template <typename Range> std::vector<std::u16string> pieces16(const Range& range) {
+    std::vector<std::u16string> ret;
+    for (const auto piece : range) {
+        ret.emplace_back(piece.data(), piece.code_unit_size());
+    }
+    return ret;
+}
+
+using strings = std::vector<std::string>;
+using strings16 = std::vector<std::u16string>;
+
+}  // namespace
+
+TEST_CASE("Split text at a delimiter") {
+    const unicode csv = "one,two,,three";
+    CHECK(pieces(split(csv, ",")) == (strings{"one", "two", "", "three"}));
+    CHECK(pieces(split(csv, ",,")) == (strings{"one,two", "three"}));
+    CHECK(pieces(split(csv, ";")) == (strings{"one,two,,three"}));
+    // Every delimiter ends a piece, and there is always one more piece
+    const unicode ends = ",a,";
+    CHECK(pieces(split(ends, ",")) == (strings{"", "a", ""}));
+    const unicode empty;
+    CHECK(pieces(split(empty, ",")) == (strings{""}));
+    CHECK(pieces(split(csv, "")) == (strings{"one,two,,three"}));
+
+    // The pieces are views of the text
+    const auto range = split(csv, ",");
+    auto it = range.begin();
+    CHECK((*it).data() == csv.data());
+    ++it;
+    CHECK(it.position() == csv.data() + 4);
+    CHECK((*it).data() == csv.data() + 4);
+
+    // Delimiters are whole code points, and can be anywhere in long text
+    const unicode accents = "caf\xc3\xa9\xc3\xa9t\xc3\xa9";
+    CHECK(pieces(split(text_view(accents), "\xc3\xa9")) == (strings{"caf", "", "t", ""}));
+    std::string line;
+    for (int i = 0; i < 40; ++i) {
+        line += "field" + std::to_string(i) + "\t";
+    }
+    const unicode long_line = line.data();
+    const auto fields = pieces(split(long_line, "\t"));
+    CHECK(fields.size() == 41);
+    CHECK(fields[39] == "field39");
+    CHECK(fields[40] == "");
+
+    const basic_text<utf16> text16 = u"\u00e9t\u00e9 \U0001F600 hiver \U0001F600";
+    CHECK(pieces16(split(text16, u" ")) == (strings16{u"\u00e9t\u00e9", u"\U0001F600", u"hiver", u"\U0001F600"}));
+    CHECK(pieces16(split(text16, u"\U0001F600")) == (strings16{u"\u00e9t\u00e9 ", u" hiver ", u""}));
+}
+
+TEST_CASE("Split text at any of a set of code points") {
+    const unicode words = "one two,three;; four";
+    CHECK(pieces(split_any(words, " ,;")) == (strings{"one", "two", "three", "", "", "four"}));
+    CHECK(pieces(split_any(words, "")) == (strings{"one two,three;; four"}));
+    const unicode empty;
+    CHECK(pieces(split_any(empty, " ")) == (strings{""}));
+
+    // Members can be any code points, and more of them than can be
+    // scanned for at once
+    const unicode mixed = "a\xe2\x80\x94" "b\xc2\xb7" "c\xe2\x80\x93" "d";
+    const unicode dashes = "\xe2\x80\x94\xe2\x80\x93";
+    CHECK(pieces(split_any(mixed, dashes)) == (strings{"a", "b\xc2\xb7" "c", "d"}));
+    CHECK(pieces(split_any(text_view(mixed), "abcdefghij"))
+          == (strings{"", "\xe2\x80\x94", "\xc2\xb7", "\xe2\x80\x93", ""}));
+
+    const basic_text<utf16> text16 = u"x\u3001y\u3002 z\U0001F600";
+    CHECK(pieces16(split_any(text16, u"\u3001\u3002 ")) == (strings16{u"x", u"y", u"", u"z\U0001F600"}));
+    CHECK(pieces16(split_any(text16, u"\U0001F600")) == (strings16{u"x\u3001y\u3002 z", u""}));
+
+    // A malformed member is U+FFFD, which only matches whole malformed code
+    // units, never the middle of a code point
+    const unicode dash = "a\xe2\x80\x94" "b\x80" "c";
+    CHECK(pieces(split_any(dash, "\x80")) == (strings{"a\xe2\x80\x94" "b", "c"}));
+    CHECK(pieces(split_any(dash, "\xef\xbf\xbd")) == (strings{"a\xe2\x80\x94" "b", "c"}));
+    const char16_t pair[] = {u'x', 0xD83D, 0xDE00, u'y', 0xDE00, u'z', 0};
+    const char16_t low[] = {0xDE00, 0};
+    const basic_text<utf16> paired = pair;
+    CHECK(pieces16(split_any(paired, low))
+          == (strings16{std::u16string(pair, pair + 4), u"z"}));
+}
+
+TEST_CASE("Iterate the lines of a text") {
+    const unicode text = "one\ntwo\r\nthree\rfour\n\nfive\n";
+    CHECK(pieces(lines(text)) == (strings{"one", "two", "three", "four", "", "five"}));
+    const unicode no_end = "one\ntwo";
+    CHECK(pieces(lines(no_end)) == (strings{"one", "two"}));
+    const unicode empty;
+    CHECK(pieces(lines(empty)) == strings{});
+    const unicode blank = "\n";
+    CHECK(pieces(lines(blank)) == (strings{""}));
+    // Vertical tab, form feed, NEL and the Unicode separators end lines too
+    const unicode others = "a\x0b" "b\x0c" "c\xc2\x85" "d\xe2\x80\xa8" "e\xe2\x80\xa9" "f\xc2\xa0\xe2\x80\xa6";
+    CHECK(pieces(lines(others)) == (strings{"a", "b", "c", "d", "e", "f\xc2\xa0\xe2\x80\xa6"}));
+
+    const basic_text<utf16> text16 = u"caf\u00e9\r\n\u65e5\u672c\u2028\U0001F600\u0085end";
+    CHECK(pieces16(lines(text16)) == (strings16{u"caf\u00e9", u"\u65e5\u672c", u"\U0001F600", u"end"}));
+
+    // The ranges work with the standard algorithms
+    std::string log;
+    for (int i = 0; i < 100; ++i) {
+        log += (i % 3 ? "info: " : "error: ") + std::to_string(i) + "\n";
+    }
+    const unicode log_text = log.data();
+    const auto log_lines = lines(log_text);
+    CHECK(std::distance(log_lines.begin(), log_lines.end()) == 100);
+    const unicode error = "error";
+    const auto errors = std::count_if(log_lines.begin(), log_lines.end(), [&](text_view line) {
+        return line.to_text().contains(error);
+    });
+    CHECK(errors == 34);
+    const auto found = std::find_if(log_lines.begin(), log_lines.end(), [](text_view line) {
+        return line == unicode("info: 50");
+    });
+    REQUIRE(found != log_lines.end());
+    CHECK(found.position() - log_text.data() == 457);
+}
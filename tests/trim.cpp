@@ -0,0 +1,78 @@
+#include <neo/unicode.hpp>
+
+#include <catch/catch.hpp>
+
+#include <string>
+
+using namespace neo;
+
+namespace {
+
+std::string str(text_view view) {
+    return std::string(view.data(), view.code_unit_size());
+}
+
+}  // namespace
+
+TEST_CASE("Trim ASCII white space") {
+    const unicode field = " \t value with spaces\r\n";
+    CHECK(str(trim(field)) == "value with spaces");
+    CHECK(str(trim_start(field)) == "value with spaces\r\n");
+    CHECK(str(trim_end(field)) == " \t value with spaces");
+    // The views are of the text
+    CHECK(trim(field).data() == field.data() + 3);
+
+    const unicode plain = "value";
+    CHECK(trim(plain).data() == plain.data());
+    CHECK(trim(plain).code_unit_size() == 5);
+    const unicode blank = " \t\n\v\f\r ";
+    CHECK(trim(blank).empty());
+    CHECK(trim_start(blank).empty());
+    CHECK(trim_end(blank).empty());
+    const unicode empty;
+    CHECK(trim(empty).empty());
+
+    // Long runs of white space
+    const std::string padding(100, ' ');
+    const unicode padded = (padding + "\tx y\t" + padding + "\n").data();
+    CHECK(str(trim(padded)) == "x y");
+    CHECK(str(trim(text_view(padded))) == "x y");
+    const unicode long_blank = (padding + padding).data();
+    CHECK(trim(long_blank).empty());
+}
+
+TEST_CASE("Trim Unicode white space") {
+    // No-break, ideographic, em and narrow no-break spaces, NEL and the
+    // line and paragraph separators
+    const unicode text = "\xc2\xa0\xe3\x80\x80 \xe2\x80\x83value\xe2\x80\xaf\xc2\x85\xe2\x80\xa8\xe2\x80\xa9";
+    CHECK(str(trim(text)) == "value");
+    CHECK(str(trim_end(text)) == "\xc2\xa0\xe3\x80\x80 \xe2\x80\x83value");
+    // Zero width space and the Mongolian vowel separator are not white space,
+    // and other non-ASCII is kept
+    const unicode others = "\xe2\x80\x8b" "a \xe1\xa0\x8e";
+    CHECK(str(trim(others)) == "\xe2\x80\x8b" "a \xe1\xa0\x8e");
+    const unicode accents = " \xc3\xa9t\xc3\xa9 ";
+    CHECK(str(trim(accents)) == "\xc3\xa9t\xc3\xa9");
+
+    const basic_text<utf16> text16 = u"\u3000\u2003 caf\u00e9 \U0001F600\u00a0 ";
+    CHECK(std::u16string(trim(text16).data(), trim(text16).code_unit_size()) == u"caf\u00e9 \U0001F600");
+    const basic_text<utf16> long16 = u"                    x\u2029                    ";
+    CHECK(std::u16string(trim(long16).data(), trim(long16).code_unit_size()) == u"x");
+    const basic_text<utf32> text32 = U"\u0085\u205f\U0001F600\u1680";
+    CHECK(std::u32string(trim(text32).data(), trim(text32).code_unit_size()) == U"\U0001F600");
+}
+
+TEST_CASE("Classify White_Space code points") {
+    CHECK(is_white_space(U' '));
+    CHECK(is_white_space(U'\t'));
+    CHECK(is_white_space(0x3000));
+    CHECK_FALSE(is_white_space(U'a'));
+    CHECK_FALSE(is_white_space(0x200B));
+    CHECK_FALSE(is_white_space(0xFEFF));
+    std::size_t count = 0;
+    for (char32_t cp = 0; cp <= 0x10FFFF; ++cp) {
+        count += is_white_space(cp);
+    }
+    CHECK(count == 25);
+    static_assert(is_white_space(0x2028) && !is_white_space(0x2030), "is_white_space is usable in constants");
+}
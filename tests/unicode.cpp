@@ -3,6 +3,12 @@
 #include <catch/catch.hpp>
 
 #include <cstring>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace neo;
 // using namespace neo::literals;
@@ -29,6 +35,255 @@ TEST_CASE("From char*") {
     CHECK(std::strcmp(data, ptr) == 0);
 }
 
+TEST_CASE("Repertoire is recorded") {
+    unicode ascii = "Only ASCII here";
+    CHECK(ascii.repertoire() == repertoire::ascii);
+    CHECK(ascii.is_fixed_width());
+
+    const char* latin1_ptr = "Gr\xc3\xbc\xc3\x9f dich, long enough to not be small";
+    unicode latin1 = latin1_ptr;
+    CHECK(latin1.repertoire() == repertoire::latin1);
+    CHECK_FALSE(latin1.is_fixed_width());
+
+    unicode other = "\xe2\x82\xac";
+    CHECK(other.repertoire() == repertoire::any);
+
+    basic_text<utf16> bmp = u"\u20ac";
+    CHECK(bmp.repertoire() == repertoire::bmp);
+    CHECK(bmp.is_fixed_width());
+}
+
+TEST_CASE("Code point access") {
+    const char* ptr = "A\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80!";
+    unicode u = ptr;
+    CHECK(u.code_point_size() == 5);
+    CHECK(u.code_point_at(0) == U'A');
+    CHECK(u.code_point_at(1) == U'\u00e9');
+    CHECK(u.code_point_at(2) == U'\u20ac');
+    CHECK(u.code_point_at(3) == U'\U0001F600');
+    CHECK(u.code_point_at(4) == U'!');
+
+    unicode ascii = "Fixed width";
+    CHECK(ascii.code_point_size() == 11);
+    CHECK(ascii.code_point_at(6) == U'w');
+}
+
+TEST_CASE("Count code points") {
+    // Embedded nulls count, and the slice needn't be null-terminated
+    CHECK(count_code_points("a\0b\xc3\xa9xyz", 5) == 4);
+    CHECK(count_code_points(u"a\0\U0001F600", 4) == 3);
+
+    // Long enough for the vector lane counters to be flushed several times
+    std::string str;
+    std::u16string str16;
+    for (auto i = 0; i < 3000; ++i) {
+        str += "ab\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80";
+        str16 += u"ab\u00e9\u20ac\U0001F600";
+    }
+    CHECK(count_code_points(str.data(), str.size()) == 15000);
+    CHECK(count_code_points(str16.data(), str16.size()) == 15000);
+    CHECK(count_code_points(str.data() + 1, 9) == 4);
+
+    // Malformed text counts the U+FFFD that iterating it finds
+    const char stray[] = "a\x80\x80" "b\xc3\xa9\xa9" "c\xe2\x82";
+    CHECK(count_code_points(stray, sizeof(stray) - 1) == 8);
+    CHECK(count_code_points(u"x\xDC00\xD800y\xD800\xDC00\xDC00", 7) == 6);
+    std::string malformed;
+    for (auto i = 0; i < 100; ++i) {
+        malformed += "\xe0\x80\x80\x80\xc3\xa9\xf0\x9f\x98\x80\x80\xff";
+    }
+    const unicode bad = malformed.c_str();
+    CHECK(bad.code_point_size() == static_cast<std::size_t>(std::distance(bad.begin(), bad.end())));
+    // A lead byte cut short just before well-formed text
+    auto cut = std::string(65, 'a') + "\xe2" "x" "\x80" + std::string(100, 'a');
+    CHECK(count_code_points(cut.data(), cut.size()) == 168);
+
+    unicode u = str.c_str();
+    CHECK(u.encode<utf8>().cached_code_point_count() == utf8::buffer_type::uncounted);
+    CHECK(u.code_point_size() == 15000);
+    // The count is kept with the buffer and shared with copies
+    const auto copy = u;
+    CHECK(copy.encode<utf8>().cached_code_point_count() == 15000);
+    CHECK(static_cast<std::size_t>(std::distance(u.begin(), u.end())) == u.code_point_size());
+}
+
+TEST_CASE("Hash texts") {
+    CHECK(unicode("abc").hash() == unicode("abc").hash());
+    CHECK(unicode("abc").hash() != unicode("abd").hash());
+    CHECK(std::hash<unicode>{}(unicode("")) == unicode("").hash());
+
+    // Every length around the block sizes hashes every byte
+    std::string str;
+    std::unordered_set<std::size_t> hashes;
+    for (auto i = 0; i < 300; ++i) {
+        str += static_cast<char>('a' + i % 26);
+        auto flipped = str;
+        flipped[i / 2] ^= 1;
+        CHECK(text_hash{}(flipped) != text_hash{}(str));
+        hashes.insert(unicode(str.c_str()).hash());
+    }
+    CHECK(hashes.size() == 300);
+
+    // The hash of a long text is kept with the buffer and shared with copies
+    unicode u = str.c_str();
+    CHECK(u.encode<utf8>().cached_hash() == utf8::buffer_type::unhashed);
+    const auto h = u.hash();
+    const auto copy = u;
+    CHECK(copy.encode<utf8>().cached_hash() == h);
+
+    // Strings hash and compare like texts with the same code units
+    CHECK(text_hash{}(str) == h);
+    CHECK(text_hash{}(str.c_str()) == h);
+    CHECK(text_hash{}(u"\u00e9t\u00e9") == basic_text<utf16>(u"\u00e9t\u00e9").hash());
+    CHECK(text_equal{}(u, str));
+    CHECK(text_equal{}(str.c_str(), u));
+    CHECK_FALSE(text_equal{}(u, "abc"));
+#ifdef __cpp_lib_string_view
+    CHECK(text_hash{}(std::string_view(str)) == h);
+    CHECK(text_equal{}(u, std::string_view(str)));
+#endif
+
+    std::unordered_map<unicode, int, text_hash, text_equal> map;
+    map[unicode("été")] = 1;
+    map[u] = 2;
+    CHECK(map.at(unicode("été")) == 1);
+    CHECK(map.at(copy) == 2);
+#if __cpp_lib_generic_unordered_lookup >= 201811L
+    CHECK(map.find("été")->second == 1);
+    CHECK(map.find(str)->second == 2);
+    CHECK(map.count("ete") == 0);
+#endif
+
+    // Byte-swapped texts are equal if their malformed code units decode alike,
+    // and then hash alike too. An unpaired U+D800 is 0x00D8 in the wrong order.
+    constexpr auto foreign_order
+        = byte_order::native == byte_order::little ? byte_order::big : byte_order::little;
+    using swapped = basic_text<utf16_ordered<foreign_order>>;
+    const char16_t high[] = {0x7800, 0x00D8, 0};
+    const char16_t low[] = {0x7800, 0x00DC, 0};
+    REQUIRE(swapped(high) == swapped(low));
+    CHECK(swapped(high).hash() == swapped(low).hash());
+    CHECK(std::hash<swapped>{}(swapped(high)) == std::hash<swapped>{}(swapped(low)));
+    // Long texts are hashed a chunk of code points at a time
+    std::u16string long_units;
+    for (auto i = 0; i < 600; ++i) {
+        long_units += static_cast<char16_t>(0x6100 + (i % 26 << 8));
+    }
+    CHECK(swapped((long_units + high).c_str()).hash() == swapped((long_units + low).c_str()).hash());
+    CHECK(swapped(long_units.c_str()).hash() != swapped((long_units + high).c_str()).hash());
+}
+
+namespace {
+
+template <typename Encoding> int sign_of_compare(const std::u32string& a, const std::u32string& b) {
+    const basic_text<utf32> ta = a.c_str();
+    const basic_text<utf32> tb = b.c_str();
+    const unicode ua = ta.encode<utf8>().data();
+    const unicode ub = tb.encode<utf8>().data();
+    const auto ea = ua.encode<Encoding>();
+    const auto eb = ub.encode<Encoding>();
+    const basic_text<Encoding> xa = ea.data();
+    const basic_text<Encoding> xb = eb.data();
+    const auto c = xa.compare(tb);
+    // Each encoding against itself and against UTF-8
+    CHECK((c < 0) == (xa.compare(xb) < 0));
+    CHECK((c > 0) == (xa.compare(xb) > 0));
+    CHECK((c < 0) == (xa.compare(ub) < 0));
+    CHECK((c > 0) == (ua.compare(xb) > 0));
+    CHECK((xa == xb) == (c == 0));
+    return c < 0 ? -1 : (c > 0 ? 1 : 0);
+}
+
+}  // namespace
+
+TEST_CASE("Compare texts across encodings") {
+    const unicode a = "abc";
+    CHECK(a == basic_text<utf16>(u"abc"));
+    CHECK(basic_text<utf32>(U"abc") == a);
+    CHECK(a != basic_text<utf16>(u"abd"));
+    CHECK(a < basic_text<utf16>(u"abd"));
+    CHECK(a < basic_text<utf32>(U"abcd"));
+    CHECK(basic_text<utf16>(u"") < a);
+    CHECK(basic_text<utf16>(u"b") > a);
+    CHECK(a <= a);
+    CHECK(a >= basic_text<wide>(L"abc"));
+
+    // UTF-16 code units would put U+1F600 before U+FFFD
+    const basic_text<utf16> emoji = u"x\U0001F600";
+    const basic_text<utf16> replacement = u"x\uFFFD";
+    CHECK(replacement < emoji);
+    CHECK(unicode("x\uFFFD") < emoji);
+    CHECK(replacement < unicode("x\U0001F600"));
+
+    // Differences past a long equal prefix, and Latin-1 against the rest
+    std::string prefix(100, 'p');
+    std::u16string prefix16(100, u'p');
+    CHECK(unicode((prefix + "\xc3\xa9").c_str()) > basic_text<utf16>((prefix16 + u"e").c_str()));
+    CHECK(unicode((prefix + "\xc3\xa9").c_str()) == basic_text<utf16>((prefix16 + u"\u00e9").c_str()));
+    CHECK(unicode((prefix + "e").c_str()) < unicode((prefix + "f").c_str()));
+    CHECK(basic_text<latin1>("caf\xe9") == unicode("café"));
+
+    // Every pair from a pool, ordered as std::u32string orders them
+    const std::u32string pool[] = {U"", U"a", U"ab", U"\u00e9", U"\uFFFD", U"\U0001F600", U"\uE000x",
+                                   U"a\U0010FFFF", U"a\uFFFF", U"\u00e9\u00e9", U"\U0001F600a"};
+    for (const auto& x : pool) {
+        for (const auto& y : pool) {
+            const auto want = x < y ? -1 : (y < x ? 1 : 0);
+            CHECK(sign_of_compare<utf8>(x, y) == want);
+            CHECK(sign_of_compare<utf16>(x, y) == want);
+            CHECK(sign_of_compare<utf32>(x, y) == want);
+            CHECK(sign_of_compare<utf16be>(x, y) == want);
+        }
+    }
+
+    // Sorted containers can mix sources
+    std::set<basic_text<utf16>, std::less<>> set = {u"b", u"\U0001F600", u"\uFFFD", u"a"};
+    CHECK(set.count(unicode("\U0001F600")) == 1);
+    CHECK(set.begin()->compare(unicode("a")) == 0);
+    CHECK(std::prev(set.end())->compare(unicode("\U0001F600")) == 0);
+}
+
+TEST_CASE("Compact repertoires convert by widening") {
+    const char* ptr = "Gr\xc3\xbc\xc3\x9f dich, and enough ASCII to take the vector path";
+    unicode u = ptr;
+    REQUIRE(u.repertoire() == repertoire::latin1);
+    const auto u16 = u.encode<utf16>();
+    const auto u32 = u.encode<utf32>();
+    // The same conversion, but through utf8rewind
+    const auto slow = encoder<utf8, utf16>::do_encode(u.data(), u.code_unit_size());
+    REQUIRE(u16.code_unit_size() == slow.code_unit_size());
+    REQUIRE(u32.code_unit_size() == slow.code_unit_size());
+    for (auto i = 0u; i < slow.code_unit_size(); ++i) {
+        CHECK(u16.data()[i] == slow.data()[i]);
+        CHECK(u32.data()[i] == slow.data()[i]);
+    }
+
+    basic_text<utf16> back = u16.data();
+    CHECK(std::strcmp(back.encode<utf8>().data(), ptr) == 0);
+}
+
+TEST_CASE("Write to a stream of another encoding") {
+    // Longer than one stack chunk, with code points that take two UTF-16
+    // units landing on both sides of chunk boundaries
+    std::string long_str;
+    for (auto i = 0; i < 200; ++i) {
+        long_str += "a\xf0\x9f\x98\x80\xc3\xa9";
+    }
+    unicode u = long_str.c_str();
+    std::wostringstream out;
+    out << u;
+    const auto wide_buf = u.encode<wide>();
+    CHECK(out.str() == std::wstring(wide_buf.data(), wide_buf.code_unit_size()));
+
+    std::ostringstream narrow;
+    narrow << basic_text<wide>(wide_buf.data());
+    CHECK(narrow.str() == long_str);
+
+    std::wostringstream ascii;
+    ascii << unicode("Plain ASCII goes through the fast path");
+    CHECK(ascii.str() == L"Plain ASCII goes through the fast path");
+}
+
 // TEST_CASE("Raw view") {
 //     unicode u = "Hi";
 //     auto r = u.raw();
@@ -0,0 +1,83 @@
+#include <neo/unicode.hpp>
+
+#include <catch/catch.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace neo;
+
+namespace {
+
+template <typename Encoding, typename String = std::basic_string<typename Encoding::code_unit_type>>
+std::vector<String> segments(const basic_text<Encoding>& text, word_segments which = word_segments::all) {
+    std::vector<String> ret;
+    for (const auto w : words(text, which)) {
+        ret.emplace_back(w.data(), w.code_unit_size());
+    }
+    return ret;
+}
+
+using strings = std::vector<std::string>;
+
+}  // namespace
+
+TEST_CASE("Split ASCII into words") {
+    CHECK(segments(unicode("")).empty());
+    CHECK(segments(unicode("The quick (\"brown\") fox can't jump 32.3 feet, right?"))
+          == (strings{"The", " ", "quick", " ", "(", "\"", "brown", "\"", ")", " ", "fox", " ", "can't",
+                      " ", "jump", " ", "32.3", " ", "feet", ",", " ", "right", "?"}));
+    // Spaces stay together, but not with line breaks
+    CHECK(segments(unicode("a  b\r\n\nc")) == (strings{"a", "  ", "b", "\r\n", "\n", "c"}));
+    // Only WSegSpace joins, which tabs, NO-BREAK SPACE and FIGURE SPACE aren't
+    CHECK(segments(unicode("a\t b")) == (strings{"a", "\t", " ", "b"}));
+    CHECK(segments(unicode("a\xc2\xa0 b")) == (strings{"a", "\xc2\xa0", " ", "b"}));
+    CHECK(segments(unicode("a\xe2\x80\x87 b")) == (strings{"a", "\xe2\x80\x87", " ", "b"}));
+    CHECK(segments(unicode("a\xe2\x80\x83 b")) == (strings{"a", "\xe2\x80\x83 ", "b"}));
+    // Letters, digits and connectors; punctuation only joins between them
+    CHECK(segments(unicode("snake_case x1 1,000 e.g. a.")) == (strings{"snake_case", " ", "x1", " ", "1,000", " ",
+                                                                       "e.g", ".", " ", "a", "."}));
+    // Long words cross the blocks that are skipped at once
+    const std::string longer = "Supercalifragilisticexpialidocious1234567890abcdefghijklm";
+    CHECK(segments(unicode((longer + "'s " + longer).data())) == (strings{longer + "'s", " ", longer}));
+}
+
+TEST_CASE("Split other scripts and emoji into words") {
+    // Combining marks and format characters stay with what they follow
+    CHECK(segments(unicode("cafe\xcc\x81 na\xc3\xafve")) == (strings{"cafe\xcc\x81", " ", "na\xc3\xafve"}));
+    CHECK(segments(unicode("a\xc2\xad" "b")) == (strings{"a\xc2\xad" "b"}));
+    // Katakana joins Katakana; each ideograph is a segment
+    CHECK(segments(unicode("\xe3\x82\xab\xe3\x82\xbf\xe3\x82\xab\xe3\x83\x8a\xe6\xbc\xa2\xe5\xad\x97"))
+          == (strings{"\xe3\x82\xab\xe3\x82\xbf\xe3\x82\xab\xe3\x83\x8a", "\xe6\xbc\xa2", "\xe5\xad\x97"}));
+    // Hebrew letters around a gershayim-like double quote
+    CHECK(segments(unicode("\xd7\xa6\xd7\x94\"\xd7\x9c")) == (strings{"\xd7\xa6\xd7\x94\"\xd7\x9c"}));
+    // Flags pair up, and emoji join with ZWJ
+    CHECK(segments(unicode("\xf0\x9f\x87\xab\xf0\x9f\x87\xb7\xf0\x9f\x87\xa9"))
+          == (strings{"\xf0\x9f\x87\xab\xf0\x9f\x87\xb7", "\xf0\x9f\x87\xa9"}));
+    CHECK(segments(unicode("\xf0\x9f\x91\xa8\xe2\x80\x8d\xf0\x9f\x91\xa9 x"))
+          == (strings{"\xf0\x9f\x91\xa8\xe2\x80\x8d\xf0\x9f\x91\xa9", " ", "x"}));
+
+    // The same words in UTF-16
+    const unicode mixed = "na\xc3\xafve caf\xc3\xa9, 3.14!";
+    const auto u16 = mixed.encode<utf16>();
+    const auto units = segments(basic_text<utf16>(u16.data()));
+    REQUIRE(units.size() == 7);
+    CHECK(units[0] == u"na\u00efve");
+    CHECK(units[5] == u"3.14");
+}
+
+TEST_CASE("Skip space and punctuation between words") {
+    const unicode text = "Hello, world! \xe2\x80\x94 it's 9:30\xe2\x80\xa6 \xf0\x9f\x91\x8d";
+    CHECK(segments(text, word_segments::skip_space_and_punctuation)
+          == (strings{"Hello", "world", "it's", "9", "30", "\xf0\x9f\x91\x8d"}));
+    CHECK(segments(unicode(" ,.; "), word_segments::skip_space_and_punctuation).empty());
+
+    // Views of words point into the text
+    const auto range = words(text, word_segments::skip_space_and_punctuation);
+    auto it = range.begin();
+    CHECK((*it).data() == text.data());
+    ++it;
+    CHECK(*it == unicode("world"));
+    CHECK(it.position() == text.data() + 7);
+    CHECK(*words(text_view(*it)).begin() == unicode("world"));
+}
@@ -0,0 +1,263 @@
+#!/usr/bin/env python3
+"""
+Generate source/neo/unicode/ucd_tables.cpp from files of the Unicode
+Character Database.
+
+    python3 tools/ucd_tables.py <ucd-directory>
+
+Each property is stored as a two-stage table: the first stage maps a block
+of code points to one of the distinct blocks in the second stage, which holds
+a byte per code point. The value numbering must match the enums in
+ucd_tables.hpp. The few paired brackets of UAX #9 are a sorted array.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+MAX_CODE_POINT = 0x10FFFF
+
+GRAPHEME_BREAK = ['Other', 'CR', 'LF', 'Control', 'Extend', 'ZWJ', 'Regional_Indicator', 'Prepend',
+                  'SpacingMark', 'L', 'V', 'T', 'LV', 'LVT']
+EXTENDED_PICTOGRAPHIC = 0x10
+
+WORD_BREAK = ['Other', 'CR', 'LF', 'Newline', 'Extend', 'ZWJ', 'Regional_Indicator', 'Format', 'Katakana',
+              'Hebrew_Letter', 'ALetter', 'Single_Quote', 'Double_Quote', 'MidNumLet', 'MidLetter', 'MidNum',
+              'Numeric', 'ExtendNumLet', 'WSegSpace']
+WORD_PICTOGRAPHIC = 0x20
+WORD_SPACE_OR_PUNCTUATION = 0x40
+
+# Line_Break after the resolution of LB1: AI, SG and XX become AL, SA becomes
+# CM or AL, and CJ becomes NS
+LINE_BREAK = ['BK', 'CR', 'LF', 'CM', 'NL', 'WJ', 'ZW', 'GL', 'SP', 'ZWJ', 'B2', 'BA', 'BB', 'HY', 'CB', 'CL', 'CP',
+              'EX', 'IN', 'NS', 'OP', 'QU', 'IS', 'NU', 'PO', 'PR', 'SY', 'AL', 'EB', 'EM', 'H2', 'H3', 'HL', 'ID',
+              'JL', 'JV', 'JT', 'RI']
+LINE_PICTOGRAPHIC_UNASSIGNED = 0x40
+LINE_EAST_ASIAN_WIDE = 0x80
+
+SENTENCE_BREAK = ['Other', 'CR', 'LF', 'Extend', 'Sep', 'Format', 'Sp', 'Lower', 'Upper', 'OLetter', 'Numeric',
+                  'ATerm', 'SContinue', 'STerm', 'Close']
+
+BIDI_CLASS = ['L', 'R', 'AL', 'EN', 'ES', 'ET', 'AN', 'CS', 'NSM', 'BN', 'B', 'S', 'WS', 'ON', 'LRE', 'LRO', 'RLE',
+              'RLO', 'PDF', 'LRI', 'RLI', 'FSI', 'PDI']
+BIDI_BRACKET = 0x20
+# The classes that can make a paragraph other than all left-to-right, and
+# the UTF-8 lead bytes that bidi.hpp checks for them
+BIDI_RIGHT_TO_LEFT = ['R', 'AL', 'AN', 'LRE', 'LRO', 'RLE', 'RLO', 'PDF', 'LRI', 'RLI', 'FSI', 'PDI']
+BIDI_RIGHT_TO_LEFT_LEADS = set(range(0xD6, 0xE1)) | {0xE2, 0xEF, 0xF0}
+
+# Display width in columns is the low two bits. Marks, formatting and control
+# characters take none, as do the medial vowels and final consonants of
+# conjoining Hangul. East Asian wide and emoji presentation take two.
+WIDTH_ZERO_CATEGORIES = ('Mn', 'Me', 'Cf', 'Cc', 'Zl', 'Zp')
+WIDTH_ZERO_RANGES = [(0x1160, 0x11FF), (0xD7B0, 0xD7FF)]
+WIDTH_EMOJI = 0x04
+
+
+def read_ranges(path):
+    """Yield (first, last, value) for every data line of a UCD file"""
+    line_re = re.compile(r'^([0-9A-F]+)(?:\.\.([0-9A-F]+))?\s*;\s*([^#\s]+)')
+    with open(path, encoding='utf-8') as f:
+        for line in f:
+            m = line_re.match(line)
+            if m:
+                first = int(m.group(1), 16)
+                last = int(m.group(2), 16) if m.group(2) else first
+                yield first, last, m.group(3)
+
+
+def read_property(path, names, default=0):
+    """A list with the index in `names` of the value of every code point"""
+    values = [default] * (MAX_CODE_POINT + 1)
+    for first, last, name in read_ranges(path):
+        if name in names:
+            for cp in range(first, last + 1):
+                values[cp] = names.index(name)
+    return values
+
+
+def read_flag(path, wanted):
+    """A list of whether every code point has a value that is `wanted`, or
+    that `wanted` accepts if it is a function"""
+    if not callable(wanted):
+        name = wanted
+        wanted = lambda value: value == name
+    flags = [False] * (MAX_CODE_POINT + 1)
+    for first, last, value in read_ranges(path):
+        if wanted(value):
+            for cp in range(first, last + 1):
+                flags[cp] = True
+    return flags
+
+
+def read_brackets(path):
+    """A sorted list of (code point, paired bracket, whether it opens) from
+    BidiBrackets.txt"""
+    line_re = re.compile(r'^([0-9A-F]+)\s*;\s*([0-9A-F]+)\s*;\s*([oc])')
+    brackets = []
+    with open(path, encoding='utf-8') as f:
+        for line in f:
+            m = line_re.match(line)
+            if m:
+                brackets.append((int(m.group(1), 16), int(m.group(2), 16), m.group(3) == 'o'))
+    return sorted(brackets)
+
+
+def two_stage(values):
+    """Split into the smallest two-stage table, as (shift, stage1, stage2)"""
+    best = None
+    for shift in range(5, 10):
+        size = 1 << shift
+        blocks = {}
+        stage1 = []
+        stage2 = []
+        for start in range(0, MAX_CODE_POINT + 1, size):
+            block = tuple(values[start:start + size])
+            if block not in blocks:
+                blocks[block] = len(blocks)
+                stage2.extend(block)
+            stage1.append(blocks[block])
+        width = 1 if len(blocks) <= 256 else 2
+        cost = len(stage1) * width + len(stage2)
+        if best is None or cost < best[0]:
+            best = (cost, shift, stage1, stage2)
+    return best[1:]
+
+
+def emit_table(out, name, values):
+    shift, stage1, stage2 = two_stage(values)
+    out.append('static_assert({}_table_shift == {}, "ucd_tables.hpp must match the tables");'.format(name, shift))
+    out.append('')
+    index_type = 'std::uint8_t' if max(stage1) < 256 else 'std::uint16_t'
+    out.append('const {} {}_stage1[{}] = {{'.format(index_type, name, len(stage1)))
+    out.extend(wrap(stage1))
+    out.append('};')
+    out.append('')
+    out.append('const std::uint8_t {}_stage2[{}] = {{'.format(name, len(stage2)))
+    out.extend(wrap(stage2))
+    out.append('};')
+    out.append('')
+    return shift, index_type
+
+
+def wrap(numbers, width=100):
+    lines = []
+    line = '   '
+    for n in numbers:
+        item = ' {},'.format(n)
+        if len(line) + len(item) > width:
+            lines.append(line)
+            line = '   '
+        line += item
+    lines.append(line)
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument('ucd', help='directory with the UCD files')
+    parser.add_argument('--output',
+                        default=os.path.join(os.path.dirname(__file__), '..', 'source', 'neo', 'unicode',
+                                             'ucd_tables.cpp'))
+    args = parser.parse_args()
+
+    def ucd(name):
+        return os.path.join(args.ucd, name)
+
+    version = 'unknown'
+    with open(ucd('GraphemeBreakProperty.txt'), encoding='utf-8') as f:
+        m = re.search(r'(\d+\.\d+\.\d+)', f.readline())
+        if m:
+            version = m.group(1)
+
+    grapheme = read_property(ucd('GraphemeBreakProperty.txt'), GRAPHEME_BREAK)
+    pictographic = read_flag(ucd('emoji-data.txt'), 'Extended_Pictographic')
+    grapheme = [g | (EXTENDED_PICTOGRAPHIC if p else 0) for g, p in zip(grapheme, pictographic)]
+
+    word = read_property(ucd('WordBreakProperty.txt'), WORD_BREAK)
+    # WSegSpace is exactly General_Category=Zs without Line_Break=GL. Data that
+    # is tailored to all horizontal space, as Perl's is, would join tabs and
+    # no-break spaces under WB3d.
+    zs = read_flag(ucd('DerivedGeneralCategory.txt'), 'Zs')
+    glue = read_flag(ucd('LineBreak.txt'), 'GL')
+    for cp, (w, z, g) in enumerate(zip(word, zs, glue)):
+        if (w == WORD_BREAK.index('WSegSpace')) != (z and not g):
+            sys.exit('U+{:04X} has a tailored Word_Break value'.format(cp))
+    space = read_flag(ucd('PropList.txt'), 'White_Space')
+    punctuation = read_flag(ucd('DerivedGeneralCategory.txt'), lambda gc: gc.startswith('P'))
+    word = [w | (WORD_PICTOGRAPHIC if p else 0) | (WORD_SPACE_OR_PUNCTUATION if s or q else 0)
+            for w, p, s, q in zip(word, pictographic, space, punctuation)]
+
+    sentence = read_property(ucd('SentenceBreakProperty.txt'), SENTENCE_BREAK)
+
+    marks = read_flag(ucd('DerivedGeneralCategory.txt'), lambda gc: gc in ('Mn', 'Mc'))
+    unassigned = read_flag(ucd('DerivedGeneralCategory.txt'), 'Cn')
+    wide = read_flag(ucd('EastAsianWidth.txt'), lambda ea: ea in ('F', 'W', 'H'))
+    line_names = {'AI': 'AL', 'SG': 'AL', 'XX': 'AL', 'Unknown': 'AL', 'CJ': 'NS'}
+    line = [LINE_BREAK.index('AL')] * (MAX_CODE_POINT + 1)
+    for first, last, name in read_ranges(ucd('LineBreak.txt')):
+        for cp in range(first, last + 1):
+            if name == 'SA':
+                resolved = 'CM' if marks[cp] else 'AL'
+            else:
+                resolved = line_names.get(name, name)
+            line[cp] = LINE_BREAK.index(resolved)
+    line = [l | (LINE_PICTOGRAPHIC_UNASSIGNED if p and u else 0) | (LINE_EAST_ASIAN_WIDE if w else 0)
+            for l, p, u, w in zip(line, pictographic, unassigned, wide)]
+
+    bidi = read_property(ucd('DerivedBidiClass.txt'), BIDI_CLASS)
+    brackets = read_brackets(ucd('BidiBrackets.txt'))
+    for cp, _, _ in brackets:
+        bidi[cp] |= BIDI_BRACKET
+    for cp, value in enumerate(bidi):
+        if BIDI_CLASS[value & 0x1F] in BIDI_RIGHT_TO_LEFT and chr(cp).encode('utf-8')[0] not in BIDI_RIGHT_TO_LEFT_LEADS:
+            sys.exit('U+{:04X} needs another lead byte in bidi.hpp'.format(cp))
+
+    zero_width = read_flag(ucd('DerivedGeneralCategory.txt'), lambda gc: gc in WIDTH_ZERO_CATEGORIES)
+    for first, last in WIDTH_ZERO_RANGES:
+        for cp in range(first, last + 1):
+            zero_width[cp] = True
+    # Soft hyphen shows as a hyphen where it is displayed at all
+    zero_width[0x00AD] = False
+    emoji = read_flag(ucd('emoji-data.txt'), 'Emoji')
+    emoji_presentation = read_flag(ucd('emoji-data.txt'), 'Emoji_Presentation')
+    wide = read_flag(ucd('EastAsianWidth.txt'), lambda ea: ea in ('F', 'W'))
+    width = [(0 if z else 2 if w or p else 1) | (WIDTH_EMOJI if e else 0)
+             for z, w, p, e in zip(zero_width, wide, emoji_presentation, emoji)]
+
+    out = [
+        '// Generated by tools/ucd_tables.py from the Unicode Character Database {}.'.format(version),
+        '// Do not edit.',
+        '',
+        '#include "ucd_tables.hpp"',
+        '',
+        'namespace neo {',
+        '',
+        'namespace unicode_detail {',
+        '',
+    ]
+    shifts = []
+    for name, values in [('grapheme', grapheme), ('word', word), ('sentence', sentence), ('line', line), ('bidi', bidi),
+                         ('width', width)]:
+        shift, index_type = emit_table(out, name, values)
+        shifts.append((name, shift, index_type))
+    out.append('static_assert(bidi_bracket_count == {}, "ucd_tables.hpp must match the tables");'.format(
+        len(brackets)))
+    out.append('')
+    out.append('const bidi_bracket bidi_brackets[{}] = {{'.format(len(brackets)))
+    out.extend(wrap(['{{0x{:04X}, 0x{:04X}, {}}}'.format(cp, pair, 'true' if opening else 'false')
+                     for cp, pair, opening in brackets]))
+    out.append('};')
+    out.append('')
+    out.append('}  // namespace unicode_detail')
+    out.append('')
+    out.append('}  // namespace neo')
+    with open(args.output, 'w', encoding='utf-8') as f:
+        f.write('\n'.join(out) + '\n')
+    for name, shift, index_type in shifts:
+        print('{}: shift {}, first stage of {}'.format(name, shift, index_type))
+
+
+if __name__ == '__main__':
+    sys.exit(main())